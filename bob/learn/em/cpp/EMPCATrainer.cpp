@@ -8,27 +8,33 @@
 #include <vector>
 #include <algorithm>
 #include <boost/random.hpp>
+#include <boost/format.hpp>
 #include <cmath>
 
 #include <bob.learn.em/EMPCATrainer.h>
 #include <bob.core/array_copy.h>
 #include <bob.core/check.h>
+#include <bob.core/assert.h>
 #include <bob.math/linear.h>
 #include <bob.math/det.h>
 #include <bob.math/inv.h>
 #include <bob.math/pinv.h>
 #include <bob.math/stats.h>
 
+// Maximum number of samples processed at once by the E-step
+static const int s_empca_block_size = 256;
+
 bob::learn::em::EMPCATrainer::EMPCATrainer(bool compute_likelihood):
   m_compute_likelihood(compute_likelihood),
   m_rng(new boost::mt19937()),
-  m_S(0,0),
-  m_z_first_order(0,0), m_z_second_order(0,0,0),
+  m_S(0,0), m_n_mean_variance(0),
+  m_z_first_order(0,0), m_sum_z_second_order(0,0),
+  m_sum_t_z(0,0), m_sum_t_square(0), m_n_samples(0),
   m_inW(0,0), m_invM(0,0), m_sigma2(0), m_f_log2pi(0),
-  m_tmp_dxf(0,0), m_tmp_d(0), m_tmp_f(0),
+  m_tmp_dxf(0,0),
   m_tmp_dxd_1(0,0), m_tmp_dxd_2(0,0),
   m_tmp_fxd_1(0,0), m_tmp_fxd_2(0,0),
-  m_tmp_fxf_1(0,0), m_tmp_fxf_2(0,0)
+  m_tmp_bxf(0,0), m_tmp_bxd(0,0)
 {
 }
 
@@ -36,20 +42,22 @@ bob::learn::em::EMPCATrainer::EMPCATrainer(const bob::learn::em::EMPCATrainer& o
   m_compute_likelihood(other.m_compute_likelihood),
   m_rng(other.m_rng),
   m_S(bob::core::array::ccopy(other.m_S)),
+  m_n_mean_variance(other.m_n_mean_variance),
   m_z_first_order(bob::core::array::ccopy(other.m_z_first_order)),
-  m_z_second_order(bob::core::array::ccopy(other.m_z_second_order)),
+  m_sum_z_second_order(bob::core::array::ccopy(other.m_sum_z_second_order)),
+  m_sum_t_z(bob::core::array::ccopy(other.m_sum_t_z)),
+  m_sum_t_square(other.m_sum_t_square),
+  m_n_samples(other.m_n_samples),
   m_inW(bob::core::array::ccopy(other.m_inW)),
   m_invM(bob::core::array::ccopy(other.m_invM)),
   m_sigma2(other.m_sigma2), m_f_log2pi(other.m_f_log2pi),
   m_tmp_dxf(bob::core::array::ccopy(other.m_tmp_dxf)),
-  m_tmp_d(bob::core::array::ccopy(other.m_tmp_d)),
-  m_tmp_f(bob::core::array::ccopy(other.m_tmp_f)),
   m_tmp_dxd_1(bob::core::array::ccopy(other.m_tmp_dxd_1)),
   m_tmp_dxd_2(bob::core::array::ccopy(other.m_tmp_dxd_2)),
   m_tmp_fxd_1(bob::core::array::ccopy(other.m_tmp_fxd_1)),
   m_tmp_fxd_2(bob::core::array::ccopy(other.m_tmp_fxd_2)),
-  m_tmp_fxf_1(bob::core::array::ccopy(other.m_tmp_fxf_1)),
-  m_tmp_fxf_2(bob::core::array::ccopy(other.m_tmp_fxf_2))
+  m_tmp_bxf(bob::core::array::ccopy(other.m_tmp_bxf)),
+  m_tmp_bxd(bob::core::array::ccopy(other.m_tmp_bxd))
 {
 }
 
@@ -65,21 +73,23 @@ bob::learn::em::EMPCATrainer& bob::learn::em::EMPCATrainer::operator=
     m_rng                   = other.m_rng;
 	m_compute_likelihood    = other.m_compute_likelihood;
     m_S = bob::core::array::ccopy(other.m_S);
+    m_n_mean_variance = other.m_n_mean_variance;
     m_z_first_order = bob::core::array::ccopy(other.m_z_first_order);
-    m_z_second_order = bob::core::array::ccopy(other.m_z_second_order);
+    m_sum_z_second_order = bob::core::array::ccopy(other.m_sum_z_second_order);
+    m_sum_t_z = bob::core::array::ccopy(other.m_sum_t_z);
+    m_sum_t_square = other.m_sum_t_square;
+    m_n_samples = other.m_n_samples;
     m_inW = bob::core::array::ccopy(other.m_inW);
     m_invM = bob::core::array::ccopy(other.m_invM);
     m_sigma2 = other.m_sigma2;
     m_f_log2pi = other.m_f_log2pi;
     m_tmp_dxf = bob::core::array::ccopy(other.m_tmp_dxf);
-    m_tmp_d = bob::core::array::ccopy(other.m_tmp_d);
-    m_tmp_f = bob::core::array::ccopy(other.m_tmp_f);
     m_tmp_dxd_1 = bob::core::array::ccopy(other.m_tmp_dxd_1);
     m_tmp_dxd_2 = bob::core::array::ccopy(other.m_tmp_dxd_2);
     m_tmp_fxd_1 = bob::core::array::ccopy(other.m_tmp_fxd_1);
     m_tmp_fxd_2 = bob::core::array::ccopy(other.m_tmp_fxd_2);
-    m_tmp_fxf_1 = bob::core::array::ccopy(other.m_tmp_fxf_1);
-    m_tmp_fxf_2 = bob::core::array::ccopy(other.m_tmp_fxf_2);
+    m_tmp_bxf = bob::core::array::ccopy(other.m_tmp_bxf);
+    m_tmp_bxd = bob::core::array::ccopy(other.m_tmp_bxd);
   }
   return *this;
 }
@@ -90,8 +100,12 @@ bool bob::learn::em::EMPCATrainer::operator==
   return m_compute_likelihood == other.m_compute_likelihood &&
         m_rng                   == other.m_rng &&
         bob::core::array::isEqual(m_S, other.m_S) &&
+        m_n_mean_variance == other.m_n_mean_variance &&
         bob::core::array::isEqual(m_z_first_order, other.m_z_first_order) &&
-        bob::core::array::isEqual(m_z_second_order, other.m_z_second_order) &&
+        bob::core::array::isEqual(m_sum_z_second_order, other.m_sum_z_second_order) &&
+        bob::core::array::isEqual(m_sum_t_z, other.m_sum_t_z) &&
+        m_sum_t_square == other.m_sum_t_square &&
+        m_n_samples == other.m_n_samples &&
         bob::core::array::isEqual(m_inW, other.m_inW) &&
         bob::core::array::isEqual(m_invM, other.m_invM) &&
         m_sigma2 == other.m_sigma2 &&
@@ -111,8 +125,12 @@ bool bob::learn::em::EMPCATrainer::is_similar_to
   return m_compute_likelihood == other.m_compute_likelihood &&
          m_rng                == other.m_rng &&
          bob::core::array::isClose(m_S, other.m_S, r_epsilon, a_epsilon) &&
+         m_n_mean_variance == other.m_n_mean_variance &&
          bob::core::array::isClose(m_z_first_order, other.m_z_first_order, r_epsilon, a_epsilon) &&
-         bob::core::array::isClose(m_z_second_order, other.m_z_second_order, r_epsilon, a_epsilon) &&
+         bob::core::array::isClose(m_sum_z_second_order, other.m_sum_z_second_order, r_epsilon, a_epsilon) &&
+         bob::core::array::isClose(m_sum_t_z, other.m_sum_t_z, r_epsilon, a_epsilon) &&
+         bob::core::isClose(m_sum_t_square, other.m_sum_t_square, r_epsilon, a_epsilon) &&
+         m_n_samples == other.m_n_samples &&
          bob::core::array::isClose(m_inW, other.m_inW, r_epsilon, a_epsilon) &&
          bob::core::array::isClose(m_invM, other.m_invM, r_epsilon, a_epsilon) &&
          bob::core::isClose(m_sigma2, other.m_sigma2, r_epsilon, a_epsilon) &&
@@ -123,7 +141,7 @@ void bob::learn::em::EMPCATrainer::initialize(bob::learn::linear::Machine& machi
   const blitz::Array<double,2>& ar)
 {
   // reinitializes array members and checks dimensionality
-  initMembers(machine, ar);
+  initMembers(machine, ar.extent(0), ar.extent(1));
 
   // computes the mean and the covariance if required
   computeMeanVariance(machine, ar);
@@ -140,12 +158,8 @@ void bob::learn::em::EMPCATrainer::initialize(bob::learn::linear::Machine& machi
 
 void bob::learn::em::EMPCATrainer::initMembers(
   const bob::learn::linear::Machine& machine,
-  const blitz::Array<double,2>& ar)
+  const size_t n_samples, const size_t n_features)
 {
-  // Gets dimensions
-  const size_t n_samples = ar.extent(0);
-  const size_t n_features = ar.extent(1);
-
   // Checks that the dimensions are matching
   const size_t n_inputs = machine.inputSize();
   const size_t n_outputs = machine.outputSize();
@@ -162,8 +176,12 @@ void bob::learn::em::EMPCATrainer::initMembers(
     m_S.resize(n_features,n_features);
   else
     m_S.resize(0,0);
+  m_n_mean_variance = 0;
   m_z_first_order.resize(n_samples, n_outputs);
-  m_z_second_order.resize(n_samples, n_outputs, n_outputs);
+  m_sum_z_second_order.resize(n_outputs, n_outputs);
+  m_sum_t_z.resize(n_features, n_outputs);
+  m_sum_t_square = 0.;
+  m_n_samples = n_samples;
   m_inW.resize(n_outputs, n_outputs);
   m_invM.resize(n_outputs, n_outputs);
   m_sigma2 = 0.;
@@ -171,48 +189,116 @@ void bob::learn::em::EMPCATrainer::initMembers(
 
   // Cache
   m_tmp_dxf.resize(n_outputs, n_features);
-  m_tmp_d.resize(n_outputs);
-  m_tmp_f.resize(n_features);
-  
+  m_tmp_bxf.resize(std::min((int)n_samples, s_empca_block_size), n_features);
+  m_tmp_bxd.resize(0, 0);
   m_tmp_dxd_1.resize(n_outputs, n_outputs);
   m_tmp_dxd_2.resize(n_outputs, n_outputs);
   m_tmp_fxd_1.resize(n_features, n_outputs);
   m_tmp_fxd_2.resize(n_features, n_outputs);
-  // The following large cache matrices are only required to compute the
-  // log likelihood.
-  if (m_compute_likelihood)
-  {
-    m_tmp_fxf_1.resize(n_features, n_features);
-    m_tmp_fxf_2.resize(n_features, n_features);
-  }
-  else
-  {
-    m_tmp_fxf_1.resize(0,0);
-    m_tmp_fxf_2.resize(0,0);
-  }
 }
 
 void bob::learn::em::EMPCATrainer::computeMeanVariance(bob::learn::linear::Machine& machine,
   const blitz::Array<double,2>& ar)
 {
-  size_t n_samples = ar.extent(0);
-  blitz::Array<double,1> mu = machine.updateInputSubtraction();
+  // Single pass over the data, which is merged into empty statistics
+  m_n_mean_variance = 0;
+  machine.updateInputSubtraction() = 0.;
+  if (m_compute_likelihood) m_S = 0.;
+  accMeanVariance(machine, ar);
+}
+
+void bob::learn::em::EMPCATrainer::resetMeanVariance(bob::learn::linear::Machine& machine)
+{
+  // reinitializes array members; the latent means of the samples are not
+  // kept when the data is streamed
+  initMembers(machine, 0, machine.inputSize());
+  machine.updateInputSubtraction() = 0.;
+  if (m_compute_likelihood) m_S = 0.;
+}
+
+void bob::learn::em::EMPCATrainer::accMeanVariance(bob::learn::linear::Machine& machine,
+  const blitz::Array<double,2>& ar)
+{
+  const size_t n_chunk = ar.extent(0);
+  const size_t n_features = ar.extent(1);
+  if (n_features != machine.inputSize()) {
+    boost::format m("number of inputs (%u) does not match the number of features (%u)");
+    m % machine.inputSize() % n_features;
+    throw std::runtime_error(m.str());
+  }
+  if (n_chunk == 0) return;
+
+  // Mean (and scatter) of the chunk
+  blitz::Array<double,1> mu_chunk(n_features);
   blitz::Range all = blitz::Range::all();
   if (m_compute_likelihood)
   {
-    // Mean and scatter computation
-    bob::math::scatter(ar, m_S, mu);
-    // divides scatter by N-1
-    m_S /= static_cast<double>(n_samples-1);
+    blitz::Array<double,2> S_chunk(n_features, n_features);
+    bob::math::scatter(ar, S_chunk, mu_chunk);
+    m_S += S_chunk;
   }
   else
   {
-    // computes the mean and updates mu
-    mu = 0.;
-    for (size_t i=0; i<n_samples; ++i)
-      mu += ar(i,all);
-    mu /= static_cast<double>(n_samples);
+    mu_chunk = 0.;
+    for (size_t i=0; i<n_chunk; ++i)
+      mu_chunk += ar(i,all);
+    mu_chunk /= static_cast<double>(n_chunk);
+  }
+
+  // Merges the statistics of the chunk with the current ones (Chan et al.):
+  //   delta = mu_chunk - mu
+  //   mu += n_chunk / n * delta
+  //   S += S_chunk + n_prev * n_chunk / n * delta.delta^T
+  blitz::Array<double,1> mu = machine.updateInputSubtraction();
+  const double n_prev = static_cast<double>(m_n_mean_variance);
+  const double n = n_prev + n_chunk;
+  blitz::Array<double,1> delta(n_features);
+  delta = mu_chunk - mu;
+  if (m_compute_likelihood && m_n_mean_variance > 0)
+  {
+    blitz::firstIndex i;
+    blitz::secondIndex j;
+    m_S += (n_prev * n_chunk / n) * delta(i) * delta(j);
   }
+  mu += (n_chunk / n) * delta;
+  m_n_mean_variance += n_chunk;
+}
+
+void bob::learn::em::EMPCATrainer::initialize(bob::learn::linear::Machine& machine)
+{
+  if (m_n_mean_variance < 2) {
+    boost::format m("at least two samples are required to initialize the trainer, but only %u were accumulated");
+    m % m_n_mean_variance;
+    throw std::runtime_error(m.str());
+  }
+
+  // Random initialization of W and sigma2
+  initRandomWSigma2(machine);
+
+  // Computes the product m_inW = W^T.W
+  computeWtW(machine);
+  // Computes inverse(M), where M = Wt * W + sigma2 * Id
+  computeInvM();
+}
+
+void bob::learn::em::EMPCATrainer::save(bob::io::base::HDF5File& config) const
+{
+  config.set("sigma2", m_sigma2);
+  config.setArray("inW", m_inW);
+  config.setArray("invM", m_invM);
+}
+
+void bob::learn::em::EMPCATrainer::load(bob::io::base::HDF5File& config)
+{
+  const blitz::Array<double,2> inW = config.readArray<double,2>("inW");
+  if (inW.extent(0) != m_inW.extent(0) || inW.extent(1) != m_inW.extent(1)) {
+    boost::format m("the saved state of the trainer has %d outputs, whereas the trainer was initialized with %d");
+    m % inW.extent(0) % m_inW.extent(0);
+    throw std::runtime_error(m.str());
+  }
+  m_sigma2 = config.read<double>("sigma2");
+  m_inW = inW;
+  m_invM = config.readArray<double,2>("invM");
 }
 
 void bob::learn::em::EMPCATrainer::initRandomWSigma2(bob::learn::linear::Machine& machine)
@@ -251,116 +337,181 @@ void bob::learn::em::EMPCATrainer::computeInvM()
 
 void bob::learn::em::EMPCATrainer::eStep(bob::learn::linear::Machine& machine, const blitz::Array<double,2>& ar)
 {
-  // Gets mu and W from the machine
-  const blitz::Array<double,1>& mu = machine.getInputSubtraction();
+  if ((size_t)ar.extent(1) != machine.inputSize()) {
+    boost::format m("number of inputs (%u) does not match the number of features (%u)");
+    m % machine.inputSize() % ar.extent(1);
+    throw std::runtime_error(m.str());
+  }
+
+  // m_tmp_dxf = inv(M) * W^T (does not depend on the sample)
   const blitz::Array<double,2>& W = machine.getWeights();
-  const blitz::Array<double,2> Wt = W.transpose(1,0); // W^T
+  bob::math::prod(m_invM, W.transpose(1,0), m_tmp_dxf);
+
+  // The trainer may have been initialized with another number of samples,
+  // or by streaming the data, in which case no latent mean is kept
+  m_z_first_order.resize(ar.extent(0), W.extent(1));
+  const int n_block = std::min(ar.extent(0), s_empca_block_size);
+  if (m_tmp_bxf.extent(0) < n_block)
+    m_tmp_bxf.resize(n_block, ar.extent(1));
+
+  // Computes the statistics, keeping the latent means of all the samples
+  resetStatistics();
+  accBlocks(machine, ar, m_z_first_order);
+}
+
+void bob::learn::em::EMPCATrainer::resetStatistics()
+{
+  m_sum_z_second_order = 0.;
+  m_sum_t_z = 0.;
+  m_sum_t_square = 0.;
+  m_n_samples = 0;
+}
+
+void bob::learn::em::EMPCATrainer::accStatistics(const bob::learn::linear::Machine& machine,
+  const blitz::Array<double,2>& ar)
+{
+  if ((size_t)ar.extent(1) != machine.inputSize()) {
+    boost::format m("number of inputs (%u) does not match the number of features (%u)");
+    m % machine.inputSize() % ar.extent(1);
+    throw std::runtime_error(m.str());
+  }
+
+  // m_tmp_dxf = inv(M) * W^T (does not depend on the sample)
+  const blitz::Array<double,2>& W = machine.getWeights();
+  bob::math::prod(m_invM, W.transpose(1,0), m_tmp_dxf);
+
+  // The latent means are only kept for the current block
+  const int n_block = std::min(ar.extent(0), s_empca_block_size);
+  if (m_tmp_bxf.extent(0) < n_block)
+    m_tmp_bxf.resize(n_block, ar.extent(1));
+  if (m_tmp_bxd.extent(0) < n_block)
+    m_tmp_bxd.resize(n_block, W.extent(1));
+  accBlocks(machine, ar, m_tmp_bxd);
+}
+
+void bob::learn::em::EMPCATrainer::accBlocks(const bob::learn::linear::Machine& machine,
+  const blitz::Array<double,2>& ar, blitz::Array<double,2>& Z)
+{
+  const blitz::Array<double,1>& mu = machine.getInputSubtraction();
+  const blitz::Array<double,2> invMWt_t = m_tmp_dxf.transpose(1,0);
+  const int n_samples = ar.extent(0);
+  // Z either contains all the samples (eStep) or a single block (streaming)
+  const bool z_per_block = Z.extent(0) < n_samples;
 
-  // Computes the statistics
+  // Computes the statistics, by blocks of samples
   blitz::Range a = blitz::Range::all();
-  for(int i=0; i<ar.extent(0); ++i)
+  blitz::firstIndex bi;
+  blitz::secondIndex bj;
+  for (int b0=0; b0<n_samples; b0+=s_empca_block_size)
   {
-    /// 1/ First order statistics: \f$z_first_order_i = inv(M) W^T (t - \mu)\f$
-    // m_tmp_f = t (sample) - mu (normalized sample)
-    m_tmp_f = ar(i,a) - mu;
-    // m_tmp_dxf = inv(M) * W^T
-    bob::math::prod(m_invM, Wt, m_tmp_dxf);
-    blitz::Array<double,1> z_first_order_i = m_z_first_order(i,blitz::Range::all());
-    // z_first_order_i = inv(M) * W^T * (t - mu)
-    bob::math::prod(m_tmp_dxf, m_tmp_f, z_first_order_i);
-
-    /// 2/ Second order statistics:
-    ///     z_second_order_i = sigma2 * inv(M) + z_first_order_i * z_first_order_i^T
-    blitz::Array<double,2> z_second_order_i = m_z_second_order(i,blitz::Range::all(),blitz::Range::all());
-    // m_tmp_dxd = z_first_order_i * z_first_order_i^T
-    bob::math::prod(z_first_order_i, z_first_order_i, m_tmp_dxd_1); // outer product
-    // z_second_order_i = sigma2 * inv(M)
-    z_second_order_i = m_invM;
-    z_second_order_i *= m_sigma2;
-    // z_second_order_i = sigma2 * inv(M) + z_first_order_i * z_first_order_i^T
-    z_second_order_i += m_tmp_dxd_1;
+    const int b1 = std::min(b0+s_empca_block_size, n_samples) - 1;
+    // T_b = t (samples) - mu (normalized samples)
+    blitz::Array<double,2> T_b = m_tmp_bxf(blitz::Range(0, b1-b0), a);
+    const blitz::Array<double,2> ar_b = ar(blitz::Range(b0, b1), a);
+    T_b = ar_b(bi,bj) - mu(bj);
+
+    /// 1/ First order statistics: \f$Z = (T - \mu) (inv(M) W^T)^T\f$
+    blitz::Array<double,2> Z_b = z_per_block ? Z(blitz::Range(0, b1-b0), a) :
+      Z(blitz::Range(b0, b1), a);
+    bob::math::prod(T_b, invMWt_t, Z_b);
+
+    /// 2/ Sums required by the M-step: (T - mu)^T Z and ||T - mu||^2
+    const blitz::Array<double,2> T_bt = T_b.transpose(1,0);
+    bob::math::prod(T_bt, Z_b, m_tmp_fxd_2);
+    m_sum_t_z += m_tmp_fxd_2;
+    m_sum_t_square += blitz::sum(blitz::pow2(T_b));
+
+    /// 3/ Sum of the second order statistics:
+    ///     sum_i z_second_order_i = sum_i (sigma2 * inv(M) + z_first_order_i * z_first_order_i^T)
+    ///                            = N * sigma2 * inv(M) + Z^T Z
+    const blitz::Array<double,2> Z_bt = Z_b.transpose(1,0);
+    bob::math::prod(Z_bt, Z_b, m_tmp_dxd_1);
+    m_sum_z_second_order += m_tmp_dxd_1;
   }
+  m_sum_z_second_order += (n_samples * m_sigma2) * m_invM;
+  m_n_samples += n_samples;
+}
+
+void bob::learn::em::EMPCATrainer::saveStatistics(bob::io::base::HDF5File& config) const
+{
+  config.setArray("sum_z_second_order", m_sum_z_second_order);
+  config.setArray("sum_t_z", m_sum_t_z);
+  config.set("sum_t_square", m_sum_t_square);
+  config.set("n_samples", static_cast<uint64_t>(m_n_samples));
+}
+
+void bob::learn::em::EMPCATrainer::loadStatistics(bob::io::base::HDF5File& config)
+{
+  const blitz::Array<double,2> sum_t_z = config.readArray<double,2>("sum_t_z");
+  const blitz::Array<double,2> sum_z_second_order = config.readArray<double,2>("sum_z_second_order");
+  bob::core::array::assertSameShape(m_sum_t_z, sum_t_z);
+  bob::core::array::assertSameShape(m_sum_z_second_order, sum_z_second_order);
+  m_sum_t_z = sum_t_z;
+  m_sum_z_second_order = sum_z_second_order;
+  m_sum_t_square = config.read<double>("sum_t_square");
+  m_n_samples = static_cast<size_t>(config.read<uint64_t>("n_samples"));
+}
+
+void bob::learn::em::EMPCATrainer::addStatistics(const bob::learn::em::EMPCATrainer& other)
+{
+  bob::core::array::assertSameShape(m_sum_t_z, other.m_sum_t_z);
+  m_sum_z_second_order += other.m_sum_z_second_order;
+  m_sum_t_z += other.m_sum_t_z;
+  m_sum_t_square += other.m_sum_t_square;
+  m_n_samples += other.m_n_samples;
 }
 
 void bob::learn::em::EMPCATrainer::mStep(bob::learn::linear::Machine& machine, const blitz::Array<double,2>& ar)
+{
+  // The sums of statistics computed by the E-step are sufficient
+  mStep(machine);
+}
+
+void bob::learn::em::EMPCATrainer::mStep(bob::learn::linear::Machine& machine)
 {
   // 1/ New estimate of W
-  updateW(machine, ar);
+  updateW(machine);
 
   // 2/ New estimate of sigma2
-  updateSigma2(machine, ar);
+  updateSigma2(machine);
 
   // Computes the new value of inverse(M), where M = Wt * W + sigma2 * Id
   computeInvM();
 }
 
-void bob::learn::em::EMPCATrainer::updateW(bob::learn::linear::Machine& machine, const blitz::Array<double,2>& ar) {
-  // Get the mean mu and the projection matrix W
-  const blitz::Array<double,1>& mu = machine.getInputSubtraction();
+void bob::learn::em::EMPCATrainer::updateW(bob::learn::linear::Machine& machine) {
+  // Get the projection matrix W
   blitz::Array<double,2>& W = machine.updateWeights();
   const blitz::Array<double,2> Wt = W.transpose(1,0); // W^T
 
   // Compute W = sum{ (t_{i} - mu) z_first_order_i^T} * inv( sum{z_second_order_i} )
-  m_tmp_fxd_1 = 0.;
-  m_tmp_dxd_1 = 0.;
-  blitz::Range a = blitz::Range::all();
-  for(int i=0; i<ar.extent(0); ++i)
-  {
-    // m_tmp_f = t (sample) - mu (normalized sample)
-    m_tmp_f = ar(i,a) - mu;
-    // first order statistics of sample i
-    blitz::Array<double,1> z_first_order_i = m_z_first_order(i,blitz::Range::all());
-    // m_tmp_fxd_2 = (t - mu)*z_first_order_i
-    bob::math::prod(m_tmp_f, z_first_order_i, m_tmp_fxd_2);
-    m_tmp_fxd_1 += m_tmp_fxd_2;
-
-    // second order statistics of sample i
-    blitz::Array<double,2> z_second_order_i = m_z_second_order(i,blitz::Range::all(),blitz::Range::all());
-    m_tmp_dxd_1 += z_second_order_i;
-  }
-
   // m_tmp_dxd_2 = inv( sum(E(x_i.x_i^T)) )
-  bob::math::inv(m_tmp_dxd_1, m_tmp_dxd_2);
+  bob::math::inv(m_sum_z_second_order, m_tmp_dxd_2);
   // New estimates of W
-  bob::math::prod(m_tmp_fxd_1, m_tmp_dxd_2, W);
+  bob::math::prod(m_sum_t_z, m_tmp_dxd_2, W);
   // Updates W'*W as well
   bob::math::prod(Wt, W, m_inW);
 }
 
-void bob::learn::em::EMPCATrainer::updateSigma2(bob::learn::linear::Machine& machine, const blitz::Array<double,2>& ar) {
+void bob::learn::em::EMPCATrainer::updateSigma2(bob::learn::linear::Machine& machine) {
   // Get the mean mu and the projection matrix W
   const blitz::Array<double,1>& mu = machine.getInputSubtraction();
   const blitz::Array<double,2>& W = machine.getWeights();
-  const blitz::Array<double,2> Wt = W.transpose(1,0); // W^T
 
-  m_sigma2 = 0.;
-  blitz::Range a = blitz::Range::all();
-  for(int i=0; i<ar.extent(0); ++i)
-  {
-    // a. sigma2 += || t - mu ||^2
-    // m_tmp_f = t (sample) - mu (normalized sample)
-    m_tmp_f = ar(i,a) - mu;
-    // sigma2 += || t - mu ||^2
-    m_sigma2 += blitz::sum(blitz::pow2(m_tmp_f));
-
-    // b. sigma2 -= 2*E(x_i)^T*W^T*(t - mu)
-    // m_tmp_d = W^T*(t - mu)
-    bob::math::prod(Wt, m_tmp_f, m_tmp_d);
-    // first order of i
-    blitz::Array<double,1> z_first_order_i = m_z_first_order(i,blitz::Range::all());
-    // sigma2 -= 2*E(x_i)^T*W^T*(t - mu)
-    m_sigma2 -= 2*bob::math::dot(z_first_order_i, m_tmp_d);
-
-    // c. sigma2 += trace( E(x_i.x_i^T)*W^T*W )
-    // second order of i
-    blitz::Array<double,2> z_second_order_i = m_z_second_order(i,blitz::Range::all(),blitz::Range::all());
-    // m_tmp_dxd_1 = E(x_i.x_i^T)*W^T*W
-    bob::math::prod(z_second_order_i, m_inW, m_tmp_dxd_1);
-    // sigma2 += trace( E(x_i.x_i^T)*W^T*W )
-    m_sigma2 += bob::math::trace(m_tmp_dxd_1);
-  }
+  // a. sigma2 = sum_i || t_i - mu ||^2
+  m_sigma2 = m_sum_t_square;
+
+  // b. sigma2 -= 2 * sum_i E(x_i)^T*W^T*(t_i - mu)
+  //            = 2 * trace( W^T * sum_i (t_i - mu) E(x_i)^T )
+  m_sigma2 -= 2*blitz::sum(W * m_sum_t_z);
+
+  // c. sigma2 += sum_i trace( E(x_i.x_i^T)*W^T*W )
+  //            = trace( sum_i E(x_i.x_i^T) * W^T*W )
+  bob::math::prod(m_sum_z_second_order, m_inW, m_tmp_dxd_1);
+  m_sigma2 += bob::math::trace(m_tmp_dxd_1);
+
   // Normalization factor
-  m_sigma2 /= (static_cast<double>(ar.extent(0)) * mu.extent(0));
+  m_sigma2 /= (static_cast<double>(m_n_samples) * mu.extent(0));
 }
 
 double bob::learn::em::EMPCATrainer::computeLikelihood(bob::learn::linear::Machine& machine)
@@ -398,23 +549,52 @@ double bob::learn::em::EMPCATrainer::computeLikelihood(bob::learn::linear::Machi
 
   // Compute inverse(M), where M = Wt * W + sigma2 * Id
   computeInvM();
-  // m_tmp_fxf_1 = I = eye(n_features)
-  bob::math::eye(m_tmp_fxf_1);
-  // m_tmp_fxd_1 = W * inv(M)
-  bob::math::prod(W, m_invM, m_tmp_fxd_1);
-  // m_tmp_fxf_2 = (W * inv(M) * Wt)
-  bob::math::prod(m_tmp_fxd_1, Wt, m_tmp_fxf_2);
-  // m_tmp_fxd_1 = inv(C) = (I - W.M^-1.W^T) / sigma2
-  m_tmp_fxf_1 -= m_tmp_fxf_2;
-  m_tmp_fxf_1 /= m_sigma2;
-
-  // 3/ Compute inv(C).S
-  bob::math::prod(m_tmp_fxf_1, m_S, m_tmp_fxf_2);
+
+  // 3/ Compute tr(inv(C).S) without any fxf product, where m_S is the
+  //    scatter (N-1).S of the data:
+  //      tr(inv(C).S) = (tr(S) - tr(M^-1.W^T.S.W)) / sigma2
+  // m_tmp_fxd_1 = S.W
+  bob::math::prod(m_S, W, m_tmp_fxd_1);
+  // m_tmp_dxd_2 = W^T.S.W
+  bob::math::prod(Wt, m_tmp_fxd_1, m_tmp_dxd_2);
+  // m_tmp_dxd_1 = M^-1.W^T.S.W
+  bob::math::prod(m_invM, m_tmp_dxd_2, m_tmp_dxd_1);
+  const double trace_invCS =
+    (bob::math::trace(m_S) - bob::math::trace(m_tmp_dxd_1)) /
+    (m_sigma2 * static_cast<double>(m_n_mean_variance-1));
 
   // 4/ Use previous values to compute the log likelihood:
   // Log likelihood =  - N/2*{ d*ln(2*PI) + ln |detC| + tr(C^-1.S) }
-  double llh = - static_cast<double>(m_z_first_order.extent(0)) / 2. *
-    ( m_f_log2pi + log(fabs(detC)) + bob::math::trace(m_tmp_fxf_2) );
+  double llh = - static_cast<double>(m_n_samples) / 2. *
+    ( m_f_log2pi + log(fabs(detC)) + trace_invCS );
 
   return llh;
 }
+
+double bob::learn::em::EMPCATrainer::computeEStepLikelihood(const bob::learn::linear::Machine& machine) const
+{
+  if (m_n_samples < 2) {
+    boost::format m("at least two samples are required to compute the likelihood, but the statistics contain %u");
+    m % m_n_samples;
+    throw std::runtime_error(m.str());
+  }
+  const blitz::Array<double,2>& W = machine.getWeights();
+  const size_t n_features = W.extent(0);
+  const size_t n_outputs = W.extent(1);
+
+  // 1/ ln(det(C)), where C = sigma2.I + W.W^T, using Sylvester's determinant
+  //    theorem as in computeLikelihood(), and the inv(M) of the E-step:
+  //      det(C) = sigma2^(n_features-n_outputs) * det(M)
+  const double log_detC = (n_features - n_outputs) * log(m_sigma2) -
+    log(fabs(bob::math::det(m_invM)));
+
+  // 2/ tr(inv(C).S), where inv(C) = sigma2^-1 .(I - W.M^-1.W^T), and
+  //    (N-1).S = sum_i (t_i - mu)(t_i - mu)^T, such that
+  //      (N-1) tr(W.M^-1.W^T.S) = tr(W^T sum_i (t_i - mu) E(x_i)^T)
+  const double n = static_cast<double>(m_n_samples);
+  const double trace_invCS =
+    (m_sum_t_square - blitz::sum(W * m_sum_t_z)) / (m_sigma2 * (n - 1));
+
+  // Log likelihood =  - N/2*{ d*ln(2*PI) + ln |detC| + tr(C^-1.S) }
+  return - n / 2. * (m_f_log2pi + log_detC + trace_invCS);
+}
@@ -197,6 +197,38 @@ void bob::learn::em::FABase::setD(const blitz::Array<double,1>& d)
   m_d.reference(bob::core::array::ccopy(d));
 }
 
+void bob::learn::em::FABase::reference(const blitz::Array<double,2>& U,
+  const blitz::Array<double,2>& V, const blitz::Array<double,1>& d,
+  const boost::shared_ptr<const MappedFile>& file)
+{
+  const size_t cd = U.extent(0);
+  if (U.extent(1) < 1 || V.extent(1) < 1) {
+    boost::format m("the ranks of `U' (%d) and `V' (%d) cannot be smaller than 1");
+    m % U.extent(1) % V.extent(1);
+    throw std::runtime_error(m.str());
+  }
+  if ((size_t)V.extent(0) != cd || (size_t)d.extent(0) != cd) {
+    boost::format m("the number of rows of `V' (%d) and `d' (%d) do not match the one of `U' (%lu)");
+    m % V.extent(0) % d.extent(0) % cd;
+    throw std::runtime_error(m.str());
+  }
+  if (m_ubm && getSupervectorLength() != cd) {
+    boost::format m("the number of rows of `U' (%lu) is not set to %lu");
+    m % cd % getSupervectorLength();
+    throw std::runtime_error(m.str());
+  }
+
+  m_ru = U.extent(1);
+  m_rv = V.extent(1);
+  m_U.reference(U);
+  m_V.reference(V);
+  m_d.reference(d);
+  m_mapped_file = file;
+
+  updateCacheUbmUVD();
+  if (m_ubm) resizeTmp();
+}
+
 
 void bob::learn::em::FABase::updateCache()
 {
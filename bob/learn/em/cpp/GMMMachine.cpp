@@ -7,8 +7,10 @@
  */
 
 #include <bob.learn.em/GMMMachine.h>
+#include <bob.learn.em/MappedFile.h>
 #include <bob.core/assert.h>
 #include <bob.math/log.h>
+#include <boost/format.hpp>
 
 bob::learn::em::GMMMachine::GMMMachine(): m_gaussians(0) {
   resize(0,0);
@@ -363,26 +365,74 @@ boost::shared_ptr<bob::learn::em::Gaussian> bob::learn::em::GMMMachine::getGauss
   return m_gaussians[i];
 }
 
+/**
+ * Version of the HDF5 layout written by save(). Files without version hold
+ * one group per Gaussian (m_gaussians0, m_gaussians1, ...); version 2 packs
+ * the parameters of all the Gaussians into single datasets, such that
+ * loading does not depend on the number of Gaussians.
+ */
+static const int64_t s_hdf5_version = 2;
+
 void bob::learn::em::GMMMachine::save(bob::io::base::HDF5File& config) const {
-  int64_t v = static_cast<int64_t>(m_n_gaussians);
-  config.set("m_n_gaussians", v);
-  v = static_cast<int64_t>(m_n_inputs);
-  config.set("m_n_inputs", v);
+  config.set("version", s_hdf5_version);
+  config.set("n_gaussians", static_cast<int64_t>(m_n_gaussians));
+  config.set("n_inputs", static_cast<int64_t>(m_n_inputs));
+  config.setArray("weights", m_weights);
+  config.setArray("means", getMeans());
+  config.setArray("variances", getVariances());
+  config.setArray("variance_thresholds", getVarianceThresholds());
+}
 
-  for(size_t i=0; i<m_n_gaussians; ++i) {
-    std::ostringstream oss;
-    oss << "m_gaussians" << i;
+void bob::learn::em::GMMMachine::load(bob::io::base::HDF5File& config) {
+  if (!config.contains("version")) {
+    loadGroups(config);
+    return;
+  }
 
-    if (!config.hasGroup(oss.str())) config.createGroup(oss.str());
-    config.cd(oss.str());
-    m_gaussians[i]->save(config);
-    config.cd("..");
+  const int64_t version = config.read<int64_t>("version");
+  if (version != s_hdf5_version) {
+    boost::format m("cannot read version %d of the GMMMachine HDF5 layout (only versions 1 and %d are supported)");
+    m % version % s_hdf5_version;
+    throw std::runtime_error(m.str());
+  }
+
+  const size_t n_gaussians = static_cast<size_t>(config.read<int64_t>("n_gaussians"));
+  const size_t n_inputs = static_cast<size_t>(config.read<int64_t>("n_inputs"));
+  const blitz::Array<double,1> weights = config.readArray<double,1>("weights");
+  const blitz::Array<double,2> means = config.readArray<double,2>("means");
+  const blitz::Array<double,2> variances = config.readArray<double,2>("variances");
+  const blitz::Array<double,2> variance_thresholds = config.readArray<double,2>("variance_thresholds");
+
+  // Checks the datasets before modifying this machine
+  bob::core::array::assertSameDimensionLength(weights.extent(0), n_gaussians);
+  bob::core::array::assertSameDimensionLength(means.extent(0), n_gaussians);
+  bob::core::array::assertSameDimensionLength(means.extent(1), n_inputs);
+  bob::core::array::assertSameDimensionLength(variances.extent(0), n_gaussians);
+  bob::core::array::assertSameDimensionLength(variances.extent(1), n_inputs);
+  bob::core::array::assertSameDimensionLength(variance_thresholds.extent(0), n_gaussians);
+  bob::core::array::assertSameDimensionLength(variance_thresholds.extent(1), n_inputs);
+
+  m_n_gaussians = n_gaussians;
+  m_n_inputs = n_inputs;
+  blitz::Range a = blitz::Range::all();
+  m_gaussians.clear();
+  for(size_t i=0; i<m_n_gaussians; ++i) {
+    boost::shared_ptr<bob::learn::em::Gaussian> g(new bob::learn::em::Gaussian(m_n_inputs));
+    g->updateMean() = means(i,a);
+    g->updateVarianceThreshods() = variance_thresholds(i,a);
+    g->updateVariance() = variances(i,a);
+    g->applyVarianceThresholds();
+    m_gaussians.push_back(g);
   }
 
-  config.setArray("m_weights", m_weights);
+  // (a new array, as the current one may be a view of a mapped file)
+  m_weights.reference(weights);
+
+  // Initialise cache
+  initCache();
 }
 
-void bob::learn::em::GMMMachine::load(bob::io::base::HDF5File& config) {
+void bob::learn::em::GMMMachine::loadGroups(bob::io::base::HDF5File& config) {
   int64_t v;
   v = config.read<int64_t>("m_n_gaussians");
   m_n_gaussians = static_cast<size_t>(v);
@@ -399,13 +449,51 @@ void bob::learn::em::GMMMachine::load(bob::io::base::HDF5File& config) {
     config.cd("..");
   }
 
-  m_weights.resize(m_n_gaussians);
+  m_weights.reference(blitz::Array<double,1>(m_n_gaussians));
   config.readArray("m_weights", m_weights);
 
   // Initialise cache
   initCache();
 }
 
+void bob::learn::em::GMMMachine::saveMapped(const std::string& filename) const {
+  bob::learn::em::MappedFileWriter file(filename, "GMMMachine");
+  file.setArray("weights", m_weights);
+  file.setArray("means", getMeans());
+  file.setArray("variances", getVariances());
+  file.setArray("variance_thresholds", getVarianceThresholds());
+  file.close();
+}
+
+void bob::learn::em::GMMMachine::loadMapped(const std::string& filename) {
+  const boost::shared_ptr<const bob::learn::em::MappedFile> file(
+    new bob::learn::em::MappedFile(filename, "GMMMachine"));
+  const blitz::Array<double,1> weights = file->readArray<1>("weights");
+  const blitz::Array<double,2> means = file->readArray<2>("means");
+  const blitz::Array<double,2> variances = file->readArray<2>("variances");
+  const blitz::Array<double,2> variance_thresholds = file->readArray<2>("variance_thresholds");
+  bob::core::array::assertSameDimensionLength(weights.extent(0), means.extent(0));
+  bob::core::array::assertSameShape(means, variances);
+  bob::core::array::assertSameShape(means, variance_thresholds);
+
+  m_n_gaussians = means.extent(0);
+  m_n_inputs = means.extent(1);
+
+  // Each Gaussian uses a row of the matrices
+  blitz::Range a = blitz::Range::all();
+  m_gaussians.clear();
+  for(size_t i=0; i<m_n_gaussians; ++i) {
+    boost::shared_ptr<bob::learn::em::Gaussian> g(new bob::learn::em::Gaussian());
+    g->reference(means(i,a), variances(i,a), variance_thresholds(i,a), file);
+    m_gaussians.push_back(g);
+  }
+  m_weights.reference(weights);
+  m_mapped_file = file;
+
+  // Initialise cache
+  initCache();
+}
+
 void bob::learn::em::GMMMachine::updateCacheSupervectors() const
 {
   m_cache_mean_supervector.resize(m_n_gaussians*m_n_inputs);
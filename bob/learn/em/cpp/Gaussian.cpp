@@ -7,6 +7,7 @@
  */
 
 #include <bob.learn.em/Gaussian.h>
+#include <bob.learn.em/MappedFile.h>
 
 #include <bob.core/assert.h>
 #include <bob.math/log.h>
@@ -130,6 +131,23 @@ void bob::learn::em::Gaussian::applyVarianceThresholds() {
   preComputeConstants();
 }
 
+void bob::learn::em::Gaussian::reference(const blitz::Array<double,1>& mean,
+  const blitz::Array<double,1>& variance,
+  const blitz::Array<double,1>& variance_thresholds,
+  const boost::shared_ptr<const MappedFile>& file)
+{
+  bob::core::array::assertSameShape(mean, variance);
+  bob::core::array::assertSameShape(mean, variance_thresholds);
+  m_n_inputs = mean.extent(0);
+  m_mean.reference(mean);
+  m_variance.reference(variance);
+  m_variance_thresholds.reference(variance_thresholds);
+  m_mapped_file = file;
+
+  preComputeNLog2Pi();
+  preComputeConstants();
+}
+
 double bob::learn::em::Gaussian::logLikelihood(const blitz::Array<double,1> &x) const {
   // Check
   bob::core::array::assertSameShape(x, m_mean);
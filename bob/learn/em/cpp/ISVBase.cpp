@@ -8,6 +8,7 @@
 
 
 #include <bob.learn.em/ISVBase.h>
+#include <bob.learn.em/MappedFile.h>
 #include <bob.core/array_copy.h>
 #include <bob.math/linear.h>
 #include <bob.math/inv.h>
@@ -64,6 +65,24 @@ void bob::learn::em::ISVBase::load(bob::io::base::HDF5File& config)
   V = 0;
 }
 
+void bob::learn::em::ISVBase::saveMapped(const std::string& filename) const
+{
+  bob::learn::em::MappedFileWriter file(filename, "ISVBase");
+  file.setArray("U", m_base.getU());
+  file.setArray("d", m_base.getD());
+  file.close();
+}
+
+void bob::learn::em::ISVBase::loadMapped(const std::string& filename)
+{
+  const boost::shared_ptr<const bob::learn::em::MappedFile> file(
+    new bob::learn::em::MappedFile(filename, "ISVBase"));
+  const blitz::Array<double,2> U = file->readArray<2>("U");
+  blitz::Array<double,2> V(U.extent(0), 1);
+  V = 0;
+  m_base.reference(U, V, file->readArray<1>("d"), file);
+}
+
 bob::learn::em::ISVBase&
 bob::learn::em::ISVBase::operator=(const bob::learn::em::ISVBase& other)
 {
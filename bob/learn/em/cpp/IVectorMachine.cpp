@@ -6,12 +6,15 @@
  */
 
 #include <bob.learn.em/IVectorMachine.h>
+#include <bob.learn.em/MappedFile.h>
+#include <bob.core/assert.h>
 #include <bob.core/array_copy.h>
 #include <bob.core/check.h>
 #include <bob.math/linear.h>
 #include <bob.math/linsolve.h>
 
-bob::learn::em::IVectorMachine::IVectorMachine()
+bob::learn::em::IVectorMachine::IVectorMachine():
+  m_mapped(false)
 {
 }
 
@@ -19,7 +22,8 @@ bob::learn::em::IVectorMachine::IVectorMachine(const boost::shared_ptr<bob::lear
     const size_t rt, const double variance_threshold):
   m_ubm(ubm), m_rt(rt),
   m_T(getSupervectorLength(),rt),  m_sigma(getSupervectorLength()),
-  m_variance_threshold(variance_threshold)
+  m_variance_threshold(variance_threshold),
+  m_mapped(false)
 {
   m_sigma = 0.0;
   resizePrecompute();
@@ -29,7 +33,8 @@ bob::learn::em::IVectorMachine::IVectorMachine(const bob::learn::em::IVectorMach
   m_ubm(other.m_ubm), m_rt(other.m_rt),
   m_T(bob::core::array::ccopy(other.m_T)),
   m_sigma(bob::core::array::ccopy(other.m_sigma)),
-  m_variance_threshold(other.m_variance_threshold)
+  m_variance_threshold(other.m_variance_threshold),
+  m_mapped(false)
 {
   resizePrecompute();
 }
@@ -56,9 +61,68 @@ void bob::learn::em::IVectorMachine::load(bob::io::base::HDF5File& config)
   m_rt = m_T.extent(1);
   m_sigma.reference(config.readArray<double,1>("m_sigma"));
   m_variance_threshold = config.read<double>("m_variance_threshold");
+  m_mapped = false;
   resizePrecompute();
 }
 
+void bob::learn::em::IVectorMachine::saveMapped(const std::string& filename) const
+{
+  bob::learn::em::MappedFileWriter file(filename, "IVectorMachine");
+  file.setArray("T", m_T);
+  file.setArray("sigma", m_sigma);
+  file.set("variance_threshold", m_variance_threshold);
+  if (m_ubm)
+  {
+    file.setArray("Tct_sigmacInv", m_cache_Tct_sigmacInv);
+    file.setArray("Tct_sigmacInv_Tc", m_cache_Tct_sigmacInv_Tc);
+  }
+  file.close();
+}
+
+void bob::learn::em::IVectorMachine::loadMapped(const std::string& filename)
+{
+  const boost::shared_ptr<const bob::learn::em::MappedFile> file(
+    new bob::learn::em::MappedFile(filename, "IVectorMachine"));
+  const blitz::Array<double,2> T = file->readArray<2>("T");
+  const blitz::Array<double,1> sigma = file->readArray<1>("sigma");
+  const double variance_threshold = file->read("variance_threshold");
+  bob::core::array::assertSameDimensionLength(sigma.extent(0), T.extent(0));
+
+  // The arrays in cache only depend on T and sigma (which is already
+  // floored), and are used as they are if they fit the UBM
+  const bool mapped = file->contains("Tct_sigmacInv");
+  blitz::Array<double,3> Tct_sigmacInv, Tct_sigmacInv_Tc;
+  if (mapped)
+  {
+    Tct_sigmacInv.reference(file->readArray<3>("Tct_sigmacInv"));
+    Tct_sigmacInv_Tc.reference(file->readArray<3>("Tct_sigmacInv_Tc"));
+    const int C = Tct_sigmacInv.extent(0), rt = T.extent(1);
+    bob::core::array::assertSameDimensionLength(Tct_sigmacInv.extent(1), rt);
+    bob::core::array::assertSameDimensionLength(C * Tct_sigmacInv.extent(2), T.extent(0));
+    bob::core::array::assertSameDimensionLength(Tct_sigmacInv_Tc.extent(0), C);
+    bob::core::array::assertSameDimensionLength(Tct_sigmacInv_Tc.extent(1), rt);
+    bob::core::array::assertSameDimensionLength(Tct_sigmacInv_Tc.extent(2), rt);
+  }
+
+  m_T.reference(T);
+  m_rt = m_T.extent(1);
+  m_sigma.reference(sigma);
+  m_variance_threshold = variance_threshold;
+  // Replaced rather than resized, such that they are never views of a
+  // former mapped file
+  m_cache_Tct_sigmacInv.reference(Tct_sigmacInv);
+  m_cache_Tct_sigmacInv_Tc.reference(Tct_sigmacInv_Tc);
+  m_mapped_file = file;
+  m_mapped = mapped;
+  if (m_mapped && (!m_ubm || isCacheSized()))
+    resizeTmp();
+  else
+  {
+    m_mapped = false;
+    resizePrecompute();
+  }
+}
+
 void bob::learn::em::IVectorMachine::resize(const size_t rt)
 {
   m_rt = rt;
@@ -76,6 +140,7 @@ bob::learn::em::IVectorMachine::operator=(const bob::learn::em::IVectorMachine&
     m_T.reference(bob::core::array::ccopy(other.m_T));
     m_sigma.reference(bob::core::array::ccopy(other.m_sigma));
     m_variance_threshold = other.m_variance_threshold;
+    m_mapped = false;
     resizePrecompute();
   }
   return *this;
@@ -109,7 +174,14 @@ bool bob::learn::em::IVectorMachine::is_similar_to(const IVectorMachine& b,
 void bob::learn::em::IVectorMachine::setUbm(const boost::shared_ptr<bob::learn::em::GMMMachine> ubm)
 {
   m_ubm = ubm;
-  resizePrecompute();
+  // Keeps the arrays in cache of a mapped file, if they fit the new UBM
+  if (m_mapped && (!m_ubm || isCacheSized()))
+    resizeTmp();
+  else
+  {
+    m_mapped = false;
+    resizePrecompute();
+  }
 }
 
 void bob::learn::em::IVectorMachine::setT(const blitz::Array<double,2>& T)
@@ -194,6 +266,19 @@ void bob::learn::em::IVectorMachine::resizeCache()
   }
 }
 
+bool bob::learn::em::IVectorMachine::isCacheSized() const
+{
+  const int C = (int)m_ubm->getNGaussians();
+  const int D = (int)m_ubm->getNInputs();
+  return m_T.extent(0) == C*D &&
+         m_cache_Tct_sigmacInv.extent(0) == C &&
+         m_cache_Tct_sigmacInv.extent(1) == (int)m_rt &&
+         m_cache_Tct_sigmacInv.extent(2) == D &&
+         m_cache_Tct_sigmacInv_Tc.extent(0) == C &&
+         m_cache_Tct_sigmacInv_Tc.extent(1) == (int)m_rt &&
+         m_cache_Tct_sigmacInv_Tc.extent(2) == (int)m_rt;
+}
+
 void bob::learn::em::IVectorMachine::resizeTmp()
 {
   if (m_ubm)
@@ -8,6 +8,7 @@
 
 #include <bob.learn.em/IVectorTrainer.h>
 #include <bob.core/check.h>
+#include <bob.core/assert.h>
 #include <bob.core/array_copy.h>
 #include <bob.core/array_random.h>
 #include <bob.math/inv.h>
@@ -59,11 +60,22 @@ void bob::learn::em::IVectorTrainer::initialize(
 
 void bob::learn::em::IVectorTrainer::resetAccumulators(const bob::learn::em::IVectorMachine& machine)
 {
-   // Resize the accumulator
-  const int C = machine.getNGaussians();
-  const int D = machine.getNInputs();
-  const int Rt = machine.getDimRt();
+  resizeAccumulators(machine.getNGaussians(), machine.getNInputs(),
+    machine.getDimRt());
+
+  // initialize with 0
+  m_acc_Nij_wij2 = 0.;
+  m_acc_Fnormij_wij = 0.;
+  if (m_update_sigma)
+  {
+    m_acc_Nij = 0.;
+    m_acc_Snormij = 0.;
+  }
+}
 
+void bob::learn::em::IVectorTrainer::resizeAccumulators(const int C,
+  const int D, const int Rt)
+{
   // Cache
   m_acc_Nij_wij2.resize(C,Rt,Rt);
   m_acc_Fnormij_wij.resize(C,D,Rt);
@@ -84,14 +96,64 @@ void bob::learn::em::IVectorTrainer::resetAccumulators(const bob::learn::em::IVe
   m_tmp_tt2.resize(Rt,Rt);
   if (m_update_sigma)
     m_tmp_dd1.resize(D,D);
+}
 
-  // initialize with 0
-  m_acc_Nij_wij2 = 0.;
-  m_acc_Fnormij_wij = 0.;
+void bob::learn::em::IVectorTrainer::saveStatistics(bob::io::base::HDF5File& config) const
+{
+  config.setArray("acc_nij_wij2", m_acc_Nij_wij2);
+  config.setArray("acc_fnormij_wij", m_acc_Fnormij_wij);
   if (m_update_sigma)
   {
-    m_acc_Nij = 0.;
-    m_acc_Snormij = 0.;
+    config.setArray("acc_nij", m_acc_Nij);
+    config.setArray("acc_snormij", m_acc_Snormij);
+  }
+}
+
+void bob::learn::em::IVectorTrainer::loadStatistics(bob::io::base::HDF5File& config)
+{
+  if (m_update_sigma && !config.contains("acc_nij"))
+    throw std::runtime_error("the statistics were saved by a trainer which does not update sigma");
+  const blitz::Array<double,3> acc_Nij_wij2 = config.readArray<double,3>("acc_nij_wij2");
+  const blitz::Array<double,3> acc_Fnormij_wij = config.readArray<double,3>("acc_fnormij_wij");
+  blitz::Array<double,1> acc_Nij;
+  blitz::Array<double,2> acc_Snormij;
+  if (m_update_sigma)
+  {
+    acc_Nij.reference(config.readArray<double,1>("acc_nij"));
+    acc_Snormij.reference(config.readArray<double,2>("acc_snormij"));
+  }
+
+  // The accumulators are sized after acc_fnormij_wij, and the other
+  // statistics must match them
+  resizeAccumulators(acc_Fnormij_wij.extent(0), acc_Fnormij_wij.extent(1),
+    acc_Fnormij_wij.extent(2));
+  bob::core::array::assertSameShape(acc_Nij_wij2, m_acc_Nij_wij2);
+  if (m_update_sigma)
+  {
+    bob::core::array::assertSameShape(acc_Nij, m_acc_Nij);
+    bob::core::array::assertSameShape(acc_Snormij, m_acc_Snormij);
+  }
+
+  m_acc_Nij_wij2 = acc_Nij_wij2;
+  m_acc_Fnormij_wij = acc_Fnormij_wij;
+  if (m_update_sigma)
+  {
+    m_acc_Nij = acc_Nij;
+    m_acc_Snormij = acc_Snormij;
+  }
+}
+
+void bob::learn::em::IVectorTrainer::addStatistics(const bob::learn::em::IVectorTrainer& other)
+{
+  if (m_update_sigma && !other.m_update_sigma)
+    throw std::runtime_error("cannot add the statistics of a trainer which does not update sigma");
+  bob::core::array::assertSameShape(m_acc_Fnormij_wij, other.m_acc_Fnormij_wij);
+  m_acc_Nij_wij2 += other.m_acc_Nij_wij2;
+  m_acc_Fnormij_wij += other.m_acc_Fnormij_wij;
+  if (m_update_sigma)
+  {
+    m_acc_Nij += other.m_acc_Nij;
+    m_acc_Snormij += other.m_acc_Snormij;
   }
 }
 
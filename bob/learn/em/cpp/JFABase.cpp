@@ -8,6 +8,7 @@
 
 
 #include <bob.learn.em/JFABase.h>
+#include <bob.learn.em/MappedFile.h>
 #include <bob.core/array_copy.h>
 #include <bob.math/linear.h>
 #include <bob.math/inv.h>
@@ -64,6 +65,23 @@ void bob::learn::em::JFABase::load(bob::io::base::HDF5File& config)
   m_base.setD(d);
 }
 
+void bob::learn::em::JFABase::saveMapped(const std::string& filename) const
+{
+  bob::learn::em::MappedFileWriter file(filename, "JFABase");
+  file.setArray("U", m_base.getU());
+  file.setArray("V", m_base.getV());
+  file.setArray("d", m_base.getD());
+  file.close();
+}
+
+void bob::learn::em::JFABase::loadMapped(const std::string& filename)
+{
+  const boost::shared_ptr<const bob::learn::em::MappedFile> file(
+    new bob::learn::em::MappedFile(filename, "JFABase"));
+  m_base.reference(file->readArray<2>("U"), file->readArray<2>("V"),
+    file->readArray<1>("d"), file);
+}
+
 bob::learn::em::JFABase&
 bob::learn::em::JFABase::operator=(const bob::learn::em::JFABase& other)
 {
@@ -190,6 +190,21 @@ double bob::learn::em::JFAMachine::forward(const bob::learn::em::GMMStats& gmm_s
             gmm_stats, Ux, true);
 }
 
+double bob::learn::em::JFAMachine::forward(const boost::shared_ptr<const bob::learn::em::GMMStats> gmm_stats,
+  bob::learn::em::ProbeCache& cache)
+{
+  // Checks that a Base machine has been set
+  if (!m_jfa_base) throw std::runtime_error("No UBM was set in the JFA machine.");
+  if (cache.getJFABase() != m_jfa_base)
+    throw std::runtime_error("The ProbeCache is not bound to the JFABase of this machine.");
+
+  // Linear scoring, with the probe-dependent term taken from the cache
+  const blitz::Array<double,1> centred_stats = cache.getCentredStats(gmm_stats);
+  const blitz::Array<double,1>& ubm_mean = m_jfa_base->getUbm()->getMeanSupervector();
+  const blitz::Array<double,1>& ubm_variance = m_jfa_base->getUbm()->getVarianceSupervector();
+  return blitz::sum((m_cache_mVyDz - ubm_mean) / ubm_variance * centred_stats);
+}
+
 double bob::learn::em::JFAMachine::forward_(const bob::learn::em::GMMStats& input)
 {
   // Checks that a Base machine has been set
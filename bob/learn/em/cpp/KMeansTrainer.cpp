@@ -226,3 +226,34 @@ void bob::learn::em::KMeansTrainer::setFirstOrderStats(const blitz::Array<double
   bob::core::array::assertSameShape(m_firstOrderStats, firstOrderStats);
   m_firstOrderStats = firstOrderStats;
 }
+
+void bob::learn::em::KMeansTrainer::saveStatistics(bob::io::base::HDF5File& config) const
+{
+  config.setArray("zeroeth_order_statistics", m_zeroethOrderStats);
+  config.setArray("first_order_statistics", m_firstOrderStats);
+  config.set("average_min_distance", m_average_min_distance);
+}
+
+void bob::learn::em::KMeansTrainer::loadStatistics(bob::io::base::HDF5File& config)
+{
+  const blitz::Array<double,1> zeroethOrderStats = config.readArray<double,1>("zeroeth_order_statistics");
+  const blitz::Array<double,2> firstOrderStats = config.readArray<double,2>("first_order_statistics");
+  bob::core::array::assertSameShape(m_zeroethOrderStats, zeroethOrderStats);
+  bob::core::array::assertSameShape(m_firstOrderStats, firstOrderStats);
+  m_zeroethOrderStats = zeroethOrderStats;
+  m_firstOrderStats = firstOrderStats;
+  m_average_min_distance = config.read<double>("average_min_distance");
+}
+
+void bob::learn::em::KMeansTrainer::addStatistics(const bob::learn::em::KMeansTrainer& other)
+{
+  bob::core::array::assertSameShape(m_firstOrderStats, other.m_firstOrderStats);
+  // The number of samples is given by the zeroeth order statistics
+  const double n = blitz::sum(m_zeroethOrderStats);
+  const double n_other = blitz::sum(other.m_zeroethOrderStats);
+  if (n + n_other > 0.)
+    m_average_min_distance = (n * m_average_min_distance +
+      n_other * other.m_average_min_distance) / (n + n_other);
+  m_zeroethOrderStats += other.m_zeroethOrderStats;
+  m_firstOrderStats += other.m_firstOrderStats;
+}
@@ -5,17 +5,141 @@
  * Copyright (C) Idiap Research Institute, Martigny, Switzerland
  */
 #include <bob.learn.em/LinearScoring.h>
+#include <bob.learn.em/ISVMachine.h>
+#include <bob.learn.em/JFAMachine.h>
+#include <bob.learn.em/Parallel.h>
+#include <bob.core/array_copy.h>
+#include <bob.core/check.h>
 #include <bob.math/linear.h>
 
+#include <algorithm>
+#include <fstream>
+#include <limits>
 
+#include <boost/format.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+
+namespace {
+
+/**
+ * Returns the given array if it is C-contiguous and zero-based, or a
+ * contiguous copy of it, so that it can be read through its data pointer
+ */
+template <int N>
+blitz::Array<double,N> contiguous(const blitz::Array<double,N>& a)
+{
+  if (bob::core::array::isCZeroBaseContiguous(a)) return a;
+  return bob::core::array::ccopy(a);
+}
+
+/**
+ * Scores all models against a range of test trials, processed in tiles:
+ * the centred statistics of the trials of a tile are written as the
+ * contiguous rows of a (tile x CD) matrix B, and the scores of the tile
+ * are obtained with a single matrix product A.B^T.
+ *
+ * All the inputs are read through raw pointers and all the blitz arrays
+ * manipulated here are either owned by the calling thread or were created
+ * by the main thread, as blitz reference counting is not thread-safe.
+ */
+struct LinearScoringTiles
+{
+  LinearScoringTiles(const blitz::Array<double,2>& A, const double* ubm_mean,
+      const std::vector<const double*>& sumPx, const std::vector<const double*>& n,
+      const std::vector<const double*>& channelOffset, const std::vector<double>& T,
+      const bool frame_length_normalisation,
+      const size_t C, const size_t D, const size_t tile_size,
+      std::vector<blitz::Array<double,2> >& scores):
+    m_A(A), m_ubm_mean(ubm_mean), m_sumPx(sumPx), m_n(n),
+    m_channelOffset(channelOffset), m_T(T),
+    m_frame_length_normalisation(frame_length_normalisation),
+    m_C(C), m_D(D), m_tile_size(tile_size), m_scores(scores)
+  {}
+
+  void operator()(const size_t begin, const size_t end)
+  {
+    const size_t CD = m_C*m_D;
+    blitz::Array<double,2> B(m_tile_size, CD);
+    for (size_t k=begin; k<end; ++k) {
+      const size_t t0 = k*m_tile_size;
+      const size_t Tt = m_scores[k].extent(1);
+      for (size_t t=0; t<Tt; ++t) {
+        double* b = B.data() + t*CD;
+        const double* sumPx = m_sumPx[t0+t];
+        const double* n = m_n[t0+t];
+        const double* offset = m_channelOffset.empty() ? 0 : m_channelOffset[t0+t];
+
+        // B(t,:) = F - N.(m [+ Ux])
+        for (size_t c=0; c<m_C; ++c) {
+          const size_t s0 = c*m_D;
+          const double n_c = n[c];
+          if (offset)
+            for (size_t s=s0; s<s0+m_D; ++s)
+              b[s] = sumPx[s] - n_c * (m_ubm_mean[s] + offset[s]);
+          else
+            for (size_t s=s0; s<s0+m_D; ++s)
+              b[s] = sumPx[s] - m_ubm_mean[s] * n_c;
+        }
+
+        // Apply the normalisation if needed
+        if (m_frame_length_normalisation) {
+          const double sum_N = m_T[t0+t];
+          if (sum_N <= std::numeric_limits<double>::epsilon() && sum_N >= -std::numeric_limits<double>::epsilon())
+            std::fill(b, b+CD, 0.);
+          else
+            for (size_t s=0; s<CD; ++s) b[s] /= sum_N;
+        }
+      }
+
+      // scores(:,tile) = A.B^T
+      blitz::Array<double,2> Bt = B(blitz::Range(0,Tt-1), blitz::Range::all()).transpose(1,0);
+      bob::math::prod(m_A, Bt, m_scores[k]);
+    }
+  }
+
+  const blitz::Array<double,2>& m_A;
+  const double* m_ubm_mean;
+  const std::vector<const double*>& m_sumPx;
+  const std::vector<const double*>& m_n;
+  const std::vector<const double*>& m_channelOffset;
+  const std::vector<double>& m_T;
+  const bool m_frame_length_normalisation;
+  const size_t m_C;
+  const size_t m_D;
+  const size_t m_tile_size;
+  std::vector<blitz::Array<double,2> >& m_scores;
+};
+
+}
+
+// Maximum size of the B matrix of a tile when no memory budget is given (8 MB)
+static const size_t s_linear_scoring_tile_bytes = 8 << 20;
+
+/**
+ * Linear scoring engine. The models are processed in blocks and the test
+ * trials in tiles, so that at most a (block x CD) matrix A and one
+ * (tile x CD) matrix B per thread are allocated. If max_bytes is 0, all
+ * the models are processed at once and the tiles are limited to 8 MB.
+ */
 static void _linearScoring(const std::vector<blitz::Array<double,1> >& models,
                    const blitz::Array<double,1>& ubm_mean,
                    const blitz::Array<double,1>& ubm_variance,
                    const std::vector<boost::shared_ptr<const bob::learn::em::GMMStats> >& test_stats,
                    const std::vector<blitz::Array<double,1> >* test_channelOffset,
                    const bool frame_length_normalisation,
-                   blitz::Array<double,2>& scores)
+                   blitz::Array<double,2>& scores,
+                   const size_t n_threads=1,
+                   const size_t max_bytes=0)
 {
+  // Nothing to score
+  if (test_stats.empty() || models.empty()) {
+    bob::core::array::assertSameDimensionLength(scores.extent(0), models.size());
+    bob::core::array::assertSameDimensionLength(scores.extent(1), test_stats.size());
+    return;
+  }
+
   int C = test_stats[0]->sumPx.extent(0);
   int D = test_stats[0]->sumPx.extent(1);
   int CD = C*D;
@@ -25,47 +149,88 @@ static void _linearScoring(const std::vector<blitz::Array<double,1> >& models,
   // Check output size
   bob::core::array::assertSameDimensionLength(scores.extent(0), models.size());
   bob::core::array::assertSameDimensionLength(scores.extent(1), test_stats.size());
+  bob::core::array::assertSameDimensionLength(ubm_mean.extent(0), CD);
+  bob::core::array::assertSameDimensionLength(ubm_variance.extent(0), CD);
+  for(int t=0; t<Tm; ++t)
+    bob::core::array::assertSameDimensionLength(models[t].extent(0), CD);
 
-  blitz::Array<double,2> A(Tm, CD);
-  blitz::Array<double,2> B(CD, Tt);
+  // 1) Gather (contiguous) pointers to the statistics of the test trials,
+  // so that the worker threads never create new blitz references
+  std::vector<blitz::Array<double,1> > keep_1d;
+  std::vector<blitz::Array<double,2> > keep_2d;
+  keep_1d.push_back(contiguous(ubm_mean));
+  const double* ubm_mean_ptr = keep_1d.back().data();
 
-  // 1) Compute A
-  for(int t=0; t<Tm; ++t) {
-    blitz::Array<double, 1> tmp = A(t, blitz::Range::all());
-    tmp = (models[t] - ubm_mean) / ubm_variance;
+  std::vector<const double*> sumPx(Tt), n(Tt), channelOffset;
+  std::vector<double> T(Tt);
+  if (test_channelOffset) {
+    bob::core::array::assertSameDimensionLength((*test_channelOffset).size(), Tt);
+    channelOffset.resize(Tt);
+  }
+  for(int t=0; t<Tt; ++t) {
+    bob::core::array::assertSameDimensionLength(test_stats[t]->sumPx.extent(0), C);
+    bob::core::array::assertSameDimensionLength(test_stats[t]->sumPx.extent(1), D);
+    keep_2d.push_back(contiguous(test_stats[t]->sumPx));
+    sumPx[t] = keep_2d.back().data();
+    keep_1d.push_back(contiguous(test_stats[t]->n));
+    n[t] = keep_1d.back().data();
+    T[t] = test_stats[t]->T;
+    if (test_channelOffset) {
+      bob::core::array::assertSameDimensionLength((*test_channelOffset)[t].extent(0), CD);
+      keep_1d.push_back(contiguous((*test_channelOffset)[t]));
+      channelOffset[t] = keep_1d.back().data();
+    }
   }
 
-  // 2) Compute B
-  if(test_channelOffset == 0) {
-    for(int t=0; t<Tt; ++t)
-      for(int s=0; s<CD; ++s)
-        B(s, t) = test_stats[t]->sumPx(s/D, s%D) - (ubm_mean(s) * test_stats[t]->n(s/D));
+  // 2) Size the blocks of models and the tiles of test trials: half of the
+  // memory budget goes to A, the other half to the tiles being processed
+  const size_t n_threads_ = bob::learn::em::getNThreads(n_threads);
+  const size_t row_bytes = CD * sizeof(double);
+  size_t block_size = Tm;
+  size_t tile_size = s_linear_scoring_tile_bytes / row_bytes;
+  if (max_bytes > 0) {
+    block_size = max_bytes / 2 / row_bytes;
+    tile_size = max_bytes / 2 / (n_threads_ * row_bytes);
   }
-  else {
-    bob::core::array::assertSameDimensionLength((*test_channelOffset).size(), Tt);
+  block_size = std::min<size_t>(std::max<size_t>(1, block_size), Tm);
+  tile_size = std::min(std::max<size_t>(1, tile_size), (Tt + n_threads_ - 1) / n_threads_);
+  const size_t n_tiles = (Tt + tile_size - 1) / tile_size;
 
-    for(int t=0; t<Tt; ++t) {
-      bob::core::array::assertSameDimensionLength((*test_channelOffset)[t].extent(0), CD);
-      for(int s=0; s<CD; ++s)
-        B(s, t) = test_stats[t]->sumPx(s/D, s%D) - (test_stats[t]->n(s/D) * (ubm_mean(s) + (*test_channelOffset)[t](s)));
+  blitz::Array<double,2> A(block_size, CD);
+  for (int m0=0; m0<Tm; m0+=block_size) {
+    const int m1 = std::min<int>(m0 + block_size, Tm);
+
+    // 3) Compute A for this block of models
+    for(int t=m0; t<m1; ++t) {
+      blitz::Array<double, 1> tmp = A(t-m0, blitz::Range::all());
+      tmp = (models[t] - ubm_mean) / ubm_variance;
     }
-  }
+    blitz::Array<double,2> A_block = A(blitz::Range(0, m1-m0-1), blitz::Range::all());
 
-  // Apply the normalisation if needed
-  if(frame_length_normalisation) {
-    for(int t=0; t<Tt; ++t) {
-      double sum_N = test_stats[t]->T;
-      blitz::Array<double, 1> v_t = B(blitz::Range::all(),t);
-
-      if (sum_N <= std::numeric_limits<double>::epsilon() && sum_N >= -std::numeric_limits<double>::epsilon())
-        v_t = 0;
-      else
-        v_t /= sum_N;
+    // 4) Compute the corresponding slices of the scores, tile by tile, in
+    // parallel
+    std::vector<blitz::Array<double,2> > scores_tiles;
+    for (size_t k=0; k<n_tiles; ++k) {
+      const int t0 = k*tile_size;
+      const int t1 = std::min<int>(t0 + tile_size, Tt);
+      scores_tiles.push_back(scores(blitz::Range(m0, m1-1), blitz::Range(t0, t1-1)));
     }
+
+    LinearScoringTiles tiles(A_block, ubm_mean_ptr, sumPx, n, channelOffset, T,
+      frame_length_normalisation, C, D, tile_size, scores_tiles);
+    bob::learn::em::parallelFor(n_tiles, n_threads_, tiles);
   }
+}
 
-  // 3) Compute LLR
-  bob::math::prod(A, B, scores);
+/**
+ * Returns views on the rows of the given matrix of model supervectors
+ */
+static std::vector<blitz::Array<double,1> > _rows(const blitz::Array<double,2>& models)
+{
+  std::vector<blitz::Array<double,1> > rows;
+  for (int i=0; i<models.extent(0); ++i)
+    rows.push_back(models(i, blitz::Range::all()));
+  return rows;
 }
 
 
@@ -166,3 +331,166 @@ double bob::learn::em::linearScoring(const blitz::Array<double,1>& models,
   return blitz::sum(A * B);
 }
 
+
+namespace {
+
+/**
+ * Estimates the channel offsets Ux of a range of test trials. Each chunk
+ * works on its own copy of the FABase, as the latter relies on mutable
+ * working arrays in estimateX(), and on its own copy of the statistics, as
+ * estimateX() slices them (blitz reference counting is not thread-safe).
+ */
+struct ChannelOffsetEstimator
+{
+  ChannelOffsetEstimator(const bob::learn::em::FABase& base,
+      const std::vector<boost::shared_ptr<const bob::learn::em::GMMStats> >& test_stats,
+      std::vector<blitz::Array<double,1> >& Ux):
+    m_base(base), m_test_stats(test_stats), m_Ux(Ux)
+  {}
+
+  void operator()(const size_t begin, const size_t end)
+  {
+    bob::learn::em::FABase base(m_base);
+    bob::learn::em::GMMStats stats;
+    blitz::Array<double,1> x(base.getDimRu());
+    for (size_t t=begin; t<end; ++t) {
+      stats = *m_test_stats[t];
+      base.estimateX(stats, x);
+      bob::math::prod(base.getU(), x, m_Ux[t]);
+    }
+  }
+
+  const bob::learn::em::FABase& m_base;
+  const std::vector<boost::shared_ptr<const bob::learn::em::GMMStats> >& m_test_stats;
+  std::vector<blitz::Array<double,1> >& m_Ux;
+};
+
+}
+
+static void _faScoring(const std::vector<blitz::Array<double,1> >& models,
+                   const bob::learn::em::FABase& base,
+                   const std::vector<boost::shared_ptr<const bob::learn::em::GMMStats> >& test_stats,
+                   blitz::Array<double,2>& scores,
+                   const size_t n_threads)
+{
+  // Check output size
+  bob::core::array::assertSameDimensionLength(scores.extent(0), models.size());
+  bob::core::array::assertSameDimensionLength(scores.extent(1), test_stats.size());
+  if (models.empty() || test_stats.empty()) return;
+
+  // 1) Estimate the channel offset of each test trial, once for all models
+  std::vector<blitz::Array<double,1> > Ux;
+  for (size_t t=0; t<test_stats.size(); ++t)
+    Ux.push_back(blitz::Array<double,1>(base.getSupervectorLength()));
+  ChannelOffsetEstimator estimator(base, test_stats, Ux);
+  bob::learn::em::parallelFor(test_stats.size(), n_threads, estimator);
+
+  // 2) Score all models against all test trials at once
+  _linearScoring(models, base.getUbmMean(), base.getUbmVariance(),
+                 test_stats, &Ux, true, scores, n_threads);
+}
+
+void bob::learn::em::linearScoring(const std::vector<boost::shared_ptr<const bob::learn::em::ISVMachine> >& models,
+                   const std::vector<boost::shared_ptr<const bob::learn::em::GMMStats> >& test_stats,
+                   blitz::Array<double,2>& scores,
+                   const size_t n_threads)
+{
+  if (models.empty()) {
+    bob::core::array::assertSameDimensionLength(scores.extent(0), 0);
+    return;
+  }
+
+  const boost::shared_ptr<bob::learn::em::ISVBase> isv_base = models[0]->getISVBase();
+  if (!isv_base) throw std::runtime_error("No UBM was set in the ISV machine.");
+
+  std::vector<blitz::Array<double,1> > models_b;
+  for (size_t i=0; i<models.size(); ++i) {
+    const boost::shared_ptr<bob::learn::em::ISVBase> base_i = models[i]->getISVBase();
+    if (!base_i || (base_i != isv_base && *base_i != *isv_base)) {
+      boost::format m("ISV model %lu does not share the ISVBase of the first model");
+      m % i;
+      throw std::runtime_error(m.str());
+    }
+    models_b.push_back(models[i]->getMeanSupervector());
+  }
+  _faScoring(models_b, isv_base->getBase(), test_stats, scores, n_threads);
+}
+
+void bob::learn::em::linearScoring(const std::vector<boost::shared_ptr<const bob::learn::em::JFAMachine> >& models,
+                   const std::vector<boost::shared_ptr<const bob::learn::em::GMMStats> >& test_stats,
+                   blitz::Array<double,2>& scores,
+                   const size_t n_threads)
+{
+  if (models.empty()) {
+    bob::core::array::assertSameDimensionLength(scores.extent(0), 0);
+    return;
+  }
+
+  const boost::shared_ptr<bob::learn::em::JFABase> jfa_base = models[0]->getJFABase();
+  if (!jfa_base) throw std::runtime_error("No UBM was set in the JFA machine.");
+
+  std::vector<blitz::Array<double,1> > models_b;
+  for (size_t i=0; i<models.size(); ++i) {
+    const boost::shared_ptr<bob::learn::em::JFABase> base_i = models[i]->getJFABase();
+    if (!base_i || (base_i != jfa_base && *base_i != *jfa_base)) {
+      boost::format m("JFA model %lu does not share the JFABase of the first model");
+      m % i;
+      throw std::runtime_error(m.str());
+    }
+    models_b.push_back(models[i]->getMeanSupervector());
+  }
+  _faScoring(models_b, jfa_base->getBase(), test_stats, scores, n_threads);
+}
+
+
+void bob::learn::em::linearScoring(const blitz::Array<double,2>& models,
+                   const blitz::Array<double,1>& ubm_mean, const blitz::Array<double,1>& ubm_variance,
+                   const std::vector<boost::shared_ptr<const bob::learn::em::GMMStats> >& test_stats,
+                   const std::vector<blitz::Array<double,1> >& test_channelOffset,
+                   const bool frame_length_normalisation,
+                   const size_t max_bytes,
+                   blitz::Array<double,2>& scores,
+                   const size_t n_threads)
+{
+  _linearScoring(_rows(models), ubm_mean, ubm_variance, test_stats,
+                 test_channelOffset.empty() ? 0 : &test_channelOffset,
+                 frame_length_normalisation, scores, n_threads, max_bytes);
+}
+
+void bob::learn::em::linearScoring(const blitz::Array<double,2>& models,
+                   const blitz::Array<double,1>& ubm_mean, const blitz::Array<double,1>& ubm_variance,
+                   const std::vector<boost::shared_ptr<const bob::learn::em::GMMStats> >& test_stats,
+                   const std::vector<blitz::Array<double,1> >& test_channelOffset,
+                   const bool frame_length_normalisation,
+                   const size_t max_bytes,
+                   const std::string& score_file,
+                   const size_t n_threads)
+{
+  const size_t Tm = models.extent(0);
+  const size_t Tt = test_stats.size();
+
+  // Creates the score file with its final size
+  {
+    std::ofstream f(score_file.c_str(), std::ios::binary | std::ios::trunc);
+    if (f && Tm*Tt > 0) {
+      f.seekp(Tm*Tt*sizeof(double) - 1);
+      f.put(0);
+    }
+    if (!f) {
+      boost::format m("cannot create the score file `%s'");
+      m % score_file;
+      throw std::runtime_error(m.str());
+    }
+  }
+  if (Tm*Tt == 0) return;
+
+  // Maps it into memory, and scores directly into the mapping
+  boost::interprocess::file_mapping mapping(score_file.c_str(), boost::interprocess::read_write);
+  boost::interprocess::mapped_region region(mapping, boost::interprocess::read_write);
+  blitz::Array<double,2> scores(static_cast<double*>(region.get_address()),
+    blitz::shape(Tm, Tt), blitz::neverDeleteData);
+  _linearScoring(_rows(models), ubm_mean, ubm_variance, test_stats,
+                 test_channelOffset.empty() ? 0 : &test_channelOffset,
+                 frame_length_normalisation, scores, n_threads, max_bytes);
+  region.flush();
+}
@@ -7,6 +7,7 @@
 
 #include <bob.learn.em/MAP_GMMTrainer.h>
 #include <bob.core/check.h>
+#include <boost/format.hpp>
 
 bob::learn::em::MAP_GMMTrainer::MAP_GMMTrainer(
    const bool update_means,
@@ -72,10 +73,74 @@ bool bob::learn::em::MAP_GMMTrainer::setPriorGMM(boost::shared_ptr<bob::learn::e
 
 
 void bob::learn::em::MAP_GMMTrainer::mStep(bob::learn::em::GMMMachine& gmm)
+{
+  mStep(gmm, *m_gmm_base_trainer.getGMMStats());
+}
+
+void bob::learn::em::MAP_GMMTrainer::adapt(bob::learn::em::GMMMachine& gmm,
+  bob::learn::em::GMMStats& stats, const blitz::Array<double,2>& data)
+{
+  // Check that the prior GMM has been specified
+  if (!m_prior_gmm)
+    throw std::runtime_error("MAP_GMMTrainer: Prior GMM distribution has not been set");
+
+  // Adds the statistics of the new data, computed with the prior, to the
+  // accumulated ones
+  m_prior_gmm->accStatistics(data, stats);
+
+  // Re-derives the adapted model from all the accumulated statistics
+  mStep(gmm, stats);
+}
+
+void bob::learn::em::MAP_GMMTrainer::adaptMeanSupervector(
+  const blitz::Array<double,2>& data, blitz::Array<double,1>& mean_supervector)
+{
+  // Check that the prior GMM has been specified
+  if (!m_prior_gmm)
+    throw std::runtime_error("MAP_GMMTrainer: Prior GMM distribution has not been set");
+
+  const size_t n_gaussians = m_prior_gmm->getNGaussians();
+  const size_t n_inputs = m_prior_gmm->getNInputs();
+  if ((size_t)mean_supervector.extent(0) != n_gaussians*n_inputs) {
+    boost::format m("MAP_GMMTrainer: the size of the mean supervector (%d) does not match the prior GMM (%u)");
+    m % mean_supervector.extent(0) % (n_gaussians*n_inputs);
+    throw std::runtime_error(m.str());
+  }
+
+  // Accumulates the statistics of the data with the prior GMM
+  if ((size_t)m_cache_stats.sumPx.extent(0) != n_gaussians || (size_t)m_cache_stats.sumPx.extent(1) != n_inputs)
+    m_cache_stats.resize(n_gaussians, n_inputs);
+  m_cache_stats.init();
+  m_prior_gmm->accStatistics(data, m_cache_stats);
+
+  // Adapts the means, as in mStep()
+  const blitz::Array<double,1>& prior_means = m_prior_gmm->getMeanSupervector();
+  for (size_t i=0; i<n_gaussians; ++i) {
+    blitz::Range range(i*n_inputs, (i+1)*n_inputs-1);
+    const double n_i = m_cache_stats.n(i);
+    if (n_i < m_gmm_base_trainer.getMeanVarUpdateResponsibilitiesThreshold()) {
+      mean_supervector(range) = prior_means(range);
+    }
+    else {
+      const double alpha = m_reynolds_adaptation ? n_i / (n_i + m_relevance_factor) : m_alpha;
+      mean_supervector(range) = alpha * (m_cache_stats.sumPx(i,blitz::Range::all()) / n_i) + (1-alpha) * prior_means(range);
+    }
+  }
+}
+
+void bob::learn::em::MAP_GMMTrainer::mStep(bob::learn::em::GMMMachine& gmm,
+  const bob::learn::em::GMMStats& stats)
 {
   // Read options and variables
   double n_gaussians = gmm.getNGaussians();
 
+  // Checks the dimensionality of the statistics
+  if ((size_t)stats.sumPx.extent(0) != n_gaussians || (size_t)stats.sumPx.extent(1) != gmm.getNInputs()) {
+    boost::format m("MAP_GMMTrainer: the statistics (%dx%d) do not match the GMM (%ux%u)");
+    m % stats.sumPx.extent(0) % stats.sumPx.extent(1) % gmm.getNGaussians() % gmm.getNInputs();
+    throw std::runtime_error(m.str());
+  }
+
   //Checking if it is necessary to resize the cache
   if((size_t)m_cache_alpha.extent(0) != n_gaussians)
     initialize(gmm); //If it is different for some reason, there is no way, you have to initialize
@@ -92,13 +157,13 @@ void bob::learn::em::MAP_GMMTrainer::mStep(bob::learn::em::GMMMachine& gmm)
   if (!m_reynolds_adaptation)
     m_cache_alpha = m_alpha;
   else
-    m_cache_alpha = m_gmm_base_trainer.getGMMStats()->n(i) / (m_gmm_base_trainer.getGMMStats()->n(i) + m_relevance_factor);
+    m_cache_alpha = stats.n(i) / (stats.n(i) + m_relevance_factor);
 
   // - Update weights if requested
   //   Equation 11 of Reynolds et al., "Speaker Verification Using Adapted Gaussian Mixture Models", Digital Signal Processing, 2000
   if (m_gmm_base_trainer.getUpdateWeights()) {
     // Calculate the maximum likelihood weights
-    m_cache_ml_weights = m_gmm_base_trainer.getGMMStats()->n / static_cast<double>(m_gmm_base_trainer.getGMMStats()->T); //cast req. for linux/32-bits & osx
+    m_cache_ml_weights = stats.n / static_cast<double>(stats.T); //cast req. for linux/32-bits & osx
 
     // Get the prior weights
     const blitz::Array<double,1>& prior_weights = m_prior_gmm->getWeights();
@@ -123,12 +188,12 @@ void bob::learn::em::MAP_GMMTrainer::mStep(bob::learn::em::GMMMachine& gmm)
     for (size_t i=0; i<n_gaussians; ++i) {
       const blitz::Array<double,1>& prior_means = m_prior_gmm->getGaussian(i)->getMean();
       blitz::Array<double,1>& means = gmm.getGaussian(i)->updateMean();
-      if (m_gmm_base_trainer.getGMMStats()->n(i) < m_gmm_base_trainer.getMeanVarUpdateResponsibilitiesThreshold()) {
+      if (stats.n(i) < m_gmm_base_trainer.getMeanVarUpdateResponsibilitiesThreshold()) {
         means = prior_means;
       }
       else {
         // Use the maximum likelihood means
-        means = m_cache_alpha(i) * (m_gmm_base_trainer.getGMMStats()->sumPx(i,blitz::Range::all()) / m_gmm_base_trainer.getGMMStats()->n(i)) + (1-m_cache_alpha(i)) * prior_means;
+        means = m_cache_alpha(i) * (stats.sumPx(i,blitz::Range::all()) / stats.n(i)) + (1-m_cache_alpha(i)) * prior_means;
       }
     }
   }
@@ -142,11 +207,11 @@ void bob::learn::em::MAP_GMMTrainer::mStep(bob::learn::em::GMMMachine& gmm)
       blitz::Array<double,1>& means = gmm.getGaussian(i)->updateMean();
       const blitz::Array<double,1>& prior_variances = m_prior_gmm->getGaussian(i)->getVariance();
       blitz::Array<double,1>& variances = gmm.getGaussian(i)->updateVariance();
-      if (m_gmm_base_trainer.getGMMStats()->n(i) < m_gmm_base_trainer.getMeanVarUpdateResponsibilitiesThreshold()) {
+      if (stats.n(i) < m_gmm_base_trainer.getMeanVarUpdateResponsibilitiesThreshold()) {
         variances = (prior_variances + prior_means) - blitz::pow2(means);
       }
       else {
-        variances = m_cache_alpha(i) * m_gmm_base_trainer.getGMMStats()->sumPxx(i,blitz::Range::all()) / m_gmm_base_trainer.getGMMStats()->n(i) + (1-m_cache_alpha(i)) * (prior_variances + prior_means) - blitz::pow2(means);
+        variances = m_cache_alpha(i) * stats.sumPxx(i,blitz::Range::all()) / stats.n(i) + (1-m_cache_alpha(i)) * (prior_variances + prior_means) - blitz::pow2(means);
       }
       gmm.getGaussian(i)->applyVarianceThresholds();
     }
@@ -0,0 +1,260 @@
+/**
+ * @date Sun Oct 18 23:10:12 2026 +0200
+ *
+ * Copyright (C) Idiap Research Institute, Martigny, Switzerland
+ */
+
+#include <bob.learn.em/MappedFile.h>
+
+#include <cerrno>
+#include <climits>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <boost/format.hpp>
+
+namespace {
+
+  const char s_magic[8] = {'B', 'O', 'B', 'E', 'M', 'M', 'A', 'P'};
+  const boost::uint32_t s_byte_order = 0x01020304;
+  const boost::uint32_t s_version = 1;
+  const boost::uint64_t s_alignment = 64;
+
+  /* First bytes of a mapped file */
+  struct Header
+  {
+    char magic[8];
+    boost::uint32_t byte_order;
+    boost::uint32_t version;
+    boost::uint64_t n_entries;
+    boost::uint64_t table_offset;
+    char type[32];
+  };
+
+  boost::uint64_t align(const boost::uint64_t offset)
+  {
+    return (offset + s_alignment - 1) / s_alignment * s_alignment;
+  }
+
+  boost::uint64_t n_elements(const bob::learn::em::detail::MappedEntry& e)
+  {
+    boost::uint64_t n = 1;
+    for (boost::uint64_t k=0; k<e.ndim; ++k) n *= e.shape[k];
+    return n;
+  }
+
+  /* Tells if the array lies within a file of the given size */
+  bool is_valid(const bob::learn::em::detail::MappedEntry& e, const size_t size)
+  {
+    if (e.ndim > 4 || e.offset % s_alignment != 0 || e.offset > size)
+      return false;
+    boost::uint64_t n = 1;
+    for (boost::uint64_t k=0; k<e.ndim; ++k) {
+      if (e.shape[k] > INT_MAX || (e.shape[k] > 0 && n > size / e.shape[k]))
+        return false;
+      n *= e.shape[k];
+    }
+    return n <= (size - e.offset) / sizeof(double);
+  }
+
+}
+
+
+bob::learn::em::MappedFileWriter::MappedFileWriter(const std::string& filename,
+    const std::string& type):
+  m_filename(filename), m_tmp_filename(filename + ".tmp"),
+  m_offset(align(sizeof(Header))), m_closed(false)
+{
+  if (type.size() >= sizeof(Header().type)) {
+    boost::format m("the type `%s' is too long for a mapped file");
+    m % type;
+    throw std::runtime_error(m.str());
+  }
+
+  m_stream.open(m_tmp_filename.c_str(), std::ios::binary | std::ios::trunc);
+  if (!m_stream) {
+    boost::format m("cannot open the file `%s' for writing");
+    m % m_tmp_filename;
+    throw std::runtime_error(m.str());
+  }
+
+  // Completed by close(), once the table is written
+  Header header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, s_magic, sizeof(s_magic));
+  header.byte_order = s_byte_order;
+  header.version = s_version;
+  std::strncpy(header.type, type.c_str(), sizeof(header.type)-1);
+  m_stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  m_stream.write(std::string(m_offset - sizeof(header), '\0').data(),
+    m_offset - sizeof(header));
+}
+
+bob::learn::em::MappedFileWriter::~MappedFileWriter()
+{
+  if (!m_closed) {
+    m_stream.close();
+    std::remove(m_tmp_filename.c_str());
+  }
+}
+
+void bob::learn::em::MappedFileWriter::write(const std::string& name,
+    const double* data, const int ndim, const boost::uint64_t* shape)
+{
+  detail::MappedEntry entry;
+  std::memset(&entry, 0, sizeof(entry));
+  if (name.size() >= sizeof(entry.name)) {
+    boost::format m("the name `%s' is too long for a mapped file");
+    m % name;
+    throw std::runtime_error(m.str());
+  }
+  std::strncpy(entry.name, name.c_str(), sizeof(entry.name)-1);
+  entry.ndim = ndim;
+  for (int k=0; k<4; ++k) entry.shape[k] = shape[k];
+  entry.offset = m_offset;
+
+  const boost::uint64_t size = n_elements(entry) * sizeof(double);
+  m_stream.write(reinterpret_cast<const char*>(data), size);
+  const boost::uint64_t end = align(m_offset + size);
+  m_stream.write(std::string(end - m_offset - size, '\0').data(),
+    end - m_offset - size);
+  m_offset = end;
+  m_entries.push_back(entry);
+}
+
+void bob::learn::em::MappedFileWriter::set(const std::string& name,
+    const double value)
+{
+  const boost::uint64_t shape[4] = {1, 1, 1, 1};
+  write(name, &value, 0, shape);
+}
+
+void bob::learn::em::MappedFileWriter::close()
+{
+  if (m_closed) return;
+
+  if (!m_entries.empty())
+    m_stream.write(reinterpret_cast<const char*>(&m_entries[0]),
+      m_entries.size() * sizeof(detail::MappedEntry));
+
+  // Fills in the header
+  const boost::uint64_t n_entries = m_entries.size();
+  m_stream.seekp(offsetof(Header, n_entries));
+  m_stream.write(reinterpret_cast<const char*>(&n_entries), sizeof(n_entries));
+  m_stream.seekp(offsetof(Header, table_offset));
+  m_stream.write(reinterpret_cast<const char*>(&m_offset), sizeof(m_offset));
+  m_stream.close();
+  if (!m_stream) {
+    boost::format m("cannot write the file `%s'");
+    m % m_tmp_filename;
+    throw std::runtime_error(m.str());
+  }
+
+  if (std::rename(m_tmp_filename.c_str(), m_filename.c_str()) != 0) {
+    boost::format m("cannot rename `%s' to `%s': %s");
+    m % m_tmp_filename % m_filename % std::strerror(errno);
+    throw std::runtime_error(m.str());
+  }
+  m_closed = true;
+}
+
+
+bob::learn::em::MappedFile::MappedFile(const std::string& filename,
+    const std::string& type):
+  m_filename(filename), m_data(0), m_size(0)
+{
+  const int fd = open(filename.c_str(), O_RDONLY);
+  if (fd < 0) {
+    boost::format m("cannot open the file `%s': %s");
+    m % filename % std::strerror(errno);
+    throw std::runtime_error(m.str());
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(Header)) {
+    close(fd);
+    boost::format m("the file `%s' is not a mapped model file");
+    m % filename;
+    throw std::runtime_error(m.str());
+  }
+  m_size = st.st_size;
+
+  // Private and writable: updating a machine copies the pages it modifies
+  void* data = mmap(0, m_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED) {
+    boost::format m("cannot map the file `%s': %s");
+    m % filename % std::strerror(errno);
+    throw std::runtime_error(m.str());
+  }
+  m_data = static_cast<char*>(data);
+
+  const Header& header = *reinterpret_cast<const Header*>(m_data);
+  std::string error;
+  if (std::memcmp(header.magic, s_magic, sizeof(s_magic)) != 0)
+    error = "it is not a mapped model file";
+  else if (header.byte_order != s_byte_order)
+    error = "it was written with another byte order";
+  else if (header.version != s_version)
+    error = (boost::format("version %u is not supported") % header.version).str();
+  else if (std::string(header.type, strnlen(header.type, sizeof(header.type))) != type)
+    error = (boost::format("it holds a `%s', not a `%s'") %
+      std::string(header.type, strnlen(header.type, sizeof(header.type))) % type).str();
+  else if (header.table_offset % sizeof(boost::uint64_t) != 0 ||
+      header.table_offset > m_size ||
+      header.n_entries > (m_size - header.table_offset) / sizeof(detail::MappedEntry))
+    error = "its table is corrupted";
+
+  for (boost::uint64_t i=0; error.empty() && i<header.n_entries; ++i) {
+    const detail::MappedEntry& e = reinterpret_cast<const detail::MappedEntry*>
+      (m_data + header.table_offset)[i];
+    if (!is_valid(e, m_size))
+      error = "its table is corrupted";
+    else
+      m_entries[std::string(e.name, strnlen(e.name, sizeof(e.name)))] = &e;
+  }
+
+  if (!error.empty()) {
+    munmap(m_data, m_size);
+    boost::format m("cannot load the file `%s': %s");
+    m % filename % error;
+    throw std::runtime_error(m.str());
+  }
+}
+
+bob::learn::em::MappedFile::~MappedFile()
+{
+  munmap(m_data, m_size);
+}
+
+double* bob::learn::em::MappedFile::get(const std::string& name,
+    const int ndim, boost::uint64_t* shape) const
+{
+  std::map<std::string, const detail::MappedEntry*>::const_iterator it =
+    m_entries.find(name);
+  if (it == m_entries.end()) {
+    boost::format m("the file `%s' does not contain `%s'");
+    m % m_filename % name;
+    throw std::runtime_error(m.str());
+  }
+  const detail::MappedEntry& e = *it->second;
+  if (e.ndim != (boost::uint64_t)ndim) {
+    boost::format m("`%s' in the file `%s' has %lu dimensions, not %d");
+    m % name % m_filename % e.ndim % ndim;
+    throw std::runtime_error(m.str());
+  }
+  for (int k=0; k<4; ++k) shape[k] = e.shape[k];
+  return reinterpret_cast<double*>(m_data + e.offset);
+}
+
+double bob::learn::em::MappedFile::read(const std::string& name) const
+{
+  boost::uint64_t shape[4];
+  return *get(name, 0, shape);
+}
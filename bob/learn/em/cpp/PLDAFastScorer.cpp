@@ -0,0 +1,181 @@
+/**
+ * @date Sun Oct 18 15:08:14 2026 +0200
+ *
+ * Copyright (C) Idiap Research Institute, Martigny, Switzerland
+ */
+
+#include <bob.learn.em/PLDAFastScorer.h>
+#include <bob.core/assert.h>
+#include <bob.core/array_copy.h>
+#include <bob.core/check.h>
+#include <bob.math/linear.h>
+
+
+bob::learn::em::PLDAFastScorer::PLDAFastScorer():
+  m_P(0,0), m_Q(0,0), m_mu(0), m_constant(0.)
+{
+}
+
+bob::learn::em::PLDAFastScorer::PLDAFastScorer(const bob::learn::em::PLDABase& plda_base)
+{
+  const size_t dim_d = plda_base.getDimD();
+  const size_t dim_f = plda_base.getDimF();
+
+  // gamma_1, gamma_2 and the corresponding constant terms
+  blitz::Array<double,2> gamma_1(dim_f, dim_f), gamma_2(dim_f, dim_f);
+  plda_base.computeGamma(1, gamma_1);
+  plda_base.computeGamma(2, gamma_2);
+  m_constant = plda_base.computeLogLikeConstTerm(2, gamma_2) -
+    2. * plda_base.computeLogLikeConstTerm(1, gamma_1);
+
+  // P = 1/2.beta.F.gamma_2.F^T.beta and Q = 1/2.beta.F.(gamma_2 - gamma_1).F^T.beta
+  const blitz::Array<double,2> Ft_beta = plda_base.getFtBeta();
+  const blitz::Array<double,2> beta_F = Ft_beta.transpose(1,0);
+  blitz::Array<double,2> tmp(dim_d, dim_f);
+  m_P.resize(dim_d, dim_d);
+  m_Q.resize(dim_d, dim_d);
+  bob::math::prod(beta_F, gamma_2, tmp);
+  bob::math::prod(tmp, Ft_beta, m_P);
+  m_P *= 0.5;
+  gamma_2 -= gamma_1;
+  bob::math::prod(beta_F, gamma_2, tmp);
+  bob::math::prod(tmp, Ft_beta, m_Q);
+  m_Q *= 0.5;
+
+  m_mu.reference(bob::core::array::ccopy(plda_base.getMu()));
+}
+
+bob::learn::em::PLDAFastScorer::PLDAFastScorer(bob::io::base::HDF5File& config)
+{
+  load(config);
+}
+
+bob::learn::em::PLDAFastScorer::PLDAFastScorer(const bob::learn::em::PLDAFastScorer& other):
+  m_P(bob::core::array::ccopy(other.m_P)),
+  m_Q(bob::core::array::ccopy(other.m_Q)),
+  m_mu(bob::core::array::ccopy(other.m_mu)),
+  m_constant(other.m_constant)
+{
+}
+
+bob::learn::em::PLDAFastScorer::~PLDAFastScorer()
+{
+}
+
+bob::learn::em::PLDAFastScorer& bob::learn::em::PLDAFastScorer::operator=
+    (const bob::learn::em::PLDAFastScorer& other)
+{
+  if (this != &other)
+  {
+    m_P.reference(bob::core::array::ccopy(other.m_P));
+    m_Q.reference(bob::core::array::ccopy(other.m_Q));
+    m_mu.reference(bob::core::array::ccopy(other.m_mu));
+    m_constant = other.m_constant;
+  }
+  return *this;
+}
+
+bool bob::learn::em::PLDAFastScorer::operator==
+    (const bob::learn::em::PLDAFastScorer& b) const
+{
+  return (bob::core::array::isEqual(m_P, b.m_P) &&
+          bob::core::array::isEqual(m_Q, b.m_Q) &&
+          bob::core::array::isEqual(m_mu, b.m_mu) &&
+          m_constant == b.m_constant);
+}
+
+bool bob::learn::em::PLDAFastScorer::operator!=
+    (const bob::learn::em::PLDAFastScorer& b) const
+{
+  return !(this->operator==(b));
+}
+
+bool bob::learn::em::PLDAFastScorer::is_similar_to(const bob::learn::em::PLDAFastScorer& b,
+  const double r_epsilon, const double a_epsilon) const
+{
+  return (bob::core::array::isClose(m_P, b.m_P, r_epsilon, a_epsilon) &&
+          bob::core::array::isClose(m_Q, b.m_Q, r_epsilon, a_epsilon) &&
+          bob::core::array::isClose(m_mu, b.m_mu, r_epsilon, a_epsilon) &&
+          bob::core::isClose(m_constant, b.m_constant, r_epsilon, a_epsilon));
+}
+
+void bob::learn::em::PLDAFastScorer::load(bob::io::base::HDF5File& config)
+{
+  //reads all data directly into the member variables
+  m_P.reference(config.readArray<double,2>("P"));
+  m_Q.reference(config.readArray<double,2>("Q"));
+  m_mu.reference(config.readArray<double,1>("mu"));
+  m_constant = config.read<double>("constant");
+}
+
+void bob::learn::em::PLDAFastScorer::save(bob::io::base::HDF5File& config) const
+{
+  config.setArray("P", m_P);
+  config.setArray("Q", m_Q);
+  config.setArray("mu", m_mu);
+  config.set("constant", m_constant);
+}
+
+double bob::learn::em::PLDAFastScorer::score(const blitz::Array<double,1>& model,
+  const blitz::Array<double,1>& probe) const
+{
+  // Check dimensionality
+  bob::core::array::assertSameDimensionLength(model.extent(0), getDimD());
+  bob::core::array::assertSameDimensionLength(probe.extent(0), getDimD());
+
+  blitz::Array<double,1> x(model - m_mu);
+  blitz::Array<double,1> y(probe - m_mu);
+  blitz::Array<double,1> tmp(getDimD());
+
+  // 2.x^T.P.y
+  bob::math::prod(m_P, y, tmp);
+  double res = m_constant + 2. * blitz::sum(x * tmp);
+  // x^T.Q.x + y^T.Q.y
+  bob::math::prod(m_Q, x, tmp);
+  res += blitz::sum(x * tmp);
+  bob::math::prod(m_Q, y, tmp);
+  res += blitz::sum(y * tmp);
+  return res;
+}
+
+void bob::learn::em::PLDAFastScorer::quadraticTerms(const blitz::Array<double,2>& samples,
+  blitz::Array<double,1>& res) const
+{
+  blitz::firstIndex i;
+  blitz::secondIndex j;
+  blitz::Array<double,2> samples_Q(samples.extent(0), samples.extent(1));
+  bob::math::prod(samples, m_Q, samples_Q); // Q is symmetric
+  res = blitz::sum(samples_Q(i,j) * samples(i,j), j);
+}
+
+void bob::learn::em::PLDAFastScorer::score(const blitz::Array<double,2>& models,
+  const blitz::Array<double,2>& probes, blitz::Array<double,2>& scores) const
+{
+  const int Tm = models.extent(0);
+  const int Tt = probes.extent(0);
+  bob::core::array::assertSameDimensionLength(models.extent(1), getDimD());
+  bob::core::array::assertSameDimensionLength(probes.extent(1), getDimD());
+  bob::core::array::assertSameDimensionLength(scores.extent(0), Tm);
+  bob::core::array::assertSameDimensionLength(scores.extent(1), Tt);
+
+  blitz::firstIndex i;
+  blitz::secondIndex j;
+
+  // Centres the samples
+  blitz::Array<double,2> x(Tm, getDimD());
+  blitz::Array<double,2> y(Tt, getDimD());
+  x = models(i,j) - m_mu(j);
+  y = probes(i,j) - m_mu(j);
+
+  // Quadratic terms x^T.Q.x and y^T.Q.y
+  blitz::Array<double,1> qx(Tm), qy(Tt);
+  quadraticTerms(x, qx);
+  quadraticTerms(y, qy);
+
+  // Cross term 2.x^T.P.y, for all the trials at once
+  blitz::Array<double,2> x_P(Tm, getDimD());
+  bob::math::prod(x, m_P, x_P); // P is symmetric
+  bob::math::prod(x_P, y.transpose(1,0), scores);
+
+  scores = 2. * scores(i,j) + qx(i) + qy(j) + m_constant;
+}
@@ -11,6 +11,7 @@
 #include <bob.core/check.h>
 #include <bob.core/array_copy.h>
 #include <bob.learn.em/PLDAMachine.h>
+#include <bob.learn.em/MappedFile.h>
 #include <bob.math/linear.h>
 #include <bob.math/det.h>
 #include <bob.math/inv.h>
@@ -50,9 +51,11 @@ bob::learn::em::PLDABase::PLDABase(const bob::learn::em::PLDABase& other):
   m_cache_Gt_isigma(bob::core::array::ccopy(other.m_cache_Gt_isigma)),
   m_cache_logdet_alpha(other.m_cache_logdet_alpha),
   m_cache_logdet_sigma(other.m_cache_logdet_sigma),
-  m_cache_loglike_constterm(other.m_cache_loglike_constterm)
+  m_cache_loglike_constterm(other.m_cache_loglike_constterm),
+  m_table_loglike_constterm(other.m_table_loglike_constterm)
 {
   bob::core::array::ccopy(other.m_cache_gamma, m_cache_gamma);
+  bob::core::array::ccopy(other.m_table_gamma, m_table_gamma);
   resizeTmp();
 }
 
@@ -85,6 +88,8 @@ bob::learn::em::PLDABase& bob::learn::em::PLDABase::operator=
     m_cache_logdet_alpha = other.m_cache_logdet_alpha;
     m_cache_logdet_sigma = other.m_cache_logdet_sigma;
     m_cache_loglike_constterm = other.m_cache_loglike_constterm;
+    bob::core::array::ccopy(other.m_table_gamma, m_table_gamma);
+    m_table_loglike_constterm = other.m_table_loglike_constterm;
     resizeTmp();
   }
   return *this;
@@ -238,6 +243,7 @@ void bob::learn::em::PLDABase::load(bob::io::base::HDF5File& config)
     m_cache_logdet_alpha = config.read<double>("logdet_alpha");
     m_cache_logdet_sigma = config.read<double>("logdet_sigma");
   }
+  clearTables();
   resizeTmp();
 }
 
@@ -290,6 +296,80 @@ void bob::learn::em::PLDABase::save(bob::io::base::HDF5File& config) const
   config.set("logdet_sigma", m_cache_logdet_sigma);
 }
 
+void bob::learn::em::PLDABase::saveMapped(const std::string& filename) const
+{
+  bob::learn::em::MappedFileWriter file(filename, "PLDABase");
+  file.setArray("F", m_F);
+  file.setArray("G", m_G);
+  file.setArray("sigma", m_sigma);
+  file.setArray("mu", m_mu);
+  file.set("variance_threshold", m_variance_threshold);
+  file.setArray("isigma", m_cache_isigma);
+  file.setArray("alpha", m_cache_alpha);
+  file.setArray("beta", m_cache_beta);
+  file.setArray("Ft_beta", m_cache_Ft_beta);
+  file.setArray("Gt_isigma", m_cache_Gt_isigma);
+  file.set("logdet_alpha", m_cache_logdet_alpha);
+  file.set("logdet_sigma", m_cache_logdet_sigma);
+  file.close();
+}
+
+void bob::learn::em::PLDABase::loadMapped(const std::string& filename)
+{
+  const boost::shared_ptr<const bob::learn::em::MappedFile> file(
+    new bob::learn::em::MappedFile(filename, "PLDABase"));
+  const blitz::Array<double,2> F = file->readArray<2>("F");
+  const blitz::Array<double,2> G = file->readArray<2>("G");
+  const blitz::Array<double,1> sigma = file->readArray<1>("sigma");
+  const blitz::Array<double,1> mu = file->readArray<1>("mu");
+  const double variance_threshold = file->read("variance_threshold");
+  const blitz::Array<double,1> isigma = file->readArray<1>("isigma");
+  const blitz::Array<double,2> alpha = file->readArray<2>("alpha");
+  const blitz::Array<double,2> beta = file->readArray<2>("beta");
+  const blitz::Array<double,2> Ft_beta = file->readArray<2>("Ft_beta");
+  const blitz::Array<double,2> Gt_isigma = file->readArray<2>("Gt_isigma");
+  const double logdet_alpha = file->read("logdet_alpha");
+  const double logdet_sigma = file->read("logdet_sigma");
+
+  // Checks the dimensions of the arrays against the ones of F and G
+  const int d = F.extent(0), f = F.extent(1), g = G.extent(1);
+  bob::core::array::assertSameDimensionLength(G.extent(0), d);
+  bob::core::array::assertSameDimensionLength(sigma.extent(0), d);
+  bob::core::array::assertSameDimensionLength(mu.extent(0), d);
+  bob::core::array::assertSameDimensionLength(isigma.extent(0), d);
+  bob::core::array::assertSameDimensionLength(alpha.extent(0), g);
+  bob::core::array::assertSameDimensionLength(alpha.extent(1), g);
+  bob::core::array::assertSameDimensionLength(beta.extent(0), d);
+  bob::core::array::assertSameDimensionLength(beta.extent(1), d);
+  bob::core::array::assertSameDimensionLength(Ft_beta.extent(0), f);
+  bob::core::array::assertSameDimensionLength(Ft_beta.extent(1), d);
+  bob::core::array::assertSameDimensionLength(Gt_isigma.extent(0), g);
+  bob::core::array::assertSameDimensionLength(Gt_isigma.extent(1), d);
+
+  m_dim_d = d;
+  m_dim_f = f;
+  m_dim_g = g;
+  m_F.reference(F);
+  m_G.reference(G);
+  m_sigma.reference(sigma);
+  m_mu.reference(mu);
+  m_variance_threshold = variance_threshold;
+  m_cache_isigma.reference(isigma);
+  m_cache_alpha.reference(alpha);
+  m_cache_beta.reference(beta);
+  m_cache_Ft_beta.reference(Ft_beta);
+  m_cache_Gt_isigma.reference(Gt_isigma);
+  m_cache_logdet_alpha = logdet_alpha;
+  m_cache_logdet_sigma = logdet_sigma;
+  m_mapped_file = file;
+
+  // The gamma's are computed again when needed
+  m_cache_gamma.clear();
+  m_cache_loglike_constterm.clear();
+  clearTables();
+  resizeTmp();
+}
+
 void bob::learn::em::PLDABase::resizeNoInit(const size_t dim_d, const size_t dim_f,
     const size_t dim_g)
 {
@@ -307,15 +387,13 @@ void bob::learn::em::PLDABase::resizeNoInit(const size_t dim_d, const size_t dim
   m_cache_gamma.clear();
   m_cache_isigma.resize(dim_d);
   m_cache_loglike_constterm.clear();
+  clearTables();
   resizeTmp();
 }
 
 void bob::learn::em::PLDABase::resizeTmp()
 {
-  m_tmp_d_1.resize(m_dim_d);
-  m_tmp_d_2.resize(m_dim_d);
   m_tmp_d_ng_1.resize(m_dim_d, m_dim_g);
-  m_tmp_nf_nf_1.resize(m_dim_f, m_dim_f);
   m_tmp_ng_ng_1.resize(m_dim_g, m_dim_g);
 }
 
@@ -378,6 +456,7 @@ void bob::learn::em::PLDABase::applyVarianceThreshold()
 
 const blitz::Array<double,2>& bob::learn::em::PLDABase::getGamma(const size_t a) const
 {
+  if (a < m_table_gamma.size()) return m_table_gamma[a];
   if(!hasGamma(a))
     throw std::runtime_error("Gamma for this number of samples is not currently in cache. You could use the getAddGamma() method instead");
   return (m_cache_gamma.find(a))->second;
@@ -385,6 +464,7 @@ const blitz::Array<double,2>& bob::learn::em::PLDABase::getGamma(const size_t a)
 
 const blitz::Array<double,2>& bob::learn::em::PLDABase::getAddGamma(const size_t a)
 {
+  if (a < m_table_gamma.size()) return m_table_gamma[a];
   if(!hasGamma(a)) precomputeGamma(a);
   return m_cache_gamma[a];
 }
@@ -410,6 +490,7 @@ void bob::learn::em::PLDABase::precompute()
   m_cache_gamma.clear();
   precomputeFtBeta();
   m_cache_loglike_constterm.clear();
+  clearTables();
 }
 
 void bob::learn::em::PLDABase::precomputeLogLike()
@@ -482,17 +563,21 @@ void bob::learn::em::PLDABase::computeGamma(const size_t a,
 {
   // gamma = (Id + a.F^T.beta.F)^-1
 
+  // Works on a local array rather than on a member, as this is called
+  // concurrently by the machines which share this base when gamma_a is not
+  // cached
+  blitz::Array<double,2> tmp(getDimF(), getDimF());
   // Checks destination size
-  bob::core::array::assertSameShape(res, m_tmp_nf_nf_1);
-  // m_tmp_nf_nf_1 = F^T.beta.F
-  bob::math::prod(m_cache_Ft_beta, m_F, m_tmp_nf_nf_1);
-   // m_tmp_nf_nf_1 = a.F^T.beta.F
-  m_tmp_nf_nf_1 *= static_cast<double>(a);
-  // m_tmp_nf_nf_1 = Id + a.F^T.beta.F
-  for(int i=0; i<m_tmp_nf_nf_1.extent(0); ++i) m_tmp_nf_nf_1(i,i) += 1;
+  bob::core::array::assertSameShape(res, tmp);
+  // tmp = F^T.beta.F
+  bob::math::prod(m_cache_Ft_beta, m_F, tmp);
+   // tmp = a.F^T.beta.F
+  tmp *= static_cast<double>(a);
+  // tmp = Id + a.F^T.beta.F
+  for(int i=0; i<tmp.extent(0); ++i) tmp(i,i) += 1;
 
   // res = (Id + a.F^T.beta.F)^-1
-  bob::math::inv(m_tmp_nf_nf_1, res);
+  bob::math::inv(tmp, res);
 }
 
 void bob::learn::em::PLDABase::precomputeLogDetAlpha()
@@ -533,6 +618,7 @@ void bob::learn::em::PLDABase::precomputeLogLikeConstTerm(const size_t a)
 
 double bob::learn::em::PLDABase::getLogLikeConstTerm(const size_t a) const
 {
+  if (a < m_table_loglike_constterm.size()) return m_table_loglike_constterm[a];
   if(!hasLogLikeConstTerm(a))
     throw std::runtime_error("The LogLikelihood constant term for this number of samples is not currently in cache. You could use the getAddLogLikeConstTerm() method instead");
   return (m_cache_loglike_constterm.find(a))->second;
@@ -540,6 +626,7 @@ double bob::learn::em::PLDABase::getLogLikeConstTerm(const size_t a) const
 
 double bob::learn::em::PLDABase::getAddLogLikeConstTerm(const size_t a)
 {
+  if (a < m_table_loglike_constterm.size()) return m_table_loglike_constterm[a];
   if(!hasLogLikeConstTerm(a)) precomputeLogLikeConstTerm(a);
   return m_cache_loglike_constterm[a];
 }
@@ -550,6 +637,28 @@ void bob::learn::em::PLDABase::clearMaps()
   m_cache_loglike_constterm.clear();
 }
 
+void bob::learn::em::PLDABase::precomputeTables(const size_t max_n_samples)
+{
+  // Fills new tables first, so that this object is left unchanged if
+  // anything goes wrong
+  std::vector<blitz::Array<double,2> > table_gamma(max_n_samples+1);
+  std::vector<double> table_loglike_constterm(max_n_samples+1);
+  for (size_t a=0; a<=max_n_samples; ++a)
+  {
+    table_gamma[a].resize(getDimF(), getDimF());
+    computeGamma(a, table_gamma[a]);
+    table_loglike_constterm[a] = computeLogLikeConstTerm(a, table_gamma[a]);
+  }
+  m_table_gamma.swap(table_gamma);
+  m_table_loglike_constterm.swap(table_loglike_constterm);
+}
+
+void bob::learn::em::PLDABase::clearTables()
+{
+  m_table_gamma.clear();
+  m_table_loglike_constterm.clear();
+}
+
 double bob::learn::em::PLDABase::computeLogLikelihoodPointEstimate(
   const blitz::Array<double,1>& xij, const blitz::Array<double,1>& hi,
   const blitz::Array<double,1>& wij) const
@@ -561,14 +670,16 @@ double bob::learn::em::PLDABase::computeLogLikelihoodPointEstimate(
   // Computes: -D/2 log(2pi) -1/2 log(det(\Sigma))
   //   -1/2 {(x_{ij}-(\mu+Fh_{i}+Gw_{ij}))^{T}\Sigma^{-1}(x_{ij}-(\mu+Fh_{i}+Gw_{ij}))}
   double res = -0.5*((double)m_dim_d)*log(2*M_PI) - 0.5*m_cache_logdet_sigma;
-  // m_tmp_d_1 = (x_{ij} - (\mu+Fh_{i}+Gw_{ij}))
-  m_tmp_d_1 = xij - m_mu;
-  bob::math::prod(m_F, hi, m_tmp_d_2);
-  m_tmp_d_1 -= m_tmp_d_2;
-  bob::math::prod(m_G, wij, m_tmp_d_2);
-  m_tmp_d_1 -= m_tmp_d_2;
+  // tmp_d_1 = (x_{ij} - (\mu+Fh_{i}+Gw_{ij}))
+  // (local working arrays, so that several threads can use the machine)
+  blitz::Array<double,1> tmp_d_1(m_dim_d), tmp_d_2(m_dim_d);
+  tmp_d_1 = xij - m_mu;
+  bob::math::prod(m_F, hi, tmp_d_2);
+  tmp_d_1 -= tmp_d_2;
+  bob::math::prod(m_G, wij, tmp_d_2);
+  tmp_d_1 -= tmp_d_2;
   // add third term to res
-  res += -0.5*blitz::sum(blitz::pow2(m_tmp_d_1) * m_cache_isigma);
+  res += -0.5*blitz::sum(blitz::pow2(tmp_d_1) * m_cache_isigma);
   return res;
 }
 
@@ -591,8 +702,7 @@ namespace bob { namespace learn { namespace em {
 bob::learn::em::PLDAMachine::PLDAMachine():
   m_plda_base(),
   m_n_samples(0), m_nh_sum_xit_beta_xi(0), m_weighted_sum(0),
-  m_loglikelihood(0), m_cache_gamma(), m_cache_loglike_constterm(),
-  m_tmp_d_1(0), m_tmp_d_2(0), m_tmp_nf_1(0), m_tmp_nf_2(0), m_tmp_nf_nf_1(0,0)
+  m_loglikelihood(0), m_cache_gamma(), m_cache_loglike_constterm()
 {
 }
 
@@ -601,7 +711,6 @@ bob::learn::em::PLDAMachine::PLDAMachine(const boost::shared_ptr<bob::learn::em:
   m_n_samples(0), m_nh_sum_xit_beta_xi(0), m_weighted_sum(plda_base->getDimF()),
   m_loglikelihood(0), m_cache_gamma(), m_cache_loglike_constterm()
 {
-  resizeTmp();
 }
 
 
@@ -614,7 +723,6 @@ bob::learn::em::PLDAMachine::PLDAMachine(const bob::learn::em::PLDAMachine& othe
   m_cache_loglike_constterm(other.m_cache_loglike_constterm)
 {
   bob::core::array::ccopy(other.m_cache_gamma, m_cache_gamma);
-  resizeTmp();
 }
 
 bob::learn::em::PLDAMachine::PLDAMachine(bob::io::base::HDF5File& config,
@@ -639,7 +747,6 @@ bob::learn::em::PLDAMachine& bob::learn::em::PLDAMachine::operator=
     m_loglikelihood = other.m_loglikelihood;
     bob::core::array::ccopy(other.m_cache_gamma, m_cache_gamma);
     m_cache_loglike_constterm = other.m_cache_loglike_constterm;
-    resizeTmp();
   }
   return *this;
 }
@@ -712,7 +819,6 @@ void bob::learn::em::PLDAMachine::load(bob::io::base::HDF5File& config)
       m_cache_loglike_constterm[a_indices(i)] = config.read<double>(str2);
     }
   }
-  resizeTmp();
 }
 
 void bob::learn::em::PLDAMachine::save(bob::io::base::HDF5File& config) const
@@ -746,7 +852,6 @@ void bob::learn::em::PLDAMachine::setPLDABase(const boost::shared_ptr<bob::learn
   m_plda_base = plda_base;
   m_weighted_sum.resizeAndPreserve(getDimF());
   clearMaps();
-  resizeTmp();
 }
 
 
@@ -843,28 +948,35 @@ double bob::learn::em::PLDAMachine::computeLogLikelihood(const blitz::Array<doub
   const blitz::Array<double,2>& Ft_beta = getPLDABase()->getFtBeta();
   const blitz::Array<double,1>& mu = getPLDABase()->getMu();
   double terma = (enroll?m_nh_sum_xit_beta_xi:0.);
+  // Local working arrays, so that several threads can score with this machine
+  blitz::Array<double,1> tmp_d_1(getDimD()), tmp_d_2(getDimD());
+  blitz::Array<double,1> tmp_nf_1(getDimF()), tmp_nf_2(getDimF());
   // sumWeighted
-  if (enroll && m_n_samples > 0) m_tmp_nf_1 = m_weighted_sum;
-  else m_tmp_nf_1 = 0;
+  if (enroll && m_n_samples > 0) tmp_nf_1 = m_weighted_sum;
+  else tmp_nf_1 = 0;
 
   // terma += -1 / 2. * (xi^t*beta*xi)
-  m_tmp_d_1 = sample - mu;
-  bob::math::prod(beta, m_tmp_d_1, m_tmp_d_2);
-  terma += -1 / 2. * (blitz::sum(m_tmp_d_1*m_tmp_d_2));
+  tmp_d_1 = sample - mu;
+  bob::math::prod(beta, tmp_d_1, tmp_d_2);
+  terma += -1 / 2. * (blitz::sum(tmp_d_1*tmp_d_2));
 
   // sumWeighted
-  bob::math::prod(Ft_beta, m_tmp_d_1, m_tmp_nf_2);
-  m_tmp_nf_1 += m_tmp_nf_2;
-  blitz::Array<double,2> gamma_a;
+  bob::math::prod(Ft_beta, tmp_d_1, tmp_nf_2);
+  tmp_nf_1 += tmp_nf_2;
+  // Points to the cached gamma_a rather than referencing it, as changing the
+  // reference count of an array shared by several threads is not safe
+  const blitz::Array<double,2>* gamma_a;
+  blitz::Array<double,2> gamma_tmp;
   if (hasGamma(n_samples) || m_plda_base->hasGamma(n_samples))
-    gamma_a.reference(getGamma(n_samples));
+    gamma_a = &getGamma(n_samples);
   else
   {
-    gamma_a.reference(m_tmp_nf_nf_1);
-    m_plda_base->computeGamma(n_samples, gamma_a);
+    gamma_tmp.resize(getDimF(), getDimF());
+    m_plda_base->computeGamma(n_samples, gamma_tmp);
+    gamma_a = &gamma_tmp;
   }
-  bob::math::prod(gamma_a, m_tmp_nf_1, m_tmp_nf_2);
-  double termb = 1 / 2. * (blitz::sum(m_tmp_nf_1*m_tmp_nf_2));
+  bob::math::prod(*gamma_a, tmp_nf_1, tmp_nf_2);
+  double termb = 1 / 2. * (blitz::sum(tmp_nf_1*tmp_nf_2));
 
   // 1/2/ Constant term of the log likelihood:
   //      1/ First term of the likelihood: -Nsamples*D/2*log(2*PI)
@@ -875,7 +987,7 @@ double bob::learn::em::PLDAMachine::computeLogLikelihood(const blitz::Array<doub
   if (hasLogLikeConstTerm(n_samples) || m_plda_base->hasLogLikeConstTerm(n_samples))
     log_likelihood = getLogLikeConstTerm(n_samples);
   else
-    log_likelihood = m_plda_base->computeLogLikeConstTerm(n_samples, gamma_a);
+    log_likelihood = m_plda_base->computeLogLikeConstTerm(n_samples, *gamma_a);
 
   log_likelihood += terma + termb;
   return log_likelihood;
@@ -897,32 +1009,39 @@ double bob::learn::em::PLDAMachine::computeLogLikelihood(const blitz::Array<doub
   const blitz::Array<double,2>& Ft_beta = getPLDABase()->getFtBeta();
   const blitz::Array<double,1>& mu = getPLDABase()->getMu();
   double terma = (enroll?m_nh_sum_xit_beta_xi:0.);
+  // Local working arrays, so that several threads can score with this machine
+  blitz::Array<double,1> tmp_d_1(getDimD()), tmp_d_2(getDimD());
+  blitz::Array<double,1> tmp_nf_1(getDimF()), tmp_nf_2(getDimF());
   // sumWeighted
-  if (enroll && m_n_samples > 0) m_tmp_nf_1 = m_weighted_sum;
-  else m_tmp_nf_1 = 0;
+  if (enroll && m_n_samples > 0) tmp_nf_1 = m_weighted_sum;
+  else tmp_nf_1 = 0;
   for (int k=0; k<samples.extent(0); ++k)
   {
     blitz::Array<double,1> samp = samples(k,blitz::Range::all());
-    m_tmp_d_1 = samp - mu;
+    tmp_d_1 = samp - mu;
     // terma += -1 / 2. * (xi^t*beta*xi)
-    bob::math::prod(beta, m_tmp_d_1, m_tmp_d_2);
-    terma += -1 / 2. * (blitz::sum(m_tmp_d_1*m_tmp_d_2));
+    bob::math::prod(beta, tmp_d_1, tmp_d_2);
+    terma += -1 / 2. * (blitz::sum(tmp_d_1*tmp_d_2));
 
     // sumWeighted
-    bob::math::prod(Ft_beta, m_tmp_d_1, m_tmp_nf_2);
-    m_tmp_nf_1 += m_tmp_nf_2;
+    bob::math::prod(Ft_beta, tmp_d_1, tmp_nf_2);
+    tmp_nf_1 += tmp_nf_2;
   }
 
-  blitz::Array<double,2> gamma_a;
+  // Points to the cached gamma_a rather than referencing it, as changing the
+  // reference count of an array shared by several threads is not safe
+  const blitz::Array<double,2>* gamma_a;
+  blitz::Array<double,2> gamma_tmp;
   if (hasGamma(n_samples) || m_plda_base->hasGamma(n_samples))
-    gamma_a.reference(getGamma(n_samples));
+    gamma_a = &getGamma(n_samples);
   else
   {
-    gamma_a.reference(m_tmp_nf_nf_1);
-    m_plda_base->computeGamma(n_samples, gamma_a);
+    gamma_tmp.resize(getDimF(), getDimF());
+    m_plda_base->computeGamma(n_samples, gamma_tmp);
+    gamma_a = &gamma_tmp;
   }
-  bob::math::prod(gamma_a, m_tmp_nf_1, m_tmp_nf_2);
-  double termb = 1 / 2. * (blitz::sum(m_tmp_nf_1*m_tmp_nf_2));
+  bob::math::prod(*gamma_a, tmp_nf_1, tmp_nf_2);
+  double termb = 1 / 2. * (blitz::sum(tmp_nf_1*tmp_nf_2));
 
   // 1/2/ Constant term of the log likelihood:
   //      1/ First term of the likelihood: -Nsamples*D/2*log(2*PI)
@@ -933,7 +1052,7 @@ double bob::learn::em::PLDAMachine::computeLogLikelihood(const blitz::Array<doub
   if (hasLogLikeConstTerm(n_samples) || m_plda_base->hasLogLikeConstTerm(n_samples))
     log_likelihood = getLogLikeConstTerm(n_samples);
   else
-    log_likelihood = m_plda_base->computeLogLikeConstTerm(n_samples, gamma_a);
+    log_likelihood = m_plda_base->computeLogLikeConstTerm(n_samples, *gamma_a);
 
   log_likelihood += terma + termb;
   return log_likelihood;
@@ -944,17 +1063,4 @@ void bob::learn::em::PLDAMachine::resize(const size_t dim_d, const size_t dim_f,
 {
   m_weighted_sum.resizeAndPreserve(dim_f);
   clearMaps();
-  resizeTmp();
-}
-
-void bob::learn::em::PLDAMachine::resizeTmp()
-{
-  if (m_plda_base)
-  {
-    m_tmp_d_1.resize(getDimD());
-    m_tmp_d_2.resize(getDimD());
-    m_tmp_nf_1.resize(getDimF());
-    m_tmp_nf_2.resize(getDimF());
-    m_tmp_nf_nf_1.resize(getDimF(), getDimF());
-  }
 }
@@ -0,0 +1,127 @@
+/**
+ * @date Sun Oct 18 14:26:52 2026 +0200
+ *
+ * Copyright (C) Idiap Research Institute, Martigny, Switzerland
+ */
+
+#include <bob.learn.em/PLDAScoring.h>
+#include <bob.core/assert.h>
+#include <bob.math/linear.h>
+
+#include <map>
+#include <boost/format.hpp>
+
+
+/**
+ * Returns gamma_a for the given machine, computing it into res if it is
+ * neither cached in the machine nor in its base
+ */
+static blitz::Array<double,2> _getGamma(const bob::learn::em::PLDAMachine& machine,
+  const size_t a, blitz::Array<double,2>& res)
+{
+  if (machine.hasGamma(a) || machine.getPLDABase()->hasGamma(a))
+    return machine.getGamma(a);
+  machine.getPLDABase()->computeGamma(a, res);
+  return res;
+}
+
+/**
+ * Returns the log likelihood constant term for a given number of samples,
+ * computing it if it is neither cached in the machine nor in its base
+ */
+static double _getLogLikeConstTerm(const bob::learn::em::PLDAMachine& machine,
+  const size_t a, const blitz::Array<double,2>& gamma_a)
+{
+  if (machine.hasLogLikeConstTerm(a) || machine.getPLDABase()->hasLogLikeConstTerm(a))
+    return machine.getLogLikeConstTerm(a);
+  return machine.getPLDABase()->computeLogLikeConstTerm(a, gamma_a);
+}
+
+void bob::learn::em::pldaScoring(const std::vector<boost::shared_ptr<const bob::learn::em::PLDAMachine> >& models,
+                 const blitz::Array<double,2>& probes,
+                 blitz::Array<double,2>& scores)
+{
+  const int Tm = models.size();
+  const int Tt = probes.extent(0);
+  bob::core::array::assertSameDimensionLength(scores.extent(0), Tm);
+  bob::core::array::assertSameDimensionLength(scores.extent(1), Tt);
+  if (Tm == 0 || Tt == 0) return;
+
+  // Checks that all the models share the same base
+  const boost::shared_ptr<bob::learn::em::PLDABase> base = models[0]->getPLDABase();
+  if (!base) throw std::runtime_error("No PLDABase set to the first PLDA model");
+  for (int m=1; m<Tm; ++m) {
+    const boost::shared_ptr<bob::learn::em::PLDABase> base_m = models[m]->getPLDABase();
+    if (base_m != base && (!base_m || *base_m != *base)) {
+      boost::format s("PLDA model %d does not share the PLDABase of the first model");
+      s % m;
+      throw std::runtime_error(s.str());
+    }
+  }
+  const int dim_d = base->getDimD();
+  const int dim_f = base->getDimF();
+  bob::core::array::assertSameDimensionLength(probes.extent(1), dim_d);
+
+  blitz::firstIndex i;
+  blitz::secondIndex j;
+
+  // 1) Probe side: f_x = F^T.beta.(x - mu), for all probes at once
+  blitz::Array<double,2> probes_centred(Tt, dim_d);
+  probes_centred = probes(i,j) - base->getMu()(j);
+  blitz::Array<double,2> Fx(Tt, dim_f);
+  bob::math::prod(probes_centred, base->getFtBeta().transpose(1,0), Fx);
+  probes_centred.free();
+
+  // gamma_1 and l_1 (no enrollment sample)
+  blitz::Array<double,2> tmp_gamma_1(dim_f, dim_f);
+  const blitz::Array<double,2> gamma_1 = _getGamma(*models[0], 1, tmp_gamma_1);
+  const double constterm_1 = _getLogLikeConstTerm(*models[0], 1, gamma_1);
+
+  // 2) Groups the models by number of enrollment samples, as they share
+  // the same gamma_{n+1}
+  std::map<uint64_t, std::vector<int> > groups;
+  for (int m=0; m<Tm; ++m)
+    groups[models[m]->getNSamples()].push_back(m);
+
+  blitz::Array<double,2> tmp_gamma(dim_f, dim_f);
+  blitz::Array<double,2> gamma_diff(dim_f, dim_f);
+  blitz::Array<double,2> Fx_gamma_diff(Tt, dim_f);
+  blitz::Array<double,1> q(Tt);
+  for (std::map<uint64_t, std::vector<int> >::const_iterator it=groups.begin(); it!=groups.end(); ++it) {
+    const uint64_t n_samples = it->first;
+    const std::vector<int>& group = it->second;
+    const int Tg = group.size();
+    const size_t a = n_samples + 1;
+    const bob::learn::em::PLDAMachine& machine = *models[group[0]];
+    const blitz::Array<double,2> gamma_a = _getGamma(machine, a, tmp_gamma);
+    const double constterm = _getLogLikeConstTerm(machine, a, gamma_a) - constterm_1;
+
+    // Model side: u_m = gamma_{n+1}.W_m and
+    //   k_m = l_{n+1} - l_1 + A_m - loglikelihood_m + 1/2.W_m^T.u_m
+    blitz::Array<double,2> W(Tg, dim_f);
+    blitz::Array<double,2> U(Tg, dim_f);
+    blitz::Array<double,1> k(Tg);
+    for (int g=0; g<Tg; ++g) {
+      const bob::learn::em::PLDAMachine& model = *models[group[g]];
+      blitz::Array<double,1> W_g = W(g, blitz::Range::all());
+      if (n_samples > 0) W_g = model.getWeightedSum();
+      else W_g = 0.;
+      k(g) = constterm + model.getWSumXitBetaXi() - model.getLogLikelihood();
+    }
+    bob::math::prod(W, gamma_a, U); // gamma_a is symmetric
+    k += 0.5 * blitz::sum(W(i,j) * U(i,j), j);
+
+    // Probe side: 1/2.f_x^T.(gamma_{n+1} - gamma_1).f_x
+    gamma_diff = gamma_a - gamma_1;
+    bob::math::prod(Fx, gamma_diff, Fx_gamma_diff);
+    q = 0.5 * blitz::sum(Fx_gamma_diff(i,j) * Fx(i,j), j);
+
+    // Cross term: u_m^T.f_x, for all the models of the group and all probes
+    blitz::Array<double,2> cross(Tg, Tt);
+    bob::math::prod(U, Fx.transpose(1,0), cross);
+    for (int g=0; g<Tg; ++g) {
+      blitz::Array<double,1> scores_g = scores(group[g], blitz::Range::all());
+      scores_g = k(g) + cross(g, blitz::Range::all()) + q;
+    }
+  }
+}
@@ -9,6 +9,7 @@
 
 
 #include <bob.learn.em/PLDATrainer.h>
+#include <bob.learn.em/Parallel.h>
 #include <bob.core/check.h>
 #include <bob.core/array_copy.h>
 #include <bob.core/array_random.h>
@@ -29,17 +30,20 @@ bob::learn::em::PLDATrainer::PLDATrainer(const bool use_sum_second_order):
   m_rng(new boost::mt19937()),
   m_dim_d(0), m_dim_f(0), m_dim_g(0),
   m_use_sum_second_order(use_sum_second_order),
+  m_low_memory(false),
+  m_n_threads(1),
   m_initF_method(bob::learn::em::PLDATrainer::RANDOM_F), m_initF_ratio(1.),
   m_initG_method(bob::learn::em::PLDATrainer::RANDOM_G), m_initG_ratio(1.),
   m_initSigma_method(bob::learn::em::PLDATrainer::RANDOM_SIGMA),
   m_initSigma_ratio(1.),
-  m_cache_S(0,0),
+  m_cache_S(0,0), m_cache_X(0,0), m_cache_Z(0,0),
   m_cache_z_first_order(0), m_cache_sum_z_second_order(0,0), m_cache_z_second_order(0),
+  m_cache_sum_x_zt(0,0), m_cache_sum_x_square(0),
   m_cache_n_samples_per_id(0), m_cache_n_samples_in_training(), m_cache_B(0,0),
   m_cache_Ft_isigma_G(0,0), m_cache_eta(0,0), m_cache_zeta(), m_cache_iota(),
-  m_tmp_nf_1(0), m_tmp_nf_2(0), m_tmp_ng_1(0),
+  m_tmp_nf_1(0),
   m_tmp_D_1(0), m_tmp_D_2(0),
-  m_tmp_nfng_nfng(0,0), m_tmp_D_nfng_1(0,0), m_tmp_D_nfng_2(0,0)
+  m_tmp_nfng_nfng(0,0), m_tmp_D_nfng_2(0,0)
 {
 }
 
@@ -47,20 +51,26 @@ bob::learn::em::PLDATrainer::PLDATrainer(const bob::learn::em::PLDATrainer& othe
   m_rng(other.m_rng),
   m_dim_d(other.m_dim_d), m_dim_f(other.m_dim_f), m_dim_g(other.m_dim_g),
   m_use_sum_second_order(other.m_use_sum_second_order),
+  m_low_memory(other.m_low_memory),
+  m_n_threads(other.m_n_threads),
   m_initF_method(other.m_initF_method), m_initF_ratio(other.m_initF_ratio),
   m_initG_method(other.m_initG_method), m_initG_ratio(other.m_initG_ratio),
   m_initSigma_method(other.m_initSigma_method), m_initSigma_ratio(other.m_initSigma_ratio),
   m_cache_S(bob::core::array::ccopy(other.m_cache_S)),
+  m_cache_X(bob::core::array::ccopy(other.m_cache_X)),
+  m_cache_Z(bob::core::array::ccopy(other.m_cache_Z)),
   m_cache_z_first_order(),
   m_cache_sum_z_second_order(bob::core::array::ccopy(other.m_cache_sum_z_second_order)),
   m_cache_z_second_order(),
+  m_cache_sum_x_zt(bob::core::array::ccopy(other.m_cache_sum_x_zt)),
+  m_cache_sum_x_square(bob::core::array::ccopy(other.m_cache_sum_x_square)),
   m_cache_n_samples_per_id(other.m_cache_n_samples_per_id),
   m_cache_n_samples_in_training(other.m_cache_n_samples_in_training),
   m_cache_B(bob::core::array::ccopy(other.m_cache_B)),
   m_cache_Ft_isigma_G(bob::core::array::ccopy(other.m_cache_Ft_isigma_G)),
   m_cache_eta(bob::core::array::ccopy(other.m_cache_eta))
 {
-  bob::core::array::ccopy(other.m_cache_z_first_order, m_cache_z_first_order);
+  initZFirstOrder();
   bob::core::array::ccopy(other.m_cache_z_second_order, m_cache_z_second_order);
   bob::core::array::ccopy(other.m_cache_zeta, m_cache_zeta);
   bob::core::array::ccopy(other.m_cache_iota, m_cache_iota);
@@ -80,6 +90,8 @@ bob::learn::em::PLDATrainer& bob::learn::em::PLDATrainer::operator=
     m_dim_f = other.m_dim_f;
     m_dim_g = other.m_dim_g;
     m_use_sum_second_order = other.m_use_sum_second_order;
+    m_low_memory = other.m_low_memory;
+    m_n_threads = other.m_n_threads;
     m_initF_method = other.m_initF_method;
     m_initF_ratio = other.m_initF_ratio;
     m_initG_method = other.m_initG_method;
@@ -87,10 +99,14 @@ bob::learn::em::PLDATrainer& bob::learn::em::PLDATrainer::operator=
     m_initSigma_method = other.m_initSigma_method;
     m_initSigma_ratio = other.m_initSigma_ratio;
     m_cache_S = bob::core::array::ccopy(other.m_cache_S);
-    bob::core::array::ccopy(other.m_cache_z_first_order, m_cache_z_first_order);
+    m_cache_X.reference(bob::core::array::ccopy(other.m_cache_X));
+    m_cache_Z.reference(bob::core::array::ccopy(other.m_cache_Z));
     m_cache_sum_z_second_order = bob::core::array::ccopy(other.m_cache_sum_z_second_order);
     bob::core::array::ccopy(other.m_cache_z_second_order, m_cache_z_second_order);
+    m_cache_sum_x_zt.reference(bob::core::array::ccopy(other.m_cache_sum_x_zt));
+    m_cache_sum_x_square.reference(bob::core::array::ccopy(other.m_cache_sum_x_square));
     m_cache_n_samples_per_id = other.m_cache_n_samples_per_id;
+    initZFirstOrder();
     m_cache_n_samples_in_training = other.m_cache_n_samples_in_training;
     m_cache_B = bob::core::array::ccopy(other.m_cache_B);
     m_cache_Ft_isigma_G = bob::core::array::ccopy(other.m_cache_Ft_isigma_G);
@@ -109,6 +125,8 @@ bool bob::learn::em::PLDATrainer::operator==
          m_dim_d == other.m_dim_d &&
          m_dim_f == other.m_dim_f &&
          m_dim_g == other.m_dim_g &&
+         m_low_memory == other.m_low_memory &&
+         m_n_threads == other.m_n_threads &&
          m_initF_method == other.m_initF_method &&
          m_initF_ratio == other.m_initF_ratio &&
          m_initG_method == other.m_initG_method &&
@@ -145,6 +163,8 @@ bool bob::learn::em::PLDATrainer::is_similar_to
          m_dim_f == other.m_dim_f &&
          m_dim_g == other.m_dim_g &&
          m_use_sum_second_order == other.m_use_sum_second_order &&
+         m_low_memory == other.m_low_memory &&
+         m_n_threads == other.m_n_threads &&
          m_initF_method == other.m_initF_method &&
          bob::core::isClose(m_initF_ratio, other.m_initF_ratio, r_epsilon, a_epsilon) &&
          m_initG_method == other.m_initG_method &&
@@ -185,6 +205,8 @@ void bob::learn::em::PLDATrainer::initialize(bob::learn::em::PLDABase& machine,
 
   // Computes the mean and the covariance if required
   computeMeanVariance(machine, v_ar);
+  // Stores the centred training data
+  initCentredData(machine, v_ar);
 
   // Initialization (e.g. using scatter)
   initFGSigma(machine, v_ar);
@@ -224,20 +246,41 @@ void bob::learn::em::PLDATrainer::initMembers(const std::vector<blitz::Array<dou
   // Gets dimension (first Arrayset)
   const size_t n_features = v_ar[0].extent(1); // dimensionality of the data
   const size_t n_identities = v_ar.size();
+  size_t n_samples = 0;
+  for (size_t i=0; i<n_identities; ++i) n_samples += v_ar[i].extent(0);
 
   m_cache_S.resize(n_features, n_features);
+  // In low-memory mode, only the sums of the statistics are stored
+  if (m_low_memory)
+  {
+    m_cache_X.resize(0, 0);
+    m_cache_Z.resize(0, 0);
+    m_cache_sum_x_zt.resize(n_features, m_dim_f+m_dim_g);
+    m_cache_sum_x_square.resize(n_features);
+  }
+  else
+  {
+    m_cache_X.resize(n_samples, n_features);
+    m_cache_Z.resize(n_samples, m_dim_f+m_dim_g);
+    m_cache_sum_x_zt.resize(0, 0);
+    m_cache_sum_x_square.resize(0);
+  }
   m_cache_sum_z_second_order.resize(m_dim_f+m_dim_g, m_dim_f+m_dim_g);
 
+  // Forgets about any previous training set
+  m_cache_z_second_order.clear();
+  m_cache_n_samples_per_id.clear();
+  m_cache_n_samples_in_training.clear();
+  m_cache_zeta.clear();
+  m_cache_iota.clear();
+
   // Loops over the identities
   for (size_t i=0; i<n_identities; ++i)
   {
     // Number of training samples for this identity
     const size_t n_i = v_ar[i].extent(0);
-    // m_cache_z_first_order
-    blitz::Array<double,2> z_i(n_i, m_dim_f+m_dim_g);
-    m_cache_z_first_order.push_back(z_i);
     // m_z_second_order
-    if (!m_use_sum_second_order)
+    if (!m_use_sum_second_order && !m_low_memory)
     {
       blitz::Array<double,3> z2_i(n_i, m_dim_f+m_dim_g, m_dim_f+m_dim_g);
       m_cache_z_second_order.push_back(z2_i);
@@ -260,6 +303,9 @@ void bob::learn::em::PLDATrainer::initMembers(const std::vector<blitz::Array<dou
     }
   }
 
+  // m_cache_z_first_order
+  initZFirstOrder();
+
   m_cache_B.resize(n_features, m_dim_f+m_dim_g);
   m_cache_Ft_isigma_G.resize(m_dim_f, m_dim_g);
   m_cache_eta.resize(m_dim_f, m_dim_g);
@@ -268,15 +314,49 @@ void bob::learn::em::PLDATrainer::initMembers(const std::vector<blitz::Array<dou
   resizeTmp();
 }
 
+void bob::learn::em::PLDATrainer::initZFirstOrder()
+{
+  // The first order statistics of each identity are a view on consecutive
+  // rows of m_cache_Z (empty in low-memory mode)
+  m_cache_z_first_order.clear();
+  if (m_cache_Z.extent(0) == 0) return;
+  int row = 0;
+  for (size_t i=0; i<m_cache_n_samples_per_id.size(); ++i)
+  {
+    const int n_i = m_cache_n_samples_per_id[i];
+    m_cache_z_first_order.push_back(m_cache_Z(blitz::Range(row, row+n_i-1), blitz::Range::all()));
+    row += n_i;
+  }
+}
+
+void bob::learn::em::PLDATrainer::initCentredData(bob::learn::em::PLDABase& machine,
+  const std::vector<blitz::Array<double,2> >& v_ar)
+{
+  const blitz::Array<double,1>& mu = machine.getMu();
+  blitz::Range a = blitz::Range::all();
+  // Low-memory mode: only sum_ij (x_ij-mu)^2 is stored, which does not
+  // change during the training, as mu is not updated
+  if (m_low_memory)
+  {
+    m_cache_sum_x_square = 0.;
+    for (size_t i=0; i<v_ar.size(); ++i)
+      for (int j=0; j<v_ar[i].extent(0); ++j)
+        m_cache_sum_x_square += blitz::pow2(v_ar[i](j,a) - mu);
+    return;
+  }
+  // m_cache_X = all the samples x_ij-mu, stacked
+  int row = 0;
+  for (size_t i=0; i<v_ar.size(); ++i)
+    for (int j=0; j<v_ar[i].extent(0); ++j)
+      m_cache_X(row++, a) = v_ar[i](j,a) - mu;
+}
+
 void bob::learn::em::PLDATrainer::resizeTmp()
 {
   m_tmp_nf_1.resize(m_dim_f);
-  m_tmp_nf_2.resize(m_dim_f);
-  m_tmp_ng_1.resize(m_dim_g);
   m_tmp_D_1.resize(m_dim_d);
   m_tmp_D_2.resize(m_dim_d);
   m_tmp_nfng_nfng.resize(m_dim_f+m_dim_g, m_dim_f+m_dim_g);
-  m_tmp_D_nfng_1.resize(m_dim_d, m_dim_f+m_dim_g);
   m_tmp_D_nfng_2.resize(m_dim_d, m_dim_f+m_dim_g);
 }
 
@@ -499,99 +579,435 @@ void bob::learn::em::PLDATrainer::initSigma(bob::learn::em::PLDABase& machine,
   machine.applyVarianceThreshold();
 }
 
+namespace {
+
+/**
+ * Wraps the rows [begin, end) of a C-contiguous matrix with n_cols columns.
+ * The resulting array does not reference the memory block of the matrix,
+ * so that it can be created and sliced from any thread (blitz reference
+ * counting is not thread-safe).
+ */
+blitz::Array<double,2> wrapRows(double* data, const size_t n_cols,
+  const size_t begin, const size_t end)
+{
+  return blitz::Array<double,2>(data + begin*n_cols,
+    blitz::shape(end-begin, n_cols), blitz::neverDeleteData);
+}
+
+/**
+ * Computes x-mu for the sample j of the matrix v, element by element: as
+ * the samples of an identity might share their memory block with the ones
+ * of other identities, no slice of v is created from the worker threads.
+ */
+void centreSample(const blitz::Array<double,2>& v, const int j,
+  const blitz::Array<double,1>& mu, blitz::Array<double,1>& x)
+{
+  for (int d=0; d<x.extent(0); ++d) x(d) = v(j,d) - mu(d);
+}
+
+// Maximum number of samples processed at once by updateSigma() and by the
+// low-memory E-step
+const size_t s_plda_block_size = 256;
+
+/**
+ * Copies of the machine parameters, working arrays and partial sums used
+ * to process a chunk of identities [begin, end), i.e. of samples
+ * [row_begin, row_end), in its own thread. The parameters are copied by
+ * the main thread, so that the threads never reference the same blitz
+ * arrays.
+ */
+struct PLDAChunk
+{
+  PLDAChunk(const size_t begin, const size_t end, const size_t row_begin,
+      const size_t row_end, const size_t dim_d, const size_t dim_f,
+      const size_t dim_g):
+    m_begin(begin), m_end(end), m_row_begin(row_begin), m_row_end(row_end),
+    m_tmp_nf_1(dim_f), m_tmp_nf_2(dim_f), m_tmp_ng_1(dim_g),
+    m_tmp_D_1(dim_d), m_tmp_D_2(dim_d),
+    m_sum_z_second_order(dim_f+dim_g, dim_f+dim_g),
+    m_sum_x_zt(dim_d, dim_f+dim_g), m_sum_sigma(dim_d), m_n_samples(0)
+  {}
+
+  size_t m_begin;
+  size_t m_end;
+  size_t m_row_begin;
+  size_t m_row_end;
+  // Parameters
+  blitz::Array<double,1> m_mu;
+  blitz::Array<double,2> m_F;
+  blitz::Array<double,2> m_FtBeta;
+  blitz::Array<double,2> m_GtISigma;
+  blitz::Array<double,2> m_alpha;
+  blitz::Array<double,2> m_B;
+  std::map<size_t,blitz::Array<double,2> > m_gamma;
+  std::map<size_t,blitz::Array<double,2> > m_zeta;
+  std::map<size_t,blitz::Array<double,2> > m_iota;
+  // Working arrays
+  blitz::Array<double,1> m_tmp_nf_1;
+  blitz::Array<double,1> m_tmp_nf_2;
+  blitz::Array<double,1> m_tmp_ng_1;
+  blitz::Array<double,1> m_tmp_D_1;
+  blitz::Array<double,1> m_tmp_D_2;
+  blitz::Array<double,2> m_tmp_block_D; ///< Z.B^T for a block of samples (low-memory E-step: centred samples)
+  blitz::Array<double,2> m_tmp_block_nfng; ///< low-memory E-step: first order statistics of a block of samples
+  blitz::Array<double,2> m_tmp_D_nfng; ///< low-memory E-step: X^T.Z for a block of samples
+  // Partial sums
+  blitz::Array<double,2> m_sum_z_second_order; ///< sum_ij E{z_ij.z_ij^T}
+  blitz::Array<double,2> m_sum_x_zt; ///< sum_ij (x_ij-mu).E{z_ij}^T
+  blitz::Array<double,1> m_sum_sigma; ///< sum_ij Diag{(x_ij-mu).(x_ij-mu)^T - B.E{z_ij}.(x_ij-mu)^T}
+  size_t m_n_samples;
+};
+
+/**
+ * Splits the identities into (at most) n_threads contiguous chunks holding
+ * about the same number of samples; the training data must match the numbers
+ * of samples per identity given to initialize()
+ */
+std::vector<PLDAChunk> makeChunks(const std::vector<blitz::Array<double,2> >& v_ar,
+  const std::vector<size_t>& n_samples_per_id, const size_t n_threads,
+  const size_t dim_d, const size_t dim_f, const size_t dim_g)
+{
+  const size_t n_ids = v_ar.size();
+  if (n_ids != n_samples_per_id.size()) {
+    boost::format m("the number of identities (%u) does not match the one given to initialize() (%u)");
+    m % n_ids % n_samples_per_id.size();
+    throw std::runtime_error(m.str());
+  }
+  size_t n_samples = 0;
+  for (size_t i=0; i<n_ids; ++i) {
+    if (static_cast<size_t>(v_ar[i].extent(0)) != n_samples_per_id[i]) {
+      boost::format m("the number of training samples of identity %u (%d) does not match the one given to initialize() (%u)");
+      m % i % v_ar[i].extent(0) % n_samples_per_id[i];
+      throw std::runtime_error(m.str());
+    }
+    n_samples += n_samples_per_id[i];
+  }
+  const size_t n_chunks = std::min(n_ids, bob::learn::em::getNThreads(n_threads));
+
+  std::vector<PLDAChunk> chunks;
+  size_t begin = 0, cumul = 0;
+  for (size_t k=0; k<n_chunks; ++k)
+  {
+    const size_t target = n_samples*(k+1)/n_chunks;
+    // Leaves at least one identity to each of the following chunks
+    const size_t max_end = n_ids - (n_chunks-k-1);
+    const size_t row_begin = cumul;
+    size_t end = begin;
+    while (end < max_end && (end == begin || cumul < target || k == n_chunks-1))
+      cumul += v_ar[end++].extent(0);
+    chunks.push_back(PLDAChunk(begin, end, row_begin, cumul, dim_d, dim_f, dim_g));
+    begin = end;
+  }
+  return chunks;
+}
+
+/**
+ * Runs the E-step on the identities of a range of chunks: computes the
+ * first (and optionally second) order statistics of the latent variables
+ * of each sample, and the partial sum of the second order statistics.
+ * In low-memory mode (X and Z are null), the samples are centred on the fly
+ * and their first order statistics are only kept for a block of samples,
+ * which is added to the partial sum X^T.Z before being overwritten.
+ */
+struct PLDAEStep
+{
+  PLDAEStep(std::vector<PLDAChunk>& chunks,
+      const std::vector<blitz::Array<double,2> >& v_ar, double* X, double* Z,
+      std::vector<blitz::Array<double,3> >& z_second_order,
+      const bool use_sum_second_order, const size_t dim_d, const size_t dim_f,
+      const size_t dim_g):
+    m_chunks(chunks), m_v_ar(v_ar), m_X(X), m_Z(Z),
+    m_z_second_order(z_second_order),
+    m_use_sum_second_order(use_sum_second_order),
+    m_dim_d(dim_d), m_dim_f(dim_f), m_dim_g(dim_g)
+  {}
+
+  void operator()(const size_t begin, const size_t end)
+  {
+    for (size_t k=begin; k<end; ++k) process(m_chunks[k]);
+  }
+
+  void process(PLDAChunk& c)
+  {
+    blitz::Range a = blitz::Range::all();
+    // blitz indices
+    blitz::firstIndex bi;
+    blitz::secondIndex bj;
+    const bool stream = (m_X == 0);
+    // Initializes sum of z second order statistics to 0
+    c.m_sum_z_second_order = 0.;
+    if (stream) c.m_sum_x_zt = 0.;
+    size_t row = c.m_row_begin;
+    for (size_t i=c.m_begin; i<c.m_end; ++i)
+    {
+      const int n_i = m_v_ar[i].extent(0);
+      // Centred samples x_ij-mu and first order statistics of this identity
+      // (low-memory mode: of the current block of samples of this identity)
+      blitz::Array<double,2> X_i, Z_i;
+      if (stream) {
+        X_i.reference(c.m_tmp_block_D);
+        Z_i.reference(c.m_tmp_block_nfng);
+      }
+      else {
+        X_i.reference(wrapRows(m_X, m_dim_d, row, row+n_i));
+        Z_i.reference(wrapRows(m_Z, m_dim_f+m_dim_g, row, row+n_i));
+      }
+      row += n_i;
+
+      // Computes expectation of z_ij = [h_i w_ij]
+      // 1/a/ Computes expectation of h_i
+      // Loop over the samples
+      c.m_tmp_nf_1 = 0.;
+      for (int j=0; j<n_i; ++j)
+      {
+        // m_tmp_nf_2 = F^T.beta.(x_sj-mu)
+        blitz::Array<double,1> x_ij;
+        if (stream) {
+          centreSample(m_v_ar[i], j, c.m_mu, c.m_tmp_D_1);
+          x_ij.reference(c.m_tmp_D_1);
+        }
+        else x_ij.reference(X_i(j,a));
+        bob::math::prod(c.m_FtBeta, x_ij, c.m_tmp_nf_2);
+        // m_tmp_nf_1 = sum_j F^T.beta.(x_sj-mu)
+        c.m_tmp_nf_1 += c.m_tmp_nf_2;
+      }
+      const blitz::Array<double,2>& gamma_a = c.m_gamma[n_i];
+      // m_tmp_nf_2 = E(h_i) = gamma_A  sum_j F^T.beta.(x_sj-mu)
+      bob::math::prod(gamma_a, c.m_tmp_nf_1, c.m_tmp_nf_2);
+
+      // 1/b/ Precomputes: m_tmp_D_2 = F.E{h_i}
+      bob::math::prod(c.m_F, c.m_tmp_nf_2, c.m_tmp_D_2);
+
+      // 2/ First and second order statistics of z
+      // Precomputed values
+      blitz::Array<double,2>& zeta_a = c.m_zeta[n_i];
+      blitz::Array<double,2>& iota_a = c.m_iota[n_i];
+      blitz::Array<double,2> iotat_a = iota_a.transpose(1,0);
+
+      // Extracts statistics of z_ij = [h_i w_ij] from y_i = [h_i w_i1 ... w_iJ]
+      blitz::Range r1(0, m_dim_f-1);
+      blitz::Range r2(m_dim_f, m_dim_f+m_dim_g-1);
+      blitz::Array<double,2> z_sum_so_11 = c.m_sum_z_second_order(r1,r1);
+      blitz::Array<double,2> z_sum_so_12 = c.m_sum_z_second_order(r1,r2);
+      blitz::Array<double,2> z_sum_so_21 = c.m_sum_z_second_order(r2,r1);
+      blitz::Array<double,2> z_sum_so_22 = c.m_sum_z_second_order(r2,r2);
+      for (int j=0; j<n_i; ++j)
+      {
+        // Row of the sample in X_i and Z_i
+        const int r = stream ? j % s_plda_block_size : j;
+        if (stream) {
+          blitz::Array<double,1> x_ij = X_i(r,a);
+          centreSample(m_v_ar[i], j, c.m_mu, x_ij);
+        }
+        // 1/ First order statistics of z
+        blitz::Array<double,1> z_first_order_ij_1 = Z_i(r,r1);
+        z_first_order_ij_1 = c.m_tmp_nf_2; // E{h_i}
+        // m_tmp_D_1 = x_sj - mu - F.E{h_i}
+        c.m_tmp_D_1 = X_i(r,a) - c.m_tmp_D_2;
+        // m_tmp_ng_1 = G^T.sigma^-1.(x_sj-mu-fhi)
+        bob::math::prod(c.m_GtISigma, c.m_tmp_D_1, c.m_tmp_ng_1);
+        // z_first_order_ij_2 = (Id+G^T.sigma^-1.G)^-1.G^T.sigma^-1.(x_sj-mu) = E{w_ij}
+        blitz::Array<double,1> z_first_order_ij_2 = Z_i(r,r2);
+        bob::math::prod(c.m_alpha, c.m_tmp_ng_1, z_first_order_ij_2);
+
+        // 2/ Second order statistics of z
+        if (m_use_sum_second_order)
+        {
+          z_sum_so_11 += gamma_a + z_first_order_ij_1(bi) * z_first_order_ij_1(bj);
+          z_sum_so_12 += iota_a + z_first_order_ij_1(bi) * z_first_order_ij_2(bj);
+          z_sum_so_21 += iotat_a + z_first_order_ij_2(bi) * z_first_order_ij_1(bj);
+          z_sum_so_22 += zeta_a + z_first_order_ij_2(bi) * z_first_order_ij_2(bj);
+        }
+        else
+        {
+          blitz::Array<double,2> z_so_11 = m_z_second_order[i](j,r1,r1);
+          z_so_11 = gamma_a + z_first_order_ij_1(bi) * z_first_order_ij_1(bj);
+          z_sum_so_11 += z_so_11;
+          blitz::Array<double,2> z_so_12 = m_z_second_order[i](j,r1,r2);
+          z_so_12 = iota_a + z_first_order_ij_1(bi) * z_first_order_ij_2(bj);
+          z_sum_so_12 += z_so_12;
+          blitz::Array<double,2> z_so_21 = m_z_second_order[i](j,r2,r1);
+          z_so_21 = iotat_a + z_first_order_ij_2(bi) * z_first_order_ij_1(bj);
+          z_sum_so_21 += z_so_21;
+          blitz::Array<double,2> z_so_22 = m_z_second_order[i](j,r2,r2);
+          z_so_22 = zeta_a + z_first_order_ij_2(bi) * z_first_order_ij_2(bj);
+          z_sum_so_22 += z_so_22;
+        }
+
+        // 3/ Low-memory mode: adds the block to sum_ij (x_ij-mu).E{z_ij}^T
+        if (stream && (r == (int)s_plda_block_size-1 || j == n_i-1))
+        {
+          blitz::Range rb(0, r);
+          blitz::Array<double,2> X_bt = X_i(rb,a).transpose(1,0);
+          blitz::Array<double,2> Z_b = Z_i(rb,a);
+          bob::math::prod(X_bt, Z_b, c.m_tmp_D_nfng);
+          c.m_sum_x_zt += c.m_tmp_D_nfng;
+        }
+      }
+    }
+  }
+
+  std::vector<PLDAChunk>& m_chunks;
+  const std::vector<blitz::Array<double,2> >& m_v_ar;
+  double* m_X;
+  double* m_Z;
+  std::vector<blitz::Array<double,3> >& m_z_second_order;
+  const bool m_use_sum_second_order;
+  const size_t m_dim_d;
+  const size_t m_dim_f;
+  const size_t m_dim_g;
+};
+
+/**
+ * Computes the partial sums X^T.Z = sum_ij (x_ij-mu).E{z_ij}^T used by
+ * updateFG(), with a single matrix product per chunk
+ */
+struct PLDAUpdateFG
+{
+  PLDAUpdateFG(std::vector<PLDAChunk>& chunks, double* X, double* Z,
+      const size_t dim_d, const size_t dim_fg):
+    m_chunks(chunks), m_X(X), m_Z(Z), m_dim_d(dim_d), m_dim_fg(dim_fg)
+  {}
+
+  void operator()(const size_t begin, const size_t end)
+  {
+    for (size_t k=begin; k<end; ++k) process(m_chunks[k]);
+  }
+
+  void process(PLDAChunk& c)
+  {
+    if (c.m_row_end == c.m_row_begin) {
+      c.m_sum_x_zt = 0.;
+      return;
+    }
+    blitz::Array<double,2> X_c = wrapRows(m_X, m_dim_d, c.m_row_begin, c.m_row_end);
+    blitz::Array<double,2> Z_c = wrapRows(m_Z, m_dim_fg, c.m_row_begin, c.m_row_end);
+    blitz::Array<double,2> X_ct = X_c.transpose(1,0);
+    bob::math::prod(X_ct, Z_c, c.m_sum_x_zt);
+  }
+
+  std::vector<PLDAChunk>& m_chunks;
+  double* m_X;
+  double* m_Z;
+  const size_t m_dim_d;
+  const size_t m_dim_fg;
+};
+
+/**
+ * Computes the partial sums rowsum((X - Z.B^T) o X) =
+ * sum_ij Diag{(x_ij-mu).(x_ij-mu)^T - B.E{z_ij}.(x_ij-mu)^T} used by
+ * updateSigma(), by blocks of samples
+ */
+struct PLDAUpdateSigma
+{
+  PLDAUpdateSigma(std::vector<PLDAChunk>& chunks, double* X, double* Z,
+      const size_t dim_d, const size_t dim_fg):
+    m_chunks(chunks), m_X(X), m_Z(Z), m_dim_d(dim_d), m_dim_fg(dim_fg)
+  {}
+
+  void operator()(const size_t begin, const size_t end)
+  {
+    for (size_t k=begin; k<end; ++k) process(m_chunks[k]);
+  }
+
+  void process(PLDAChunk& c)
+  {
+    blitz::firstIndex bi;
+    blitz::secondIndex bj;
+    blitz::Array<double,2> Bt = c.m_B.transpose(1,0);
+    c.m_sum_sigma = 0.;
+    for (size_t r0=c.m_row_begin; r0<c.m_row_end; r0+=s_plda_block_size)
+    {
+      const size_t r1 = std::min(r0+s_plda_block_size, c.m_row_end);
+      blitz::Array<double,2> X_b = wrapRows(m_X, m_dim_d, r0, r1);
+      blitz::Array<double,2> Z_b = wrapRows(m_Z, m_dim_fg, r0, r1);
+      // m_tmp_block_D = Z.B^T
+      blitz::Array<double,2> ZBt = c.m_tmp_block_D(blitz::Range(0, (int)(r1-r0)-1), blitz::Range::all());
+      bob::math::prod(Z_b, Bt, ZBt);
+      // sigma += rowsum((X - Z.B^T) o X)
+      c.m_sum_sigma += blitz::sum((X_b(bj,bi) - ZBt(bj,bi)) * X_b(bj,bi), bj);
+    }
+    c.m_n_samples = c.m_row_end - c.m_row_begin;
+  }
+
+  std::vector<PLDAChunk>& m_chunks;
+  double* m_X;
+  double* m_Z;
+  const size_t m_dim_d;
+  const size_t m_dim_fg;
+};
+
+}
+
 void bob::learn::em::PLDATrainer::eStep(bob::learn::em::PLDABase& machine,
   const std::vector<blitz::Array<double,2> >& v_ar)
 {
+  checkLowMemory();
   // Precomputes useful variables using current estimates of F,G, and sigma
   precomputeFromFGSigma(machine);
-  // Gets the mean mu from the machine
-  const blitz::Array<double,1>& mu = machine.getMu();
-  const blitz::Array<double,2>& alpha = machine.getAlpha();
-  const blitz::Array<double,2>& F = machine.getF();
-  const blitz::Array<double,2>& FtBeta = machine.getFtBeta();
-  const blitz::Array<double,2>& GtISigma = machine.getGtISigma();
-  blitz::Range a = blitz::Range::all();
 
-  // blitz indices
-  blitz::firstIndex bi;
-  blitz::secondIndex bj;
-  // Initializes sum of z second order statistics to 0
-  m_cache_sum_z_second_order = 0.;
-  for (size_t i=0; i<v_ar.size(); ++i)
+  // Gives each chunk of identities its own copy of the parameters
+  std::vector<PLDAChunk> chunks = makeChunks(v_ar, m_cache_n_samples_per_id,
+    m_n_threads, m_dim_d, m_dim_f, m_dim_g);
+  for (size_t k=0; k<chunks.size(); ++k)
   {
-    // Computes expectation of z_ij = [h_i w_ij]
-    // 1/a/ Computes expectation of h_i
-    // Loop over the samples
-    m_tmp_nf_1 = 0.;
-    for (int j=0; j<v_ar[i].extent(0); ++j)
+    PLDAChunk& c = chunks[k];
+    if (m_low_memory)
     {
-      // m_tmp_D_1 = x_sj-mu
-      m_tmp_D_1 = v_ar[i](j,a) - mu;
-
-      // m_tmp_nf_2 = F^T.beta.(x_sj-mu)
-      bob::math::prod(FtBeta, m_tmp_D_1, m_tmp_nf_2);
-      // m_tmp_nf_1 = sum_j F^T.beta.(x_sj-mu)
-      m_tmp_nf_1 += m_tmp_nf_2;
+      c.m_mu.reference(bob::core::array::ccopy(machine.getMu()));
+      c.m_tmp_block_D.resize(s_plda_block_size, m_dim_d);
+      c.m_tmp_block_nfng.resize(s_plda_block_size, m_dim_f+m_dim_g);
+      c.m_tmp_D_nfng.resize(m_dim_d, m_dim_f+m_dim_g);
     }
-    const blitz::Array<double,2>& gamma_a = machine.getAddGamma(v_ar[i].extent(0));
-    blitz::Range r_hi(0, m_dim_f-1);
-    // m_tmp_nf_2 = E(h_i) = gamma_A  sum_j F^T.beta.(x_sj-mu)
-    bob::math::prod(gamma_a, m_tmp_nf_1, m_tmp_nf_2);
-
-    // 1/b/ Precomputes: m_tmp_D_2 = F.E{h_i}
-    bob::math::prod(F, m_tmp_nf_2, m_tmp_D_2);
-
-    // 2/ First and second order statistics of z
-    // Precomputed values
-    blitz::Array<double,2>& zeta_a = m_cache_zeta[v_ar[i].extent(0)];
-    blitz::Array<double,2>& iota_a = m_cache_iota[v_ar[i].extent(0)];
-    blitz::Array<double,2> iotat_a = iota_a.transpose(1,0);
-
-    // Extracts statistics of z_ij = [h_i w_ij] from y_i = [h_i w_i1 ... w_iJ]
-    blitz::Range r1(0, m_dim_f-1);
-    blitz::Range r2(m_dim_f, m_dim_f+m_dim_g-1);
-    for (int j=0; j<v_ar[i].extent(0); ++j)
+    c.m_F.reference(bob::core::array::ccopy(machine.getF()));
+    c.m_FtBeta.reference(bob::core::array::ccopy(machine.getFtBeta()));
+    c.m_GtISigma.reference(bob::core::array::ccopy(machine.getGtISigma()));
+    c.m_alpha.reference(bob::core::array::ccopy(machine.getAlpha()));
+    // gamma_a, zeta_a and iota_a were computed for all the numbers of samples
+    // a of the training set by precomputeFromFGSigma()
+    std::map<size_t,bool>::const_iterator it;
+    for (it=m_cache_n_samples_in_training.begin();
+         it!=m_cache_n_samples_in_training.end(); ++it)
     {
-      // 1/ First order statistics of z
-      blitz::Array<double,1> z_first_order_ij_1 = m_cache_z_first_order[i](j,r1);
-      z_first_order_ij_1 = m_tmp_nf_2; // E{h_i}
-      // m_tmp_D_1 = x_sj - mu - F.E{h_i}
-      m_tmp_D_1 = v_ar[i](j,a) - mu - m_tmp_D_2;
-      // m_tmp_ng_1 = G^T.sigma^-1.(x_sj-mu-fhi)
-      bob::math::prod(GtISigma, m_tmp_D_1, m_tmp_ng_1);
-      // z_first_order_ij_2 = (Id+G^T.sigma^-1.G)^-1.G^T.sigma^-1.(x_sj-mu) = E{w_ij}
-      blitz::Array<double,1> z_first_order_ij_2 = m_cache_z_first_order[i](j,r2);
-      bob::math::prod(alpha, m_tmp_ng_1, z_first_order_ij_2);
-
-      // 2/ Second order statistics of z
-      blitz::Array<double,2> z_sum_so_11 = m_cache_sum_z_second_order(r1,r1);
-      blitz::Array<double,2> z_sum_so_12 = m_cache_sum_z_second_order(r1,r2);
-      blitz::Array<double,2> z_sum_so_21 = m_cache_sum_z_second_order(r2,r1);
-      blitz::Array<double,2> z_sum_so_22 = m_cache_sum_z_second_order(r2,r2);
-      if (m_use_sum_second_order)
-      {
-        z_sum_so_11 += gamma_a + z_first_order_ij_1(bi) * z_first_order_ij_1(bj);
-        z_sum_so_12 += iota_a + z_first_order_ij_1(bi) * z_first_order_ij_2(bj);
-        z_sum_so_21 += iotat_a + z_first_order_ij_2(bi) * z_first_order_ij_1(bj);
-        z_sum_so_22 += zeta_a + z_first_order_ij_2(bi) * z_first_order_ij_2(bj);
-      }
-      else
-      {
-        blitz::Array<double,2> z_so_11 = m_cache_z_second_order[i](j,r1,r1);
-        z_so_11 = gamma_a + z_first_order_ij_1(bi) * z_first_order_ij_1(bj);
-        z_sum_so_11 += z_so_11;
-        blitz::Array<double,2> z_so_12 = m_cache_z_second_order[i](j,r1,r2);
-        z_so_12 = iota_a + z_first_order_ij_1(bi) * z_first_order_ij_2(bj);
-        z_sum_so_12 += z_so_12;
-        blitz::Array<double,2> z_so_21 = m_cache_z_second_order[i](j,r2,r1);
-        z_so_21 = iotat_a + z_first_order_ij_2(bi) * z_first_order_ij_1(bj);
-        z_sum_so_21 += z_so_21;
-        blitz::Array<double,2> z_so_22 = m_cache_z_second_order[i](j,r2,r2);
-        z_so_22 = zeta_a + z_first_order_ij_2(bi) * z_first_order_ij_2(bj);
-        z_sum_so_22 += z_so_22;
-      }
+      const size_t n_i = it->first;
+      c.m_gamma[n_i].reference(bob::core::array::ccopy(machine.getGamma(n_i)));
+      c.m_zeta[n_i].reference(bob::core::array::ccopy(m_cache_zeta[n_i]));
+      c.m_iota[n_i].reference(bob::core::array::ccopy(m_cache_iota[n_i]));
     }
   }
+
+  PLDAEStep estep(chunks, v_ar,
+    m_low_memory ? 0 : m_cache_X.data(), m_low_memory ? 0 : m_cache_Z.data(),
+    m_cache_z_second_order, m_use_sum_second_order || m_low_memory,
+    m_dim_d, m_dim_f, m_dim_g);
+  bob::learn::em::parallelFor(chunks.size(), chunks.size(), estep);
+
+  // Sums the second order statistics of the chunks
+  m_cache_sum_z_second_order = 0.;
+  for (size_t k=0; k<chunks.size(); ++k)
+    m_cache_sum_z_second_order += chunks[k].m_sum_z_second_order;
+  // Low-memory mode: sums the numerators of the update of B of the chunks
+  if (m_low_memory)
+  {
+    m_cache_sum_x_zt = 0.;
+    for (size_t k=0; k<chunks.size(); ++k)
+      m_cache_sum_x_zt += chunks[k].m_sum_x_zt;
+  }
+}
+
+size_t bob::learn::em::PLDATrainer::getNSamples() const
+{
+  size_t n_samples = 0;
+  for (size_t i=0; i<m_cache_n_samples_per_id.size(); ++i)
+    n_samples += m_cache_n_samples_per_id[i];
+  return n_samples;
+}
+
+void bob::learn::em::PLDATrainer::checkLowMemory() const
+{
+  // The stored data depends on the mode set when calling initialize()
+  if (m_low_memory != (m_cache_sum_x_square.extent(0) != 0))
+    throw std::runtime_error("the trainer was not initialized with the current low_memory flag");
 }
 
 void bob::learn::em::PLDATrainer::precomputeFromFGSigma(bob::learn::em::PLDABase& machine)
@@ -657,6 +1073,7 @@ void bob::learn::em::PLDATrainer::precomputeLogLike(bob::learn::em::PLDABase& ma
 void bob::learn::em::PLDATrainer::mStep(bob::learn::em::PLDABase& machine,
   const std::vector<blitz::Array<double,2> >& v_ar)
 {
+  checkLowMemory();
   // 1/ New estimate of B = {F G}
   updateFG(machine, v_ar);
 
@@ -675,24 +1092,23 @@ void bob::learn::em::PLDATrainer::updateFG(bob::learn::em::PLDABase& machine,
   /// Computes the B matrix (B = [F G])
   /// B = (sum_ij (x_ij-mu).E{z_i}^T).(sum_ij E{z_i.z_i^T})^-1
 
-  // 1/ Computes the numerator (sum_ij (x_ij-mu).E{z_i}^T)
-  // Gets the mean mu from the machine
-  const blitz::Array<double,1>& mu = machine.getMu();
-  blitz::Range a = blitz::Range::all();
-  m_tmp_D_nfng_2 = 0.;
-  for (size_t i=0; i<v_ar.size(); ++i)
+  // 1/ Computes the numerator (sum_ij (x_ij-mu).E{z_i}^T = X^T.Z)
+  if (m_low_memory)
   {
-    // Loop over the samples
-    for (int j=0; j<v_ar[i].extent(0); ++j)
-    {
-      // m_tmp_D_1 = x_sj-mu
-      m_tmp_D_1 = v_ar[i](j,a) - mu;
-      // z_first_order_ij = E{z_ij}
-      blitz::Array<double,1> z_first_order_ij = m_cache_z_first_order[i](j, a);
-      // m_tmp_D_nfng_1 = (x_sj-mu).E{z_ij}^T
-      bob::math::prod(m_tmp_D_1, z_first_order_ij, m_tmp_D_nfng_1);
-      m_tmp_D_nfng_2 += m_tmp_D_nfng_1;
-    }
+    // Already accumulated by the E-step
+    m_tmp_D_nfng_2 = m_cache_sum_x_zt;
+  }
+  else
+  {
+    std::vector<PLDAChunk> chunks = makeChunks(v_ar, m_cache_n_samples_per_id,
+      m_n_threads, m_dim_d, m_dim_f, m_dim_g);
+    PLDAUpdateFG update(chunks, m_cache_X.data(), m_cache_Z.data(), m_dim_d,
+      m_dim_f+m_dim_g);
+    bob::learn::em::parallelFor(chunks.size(), chunks.size(), update);
+    // Sums the partial numerators of the chunks
+    m_tmp_D_nfng_2 = 0.;
+    for (size_t k=0; k<chunks.size(); ++k)
+      m_tmp_D_nfng_2 += chunks[k].m_sum_x_zt;
   }
 
   // 2/ Computes the denominator inv(sum_ij E{z_i.z_i^T})
@@ -702,6 +1118,7 @@ void bob::learn::em::PLDATrainer::updateFG(bob::learn::em::PLDABase& machine,
   bob::math::prod(m_tmp_D_nfng_2, m_tmp_nfng_nfng, m_cache_B);
 
   // 4/ Updates the machine
+  blitz::Range a = blitz::Range::all();
   blitz::Array<double, 2>& F = machine.updateF();
   blitz::Array<double, 2>& G = machine.updateG();
   F = m_cache_B(a, blitz::Range(0, m_dim_f-1));
@@ -714,31 +1131,41 @@ void bob::learn::em::PLDATrainer::updateSigma(bob::learn::em::PLDABase& machine,
   /// Computes the Sigma matrix
   /// Sigma = 1/IJ sum_ij Diag{(x_ij-mu).(x_ij-mu)^T - B.E{z_i}.(x_ij-mu)^T}
 
-  // Gets the mean mu and the matrix sigma from the machine
+  // Gets the matrix sigma from the machine
   blitz::Array<double,1>& sigma = machine.updateSigma();
-  const blitz::Array<double,1>& mu = machine.getMu();
-  blitz::Range a = blitz::Range::all();
 
+  // Low-memory mode: as the E{z_ij} are not stored, uses
+  // sum_ij Diag{B.E{z_ij}.(x_ij-mu)^T} = rowsum(B o sum_ij (x_ij-mu).E{z_ij}^T)
+  if (m_low_memory)
+  {
+    blitz::firstIndex bi;
+    blitz::secondIndex bj;
+    sigma = m_cache_sum_x_square - blitz::sum(m_cache_B(bi,bj) * m_cache_sum_x_zt(bi,bj), bj);
+    sigma /= static_cast<double>(getNSamples());
+    // Apply variance threshold
+    machine.applyVarianceThreshold();
+    return;
+  }
+
+  // Gives each chunk of identities its own copy of B
+  std::vector<PLDAChunk> chunks = makeChunks(v_ar, m_cache_n_samples_per_id,
+    m_n_threads, m_dim_d, m_dim_f, m_dim_g);
+  for (size_t k=0; k<chunks.size(); ++k)
+  {
+    chunks[k].m_B.reference(bob::core::array::ccopy(m_cache_B));
+    chunks[k].m_tmp_block_D.resize(s_plda_block_size, m_dim_d);
+  }
+  PLDAUpdateSigma update(chunks, m_cache_X.data(), m_cache_Z.data(), m_dim_d,
+    m_dim_f+m_dim_g);
+  bob::learn::em::parallelFor(chunks.size(), chunks.size(), update);
+
+  // Sums the partial sums of the chunks
   sigma = 0.;
   size_t n_IJ=0; /// counts the number of samples
-  for (size_t i=0; i<v_ar.size(); ++i)
+  for (size_t k=0; k<chunks.size(); ++k)
   {
-    // Loop over the samples
-    for (int j=0; j<v_ar[i].extent(0); ++j)
-    {
-      // m_tmp_D_1 = x_ij-mu
-      m_tmp_D_1 = v_ar[i](j,a) - mu;
-      // sigma += Diag{(x_ij-mu).(x_ij-mu)^T}
-      sigma += blitz::pow2(m_tmp_D_1);
-
-      // z_first_order_ij = E{z_ij}
-      blitz::Array<double,1> z_first_order_ij = m_cache_z_first_order[i](j,a);
-      // m_tmp_D_2 = B.E{z_ij}
-      bob::math::prod(m_cache_B, z_first_order_ij, m_tmp_D_2);
-      // sigma -= Diag{B.E{z_ij}.(x_ij-mu)
-      sigma -= (m_tmp_D_1 * m_tmp_D_2);
-      ++n_IJ;
-    }
+    sigma += chunks[k].m_sum_sigma;
+    n_IJ += chunks[k].m_n_samples;
   }
   // Normalizes by the number of samples
   sigma /= static_cast<double>(n_IJ);
@@ -749,10 +1176,20 @@ void bob::learn::em::PLDATrainer::updateSigma(bob::learn::em::PLDABase& machine,
 
 void bob::learn::em::PLDATrainer::enroll(bob::learn::em::PLDAMachine& plda_machine,
   const blitz::Array<double,2>& ar) const
+{
+  // Forgets about any previous enrollment sample, and adds the new ones
+  plda_machine.setNSamples(0);
+  plda_machine.updateWeightedSum() = 0.;
+  plda_machine.setWSumXitBetaXi(0.);
+  enrollAppend(plda_machine, ar);
+}
+
+void bob::learn::em::PLDATrainer::enrollAppend(bob::learn::em::PLDAMachine& plda_machine,
+  const blitz::Array<double,2>& ar) const
 {
   // Gets dimension
   const size_t dim_d = ar.extent(1);
-  const int n_samples = ar.extent(0);
+  const int n_new_samples = ar.extent(0);
   // Compare the dimensionality from the base trainer/machine with the one
   // of the enrollment samples
   if (plda_machine.getDimD() != dim_d) {
@@ -773,12 +1210,13 @@ void bob::learn::em::PLDATrainer::enroll(bob::learn::em::PLDAMachine& plda_machi
   const blitz::Array<double,2>& beta = plda_machine.getPLDABase()->getBeta();
   const blitz::Array<double,2>& FtBeta = plda_machine.getPLDABase()->getFtBeta();
 
-  // Updates the PLDA machine
+  // Updates the PLDA machine: the statistics of the enrollment samples are
+  // additive, so that only the new samples are processed
+  const uint64_t n_samples = plda_machine.getNSamples() + n_new_samples;
   plda_machine.setNSamples(n_samples);
-  double terma = 0.;
-  weighted_sum = 0.;
+  double terma = plda_machine.getWSumXitBetaXi();
   blitz::Range a = blitz::Range::all();
-  for (int i=0; i<n_samples; ++i) {
+  for (int i=0; i<n_new_samples; ++i) {
     m_tmp_D_1 =  ar(i,a) - mu;
     // a/ weighted sum
     bob::math::prod(FtBeta, m_tmp_D_1, m_tmp_nf_1);
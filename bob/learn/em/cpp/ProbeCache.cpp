@@ -0,0 +1,132 @@
+/**
+ * @date Sun Oct 18 11:02:47 2026 +0200
+ *
+ * Copyright (C) Idiap Research Institute, Martigny, Switzerland
+ */
+
+
+#include <bob.learn.em/ProbeCache.h>
+#include <bob.core/check.h>
+#include <bob.math/linear.h>
+
+
+bob::learn::em::ProbeCache::ProbeCache(const boost::shared_ptr<bob::learn::em::ISVBase> isv_base,
+    const size_t max_bytes):
+  m_isv_base(isv_base), m_max_bytes(max_bytes),
+  m_n_hits(0), m_n_misses(0)
+{
+  if (!m_isv_base) throw std::runtime_error("No ISVBase was given to the ProbeCache.");
+}
+
+bob::learn::em::ProbeCache::ProbeCache(const boost::shared_ptr<bob::learn::em::JFABase> jfa_base,
+    const size_t max_bytes):
+  m_jfa_base(jfa_base), m_max_bytes(max_bytes),
+  m_n_hits(0), m_n_misses(0)
+{
+  if (!m_jfa_base) throw std::runtime_error("No JFABase was given to the ProbeCache.");
+}
+
+bob::learn::em::ProbeCache::~ProbeCache() {
+}
+
+const bob::learn::em::FABase& bob::learn::em::ProbeCache::getBase() const
+{
+  if (m_isv_base) return m_isv_base->getBase();
+  return m_jfa_base->getBase();
+}
+
+size_t bob::learn::em::ProbeCache::getEntryBytes() const
+{
+  // Ux and the centred statistics
+  return 2 * getBase().getSupervectorLength() * sizeof(double);
+}
+
+size_t bob::learn::em::ProbeCache::getNBytes() const
+{
+  if (m_entries.empty()) return 0;
+  return m_entries.size() * getEntryBytes();
+}
+
+void bob::learn::em::ProbeCache::setMaxBytes(const size_t max_bytes)
+{
+  m_max_bytes = max_bytes;
+  evict(0);
+}
+
+void bob::learn::em::ProbeCache::clear()
+{
+  m_entries.clear();
+  m_lru.clear();
+}
+
+void bob::learn::em::ProbeCache::evict(const size_t n_entries)
+{
+  if (m_lru.empty()) return;
+  const size_t entry_bytes = getEntryBytes();
+  while (!m_lru.empty() && (m_entries.size() + n_entries) * entry_bytes > m_max_bytes) {
+    m_entries.erase(m_lru.back());
+    m_lru.pop_back();
+  }
+}
+
+const bob::learn::em::ProbeCache::Entry&
+bob::learn::em::ProbeCache::lookup(const boost::shared_ptr<const bob::learn::em::GMMStats> gmm_stats)
+{
+  if (!gmm_stats) throw std::runtime_error("No GMMStats was given to the ProbeCache.");
+
+  std::map<const bob::learn::em::GMMStats*, Entry>::iterator it = m_entries.find(gmm_stats.get());
+  if (it != m_entries.end()) {
+    ++m_n_hits;
+    // Moves the probe to the front of the LRU list
+    m_lru.splice(m_lru.begin(), m_lru, it->second.lru);
+    return it->second;
+  }
+  ++m_n_misses;
+
+  const bob::learn::em::FABase& base = getBase();
+  const size_t dim_c = base.getNGaussians();
+  const size_t dim_d = base.getNInputs();
+  bob::core::array::assertSameDimensionLength(gmm_stats->sumPx.extent(0), dim_c);
+  bob::core::array::assertSameDimensionLength(gmm_stats->sumPx.extent(1), dim_d);
+
+  // Makes room for the new probe (the most recent one is always kept)
+  evict(1);
+
+  Entry entry;
+  entry.stats = gmm_stats;
+  entry.Ux.resize(dim_c*dim_d);
+  entry.centred_stats.resize(dim_c*dim_d);
+
+  // Ux
+  m_tmp_x.resize(base.getDimRu());
+  base.estimateX(*gmm_stats, m_tmp_x);
+  bob::math::prod(base.getU(), m_tmp_x, entry.Ux);
+
+  // (F - N.(m + Ux)) / T
+  const blitz::Array<double,1>& mean = base.getUbmMean();
+  blitz::Range rall = blitz::Range::all();
+  for (size_t c=0; c<dim_c; ++c) {
+    blitz::Range rc(c*dim_d,(c+1)*dim_d-1);
+    blitz::Array<double,1> centred_stats_c = entry.centred_stats(rc);
+    centred_stats_c = gmm_stats->sumPx(c,rall) - gmm_stats->n(c) * (mean(rc) + entry.Ux(rc));
+  }
+  const double sum_N = gmm_stats->T;
+  if (sum_N == 0)
+    entry.centred_stats = 0;
+  else
+    entry.centred_stats /= sum_N;
+
+  m_lru.push_front(gmm_stats.get());
+  entry.lru = m_lru.begin();
+  return m_entries.insert(std::make_pair(gmm_stats.get(), entry)).first->second;
+}
+
+blitz::Array<double,1> bob::learn::em::ProbeCache::getUx(const boost::shared_ptr<const bob::learn::em::GMMStats> gmm_stats)
+{
+  return lookup(gmm_stats).Ux;
+}
+
+blitz::Array<double,1> bob::learn::em::ProbeCache::getCentredStats(const boost::shared_ptr<const bob::learn::em::GMMStats> gmm_stats)
+{
+  return lookup(gmm_stats).centred_stats;
+}
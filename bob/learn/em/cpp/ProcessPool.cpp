@@ -0,0 +1,226 @@
+/**
+ * @date Sun Oct 18 21:52:40 2026 +0200
+ *
+ * Copyright (C) Idiap Research Institute, Martigny, Switzerland
+ */
+
+#include <bob.learn.em/ProcessPool.h>
+
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <ctime>
+#include <stdexcept>
+#include <string>
+
+#include <fcntl.h>
+#include <semaphore.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/prctl.h>
+#endif
+
+#include <boost/format.hpp>
+
+static std::string error_message(const std::string& what)
+{
+  return what + ": " + std::strerror(errno);
+}
+
+
+bob::learn::em::SharedMemory::SharedMemory(const size_t size):
+  m_data(0), m_size(size > 0 ? size : 1)
+{
+  // Finds a name which is not used yet
+  static unsigned counter = 0;
+  std::string name;
+  int fd = -1;
+  while (fd < 0) {
+    name = (boost::format("/bob.learn.em.%d.%u") % getpid() % counter++).str();
+    fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0 && errno != EEXIST)
+      throw std::runtime_error(error_message("cannot create the shared memory `" + name + "'"));
+  }
+  shm_unlink(name.c_str());
+
+  if (ftruncate(fd, m_size) != 0) {
+    const std::string message = error_message("cannot resize the shared memory");
+    close(fd);
+    throw std::runtime_error(message);
+  }
+  m_data = mmap(0, m_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (m_data == MAP_FAILED) {
+    m_data = 0;
+    throw std::runtime_error(error_message("cannot map the shared memory"));
+  }
+}
+
+bob::learn::em::SharedMemory::~SharedMemory()
+{
+  if (m_data) munmap(m_data, m_size);
+}
+
+
+/* Shared by the parent and all the workers */
+struct bob::learn::em::ProcessPool::Control
+{
+  int stop;
+  sem_t done;
+};
+
+/* One per worker */
+struct bob::learn::em::ProcessPool::Worker
+{
+  sem_t start;
+  int failed;
+  char error[256];
+};
+
+/* The current time, plus the given number of milliseconds */
+static struct timespec deadline_in(const long milliseconds)
+{
+  struct timespec deadline;
+  clock_gettime(CLOCK_REALTIME, &deadline);
+  deadline.tv_sec += milliseconds / 1000;
+  deadline.tv_nsec += (milliseconds % 1000) * 1000000;
+  if (deadline.tv_nsec >= 1000000000) {
+    deadline.tv_sec += 1;
+    deadline.tv_nsec -= 1000000000;
+  }
+  return deadline;
+}
+
+static size_t align(const size_t offset)
+{
+  const size_t a = sizeof(double) > sizeof(void*) ? sizeof(double) : sizeof(void*);
+  return (offset + a - 1) / a * a;
+}
+
+bob::learn::em::ProcessPool::ProcessPool(const size_t n_processes,
+    const job_type& job):
+  m_job(job),
+  m_control(align(sizeof(Control)) + n_processes * align(sizeof(Worker)))
+{
+  if (n_processes == 0)
+    throw std::runtime_error("the number of processes should be strictly positive");
+
+  if (sem_init(&control().done, 1, 0) != 0)
+    throw std::runtime_error(error_message("cannot create a semaphore"));
+  for (size_t k=0; k<n_processes; ++k)
+    if (sem_init(&worker(k).start, 1, 0) != 0)
+      throw std::runtime_error(error_message("cannot create a semaphore"));
+
+  const pid_t parent = getpid();
+  for (size_t k=0; k<n_processes; ++k) {
+    const pid_t pid = fork();
+    if (pid < 0) {
+      const std::string message = error_message("cannot start a worker process");
+      stop();
+      throw std::runtime_error(message);
+    }
+    if (pid == 0) work(k, parent); // never returns
+    m_pids.push_back(pid);
+  }
+}
+
+bob::learn::em::ProcessPool::~ProcessPool()
+{
+  const size_t n_processes = m_pids.size();
+  stop();
+  sem_destroy(&control().done);
+  for (size_t k=0; k<n_processes; ++k) sem_destroy(&worker(k).start);
+}
+
+bob::learn::em::ProcessPool::Control& bob::learn::em::ProcessPool::control() const
+{
+  return *static_cast<Control*>(m_control.get());
+}
+
+bob::learn::em::ProcessPool::Worker& bob::learn::em::ProcessPool::worker(const size_t k) const
+{
+  char* base = static_cast<char*>(m_control.get()) + align(sizeof(Control));
+  return *reinterpret_cast<Worker*>(base + k * align(sizeof(Worker)));
+}
+
+void bob::learn::em::ProcessPool::work(const size_t k, const pid_t parent)
+{
+#ifdef __linux__
+  // Killed with its parent, unless the parent is already gone
+  prctl(PR_SET_PDEATHSIG, SIGKILL);
+#endif
+  if (getppid() != parent) _exit(1);
+
+  Worker& w = worker(k);
+  while (true) {
+    // Checks every second that the parent is still there, where the
+    // signal above is not available
+    while (true) {
+      const struct timespec deadline = deadline_in(1000);
+      if (sem_timedwait(&w.start, &deadline) == 0) break;
+      if ((errno != ETIMEDOUT && errno != EINTR) || getppid() != parent) _exit(1);
+    }
+    if (control().stop) break;
+
+    w.failed = 0;
+    try {
+      m_job(k);
+    }
+    catch (std::exception& e) {
+      w.failed = 1;
+      std::strncpy(w.error, e.what(), sizeof(w.error)-1);
+    }
+    catch (...) {
+      w.failed = 1;
+      std::strncpy(w.error, "unknown exception", sizeof(w.error)-1);
+    }
+    sem_post(&control().done);
+  }
+  // Does not go back to the caller, nor run its exit handlers
+  _exit(0);
+}
+
+void bob::learn::em::ProcessPool::run()
+{
+  for (size_t k=0; k<m_pids.size(); ++k) sem_post(&worker(k).start);
+
+  // Waits for the workers, checking every 100 ms that none of them died
+  size_t n_done = 0;
+  while (n_done < m_pids.size()) {
+    const struct timespec deadline = deadline_in(100);
+    if (sem_timedwait(&control().done, &deadline) == 0) {
+      ++n_done;
+      continue;
+    }
+    if (errno != ETIMEDOUT && errno != EINTR)
+      throw std::runtime_error(error_message("cannot wait for the worker processes"));
+    for (size_t k=0; k<m_pids.size(); ++k) {
+      int status;
+      if (waitpid(m_pids[k], &status, WNOHANG) == m_pids[k]) {
+        boost::format m("the worker process %d exited unexpectedly");
+        m % m_pids[k];
+        throw std::runtime_error(m.str());
+      }
+    }
+  }
+
+  for (size_t k=0; k<m_pids.size(); ++k)
+    if (worker(k).failed) {
+      boost::format m("the worker process %d failed: %s");
+      m % m_pids[k] % worker(k).error;
+      throw std::runtime_error(m.str());
+    }
+}
+
+void bob::learn::em::ProcessPool::stop()
+{
+  control().stop = 1;
+  for (size_t k=0; k<m_pids.size(); ++k) sem_post(&worker(k).start);
+  for (size_t k=0; k<m_pids.size(); ++k) {
+    int status;
+    while (waitpid(m_pids[k], &status, 0) < 0 && errno == EINTR);
+  }
+  m_pids.clear();
+}
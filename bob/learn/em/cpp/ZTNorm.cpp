@@ -7,8 +7,209 @@
  */
 
 #include <bob.learn.em/ZTNorm.h>
+#include <bob.learn.em/Parallel.h>
 #include <bob.core/assert.h>
+#include <algorithm>
+#include <functional>
 #include <limits>
+#include <stdexcept>
+#include <vector>
+#include <boost/format.hpp>
+
+
+bob::learn::em::ZTNormStatistics::ZTNormStatistics()
+{
+}
+
+bob::learn::em::ZTNormStatistics::ZTNormStatistics(
+    const blitz::Array<double,2>& rawscores_zprobes_vs_models,
+    const blitz::Array<double,2>& rawscores_probes_vs_tmodels,
+    const blitz::Array<double,2>& rawscores_zprobes_vs_tmodels,
+    const blitz::Array<bool,2>& mask_zprobes_vs_tmodels_istruetrial)
+{
+  computeZNorm(rawscores_zprobes_vs_models);
+  if (rawscores_zprobes_vs_models.extent(1) > 0)
+    computeTNorm(rawscores_probes_vs_tmodels, rawscores_zprobes_vs_tmodels, &mask_zprobes_vs_tmodels_istruetrial);
+  else
+    computeTNorm(rawscores_probes_vs_tmodels);
+}
+
+bob::learn::em::ZTNormStatistics::ZTNormStatistics(
+    const blitz::Array<double,2>& rawscores_zprobes_vs_models,
+    const blitz::Array<double,2>& rawscores_probes_vs_tmodels,
+    const blitz::Array<double,2>& rawscores_zprobes_vs_tmodels)
+{
+  computeZNorm(rawscores_zprobes_vs_models);
+  if (rawscores_zprobes_vs_models.extent(1) > 0)
+    computeTNorm(rawscores_probes_vs_tmodels, rawscores_zprobes_vs_tmodels);
+  else
+    computeTNorm(rawscores_probes_vs_tmodels);
+}
+
+bob::learn::em::ZTNormStatistics::~ZTNormStatistics()
+{
+}
+
+void bob::learn::em::ZTNormStatistics::computeZNorm(const blitz::Array<double,2>& B)
+{
+  int size_znorm = B.extent(1);
+  if (size_znorm == 0) {
+    m_z_mean.resize(0);
+    m_z_std.resize(0);
+    return;
+  }
+
+  // Declare needed IndexPlaceholder
+  blitz::firstIndex ii;
+  blitz::secondIndex jj;
+
+  // Constant to check if the std is close to 0.
+  const double eps = std::numeric_limits<double>::min();
+
+  // mean(B)
+  m_z_mean.resize(B.extent(0));
+  m_z_mean = blitz::mean(B, jj);
+  // std(B)
+  m_z_std.resize(B.extent(0));
+  if (size_znorm > 1)
+    m_z_std = blitz::sqrt(blitz::sum(blitz::pow2(B(ii, jj) - m_z_mean(ii)), jj) / (size_znorm - 1));
+  else // 1 single value -> std = 0
+    m_z_std = 0;
+  m_z_std = blitz::where( m_z_std <= eps, 1., m_z_std);
+}
+
+/**
+ * Computes the mean and std of the T-Norm scores of each probe, once
+ * Z-normalised as zC = (C - mean(D)) / std(D). zC is never stored.
+ */
+static void _tNormStatistics(const blitz::Array<double,2>& C,
+    const blitz::Array<double,1>& mean_D, const blitz::Array<double,1>& std_D,
+    blitz::Array<double,1>& mean_zC, blitz::Array<double,1>& std_zC)
+{
+  int size_tnorm = C.extent(0);
+  int size_enroll = C.extent(1);
+
+  // Declare needed IndexPlaceholder
+  blitz::firstIndex ii;
+  blitz::secondIndex jj;
+
+  // Constant to check if the std is close to 0.
+  const double eps = std::numeric_limits<double>::min();
+
+  mean_zC.resize(size_enroll);
+  std_zC.resize(size_enroll);
+  mean_zC = blitz::mean((C(jj, ii) - mean_D(jj)) / std_D(jj), jj);
+  if (size_tnorm > 1)
+    std_zC = sqrt(blitz::sum(pow((C(jj, ii) - mean_D(jj)) / std_D(jj) - mean_zC(ii), 2) , jj) / (size_tnorm - 1));
+  else // 1 single value -> std = 0
+    std_zC = 0;
+  std_zC = blitz::where( std_zC <= eps, 1., std_zC);
+}
+
+void bob::learn::em::ZTNormStatistics::computeTNorm(const blitz::Array<double,2>& C)
+{
+  int size_tnorm = C.extent(0);
+  if (size_tnorm == 0) {
+    m_t_mean.resize(0);
+    m_t_std.resize(0);
+    return;
+  }
+
+  // (C - 0) / 1 == C exactly
+  blitz::Array<double,1> mean_D(size_tnorm);
+  blitz::Array<double,1> std_D(size_tnorm);
+  mean_D = 0.;
+  std_D = 1.;
+  _tNormStatistics(C, mean_D, std_D, m_t_mean, m_t_std);
+}
+
+void bob::learn::em::ZTNormStatistics::computeTNorm(const blitz::Array<double,2>& C,
+  const blitz::Array<double,2>& D,
+  const blitz::Array<bool,2>* mask_zprobes_vs_tmodels_istruetrial)
+{
+  int size_tnorm = C.extent(0);
+  int size_znorm = D.extent(1);
+  if (size_tnorm == 0) {
+    m_t_mean.resize(0);
+    m_t_std.resize(0);
+    return;
+  }
+  if (size_znorm == 0) {
+    computeTNorm(C);
+    return;
+  }
+
+  bob::core::array::assertSameDimensionLength(D.extent(0), size_tnorm);
+  if (mask_zprobes_vs_tmodels_istruetrial) {
+    bob::core::array::assertSameDimensionLength(mask_zprobes_vs_tmodels_istruetrial->extent(0), size_tnorm);
+    bob::core::array::assertSameDimensionLength(mask_zprobes_vs_tmodels_istruetrial->extent(1), size_znorm);
+  }
+
+  // Constant to check if the std is close to 0.
+  const double eps = std::numeric_limits<double>::min();
+
+  blitz::Array<double,1> mean_Dimp(size_tnorm);
+  blitz::Array<double,1> std_Dimp(size_tnorm);
+
+  // Compute mean_Dimp and std_Dimp = D only with impostors
+  for (int i = 0; i < size_tnorm; ++i) {
+    double sum = 0;
+    double sumsq = 0;
+    double count = 0;
+    for (int j = 0; j < size_znorm; ++j) {
+      bool keep;
+      // The second part is never executed if mask_zprobes_vs_tmodels_istruetrial==NULL
+      keep = (mask_zprobes_vs_tmodels_istruetrial == NULL) || !(*mask_zprobes_vs_tmodels_istruetrial)(i, j); //tnorm_models_spk_ids(i) != znorm_tests_spk_ids(j);
+
+      double value = keep * D(i, j);
+      sum += value;
+      sumsq += value*value;
+      count += keep;
+    }
+
+    double mean = sum / count;
+    mean_Dimp(i) = mean;
+    if (count > 1)
+      std_Dimp(i) = sqrt((sumsq - count * mean * mean) / (count -1));
+    else // 1 single value -> std = 0
+      std_Dimp(i) = 0;
+  }
+  std_Dimp = blitz::where( std_Dimp <= eps, 1., std_Dimp);
+
+  _tNormStatistics(C, mean_Dimp, std_Dimp, m_t_mean, m_t_std);
+}
+
+void bob::learn::em::ZTNormStatistics::normalize(const blitz::Array<double,2>& rawscores,
+  const int offset0, const int offset1,
+  blitz::Array<double,2>& normalizedscores) const
+{
+  int size0 = rawscores.extent(0);
+  int size1 = rawscores.extent(1);
+  bob::core::array::assertSameDimensionLength(normalizedscores.extent(0), size0);
+  bob::core::array::assertSameDimensionLength(normalizedscores.extent(1), size1);
+
+  const bool znorm = hasZNorm();
+  const bool tnorm = hasTNorm();
+  if (offset0 < 0 || offset1 < 0 ||
+      (znorm && offset0 + size0 > m_z_mean.extent(0)) ||
+      (tnorm && offset1 + size1 > m_t_mean.extent(0))) {
+    boost::format m("the tile of scores [%d:%d, %d:%d] is out of the range of the ZT-Norm statistics (%d x %d)");
+    m % offset0 % (offset0 + size0) % offset1 % (offset1 + size1) % m_z_mean.extent(0) % m_t_mean.extent(0);
+    throw std::runtime_error(m.str());
+  }
+
+  for (int i = 0; i < size0; ++i)
+    for (int j = 0; j < size1; ++j) {
+      double score = rawscores(i, j);
+      // zA = (A - mean(B)) / std(B)      [znorm on oringinal scores]
+      if (znorm)
+        score = (score - m_z_mean(offset0 + i)) / m_z_std(offset0 + i);
+      // ztA = (zA - mean(zC)) / std(zC)  [ztnorm on eval scores]
+      if (tnorm)
+        score = (score - m_t_mean(offset1 + j)) / m_t_std(offset1 + j);
+      normalizedscores(i, j) = score;
+    }
+}
 
 
 static void _ztNorm(const blitz::Array<double,2>& rawscores_probes_vs_models,
@@ -59,88 +260,17 @@ static void _ztNorm(const blitz::Array<double,2>& rawscores_probes_vs_models,
   bob::core::array::assertSameDimensionLength(scores.extent(0), size_eval);
   bob::core::array::assertSameDimensionLength(scores.extent(1), size_enroll);
 
-  // Declare needed IndexPlaceholder
-  blitz::firstIndex ii;
-  blitz::secondIndex jj;
-
-  // Constant to check if the std is close to 0.
-  const double eps = std::numeric_limits<double>::min();
-
-  // zA
-  blitz::Array<double,2> zA(A.shape());
-  if (B && size_znorm > 0) {
-    // Znorm  -->      zA  = (A - mean(B) ) / std(B)    [znorm on oringinal scores]
-    // mean(B)
-    blitz::Array<double,1> mean_B(blitz::mean(*B, jj));
-    // std(B)
-    blitz::Array<double,2> B2n(B->shape());
-    B2n = blitz::pow2((*B)(ii, jj) - mean_B(ii));
-    blitz::Array<double,1> std_B(B->extent(0));
-    if(size_znorm>1)
-      std_B = blitz::sqrt(blitz::sum(B2n, jj) / (size_znorm - 1));
-    else // 1 single value -> std = 0
-      std_B = 0;
-    std_B = blitz::where( std_B <= eps, 1., std_B);
-
-    zA = (A(ii, jj) - mean_B(ii)) / std_B(ii);
-  }
-  else
-    zA = A;
-
-  blitz::Array<double,2> zC(size_tnorm, size_enroll);
-  if (D && size_tnorm > 0 && size_znorm > 0) {
-    blitz::Array<double,1> mean_Dimp(size_tnorm);
-    blitz::Array<double,1> std_Dimp(size_tnorm);
-
-    // Compute mean_Dimp and std_Dimp = D only with impostors
-    for (int i = 0; i < size_tnorm; ++i) {
-      double sum = 0;
-      double sumsq = 0;
-      double count = 0;
-      for (int j = 0; j < size_znorm; ++j) {
-        bool keep;
-        // The second part is never executed if mask_zprobes_vs_tmodels_istruetrial==NULL
-        keep = (mask_zprobes_vs_tmodels_istruetrial == NULL) || !(*mask_zprobes_vs_tmodels_istruetrial)(i, j); //tnorm_models_spk_ids(i) != znorm_tests_spk_ids(j);
-
-        double value = keep * (*D)(i, j);
-        sum += value;
-        sumsq += value*value;
-        count += keep;
-      }
-
-      double mean = sum / count;
-      mean_Dimp(i) = mean;
-      if (count > 1)
-        std_Dimp(i) = sqrt((sumsq - count * mean * mean) / (count -1));
-      else // 1 single value -> std = 0
-        std_Dimp(i) = 0;
-    }
-
-    // zC  = (C - mean(D)) / std(D)     [znorm the tnorm scores]
-    std_Dimp = blitz::where( std_Dimp <= eps, 1., std_Dimp);
-    zC = ((*C)(ii, jj) - mean_Dimp(ii)) / std_Dimp(ii);
-  }
-  else if (C && size_tnorm > 0)
-    zC = *C;
-
-  if (C && size_tnorm > 0)
-  {
-    blitz::Array<double,1> mean_zC(size_enroll);
-    blitz::Array<double,1> std_zC(size_enroll);
-
-    // ztA = (zA - mean(zC)) / std(zC)  [ztnorm on eval scores]
-    mean_zC = blitz::mean(zC(jj, ii), jj);
-    if (size_tnorm > 1)
-      std_zC = sqrt(blitz::sum(pow(zC(jj, ii) - mean_zC(ii), 2) , jj) / (size_tnorm - 1));
-    else // 1 single value -> std = 0
-      std_zC = 0;
-    std_zC = blitz::where( std_zC <= eps, 1., std_zC);
-
-    // Normalised scores
-    scores = (zA(ii, jj) - mean_zC(jj)) /  std_zC(jj);
+  // Compute the statistics, and normalise all the scores as a single tile
+  bob::learn::em::ZTNormStatistics statistics;
+  if (B && size_znorm > 0)
+    statistics.computeZNorm(*B);
+  if (C && size_tnorm > 0) {
+    if (D && size_znorm > 0)
+      statistics.computeTNorm(*C, *D, mask_zprobes_vs_tmodels_istruetrial);
+    else
+      statistics.computeTNorm(*C);
   }
-  else
-    scores = zA;
+  statistics.normalize(A, 0, 0, scores);
 }
 
 void bob::learn::em::ztNorm(const blitz::Array<double,2>& rawscores_probes_vs_models,
@@ -179,3 +309,113 @@ void bob::learn::em::zNorm(const blitz::Array<double,2>& rawscores_probes_vs_mod
   _ztNorm(rawscores_probes_vs_models, &rawscores_zprobes_vs_models, NULL,
                  NULL, NULL, scores);
 }
+
+
+namespace {
+
+/**
+ * Computes the mean and std of the top_k highest scores of a set of cohort
+ * score vectors. The scores are read through a raw pointer and strides, as
+ * blitz reference counting is not thread-safe.
+ */
+struct TopKStatistics
+{
+  TopKStatistics(const double* scores, const ptrdiff_t stride_vector,
+      const ptrdiff_t stride_cohort, const size_t size_cohort, const size_t top_k,
+      blitz::Array<double,1>& mean, blitz::Array<double,1>& std):
+    m_scores(scores), m_stride_vector(stride_vector), m_stride_cohort(stride_cohort),
+    m_size_cohort(size_cohort), m_top_k(top_k),
+    m_mean(mean.data()), m_std(std.data())
+  {}
+
+  void operator()(const size_t begin, const size_t end)
+  {
+    // Constant to check if the std is close to 0.
+    const double eps = std::numeric_limits<double>::min();
+
+    std::vector<double> cohort(m_size_cohort);
+    for (size_t i=begin; i<end; ++i) {
+      const double* scores = m_scores + i*m_stride_vector;
+      for (size_t k=0; k<m_size_cohort; ++k)
+        cohort[k] = scores[k*m_stride_cohort];
+
+      // Moves the top_k highest scores to the front
+      if (m_top_k < m_size_cohort)
+        std::nth_element(cohort.begin(), cohort.begin() + m_top_k - 1, cohort.end(), std::greater<double>());
+
+      double sum = 0.;
+      for (size_t k=0; k<m_top_k; ++k)
+        sum += cohort[k];
+      const double mean = sum / m_top_k;
+
+      double std = 0.; // 1 single value -> std = 0
+      if (m_top_k > 1) {
+        double sumsq = 0.;
+        for (size_t k=0; k<m_top_k; ++k)
+          sumsq += (cohort[k] - mean) * (cohort[k] - mean);
+        std = sqrt(sumsq / (m_top_k - 1));
+      }
+
+      m_mean[i] = mean;
+      m_std[i] = std <= eps ? 1. : std;
+    }
+  }
+
+  const double* m_scores;
+  const ptrdiff_t m_stride_vector;
+  const ptrdiff_t m_stride_cohort;
+  const size_t m_size_cohort;
+  const size_t m_top_k;
+  double* m_mean;
+  double* m_std;
+};
+
+}
+
+void bob::learn::em::asNorm(const blitz::Array<double,2>& rawscores_probes_vs_models,
+            const blitz::Array<double,2>& rawscores_zprobes_vs_models,
+            const blitz::Array<double,2>& rawscores_probes_vs_tmodels,
+            const size_t top_k,
+            blitz::Array<double,2>& scores,
+            const size_t n_threads)
+{
+  // Rename variables
+  const blitz::Array<double,2>& A = rawscores_probes_vs_models;
+  const blitz::Array<double,2>& B = rawscores_zprobes_vs_models;
+  const blitz::Array<double,2>& C = rawscores_probes_vs_tmodels;
+
+  // Compute the sizes
+  int size_eval  = A.extent(0);
+  int size_enroll = A.extent(1);
+  int size_znorm = B.extent(1);
+  int size_tnorm = C.extent(0);
+
+  // Check the inputs
+  if (size_znorm == 0 || size_tnorm == 0)
+    throw std::runtime_error("AS-Norm requires non-empty Z-Norm and T-Norm cohorts");
+  bob::core::array::assertSameDimensionLength(B.extent(0), size_eval);
+  bob::core::array::assertSameDimensionLength(C.extent(1), size_enroll);
+  bob::core::array::assertSameDimensionLength(scores.extent(0), size_eval);
+  bob::core::array::assertSameDimensionLength(scores.extent(1), size_enroll);
+
+  // Statistics of the top-K cohort scores, for each model and each probe
+  blitz::Array<double,1> mean_B(size_eval), std_B(size_eval);
+  blitz::Array<double,1> mean_C(size_enroll), std_C(size_enroll);
+  const size_t top_k_B = (top_k == 0 ? size_znorm : std::min<size_t>(top_k, size_znorm));
+  const size_t top_k_C = (top_k == 0 ? size_tnorm : std::min<size_t>(top_k, size_tnorm));
+
+  // (the first element of the arrays is at data() for zero-based arrays)
+  const blitz::Array<double,2> B_ = (B.base(0) == 0 && B.base(1) == 0 ? B : B.copy());
+  const blitz::Array<double,2> C_ = (C.base(0) == 0 && C.base(1) == 0 ? C : C.copy());
+  TopKStatistics statistics_B(B_.data(), B_.stride(0), B_.stride(1), size_znorm, top_k_B, mean_B, std_B);
+  bob::learn::em::parallelFor(size_eval, n_threads, statistics_B);
+  TopKStatistics statistics_C(C_.data(), C_.stride(1), C_.stride(0), size_tnorm, top_k_C, mean_C, std_C);
+  bob::learn::em::parallelFor(size_enroll, n_threads, statistics_C);
+
+  // Declare needed IndexPlaceholder
+  blitz::firstIndex ii;
+  blitz::secondIndex jj;
+
+  // Normalised scores
+  scores = 0.5 * ((A(ii, jj) - mean_B(ii)) / std_B(ii) + (A(ii, jj) - mean_C(jj)) / std_C(jj));
+}
@@ -0,0 +1,351 @@
+/**
+ * @date Sun Oct 18 21:30:12 2026 +0200
+ *
+ * @brief Python API for bob::learn::em
+ *
+ * Copyright (C) Idiap Research Institute, Martigny, Switzerland
+ */
+
+#include "main.h"
+#include <bob.learn.em/EMDriver.h>
+#include <bob.learn.em/ProcessEStep.h>
+
+/* converts PyObject to bool and returns false if object is NULL */
+static inline bool f(PyObject* o){return o != 0 && PyObject_IsTrue(o) > 0;}
+
+static int extract_GMMStats_1d(PyObject *list,
+                             std::vector<bob::learn::em::GMMStats>& training_data)
+{
+  for (int i=0; i<PyList_GET_SIZE(list); i++){
+
+    PyBobLearnEMGMMStatsObject* stats;
+    if (!PyArg_Parse(PyList_GetItem(list, i), "O!", &PyBobLearnEMGMMStats_Type, &stats)){
+      PyErr_Format(PyExc_RuntimeError, "Expected GMMStats objects");
+      return -1;
+    }
+    training_data.push_back(*stats->cxx);
+  }
+  return 0;
+}
+
+static int extract_GMMStats_2d(PyObject *list,
+                             std::vector<std::vector<boost::shared_ptr<bob::learn::em::GMMStats> > >& training_data)
+{
+  for (int i=0; i<PyList_GET_SIZE(list); i++)
+  {
+    PyObject* another_list;
+    if(!PyArg_Parse(PyList_GetItem(list, i), "O!", &PyList_Type, &another_list)){
+      PyErr_Format(PyExc_RuntimeError, "Expected a list of lists of GMMStats objects [[GMMStats,GMMStats],[GMMStats,GMMStats].....[GMMStats,GMMStats]]");
+      return -1;
+    }
+
+    std::vector<boost::shared_ptr<bob::learn::em::GMMStats> > another_training_data;
+    for (int j=0; j<PyList_GET_SIZE(another_list); j++){
+
+      PyBobLearnEMGMMStatsObject* stats;
+      if (!PyArg_Parse(PyList_GetItem(another_list, j), "O!", &PyBobLearnEMGMMStats_Type, &stats)){
+        PyErr_Format(PyExc_RuntimeError, "Expected GMMStats objects");
+        return -1;
+      }
+      another_training_data.push_back(stats->cxx);
+    }
+    training_data.push_back(another_training_data);
+  }
+  return 0;
+}
+
+static int list_as_vector(PyObject* list, std::vector<blitz::Array<double,2> >& vec)
+{
+  for (int i=0; i<PyList_GET_SIZE(list); i++)
+  {
+    PyBlitzArrayObject* blitz_object;
+    if (!PyArg_Parse(PyList_GetItem(list, i), "O&", &PyBlitzArray_Converter, &blitz_object)){
+      PyErr_Format(PyExc_RuntimeError, "Expected numpy array object");
+      return -1;
+    }
+    auto blitz_object_ = make_safe(blitz_object);
+    vec.push_back(*PyBlitzArrayCxx_AsBlitz<double,2>(blitz_object));
+  }
+  return 0;
+}
+
+/* Converts the data to a 2D array of float64 with n_inputs columns */
+static PyBlitzArrayObject* extract_2d_data(PyObject* data, const size_t n_inputs)
+{
+  PyBlitzArrayObject* array = 0;
+  if (!PyBlitzArray_Converter(data, &array)) return 0;
+  auto array_ = make_safe(array);
+
+  if (array->type_num != NPY_FLOAT64 || array->ndim != 2){
+    PyErr_Format(PyExc_TypeError, "`data' should be a 2D array of float64");
+    return 0;
+  }
+  if (array->shape[1] != (Py_ssize_t)n_inputs) {
+    PyErr_Format(PyExc_TypeError, "`data' should have the shape [N, %" PY_FORMAT_SIZE_T "d] not [N, %" PY_FORMAT_SIZE_T "d]", n_inputs, array->shape[1]);
+    return 0;
+  }
+  Py_INCREF(array);
+  return array;
+}
+
+/* Thrown when the Python callback raised; the Python error is already set */
+struct PythonCallbackError: public std::exception {};
+
+/* Calls a Python callable from the EMDriver, taking the GIL back */
+class PythonCallback {
+  public:
+    PythonCallback(PyObject* callable): m_callable(callable) {}
+    void operator()(size_t iteration, double likelihood) const {
+      PyGILState_STATE state = PyGILState_Ensure();
+      PyObject* result = PyObject_CallFunction(m_callable, "nd", (Py_ssize_t)iteration, likelihood);
+      Py_XDECREF(result);
+      PyGILState_Release(state);
+      if (!result) throw PythonCallbackError();
+    }
+  private:
+    PyObject* m_callable;
+};
+
+/* The options of the EMDriver, which do not depend on the trainer */
+struct DriverOptions {
+  size_t max_iterations;
+  double convergence_threshold;
+  bool initialize;
+  PyObject* callback;
+  std::string checkpoint;
+  size_t checkpoint_iterations;
+  double checkpoint_seconds;
+  size_t n_processes;
+};
+
+/* Runs the E-step in worker processes, for the trainers which support it.
+   The workers are forked right away: it should be called with the GIL held,
+   before any thread is started. */
+template <typename T>
+static void set_process_estep(bob::learn::em::EMDriver<T>&, T&,
+  typename bob::learn::em::EMTrainerTraits<T>::machine_type&,
+  const typename bob::learn::em::EMTrainerTraits<T>::data_type&,
+  size_t n_processes)
+{
+  if (n_processes > 1)
+    throw std::runtime_error("this trainer cannot run its E-step in several processes");
+}
+
+template <typename T>
+static void set_process_estep_(bob::learn::em::EMDriver<T>& driver, T& trainer,
+  typename bob::learn::em::EMTrainerTraits<T>::machine_type& machine,
+  const typename bob::learn::em::EMTrainerTraits<T>::data_type& data,
+  size_t n_processes)
+{
+  if (n_processes > 1)
+    driver.setEStep(bob::learn::em::ProcessEStep<T>(n_processes, trainer, machine, data));
+}
+
+static void set_process_estep(bob::learn::em::EMDriver<bob::learn::em::KMeansTrainer>& driver,
+  bob::learn::em::KMeansTrainer& trainer, bob::learn::em::KMeansMachine& machine,
+  const blitz::Array<double,2>& data, size_t n_processes){
+  set_process_estep_(driver, trainer, machine, data, n_processes);
+}
+static void set_process_estep(bob::learn::em::EMDriver<bob::learn::em::ML_GMMTrainer>& driver,
+  bob::learn::em::ML_GMMTrainer& trainer, bob::learn::em::GMMMachine& machine,
+  const blitz::Array<double,2>& data, size_t n_processes){
+  set_process_estep_(driver, trainer, machine, data, n_processes);
+}
+static void set_process_estep(bob::learn::em::EMDriver<bob::learn::em::MAP_GMMTrainer>& driver,
+  bob::learn::em::MAP_GMMTrainer& trainer, bob::learn::em::GMMMachine& machine,
+  const blitz::Array<double,2>& data, size_t n_processes){
+  set_process_estep_(driver, trainer, machine, data, n_processes);
+}
+static void set_process_estep(bob::learn::em::EMDriver<bob::learn::em::IVectorTrainer>& driver,
+  bob::learn::em::IVectorTrainer& trainer, bob::learn::em::IVectorMachine& machine,
+  const std::vector<bob::learn::em::GMMStats>& data, size_t n_processes){
+  set_process_estep_(driver, trainer, machine, data, n_processes);
+}
+
+template <typename T>
+static size_t run_em_driver(T& trainer,
+  typename bob::learn::em::EMTrainerTraits<T>::machine_type& machine,
+  const typename bob::learn::em::EMTrainerTraits<T>::data_type& data,
+  const DriverOptions& options)
+{
+  bob::learn::em::EMDriver<T> driver(options.max_iterations, options.convergence_threshold, options.initialize);
+  if (options.callback) driver.setCallback(PythonCallback(options.callback));
+  driver.setCheckpoint(options.checkpoint, options.checkpoint_iterations, options.checkpoint_seconds);
+  set_process_estep(driver, trainer, machine, data, options.n_processes);
+  GILReleaser gil;
+  return driver.train(trainer, machine, data);
+}
+
+
+/*** train_native ***/
+bob::extension::FunctionDoc train_native = bob::extension::FunctionDoc(
+  "train_native",
+  "Trains a machine given a trainer and the proper data, running the whole EM loop in C++",
+  "This is the same loop as :py:func:`bob.learn.em.train`, which uses this function for the trainers of this package. "
+  "The GIL is released during the training, such that other Python threads may run meanwhile; it is only taken back to call the ``callback``.",
+  true
+)
+.add_prototype("trainer, machine, data, [max_iterations], [convergence_threshold], [initialize], [rng], [callback], [checkpoint], [checkpoint_iterations], [checkpoint_seconds], [n_processes]", "n_iterations")
+.add_parameter("trainer", "one of :py:class:`KMeansTrainer`, :py:class:`MAP_GMMTrainer`, :py:class:`ML_GMMTrainer`, :py:class:`ISVTrainer`, :py:class:`IVectorTrainer`, :py:class:`PLDATrainer`, :py:class:`EMPCATrainer`", "A trainer mechanism")
+.add_parameter("machine", "one of :py:class:`KMeansMachine`, :py:class:`GMMMachine`, :py:class:`ISVBase`, :py:class:`IVectorMachine`, :py:class:`PLDABase`, :py:class:`bob.learn.linear.Machine`", "A container machine")
+.add_parameter("data", "array_like <float, 2D> or list", "The data to be trained, as expected by the ``e_step`` of the trainer")
+.add_parameter("max_iterations", "int", "[Default: ``50``] The maximum number of iterations")
+.add_parameter("convergence_threshold", "float", "[Default: ``None``] The convergence threshold on the relative change of the likelihood. If None, the training stops after ``max_iterations``")
+.add_parameter("initialize", "bool", "[Default: ``True``] If True, runs the initialization procedure. When resuming from a ``checkpoint``, the trainer is initialized on a copy of the machine in any case")
+.add_parameter("rng", ":py:class:`bob.core.random.mt19937`", "The Mersenne Twister mt19937 random generator used for the initialization")
+.add_parameter("callback", "callable", "Called after each iteration as ``callback(iteration, likelihood)``; the likelihood is 0 for the trainers which do not compute it")
+.add_parameter("checkpoint", "str", "[Default: ``None``] An HDF5 file where the machine, the state of the trainer and of ``rng`` are saved during the training. If it exists when the training starts, the training resumes from it, following exactly the same iterations as if it had not been interrupted. It is removed once the training is over")
+.add_parameter("checkpoint_iterations", "int", "[Default: ``0``] Writes the ``checkpoint`` every given number of iterations; 0 disables this criterion")
+.add_parameter("checkpoint_seconds", "float", "[Default: ``0``] Writes the ``checkpoint`` when at least the given number of seconds passed since the last one; 0 disables this criterion")
+.add_parameter("n_processes", "int", "[Default: ``1``] If greater than 1, the E-step is run on as many shards of the data, in worker processes which get the parameters of the machine and return their statistics through shared memory. Only supported by :py:class:`KMeansTrainer`, :py:class:`ML_GMMTrainer`, :py:class:`MAP_GMMTrainer` and :py:class:`IVectorTrainer`")
+.add_return("n_iterations", "int", "The number of iterations which were run");
+PyObject* PyBobLearnEM_train_native(PyObject*, PyObject* args, PyObject* kwargs) {
+  BOB_TRY
+
+  char** kwlist = train_native.kwlist(0);
+
+  PyObject* trainer = 0;
+  PyObject* machine = 0;
+  PyObject* data = 0;
+  Py_ssize_t max_iterations = 50;
+  PyObject* convergence_threshold = 0;
+  PyObject* initialize = 0;
+  PyBoostMt19937Object* rng = 0;
+  PyObject* callback = 0;
+  const char* checkpoint = 0;
+  Py_ssize_t checkpoint_iterations = 0;
+  double checkpoint_seconds = 0.;
+  Py_ssize_t n_processes = 1;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OOO|nOOO!Ozndn", kwlist, &trainer, &machine, &data,
+                                                                   &max_iterations, &convergence_threshold, &initialize,
+                                                                   &PyBoostMt19937_Type, &rng, &callback,
+                                                                   &checkpoint, &checkpoint_iterations, &checkpoint_seconds,
+                                                                   &n_processes)) return 0;
+
+  if (max_iterations < 0){
+    PyErr_Format(PyExc_ValueError, "`max_iterations' should be positive");
+    return 0;
+  }
+  double threshold = -1.;
+  if (convergence_threshold && convergence_threshold != Py_None){
+    threshold = PyFloat_AsDouble(convergence_threshold);
+    if (PyErr_Occurred()) return 0;
+  }
+  if (checkpoint_iterations < 0 || checkpoint_seconds < 0.){
+    PyErr_Format(PyExc_ValueError, "`checkpoint_iterations' and `checkpoint_seconds' should be positive");
+    return 0;
+  }
+  if (n_processes < 1){
+    PyErr_Format(PyExc_ValueError, "`n_processes' should be strictly positive");
+    return 0;
+  }
+  if (callback == Py_None) callback = 0;
+  if (callback && !PyCallable_Check(callback)){
+    PyErr_Format(PyExc_TypeError, "`callback' should be callable");
+    return 0;
+  }
+
+  DriverOptions options;
+  options.max_iterations = max_iterations;
+  options.convergence_threshold = threshold;
+  options.initialize = initialize ? f(initialize) : true;
+  options.callback = callback;
+  options.checkpoint = checkpoint ? checkpoint : "";
+  options.checkpoint_iterations = checkpoint_iterations;
+  options.checkpoint_seconds = checkpoint_seconds;
+  options.n_processes = n_processes;
+
+  size_t n_iterations = 0;
+  try {
+    if (PyBobLearnEMKMeansTrainer_Check(trainer)){
+      if (!PyBobLearnEMKMeansMachine_Check(machine)){
+        PyErr_Format(PyExc_TypeError, "`%s' should be trained on a KMeansMachine", Py_TYPE(trainer)->tp_name);
+        return 0;
+      }
+      auto t = reinterpret_cast<PyBobLearnEMKMeansTrainerObject*>(trainer)->cxx;
+      auto m = reinterpret_cast<PyBobLearnEMKMeansMachineObject*>(machine)->cxx;
+      PyBlitzArrayObject* array = extract_2d_data(data, m->getNInputs());
+      if (!array) return 0;
+      auto array_ = make_safe(array);
+      if (rng) t->setRng(rng->rng);
+      n_iterations = run_em_driver(*t, *m, *PyBlitzArrayCxx_AsBlitz<double,2>(array), options);
+    }
+    else if (PyBobLearnEMMLGMMTrainer_Check(trainer) || PyBobLearnEMMAPGMMTrainer_Check(trainer)){
+      if (!PyBobLearnEMGMMMachine_Check(machine)){
+        PyErr_Format(PyExc_TypeError, "`%s' should be trained on a GMMMachine", Py_TYPE(trainer)->tp_name);
+        return 0;
+      }
+      auto m = reinterpret_cast<PyBobLearnEMGMMMachineObject*>(machine)->cxx;
+      PyBlitzArrayObject* array = extract_2d_data(data, m->getNInputs());
+      if (!array) return 0;
+      auto array_ = make_safe(array);
+      if (PyBobLearnEMMLGMMTrainer_Check(trainer))
+        n_iterations = run_em_driver(*reinterpret_cast<PyBobLearnEMMLGMMTrainerObject*>(trainer)->cxx, *m,
+          *PyBlitzArrayCxx_AsBlitz<double,2>(array), options);
+      else
+        n_iterations = run_em_driver(*reinterpret_cast<PyBobLearnEMMAPGMMTrainerObject*>(trainer)->cxx, *m,
+          *PyBlitzArrayCxx_AsBlitz<double,2>(array), options);
+    }
+    else if (PyBobLearnEMISVTrainer_Check(trainer)){
+      if (!PyBobLearnEMISVBase_Check(machine) || !PyList_Check(data)){
+        PyErr_Format(PyExc_TypeError, "`%s' should be trained on an ISVBase with a list of lists of GMMStats", Py_TYPE(trainer)->tp_name);
+        return 0;
+      }
+      auto t = reinterpret_cast<PyBobLearnEMISVTrainerObject*>(trainer)->cxx;
+      std::vector<std::vector<boost::shared_ptr<bob::learn::em::GMMStats> > > training_data;
+      if (extract_GMMStats_2d(data, training_data) != 0) return 0;
+      if (rng) t->setRng(rng->rng);
+      n_iterations = run_em_driver(*t, *reinterpret_cast<PyBobLearnEMISVBaseObject*>(machine)->cxx,
+        training_data, options);
+    }
+    else if (PyBobLearnEMIVectorTrainer_Check(trainer)){
+      if (!PyBobLearnEMIVectorMachine_Check(machine) || !PyList_Check(data)){
+        PyErr_Format(PyExc_TypeError, "`%s' should be trained on an IVectorMachine with a list of GMMStats", Py_TYPE(trainer)->tp_name);
+        return 0;
+      }
+      auto t = reinterpret_cast<PyBobLearnEMIVectorTrainerObject*>(trainer)->cxx;
+      std::vector<bob::learn::em::GMMStats> training_data;
+      if (extract_GMMStats_1d(data, training_data) != 0) return 0;
+      if (rng) t->setRng(rng->rng);
+      n_iterations = run_em_driver(*t, *reinterpret_cast<PyBobLearnEMIVectorMachineObject*>(machine)->cxx,
+        training_data, options);
+    }
+    else if (PyBobLearnEMPLDATrainer_Check(trainer)){
+      if (!PyBobLearnEMPLDABase_Check(machine) || !PyList_Check(data)){
+        PyErr_Format(PyExc_TypeError, "`%s' should be trained on a PLDABase with a list of 2D arrays", Py_TYPE(trainer)->tp_name);
+        return 0;
+      }
+      auto t = reinterpret_cast<PyBobLearnEMPLDATrainerObject*>(trainer)->cxx;
+      std::vector<blitz::Array<double,2> > training_data;
+      if (list_as_vector(data, training_data) != 0) return 0;
+      if (rng) t->setRng(rng->rng);
+      n_iterations = run_em_driver(*t, *reinterpret_cast<PyBobLearnEMPLDABaseObject*>(machine)->cxx,
+        training_data, options);
+    }
+    else if (PyBobLearnEMEMPCATrainer_Check(trainer)){
+      if (!PyObject_IsInstance(machine, reinterpret_cast<PyObject*>(&PyBobLearnLinearMachine_Type))){
+        PyErr_Format(PyExc_TypeError, "`%s' should be trained on a bob.learn.linear.Machine", Py_TYPE(trainer)->tp_name);
+        return 0;
+      }
+      auto t = reinterpret_cast<PyBobLearnEMEMPCATrainerObject*>(trainer)->cxx;
+      auto m = reinterpret_cast<PyBobLearnLinearMachineObject*>(machine)->cxx;
+      PyBlitzArrayObject* array = extract_2d_data(data, m->inputSize());
+      if (!array) return 0;
+      auto array_ = make_safe(array);
+      if (rng) t->setRng(rng->rng);
+      n_iterations = run_em_driver(*t, *m, *PyBlitzArrayCxx_AsBlitz<double,2>(array), options);
+    }
+    else {
+      PyErr_Format(PyExc_TypeError, "`%s' is not a trainer of bob.learn.em", Py_TYPE(trainer)->tp_name);
+      return 0;
+    }
+  }
+  catch (PythonCallbackError&) {
+    return 0;
+  }
+
+  return Py_BuildValue("n", n_iterations);
+
+  BOB_CATCH_FUNCTION("train_native", 0)
+}
@@ -163,10 +163,10 @@ static PyGetSetDef PyBobLearnEMEMPCATrainer_getseters[] = {
 static auto initialize = bob::extension::FunctionDoc(
   "initialize",
   "",
-  "",
+  "If ``data`` is not given, the initialization uses the mean and scatter streamed with :py:meth:`acc_mean_variance`.",
   true
 )
-.add_prototype("linear_machine, data, [rng]")
+.add_prototype("linear_machine, [data], [rng]")
 .add_parameter("linear_machine", ":py:class:`bob.learn.linear.Machine`", "LinearMachine Object")
 .add_parameter("data", "array_like <float, 2D>", "Input data")
 .add_parameter("rng", ":py:class:`bob.core.random.mt19937`", "The Mersenne Twister mt19937 random generator used for the initialization of subspaces/arrays before the EM loop.");
@@ -180,17 +180,19 @@ static PyObject* PyBobLearnEMEMPCATrainer_initialize(PyBobLearnEMEMPCATrainerObj
   PyBlitzArrayObject* data                      = 0;
   PyBoostMt19937Object* rng = 0;
 
-  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!O&|O!", kwlist, &PyBobLearnLinearMachine_Type, &linear_machine,
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!|O&O!", kwlist, &PyBobLearnLinearMachine_Type, &linear_machine,
                                                                  &PyBlitzArray_Converter, &data,
                                                                  &PyBoostMt19937_Type, &rng)) return 0;
-  auto data_ = make_safe(data);
+  auto data_ = make_xsafe(data);
 
   if(rng){
     self->cxx->setRng(rng->rng);
   }
 
-
-  self->cxx->initialize(*linear_machine->cxx, *PyBlitzArrayCxx_AsBlitz<double,2>(data));
+  if (data)
+    self->cxx->initialize(*linear_machine->cxx, *PyBlitzArrayCxx_AsBlitz<double,2>(data));
+  else
+    self->cxx->initialize(*linear_machine->cxx);
 
   BOB_CATCH_MEMBER("cannot perform the initialize method", 0)
 
@@ -233,10 +235,10 @@ static PyObject* PyBobLearnEMEMPCATrainer_e_step(PyBobLearnEMEMPCATrainerObject*
 static auto m_step = bob::extension::FunctionDoc(
   "m_step",
   "",
-  0,
+  "Only the sums of statistics computed by :py:meth:`e_step` or :py:meth:`acc_statistics` are used, such that ``data`` may be omitted.",
   true
 )
-.add_prototype("linear_machine,data")
+.add_prototype("linear_machine,[data]")
 .add_parameter("linear_machine", ":py:class:`bob.learn.linear.Machine`", "LinearMachine Object")
 .add_parameter("data", "array_like <float, 2D>", "Input data");
 static PyObject* PyBobLearnEMEMPCATrainer_m_step(PyBobLearnEMEMPCATrainerObject* self, PyObject* args, PyObject* kwargs) {
@@ -247,11 +249,11 @@ static PyObject* PyBobLearnEMEMPCATrainer_m_step(PyBobLearnEMEMPCATrainerObject*
 
   PyBobLearnLinearMachineObject* linear_machine;
   PyBlitzArrayObject* data = 0;
-  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!O&", kwlist, &PyBobLearnLinearMachine_Type, &linear_machine,
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!|O&", kwlist, &PyBobLearnLinearMachine_Type, &linear_machine,
                                                                  &PyBlitzArray_Converter, &data)) return 0;
-  auto data_ = make_safe(data);
+  auto data_ = make_xsafe(data);
 
-  self->cxx->mStep(*linear_machine->cxx, *PyBlitzArrayCxx_AsBlitz<double,2>(data));
+  self->cxx->mStep(*linear_machine->cxx);
 
 
   BOB_CATCH_MEMBER("cannot perform the m_step method", 0)
@@ -285,6 +287,172 @@ static PyObject* PyBobLearnEMEMPCATrainer_compute_likelihood(PyBobLearnEMEMPCATr
 }
 
 
+/*** compute_e_step_likelihood ***/
+static auto compute_e_step_likelihood = bob::extension::FunctionDoc(
+  "compute_e_step_likelihood",
+  "Computes the log likelihood of the parameters used by the last E-step, from its sums of statistics",
+  "This gives the same value as :py:meth:`compute_likelihood` called right after :py:meth:`e_step` (or :py:meth:`acc_statistics`), "
+  "without any product of size ``n_features x n_features``. It is only valid before the next :py:meth:`m_step`.",
+  true
+)
+.add_prototype("linear_machine","likelihood")
+.add_parameter("linear_machine", ":py:class:`bob.learn.linear.Machine`", "LinearMachine Object")
+.add_return("likelihood","float","The log likelihood");
+static PyObject* PyBobLearnEMEMPCATrainer_compute_e_step_likelihood(PyBobLearnEMEMPCATrainerObject* self, PyObject* args, PyObject* kwargs) {
+  BOB_TRY
+
+  /* Parses input arguments in a single shot */
+  char** kwlist = compute_e_step_likelihood.kwlist(0);
+
+  PyBobLearnLinearMachineObject* linear_machine;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!", kwlist, &PyBobLearnLinearMachine_Type, &linear_machine)) return 0;
+
+  double value = self->cxx->computeEStepLikelihood(*linear_machine->cxx);
+  return Py_BuildValue("d", value);
+
+  BOB_CATCH_MEMBER("cannot perform the compute_e_step_likelihood method", 0)
+}
+
+
+/*** reset_mean_variance ***/
+static auto reset_mean_variance = bob::extension::FunctionDoc(
+  "reset_mean_variance",
+  "Resets the mean (stored in the machine) and the scatter before streaming the training data with :py:meth:`acc_mean_variance`",
+  "",
+  true
+)
+.add_prototype("linear_machine")
+.add_parameter("linear_machine", ":py:class:`bob.learn.linear.Machine`", "LinearMachine Object");
+static PyObject* PyBobLearnEMEMPCATrainer_reset_mean_variance(PyBobLearnEMEMPCATrainerObject* self, PyObject* args, PyObject* kwargs) {
+  BOB_TRY
+
+  /* Parses input arguments in a single shot */
+  char** kwlist = reset_mean_variance.kwlist(0);
+
+  PyBobLearnLinearMachineObject* linear_machine;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!", kwlist, &PyBobLearnLinearMachine_Type, &linear_machine)) return 0;
+
+  self->cxx->resetMeanVariance(*linear_machine->cxx);
+
+  BOB_CATCH_MEMBER("cannot perform the reset_mean_variance method", 0)
+
+  Py_RETURN_NONE;
+}
+
+
+/*** acc_mean_variance ***/
+static auto acc_mean_variance = bob::extension::FunctionDoc(
+  "acc_mean_variance",
+  "Updates the mean (stored in the machine) and the scatter with a chunk of the training data",
+  "The data is only read once (Welford's online update), such that it can be given by chunks which do not fit in memory together. "
+  "Call :py:meth:`initialize` without data once all the chunks were given.",
+  true
+)
+.add_prototype("linear_machine,data")
+.add_parameter("linear_machine", ":py:class:`bob.learn.linear.Machine`", "LinearMachine Object")
+.add_parameter("data", "array_like <float, 2D>", "A chunk of the input data");
+static PyObject* PyBobLearnEMEMPCATrainer_acc_mean_variance(PyBobLearnEMEMPCATrainerObject* self, PyObject* args, PyObject* kwargs) {
+  BOB_TRY
+
+  /* Parses input arguments in a single shot */
+  char** kwlist = acc_mean_variance.kwlist(0);
+
+  PyBobLearnLinearMachineObject* linear_machine;
+  PyBlitzArrayObject* data = 0;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!O&", kwlist, &PyBobLearnLinearMachine_Type, &linear_machine,
+                                                                 &PyBlitzArray_Converter, &data)) return 0;
+  auto data_ = make_safe(data);
+
+  self->cxx->accMeanVariance(*linear_machine->cxx, *PyBlitzArrayCxx_AsBlitz<double,2>(data));
+
+  BOB_CATCH_MEMBER("cannot perform the acc_mean_variance method", 0)
+
+  Py_RETURN_NONE;
+}
+
+
+/*** reset_statistics ***/
+static auto reset_statistics = bob::extension::FunctionDoc(
+  "reset_statistics",
+  "Resets the sums of statistics before streaming the training data with :py:meth:`acc_statistics`",
+  "",
+  true
+)
+.add_prototype("");
+static PyObject* PyBobLearnEMEMPCATrainer_reset_statistics(PyBobLearnEMEMPCATrainerObject* self) {
+  BOB_TRY
+
+  self->cxx->resetStatistics();
+
+  BOB_CATCH_MEMBER("cannot perform the reset_statistics method", 0)
+
+  Py_RETURN_NONE;
+}
+
+
+/*** acc_statistics ***/
+static auto acc_statistics = bob::extension::FunctionDoc(
+  "acc_statistics",
+  "Streaming E-step: accumulates the sums of statistics required by :py:meth:`m_step` for a chunk of the training data",
+  "Contrary to :py:meth:`e_step`, the latent variables of the samples are not kept, such that the memory does not depend on the number of samples.",
+  true
+)
+.add_prototype("linear_machine,data")
+.add_parameter("linear_machine", ":py:class:`bob.learn.linear.Machine`", "LinearMachine Object")
+.add_parameter("data", "array_like <float, 2D>", "A chunk of the input data");
+static PyObject* PyBobLearnEMEMPCATrainer_acc_statistics(PyBobLearnEMEMPCATrainerObject* self, PyObject* args, PyObject* kwargs) {
+  BOB_TRY
+
+  /* Parses input arguments in a single shot */
+  char** kwlist = acc_statistics.kwlist(0);
+
+  PyBobLearnLinearMachineObject* linear_machine;
+  PyBlitzArrayObject* data = 0;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!O&", kwlist, &PyBobLearnLinearMachine_Type, &linear_machine,
+                                                                 &PyBlitzArray_Converter, &data)) return 0;
+  auto data_ = make_safe(data);
+
+  self->cxx->accStatistics(*linear_machine->cxx, *PyBlitzArrayCxx_AsBlitz<double,2>(data));
+
+  BOB_CATCH_MEMBER("cannot perform the acc_statistics method", 0)
+
+  Py_RETURN_NONE;
+}
+
+
+/*** save_statistics ***/
+static auto save_statistics = bob::extension::FunctionDoc(
+  "save_statistics",
+  "Saves the statistics accumulated by the last E-step (the sums of statistics) to the given HDF5 file",
+  "The E-step can be run on shards of the data, e.g. in several processes, each of them saving its statistics. "
+  "The statistics are then summed with :py:meth:`load_statistics` and :py:meth:`add_statistics` before the M-step.",
+  true
+)
+.add_prototype("hdf5")
+.add_parameter("hdf5", ":py:class:`bob.io.base.HDF5File`", "An HDF5 file open for writing");
+
+
+/*** load_statistics ***/
+static auto load_statistics = bob::extension::FunctionDoc(
+  "load_statistics",
+  "Loads statistics saved by :py:meth:`save_statistics`, in place of the accumulated ones",
+  "The trainer should have been initialized for the same machine, such that :py:meth:`m_step` can be called afterwards.",
+  true
+)
+.add_prototype("hdf5")
+.add_parameter("hdf5", ":py:class:`bob.io.base.HDF5File`", "An HDF5 file open for reading");
+
+
+/*** add_statistics ***/
+static auto add_statistics = bob::extension::FunctionDoc(
+  "add_statistics",
+  "Adds the statistics accumulated by another trainer to the ones of this trainer",
+  0,
+  true
+)
+.add_prototype("other")
+.add_parameter("other", ":py:class:`bob.learn.em.EMPCATrainer`", "A trainer, e.g. in which :py:meth:`load_statistics` was called");
+
 
 static PyMethodDef PyBobLearnEMEMPCATrainer_methods[] = {
   {
@@ -311,6 +479,54 @@ static PyMethodDef PyBobLearnEMEMPCATrainer_methods[] = {
     METH_VARARGS|METH_KEYWORDS,
     compute_likelihood.doc()
   },
+  {
+    compute_e_step_likelihood.name(),
+    (PyCFunction)PyBobLearnEMEMPCATrainer_compute_e_step_likelihood,
+    METH_VARARGS|METH_KEYWORDS,
+    compute_e_step_likelihood.doc()
+  },
+  {
+    reset_mean_variance.name(),
+    (PyCFunction)PyBobLearnEMEMPCATrainer_reset_mean_variance,
+    METH_VARARGS|METH_KEYWORDS,
+    reset_mean_variance.doc()
+  },
+  {
+    acc_mean_variance.name(),
+    (PyCFunction)PyBobLearnEMEMPCATrainer_acc_mean_variance,
+    METH_VARARGS|METH_KEYWORDS,
+    acc_mean_variance.doc()
+  },
+  {
+    reset_statistics.name(),
+    (PyCFunction)PyBobLearnEMEMPCATrainer_reset_statistics,
+    METH_NOARGS,
+    reset_statistics.doc()
+  },
+  {
+    acc_statistics.name(),
+    (PyCFunction)PyBobLearnEMEMPCATrainer_acc_statistics,
+    METH_VARARGS|METH_KEYWORDS,
+    acc_statistics.doc()
+  },
+  {
+    save_statistics.name(),
+    (PyCFunction)PyBobLearnEMTrainer_save_statistics<PyBobLearnEMEMPCATrainerObject>,
+    METH_VARARGS|METH_KEYWORDS,
+    save_statistics.doc()
+  },
+  {
+    load_statistics.name(),
+    (PyCFunction)PyBobLearnEMTrainer_load_statistics<PyBobLearnEMEMPCATrainerObject>,
+    METH_VARARGS|METH_KEYWORDS,
+    load_statistics.doc()
+  },
+  {
+    add_statistics.name(),
+    (PyCFunction)PyBobLearnEMTrainer_add_statistics<PyBobLearnEMEMPCATrainerObject, &PyBobLearnEMEMPCATrainer_Type>,
+    METH_VARARGS|METH_KEYWORDS,
+    add_statistics.doc()
+  },
   {0} /* Sentinel */
 };
 
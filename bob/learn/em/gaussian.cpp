@@ -167,7 +167,7 @@ static auto mean = bob::extension::VariableDoc(
 );
 PyObject* PyBobLearnEMGaussian_getMean(PyBobLearnEMGaussianObject* self, void*){
   BOB_TRY
-  return PyBlitzArrayCxx_AsConstNumpy(self->cxx->getMean());
+  return PyBobLearnEM_AsConstNumpy(self->cxx->getMean(), self->cxx->getMappedFile());
   BOB_CATCH_MEMBER("mean could not be read", 0)
 }
 int PyBobLearnEMGaussian_setMean(PyBobLearnEMGaussianObject* self, PyObject* value, void*){
@@ -211,7 +211,7 @@ static auto variance = bob::extension::VariableDoc(
 );
 PyObject* PyBobLearnEMGaussian_getVariance(PyBobLearnEMGaussianObject* self, void*){
   BOB_TRY
-  return PyBlitzArrayCxx_AsConstNumpy(self->cxx->getVariance());
+  return PyBobLearnEM_AsConstNumpy(self->cxx->getVariance(), self->cxx->getMappedFile());
   BOB_CATCH_MEMBER("variance could not be read", 0)
 }
 int PyBobLearnEMGaussian_setVariance(PyBobLearnEMGaussianObject* self, PyObject* value, void*){
@@ -256,7 +256,7 @@ static auto variance_thresholds = bob::extension::VariableDoc(
 );
 PyObject* PyBobLearnEMGaussian_getVarianceThresholds(PyBobLearnEMGaussianObject* self, void*){
   BOB_TRY
-  return PyBlitzArrayCxx_AsConstNumpy(self->cxx->getVarianceThresholds());
+  return PyBobLearnEM_AsConstNumpy(self->cxx->getVarianceThresholds(), self->cxx->getMappedFile());
   BOB_CATCH_MEMBER("variance_thresholds could not be read", 0)
 }
 int PyBobLearnEMGaussian_setVarianceThresholds(PyBobLearnEMGaussianObject* self, PyObject* value, void*){
@@ -282,7 +282,7 @@ static auto weights = bob::extension::VariableDoc(
 );
 PyObject* PyBobLearnEMGMMMachine_getWeights(PyBobLearnEMGMMMachineObject* self, void*){
   BOB_TRY
-  return PyBlitzArrayCxx_AsConstNumpy(self->cxx->getWeights());
+  return PyBobLearnEM_AsConstNumpy(self->cxx->getWeights(), self->cxx->getMappedFile());
   BOB_CATCH_MEMBER("weights could not be read", 0)
 }
 int PyBobLearnEMGMMMachine_setWeights(PyBobLearnEMGMMMachineObject* self, PyObject* value, void*){
@@ -561,6 +561,50 @@ static PyObject* PyBobLearnEMGMMMachine_Load(PyBobLearnEMGMMMachineObject* self,
 }
 
 
+/*** save_mapped ***/
+static auto save_mapped = bob::extension::FunctionDoc(
+  "save_mapped",
+  "Save the GMMMachine to a flat binary file, which can be mapped in memory by :py:meth:`load_mapped`",
+  "The arrays are stored in the byte order of this computer."
+)
+.add_prototype("filename")
+.add_parameter("filename", "str", "The name of the file to write");
+static PyObject* PyBobLearnEMGMMMachine_SaveMapped(PyBobLearnEMGMMMachineObject* self, PyObject* args, PyObject* kwargs) {
+  BOB_TRY
+
+  char** kwlist = save_mapped.kwlist(0);
+  const char* filename;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "s", kwlist, &filename)) return 0;
+
+  self->cxx->saveMapped(filename);
+
+  BOB_CATCH_MEMBER("cannot save the data", 0)
+  Py_RETURN_NONE;
+}
+
+/*** load_mapped ***/
+static auto load_mapped = bob::extension::FunctionDoc(
+  "load_mapped",
+  "Load the GMMMachine from a file written by :py:meth:`save_mapped`, mapping it in memory",
+  "Instead of being copies, the weights, means and variances are views of the file: the processes which load the same file share a single copy of it in memory. "
+  "Modifying the machine afterwards does not modify the file."
+)
+.add_prototype("filename")
+.add_parameter("filename", "str", "The name of the file to map");
+static PyObject* PyBobLearnEMGMMMachine_LoadMapped(PyBobLearnEMGMMMachineObject* self, PyObject* args, PyObject* kwargs) {
+  BOB_TRY
+
+  char** kwlist = load_mapped.kwlist(0);
+  const char* filename;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "s", kwlist, &filename)) return 0;
+
+  self->cxx->loadMapped(filename);
+
+  BOB_CATCH_MEMBER("cannot load the data", 0)
+  Py_RETURN_NONE;
+}
+
+
 /*** is_similar_to ***/
 static auto is_similar_to = bob::extension::FunctionDoc(
   "is_similar_to",
@@ -896,6 +940,18 @@ static PyMethodDef PyBobLearnEMGMMMachine_methods[] = {
     METH_VARARGS|METH_KEYWORDS,
     load.doc()
   },
+  {
+    save_mapped.name(),
+    (PyCFunction)PyBobLearnEMGMMMachine_SaveMapped,
+    METH_VARARGS|METH_KEYWORDS,
+    save_mapped.doc()
+  },
+  {
+    load_mapped.name(),
+    (PyCFunction)PyBobLearnEMGMMMachine_LoadMapped,
+    METH_VARARGS|METH_KEYWORDS,
+    load_mapped.doc()
+  },
   {
     is_similar_to.name(),
     (PyCFunction)PyBobLearnEMGMMMachine_IsSimilarTo,
@@ -0,0 +1,419 @@
+/**
+ * @date Sun Oct 18 21:30:12 2026 +0200
+ *
+ * @brief Generic driver of the EM loop of the trainers
+ *
+ * Copyright (C) Idiap Research Institute, Martigny, Switzerland
+ */
+
+#ifndef BOB_LEARN_EM_EM_DRIVER_H
+#define BOB_LEARN_EM_EM_DRIVER_H
+
+#include <cmath>
+#include <cstdio>
+#include <ctime>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/random.hpp>
+
+#include <bob.io.base/HDF5File.h>
+
+#include <bob.learn.em/KMeansTrainer.h>
+#include <bob.learn.em/ML_GMMTrainer.h>
+#include <bob.learn.em/MAP_GMMTrainer.h>
+#include <bob.learn.em/ISVTrainer.h>
+#include <bob.learn.em/IVectorTrainer.h>
+#include <bob.learn.em/PLDATrainer.h>
+#include <bob.learn.em/EMPCATrainer.h>
+
+namespace bob { namespace learn { namespace em {
+
+/**
+ * @brief Describes how the EMDriver calls a trainer: the type of machine and
+ * data it works on, and whether it computes a likelihood. It is specialized
+ * for each trainer, as their initialize(), mStep() and finalize() methods do
+ * not all take the training data.
+ *
+ * computeLikelihood() is always called right after the eStep(), and should
+ * reuse its results rather than going through the data again.
+ *
+ * getRng(), saveState(), loadState() and loadMachine() are used for the
+ * checkpoints: their default versions are given by EMTrainerTraitsBase.
+ */
+template <typename T> struct EMTrainerTraits;
+
+/**
+ * @brief Default checkpointing behaviour of the traits: the trainer has a
+ * random number generator, and no state besides the accumulators of the
+ * E-step, which are recomputed when resuming.
+ */
+template <typename T, typename M> struct EMTrainerTraitsBase
+{
+  static boost::shared_ptr<boost::mt19937> getRng(const T& t)
+  { return t.getRng(); }
+  static void saveState(const T&, bob::io::base::HDF5File&) {}
+  static void loadState(T&, bob::io::base::HDF5File&) {}
+  static void loadMachine(M& m, bob::io::base::HDF5File& config)
+  { m.load(config); }
+};
+
+template <> struct EMTrainerTraits<KMeansTrainer>:
+  public EMTrainerTraitsBase<KMeansTrainer, KMeansMachine>
+{
+  typedef KMeansMachine machine_type;
+  typedef blitz::Array<double,2> data_type;
+  static const bool has_likelihood = true;
+
+  static void initialize(KMeansTrainer& t, machine_type& m, const data_type& d)
+  { t.initialize(m, d); }
+  static void mStep(KMeansTrainer& t, machine_type& m, const data_type&)
+  { t.mStep(m); }
+  static double computeLikelihood(KMeansTrainer& t, machine_type& m)
+  { return t.computeLikelihood(m); }
+  static void finalize(KMeansTrainer&, machine_type&, const data_type&) {}
+};
+
+template <> struct EMTrainerTraits<ML_GMMTrainer>:
+  public EMTrainerTraitsBase<ML_GMMTrainer, GMMMachine>
+{
+  typedef GMMMachine machine_type;
+  typedef blitz::Array<double,2> data_type;
+  static const bool has_likelihood = true;
+
+  static void initialize(ML_GMMTrainer& t, machine_type& m, const data_type&)
+  { t.initialize(m); }
+  static void mStep(ML_GMMTrainer& t, machine_type& m, const data_type&)
+  { t.mStep(m); }
+  static double computeLikelihood(ML_GMMTrainer& t, machine_type& m)
+  { return t.computeLikelihood(m); }
+  static void finalize(ML_GMMTrainer&, machine_type&, const data_type&) {}
+  static boost::shared_ptr<boost::mt19937> getRng(const ML_GMMTrainer&)
+  { return boost::shared_ptr<boost::mt19937>(); }
+};
+
+template <> struct EMTrainerTraits<MAP_GMMTrainer>:
+  public EMTrainerTraitsBase<MAP_GMMTrainer, GMMMachine>
+{
+  typedef GMMMachine machine_type;
+  typedef blitz::Array<double,2> data_type;
+  static const bool has_likelihood = true;
+
+  static void initialize(MAP_GMMTrainer& t, machine_type& m, const data_type&)
+  { t.initialize(m); }
+  static void mStep(MAP_GMMTrainer& t, machine_type& m, const data_type&)
+  { t.mStep(m); }
+  static double computeLikelihood(MAP_GMMTrainer& t, machine_type& m)
+  { return t.computeLikelihood(m); }
+  static void finalize(MAP_GMMTrainer&, machine_type&, const data_type&) {}
+  static boost::shared_ptr<boost::mt19937> getRng(const MAP_GMMTrainer&)
+  { return boost::shared_ptr<boost::mt19937>(); }
+};
+
+template <> struct EMTrainerTraits<ISVTrainer>:
+  public EMTrainerTraitsBase<ISVTrainer, ISVBase>
+{
+  typedef ISVBase machine_type;
+  typedef std::vector<std::vector<boost::shared_ptr<GMMStats> > > data_type;
+  static const bool has_likelihood = false;
+
+  static void initialize(ISVTrainer& t, machine_type& m, const data_type& d)
+  { t.initialize(m, d); }
+  static void mStep(ISVTrainer& t, machine_type& m, const data_type&)
+  { t.mStep(m); }
+  static double computeLikelihood(ISVTrainer&, machine_type&)
+  { return 0.; }
+  static void finalize(ISVTrainer&, machine_type&, const data_type&) {}
+};
+
+template <> struct EMTrainerTraits<IVectorTrainer>:
+  public EMTrainerTraitsBase<IVectorTrainer, IVectorMachine>
+{
+  typedef IVectorMachine machine_type;
+  typedef std::vector<GMMStats> data_type;
+  static const bool has_likelihood = false;
+
+  static void initialize(IVectorTrainer& t, machine_type& m, const data_type&)
+  { t.initialize(m); }
+  static void mStep(IVectorTrainer& t, machine_type& m, const data_type&)
+  { t.mStep(m); }
+  static double computeLikelihood(IVectorTrainer&, machine_type&)
+  { return 0.; }
+  static void finalize(IVectorTrainer&, machine_type&, const data_type&) {}
+  static void loadMachine(machine_type& m, bob::io::base::HDF5File& config)
+  { m.load(config); m.precompute(); }
+};
+
+template <> struct EMTrainerTraits<PLDATrainer>:
+  public EMTrainerTraitsBase<PLDATrainer, PLDABase>
+{
+  typedef PLDABase machine_type;
+  typedef std::vector<blitz::Array<double,2> > data_type;
+  static const bool has_likelihood = false;
+
+  static void initialize(PLDATrainer& t, machine_type& m, const data_type& d)
+  { t.initialize(m, d); }
+  static void mStep(PLDATrainer& t, machine_type& m, const data_type& d)
+  { t.mStep(m, d); }
+  static double computeLikelihood(PLDATrainer&, machine_type&)
+  { return 0.; }
+  static void finalize(PLDATrainer& t, machine_type& m, const data_type& d)
+  { t.finalize(m, d); }
+};
+
+template <> struct EMTrainerTraits<EMPCATrainer>:
+  public EMTrainerTraitsBase<EMPCATrainer, bob::learn::linear::Machine>
+{
+  typedef bob::learn::linear::Machine machine_type;
+  typedef blitz::Array<double,2> data_type;
+  static const bool has_likelihood = true;
+
+  static void initialize(EMPCATrainer& t, machine_type& m, const data_type& d)
+  { t.initialize(m, d); }
+  static void mStep(EMPCATrainer& t, machine_type& m, const data_type&)
+  { t.mStep(m); }
+  static double computeLikelihood(EMPCATrainer& t, machine_type& m)
+  { return t.computeEStepLikelihood(m); }
+  static void finalize(EMPCATrainer&, machine_type&, const data_type&) {}
+  static void saveState(const EMPCATrainer& t, bob::io::base::HDF5File& config)
+  { t.save(config); }
+  static void loadState(EMPCATrainer& t, bob::io::base::HDF5File& config)
+  { t.load(config); }
+};
+
+
+/**
+ * @brief Runs the EM loop of a trainer on a machine: initialization, an
+ * E-step, then (M-step, E-step) iterations until the maximum number of
+ * iterations is reached or, for the trainers which compute a likelihood,
+ * until its relative change falls below the convergence threshold.
+ *
+ * If a checkpoint file is set, the machine, the trainer state and the state
+ * of the random number generator are saved to it every given number of
+ * iterations and/or seconds. The file is first written next to its final
+ * location, then renamed, so that it is never left half written. If the
+ * file exists when train() is called, the training resumes from it, and
+ * follows exactly the same trajectory as if it had not been interrupted.
+ * The file is removed once the training is over. When resuming, the trainer
+ * is always initialized, on a copy of the machine, such that its caches are
+ * set up whatever the initialize flag.
+ */
+template <typename T>
+class EMDriver
+{
+  public:
+    typedef EMTrainerTraits<T> traits_type;
+    typedef typename traits_type::machine_type machine_type;
+    typedef typename traits_type::data_type data_type;
+    /**
+     * @brief Called after each iteration, with the number of the iteration
+     * (starting at 1) and the current likelihood (0 if the trainer does not
+     * compute any)
+     */
+    typedef boost::function<void (size_t, double)> callback_type;
+    /**
+     * @brief Replaces the E-step of the trainer, e.g. to run it in several
+     * processes (see ProcessEStep)
+     */
+    typedef boost::function<void (T&, machine_type&, const data_type&)> estep_type;
+
+    /**
+     * @brief Constructor. A negative convergence threshold disables the
+     * convergence check.
+     */
+    EMDriver(const size_t max_iterations=50,
+        const double convergence_threshold=-1., const bool initialize=true):
+      m_max_iterations(max_iterations),
+      m_convergence_threshold(convergence_threshold),
+      m_initialize(initialize),
+      m_checkpoint_iterations(0),
+      m_checkpoint_seconds(0.)
+    {}
+
+    /**
+     * @brief Trains the machine, and returns the number of iterations
+     */
+    size_t train(T& trainer, machine_type& machine, const data_type& data) const
+    {
+      size_t n_iterations = 0;
+      double likelihood = 0.;
+      if (!m_checkpoint.empty() && exists(m_checkpoint))
+      {
+        resume(trainer, machine, data, n_iterations, likelihood);
+        eStep(trainer, machine, data);
+      }
+      else
+      {
+        if (m_initialize)
+          traits_type::initialize(trainer, machine, data);
+
+        eStep(trainer, machine, data);
+        if (traits_type::has_likelihood)
+          likelihood = traits_type::computeLikelihood(trainer, machine);
+      }
+
+      std::time_t last_checkpoint = std::time(0);
+      while (n_iterations < m_max_iterations)
+      {
+        const double previous_likelihood = likelihood;
+        traits_type::mStep(trainer, machine, data);
+        eStep(trainer, machine, data);
+        ++n_iterations;
+
+        bool converged = false;
+        if (traits_type::has_likelihood)
+        {
+          likelihood = traits_type::computeLikelihood(trainer, machine);
+          const double convergence_value =
+            std::fabs((previous_likelihood - likelihood) / previous_likelihood);
+          converged = m_convergence_threshold >= 0. &&
+            convergence_value <= m_convergence_threshold;
+        }
+        if (m_callback) m_callback(n_iterations, likelihood);
+        if (converged) break;
+
+        if (!m_checkpoint.empty())
+        {
+          const std::time_t now = std::time(0);
+          if ((m_checkpoint_iterations > 0 && n_iterations % m_checkpoint_iterations == 0) ||
+              (m_checkpoint_seconds > 0. && std::difftime(now, last_checkpoint) >= m_checkpoint_seconds))
+          {
+            checkpoint(trainer, machine, n_iterations, likelihood);
+            last_checkpoint = now;
+          }
+        }
+      }
+
+      traits_type::finalize(trainer, machine, data);
+      if (!m_checkpoint.empty()) std::remove(m_checkpoint.c_str());
+      return n_iterations;
+    }
+
+    /**
+     * @brief Setters and getters
+     */
+    void setMaxIterations(const size_t max_iterations)
+    { m_max_iterations = max_iterations; }
+    size_t getMaxIterations() const { return m_max_iterations; }
+    void setConvergenceThreshold(const double convergence_threshold)
+    { m_convergence_threshold = convergence_threshold; }
+    double getConvergenceThreshold() const { return m_convergence_threshold; }
+    void setInitialize(const bool initialize) { m_initialize = initialize; }
+    bool getInitialize() const { return m_initialize; }
+    void setCallback(const callback_type& callback) { m_callback = callback; }
+    void setEStep(const estep_type& estep) { m_estep = estep; }
+
+    /**
+     * @brief Sets the checkpoint file, written every given number of
+     * iterations and/or seconds (0 disables the corresponding criterion).
+     * An empty filename disables the checkpoints.
+     */
+    void setCheckpoint(const std::string& filename,
+        const size_t every_iterations, const double every_seconds)
+    {
+      m_checkpoint = filename;
+      m_checkpoint_iterations = every_iterations;
+      m_checkpoint_seconds = every_seconds;
+    }
+    const std::string& getCheckpoint() const { return m_checkpoint; }
+
+  private:
+    void eStep(T& trainer, machine_type& machine, const data_type& data) const
+    {
+      if (m_estep) m_estep(trainer, machine, data);
+      else trainer.eStep(machine, data);
+    }
+
+    static bool exists(const std::string& filename)
+    {
+      std::FILE* f = std::fopen(filename.c_str(), "rb");
+      if (!f) return false;
+      std::fclose(f);
+      return true;
+    }
+
+    void checkpoint(const T& trainer, const machine_type& machine,
+        const size_t n_iterations, const double likelihood) const
+    {
+      const std::string tmp = m_checkpoint + ".tmp";
+      {
+        bob::io::base::HDF5File config(tmp, 'w');
+        config.set("iteration", static_cast<uint64_t>(n_iterations));
+        config.set("likelihood", likelihood);
+        config.createGroup("machine");
+        config.cd("machine");
+        machine.save(config);
+        config.cd("..");
+        config.createGroup("trainer");
+        config.cd("trainer");
+        traits_type::saveState(trainer, config);
+        config.cd("..");
+
+        // The state of the generator is written as its sequence of words
+        boost::shared_ptr<boost::mt19937> rng = traits_type::getRng(trainer);
+        if (rng)
+        {
+          std::stringstream ss;
+          ss << *rng;
+          std::vector<uint64_t> words;
+          uint64_t word;
+          while (ss >> word) words.push_back(word);
+          blitz::Array<uint64_t,1> state(words.size());
+          for (size_t i=0; i<words.size(); ++i) state(i) = words[i];
+          config.setArray("rng", state);
+        }
+      }
+      if (std::rename(tmp.c_str(), m_checkpoint.c_str()) != 0)
+        throw std::runtime_error("cannot move the checkpoint `" + tmp +
+          "' to `" + m_checkpoint + "'");
+    }
+
+    void resume(T& trainer, machine_type& machine, const data_type& data,
+        size_t& n_iterations, double& likelihood) const
+    {
+      // The initialization also sets up the caches of the trainer which
+      // only depend on the data; it is run on a copy of the machine, which
+      // is then overwritten with the checkpoint. It is hence required even
+      // if the machine was not to be initialized.
+      {
+        machine_type scratch(machine);
+        traits_type::initialize(trainer, scratch, data);
+      }
+
+      bob::io::base::HDF5File config(m_checkpoint, 'r');
+      n_iterations = static_cast<size_t>(config.read<uint64_t>("iteration"));
+      likelihood = config.read<double>("likelihood");
+      config.cd("machine");
+      traits_type::loadMachine(machine, config);
+      config.cd("..");
+      config.cd("trainer");
+      traits_type::loadState(trainer, config);
+      config.cd("..");
+
+      boost::shared_ptr<boost::mt19937> rng = traits_type::getRng(trainer);
+      if (rng && config.contains("rng"))
+      {
+        const blitz::Array<uint64_t,1> state = config.readArray<uint64_t,1>("rng");
+        std::stringstream ss;
+        for (int i=0; i<state.extent(0); ++i) ss << state(i) << ' ';
+        ss >> *rng;
+      }
+    }
+
+    size_t m_max_iterations;
+    double m_convergence_threshold;
+    bool m_initialize;
+    callback_type m_callback;
+    estep_type m_estep;
+    std::string m_checkpoint;
+    size_t m_checkpoint_iterations;
+    double m_checkpoint_seconds;
+};
+
+} } } // namespaces
+
+#endif // BOB_LEARN_EM_EM_DRIVER_H
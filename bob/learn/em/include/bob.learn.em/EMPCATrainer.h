@@ -12,6 +12,7 @@
 #define BOB_LEARN_EM_EMPCA_TRAINER_H
 
 #include <bob.learn.linear/machine.h>
+#include <bob.io.base/HDF5File.h>
 #include <blitz/array.h>
 
 namespace bob { namespace learn { namespace em {
@@ -86,9 +87,10 @@ class EMPCATrainer
 
     /**
      * @brief Calculates and saves statistics across the dataset, and saves
-     * these as m_z_{first,second}_order.
+     * these as m_z_first_order and m_sum_z_second_order, along with the sums
+     * over the samples required by the mStep() that follows.
      *
-     * The statistics will be used in the mStep() that follows.
+     * The samples are processed by blocks, using matrix products.
      */
     virtual void eStep(bob::learn::linear::Machine& machine,
       const blitz::Array<double,2>& ar);
@@ -106,6 +108,82 @@ class EMPCATrainer
      */
     virtual double computeLikelihood(bob::learn::linear::Machine& machine);
 
+    /**
+     * @brief Computes the same log likelihood as computeLikelihood(), for the
+     * parameters used by the last eStep() (or accStatistics() calls), from
+     * the sums of statistics of the E-step rather than from the covariance
+     * of the data. It does not require any product of size n_features x
+     * n_features, but is only valid before the next mStep().
+     */
+    double computeEStepLikelihood(const bob::learn::linear::Machine& machine) const;
+
+    /**
+     * @brief Resets the mean (stored in the machine) and the scatter before
+     * streaming the training data through accMeanVariance().
+     *
+     * This is the first step of the streaming initialization, for datasets
+     * that are given by chunks rather than as a single array.
+     */
+    void resetMeanVariance(bob::learn::linear::Machine& machine);
+
+    /**
+     * @brief Updates the mean (stored in the machine) and the scatter (if
+     * the likelihood is computed) with a chunk of the training data.
+     *
+     * The statistics of the chunk are merged with the current ones using
+     * the pairwise form of Welford's online update, such that the data is
+     * only read once.
+     */
+    void accMeanVariance(bob::learn::linear::Machine& machine,
+      const blitz::Array<double,2>& ar);
+
+    /**
+     * @brief Finishes the streaming initialization, using the mean and
+     * scatter given by accMeanVariance(), before the EM loop.
+     */
+    void initialize(bob::learn::linear::Machine& machine);
+
+    /**
+     * @brief Resets the sums of statistics before streaming the training
+     * data through accStatistics().
+     */
+    void resetStatistics();
+
+    /**
+     * @brief Streaming E-step: accumulates the sums of statistics required
+     * by mStep() for a chunk of the training data.
+     *
+     * Contrary to eStep(), the latent means of the samples are not kept.
+     */
+    void accStatistics(const bob::learn::linear::Machine& machine,
+      const blitz::Array<double,2>& ar);
+
+    /**
+     * @brief Performs a maximization step from the sums of statistics
+     * given by eStep() or accStatistics().
+     */
+    void mStep(bob::learn::linear::Machine& machine);
+
+    /**
+     * @brief Saves the sums of statistics given by eStep() or
+     * accStatistics(), e.g. on a shard of the data, such that they can be
+     * summed with the ones of the other shards before mStep()
+     */
+    void saveStatistics(bob::io::base::HDF5File& config) const;
+
+    /**
+     * @brief Loads sums of statistics saved by saveStatistics(), in place of
+     * the current ones. The trainer should have been initialized for the
+     * same machine.
+     */
+    void loadStatistics(bob::io::base::HDF5File& config);
+
+    /**
+     * @brief Adds the sums of statistics of another trainer to the ones of
+     * this trainer
+     */
+    void addStatistics(const EMPCATrainer& other);
+
     /**
      * @brief Sets \f$\sigma^2\f$ (Mostly for test purpose)
      */
@@ -116,6 +194,19 @@ class EMPCATrainer
      */
     double getSigma2() const { return m_sigma2; }
 
+    /**
+     * @brief Saves the state of the trainer which is not stored in the
+     * machine (\f$\sigma^2\f$, \f$W^T W\f$ and \f$M^{-1}\f$), e.g. to
+     * resume a training later on
+     */
+    void save(bob::io::base::HDF5File& config) const;
+
+    /**
+     * @brief Loads the state of the trainer saved by save(). The trainer
+     * should have been initialized with the same data beforehand.
+     */
+    void load(bob::io::base::HDF5File& config);
+
     /**
      * @brief Sets the Random Number Generator
      */
@@ -134,9 +225,13 @@ class EMPCATrainer
     bool m_compute_likelihood;
     boost::shared_ptr<boost::mt19937> m_rng;
 
-    blitz::Array<double,2> m_S; /// Covariance of the training data (required only if we need to compute the log likelihood)
+    blitz::Array<double,2> m_S; /// Scatter of the training data, which is (N-1) times its covariance (required only if we need to compute the log likelihood)
+    size_t m_n_mean_variance; /// Number of samples in the mean and the scatter
     blitz::Array<double,2> m_z_first_order; /// Current mean of the \f$z_{n}\f$ latent variable
-    blitz::Array<double,3> m_z_second_order; /// Current covariance of the \f$z_{n}\f$ latent variable
+    blitz::Array<double,2> m_sum_z_second_order; /// Current sum of the second order statistics \f$\sum_{n} E(z_{n} z_{n}^T) = Z^T Z + N \sigma^2 M^{-1}\f$
+    blitz::Array<double,2> m_sum_t_z; /// Current sum \f$\sum_{n} (t_{n} - \mu) E(z_{n})^T\f$
+    double m_sum_t_square; /// Current sum \f$\sum_{n} ||t_{n} - \mu||^2\f$
+    size_t m_n_samples; /// Number of samples in the current statistics
     blitz::Array<double,2> m_inW; /// The matrix product \f$W^T W\f$
     blitz::Array<double,2> m_invM; /// The matrix \f$inv(M)\f$, where \f$M = W^T W + \sigma^2 Id\f$
     double m_sigma2; /// The variance \f$sigma^2\f$ of the noise epsilon of the probabilistic model
@@ -144,24 +239,22 @@ class EMPCATrainer
 
     // Working arrays
     mutable blitz::Array<double,2> m_tmp_dxf; /// size dimensionality x n_features
-    mutable blitz::Array<double,1> m_tmp_d; /// size dimensionality
-    mutable blitz::Array<double,1> m_tmp_f; /// size n_features
     mutable blitz::Array<double,2> m_tmp_dxd_1; /// size dimensionality x dimensionality
     mutable blitz::Array<double,2> m_tmp_dxd_2; /// size dimensionality x dimensionality
     mutable blitz::Array<double,2> m_tmp_fxd_1; /// size n_features x dimensionality
     mutable blitz::Array<double,2> m_tmp_fxd_2; /// size n_features x dimensionality
-    mutable blitz::Array<double,2> m_tmp_fxf_1; /// size n_features x n_features
-    mutable blitz::Array<double,2> m_tmp_fxf_2; /// size n_features x n_features
+    mutable blitz::Array<double,2> m_tmp_bxf; /// size block x n_features (centred samples of a block)
+    mutable blitz::Array<double,2> m_tmp_bxd; /// size block x dimensionality (latent means of a block, streaming E-step)
 
 
     /**
      * @brief Initializes/resizes the (array) members
      */
     void initMembers(const bob::learn::linear::Machine& machine,
-      const blitz::Array<double,2>& ar);
+      const size_t n_samples, const size_t n_features);
     /**
      * @brief Computes the mean and the variance (if required) of the training
-     * data
+     * data, in a single pass
      */
     void computeMeanVariance(bob::learn::linear::Machine& machine,
       const blitz::Array<double,2>& ar);
@@ -181,18 +274,23 @@ class EMPCATrainer
      *   \f$W\f$ is the projection matrix (from the LinearMachine)
      */
     void computeInvM();
+    /**
+     * @brief Accumulates the statistics of a chunk of samples, by blocks,
+     * and sets the latent means of the samples in Z.
+     * m_tmp_dxf should contain \f$M^{-1} W^T\f$.
+     */
+    void accBlocks(const bob::learn::linear::Machine& machine,
+      const blitz::Array<double,2>& ar, blitz::Array<double,2>& Z);
     /**
      * @brief M-Step (part 1): Computes the new estimate of \f$W\f$ using the
      * new estimated statistics.
      */
-    void updateW(bob::learn::linear::Machine& machine,
-       const blitz::Array<double,2>& ar);
+    void updateW(bob::learn::linear::Machine& machine);
     /**
      * @brief M-Step (part 2): Computes the new estimate of \f$\sigma^2\f$ using
      * the new estimated statistics.
      */
-    void updateSigma2(bob::learn::linear::Machine& machine,
-       const blitz::Array<double,2>& ar);
+    void updateSigma2(bob::learn::linear::Machine& machine);
 };
 
 } } } // namespaces
@@ -213,6 +213,24 @@ class FABase
      */
     void setD(const blitz::Array<double,1>& d);
 
+    /**
+     * @brief Makes U, V and diag(d) views of the given arrays (for
+     * instance, of a MappedFile) instead of copies. If a UBM is set, the
+     * arrays should have CD rows. The mapped file the arrays belong to, if
+     * any, is kept mapped as long as this object lives.
+     */
+    void reference(const blitz::Array<double,2>& U,
+      const blitz::Array<double,2>& V, const blitz::Array<double,1>& d,
+      const boost::shared_ptr<const MappedFile>& file =
+        boost::shared_ptr<const MappedFile>());
+
+    /**
+     * @brief Returns the mapped file which the arrays were taken from by
+     * reference(), if any
+     */
+    const boost::shared_ptr<const MappedFile>& getMappedFile() const
+    { return m_mapped_file; }
+
 
     /**
      * @brief Estimates x from the GMM statistics considering the LPT
@@ -274,6 +292,9 @@ class FABase
     blitz::Array<double,2> m_U;
     blitz::Array<double,2> m_V;
     blitz::Array<double,1> m_d;
+    // The mapped file U, V and d may be views of; only replaced by
+    // reference(), since the other methods may keep using the same arrays
+    boost::shared_ptr<const MappedFile> m_mapped_file;
 
     // Vectors/Matrices precomputed in cache
     blitz::Array<double,1> m_cache_mean;
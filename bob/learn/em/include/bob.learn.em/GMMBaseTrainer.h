@@ -102,6 +102,28 @@ class GMMBaseTrainer
      */
     void setGMMStats(boost::shared_ptr<bob::learn::em::GMMStats> stats);
 
+    /**
+     * @brief Saves the statistics accumulated by the E-step, e.g. on a
+     * shard of the data, such that they can be summed with the ones of the
+     * other shards before the M-step
+     */
+    void saveStatistics(bob::io::base::HDF5File& config) const
+    { m_ss->save(config); }
+
+    /**
+     * @brief Loads statistics saved by saveStatistics(), in place of the
+     * accumulated ones
+     */
+    void loadStatistics(bob::io::base::HDF5File& config)
+    { m_ss->load(config); }
+
+    /**
+     * @brief Adds the statistics accumulated by another trainer to the
+     * ones of this trainer
+     */
+    void addStatistics(const GMMBaseTrainer& other)
+    { *m_ss += *other.m_ss; }
+
     /**
      * update means on each iteration
      */
@@ -296,15 +296,38 @@ class GMMMachine
     { return m_n_gaussians; }
 
     /**
-     * Save to a Configuration
+     * Save to a Configuration, with the means, variances and variance
+     * thresholds of all the Gaussians packed into n_gaussians x n_inputs
+     * datasets (version 2 of the layout)
      */
     void save(bob::io::base::HDF5File& config) const;
 
     /**
-     * Load from a Configuration
+     * Load from a Configuration, in either the packed layout or the former
+     * one with a group per Gaussian
      */
     void load(bob::io::base::HDF5File& config);
 
+    /**
+     * Save to a flat binary file which can be mapped in memory by
+     * loadMapped() (see MappedFile)
+     */
+    void saveMapped(const std::string& filename) const;
+
+    /**
+     * Load from a file written by saveMapped(), which is mapped in memory:
+     * the weights, means, variances and variance thresholds are views of
+     * the file, shared by all the processes which map it. The file stays
+     * mapped as long as the machine, or one of its Gaussians, lives.
+     */
+    void loadMapped(const std::string& filename);
+
+    /**
+     * Returns the file mapped by the last call to loadMapped(), if any
+     */
+    const boost::shared_ptr<const MappedFile>& getMappedFile() const
+    { return m_mapped_file; }
+
     /**
      * Load/Reload mean/variance supervector in cache
      */
@@ -319,6 +342,11 @@ class GMMMachine
      */
     void copy(const GMMMachine&);
 
+    /**
+     * Load from a Configuration saved with a group per Gaussian
+     */
+    void loadGroups(bob::io::base::HDF5File& config);
+
     /**
      * The number of Gaussian components
      */
@@ -339,6 +367,12 @@ class GMMMachine
      */
     blitz::Array<double,1> m_weights;
 
+    /**
+     * The mapped file the weights may be a view of. It is only replaced by
+     * loadMapped(), since the other methods may keep using the same array.
+     */
+    boost::shared_ptr<const MappedFile> m_mapped_file;
+
     /**
      * Update the mean and variance supervectors
      * in cache (into a 1D blitz array)
@@ -11,10 +11,13 @@
 
 #include <bob.io.base/HDF5File.h>
 #include <blitz/array.h>
+#include <boost/shared_ptr.hpp>
 #include <limits>
 
 namespace bob { namespace learn { namespace em {
 
+class MappedFile;
+
 /**
  * @brief This class implements a multivariate diagonal Gaussian distribution.
  */
@@ -156,6 +159,26 @@ class Gaussian
      */
     void applyVarianceThresholds();
 
+    /**
+     * Makes the mean, the variance and the variance flooring thresholds
+     * views of the given arrays (for instance, of a MappedFile) instead of
+     * copies. The variance is assumed to be floored already, and is not
+     * modified. The mapped file the arrays belong to, if any, is kept
+     * mapped as long as this Gaussian lives.
+     */
+    void reference(const blitz::Array<double,1>& mean,
+      const blitz::Array<double,1>& variance,
+      const blitz::Array<double,1>& variance_thresholds,
+      const boost::shared_ptr<const MappedFile>& file =
+        boost::shared_ptr<const MappedFile>());
+
+    /**
+     * Returns the mapped file which the arrays were taken from by
+     * reference(), if any
+     */
+    const boost::shared_ptr<const MappedFile>& getMappedFile() const
+    { return m_mapped_file; }
+
     /**
      * Output the log likelihood of the sample, x
      * @param x The data sample (feature vector)
@@ -240,6 +263,12 @@ class Gaussian
      * The number of inputs (feature dimensionality)
      */
     size_t m_n_inputs;
+
+    /**
+     * The mapped file the arrays may be views of. It is only replaced by
+     * reference(), since the other methods may keep using the same arrays.
+     */
+    boost::shared_ptr<const MappedFile> m_mapped_file;
 };
 
 } } } // namespaces
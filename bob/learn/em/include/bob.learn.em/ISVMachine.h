@@ -16,6 +16,7 @@
 #include <bob.learn.em/ISVBase.h>
 #include <bob.learn.em/GMMMachine.h>
 #include <bob.learn.em/LinearScoring.h>
+#include <bob.learn.em/ProbeCache.h>
 
 #include <bob.io.base/HDF5File.h>
 #include <boost/shared_ptr.hpp>
@@ -136,6 +137,12 @@ class ISVMachine
     const blitz::Array<double,1>& getZ() const
     { return m_z; }
 
+    /**
+     * @brief Returns the mean supervector of the enrolled model m + Dz
+     */
+    const blitz::Array<double,1>& getMeanSupervector() const
+    { return m_cache_mDz; }
+
     /**
      * @brief Returns the z speaker factors in order to update it
      */
@@ -187,6 +194,14 @@ class ISVMachine
      */
     double forward(const bob::learn::em::GMMStats& gmm_stats,
       const blitz::Array<double,1>& Ux);
+    /**
+     * @brief Computes a score for the given UBM statistics, reusing the Ux
+     * vector and centred statistics held by the given ProbeCache (which
+     * computes and stores them if this probe was not cached yet)
+     * @warning The cache must be bound to the ISVBase of this machine
+     */
+    double forward(const boost::shared_ptr<const bob::learn::em::GMMStats> gmm_stats,
+      bob::learn::em::ProbeCache& cache);
 
     /**
      * @brief Execute the machine
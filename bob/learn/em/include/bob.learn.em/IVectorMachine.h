@@ -94,6 +94,29 @@ class IVectorMachine
      */
     void load(bob::io::base::HDF5File& config);
 
+    /**
+     * @brief Saves model to a flat binary file which can be mapped in memory
+     * by loadMapped() (see MappedFile), with the arrays in cache if a UBM is
+     * set
+     */
+    void saveMapped(const std::string& filename) const;
+
+    /**
+     * @brief Loads model from a file written by saveMapped(), which is
+     * mapped in memory: \f$T\f$, \f$\Sigma\f$ and the arrays in cache are
+     * views of the file, shared by all the processes which map it. The
+     * file stays mapped as long as the machine lives. Resets the current
+     * state.
+     */
+    void loadMapped(const std::string& filename);
+
+    /**
+     * @brief Returns the file mapped by the last call to loadMapped(), if
+     * any
+     */
+    const boost::shared_ptr<const MappedFile>& getMappedFile() const
+    { return m_mapped_file; }
+
     /**
      * @brief Returns the UBM
      */
@@ -247,6 +270,11 @@ class IVectorMachine
      * @brief Resize cache and working arrays before updating cache
      */
     void resizePrecompute();
+    /**
+     * @brief Tells if the arrays in cache have the dimensions implied by
+     * the UBM and \f$T\f$
+     */
+    bool isCacheSized() const;
 
     // UBM
     boost::shared_ptr<bob::learn::em::GMMMachine> m_ubm;
@@ -262,6 +290,10 @@ class IVectorMachine
 
     blitz::Array<double,3> m_cache_Tct_sigmacInv;
     blitz::Array<double,3> m_cache_Tct_sigmacInv_Tc;
+    bool m_mapped; ///< Whether the cache was loaded by loadMapped()
+    ///< The file the arrays may be views of; only replaced by loadMapped(),
+    ///< since the other methods may keep using the same arrays
+    boost::shared_ptr<const MappedFile> m_mapped_file;
 
     mutable blitz::Array<double,1> m_tmp_d;
     mutable blitz::Array<double,1> m_tmp_t1;
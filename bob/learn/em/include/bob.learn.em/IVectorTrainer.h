@@ -110,6 +110,25 @@ class IVectorTrainer
     const blitz::Array<double,2>& getAccSnormij() const
     { return m_acc_Snormij; }
 
+    /**
+     * @brief Saves the accumulators of the E-step, e.g. on a shard of the
+     * data, such that they can be summed with the ones of the other shards
+     * before the M-step
+     */
+    void saveStatistics(bob::io::base::HDF5File& config) const;
+
+    /**
+     * @brief Loads accumulators saved by saveStatistics(), in place of the
+     * current ones
+     */
+    void loadStatistics(bob::io::base::HDF5File& config);
+
+    /**
+     * @brief Adds the accumulators of another trainer to the ones of this
+     * trainer
+     */
+    void addStatistics(const IVectorTrainer& other);
+
     /**
      * @brief Setters for the accumulators, Very useful if the e-Step needs
      * to be parallelized.
@@ -130,8 +149,19 @@ class IVectorTrainer
     void setRng(boost::shared_ptr<boost::mt19937> rng){
       m_rng = rng;
     };
+    boost::shared_ptr<boost::mt19937> getRng() const {
+      return m_rng;
+    };
+
+    bool getUpdateSigma() const
+    { return m_update_sigma; }
 
   protected:
+    /**
+     * @brief Resizes the accumulators and the working arrays
+     */
+    void resizeAccumulators(const int C, const int D, const int Rt);
+
     // Attributes
     bool m_update_sigma;
 
@@ -99,6 +99,27 @@ class JFABase
      */
     void load(bob::io::base::HDF5File& config);
 
+    /**
+     * @brief Saves model to a flat binary file which can be mapped in memory
+     * by loadMapped() (see MappedFile)
+     */
+    void saveMapped(const std::string& filename) const;
+
+    /**
+     * @brief Loads data from a file written by saveMapped(), which is
+     * mapped in memory: U, V and diag(d) are views of the file, shared by all the
+     * processes which map it. The file stays mapped as long as the
+     * machine lives. Resets the current state.
+     */
+    void loadMapped(const std::string& filename);
+
+    /**
+     * @brief Returns the file mapped by the last call to loadMapped(), if
+     * any
+     */
+    const boost::shared_ptr<const MappedFile>& getMappedFile() const
+    { return m_base.getMappedFile(); }
+
     /**
      * @brief Returns the UBM
      */
@@ -142,6 +142,27 @@ class KMeansTrainer
     void setFirstOrderStats(const blitz::Array<double,2>& firstOrderStats);
     void setAverageMinDistance(const double value) { m_average_min_distance = value; }
 
+    /**
+     * @brief Saves the statistics accumulated by the E-step, e.g. on a
+     * shard of the data, such that they can be summed with the ones of the
+     * other shards before the M-step
+     */
+    void saveStatistics(bob::io::base::HDF5File& config) const;
+
+    /**
+     * @brief Loads statistics saved by saveStatistics(), in place of the
+     * accumulated ones. The accumulators should have been sized for the
+     * same machine, e.g. by resetAccumulators().
+     */
+    void loadStatistics(bob::io::base::HDF5File& config);
+
+    /**
+     * @brief Adds the statistics accumulated by another trainer to the
+     * ones of this trainer. The average min distance is weighted by the
+     * number of samples of each trainer.
+     */
+    void addStatistics(const KMeansTrainer& other);
+
 
   private:
 
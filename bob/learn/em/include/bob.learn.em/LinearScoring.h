@@ -9,11 +9,15 @@
 
 #include <blitz/array.h>
 #include <boost/shared_ptr.hpp>
+#include <string>
 #include <vector>
 #include <bob.learn.em/GMMMachine.h>
 
 namespace bob { namespace learn { namespace em {
 
+class ISVMachine;
+class JFAMachine;
+
 /**
  * Compute a matrix of scores using linear scoring.
  *
@@ -77,6 +81,55 @@ void linearScoring(const std::vector<boost::shared_ptr<const bob::learn::em::GMM
                    const bool frame_length_normalisation,
                    blitz::Array<double,2>& scores);
 
+/**
+ * Compute a matrix of scores using linear scoring, within a memory budget.
+ *
+ * The models are processed in blocks and the test trials in tiles, so that
+ * the working memory stays below @c max_bytes whatever the number of models
+ * and test trials. In particular, @c models may wrap a memory-mapped file,
+ * in which case the model supervectors are read block by block.
+ *
+ * @param models        2D array of mean supervectors of the client models (one per row)
+ * @param ubm_mean      mean supervector of the world model
+ * @param ubm_variance  variance supervector of the world model
+ * @param test_stats    list of accumulate statistics for each test trial
+ * @param test_channelOffset  list of channel offset (for JFA/ISA for instance), or an empty list
+ * @param frame_length_normalisation   perform a normalisation by the number of feature vectors
+ * @param max_bytes     memory budget of the working arrays, in bytes (0 means unbounded)
+ * @param[out] scores 2D matrix of scores, <tt>scores[m, s]</tt> is the score for model @c m against statistics @c s
+ * @param n_threads     number of threads (1 by default; 0 means one per hardware thread)
+ * @warning the output scores matrix should have the correct size (number of models x number of test_stats)
+ */
+void linearScoring(const blitz::Array<double,2>& models,
+                   const blitz::Array<double,1>& ubm_mean, const blitz::Array<double,1>& ubm_variance,
+                   const std::vector<boost::shared_ptr<const bob::learn::em::GMMStats> >& test_stats,
+                   const std::vector<blitz::Array<double,1> >& test_channelOffset,
+                   const bool frame_length_normalisation,
+                   const size_t max_bytes,
+                   blitz::Array<double,2>& scores,
+                   const size_t n_threads=1);
+
+/**
+ * Compute a matrix of scores using linear scoring, within a memory budget,
+ * and write it to a file rather than keeping it in memory.
+ *
+ * The file is (re)created as a raw, row-major matrix of (number of models
+ * x number of test_stats) native 64-bit floats, which is memory-mapped and
+ * filled tile by tile.
+ *
+ * @param score_file    the name of the score file to create
+ *
+ * The other parameters are those of the previous function.
+ */
+void linearScoring(const blitz::Array<double,2>& models,
+                   const blitz::Array<double,1>& ubm_mean, const blitz::Array<double,1>& ubm_variance,
+                   const std::vector<boost::shared_ptr<const bob::learn::em::GMMStats> >& test_stats,
+                   const std::vector<blitz::Array<double,1> >& test_channelOffset,
+                   const bool frame_length_normalisation,
+                   const size_t max_bytes,
+                   const std::string& score_file,
+                   const size_t n_threads=1);
+
 /**
  * Compute a score using linear scoring.
  *
@@ -93,6 +146,46 @@ double linearScoring(const blitz::Array<double,1>& model,
                    const blitz::Array<double,1>& test_channelOffset,
                    const bool frame_length_normalisation);
 
+/**
+ * Compute a matrix of scores for a set of ISV models, each score being the
+ * one returned by ISVMachine::forward().
+ *
+ * The channel offset Ux of each test trial is estimated only once and shared
+ * by all the models, the test trials being distributed over several threads.
+ *
+ * @warning All the models must share the same ISVBase (same UBM and U).
+ *
+ * @param models      list of enrolled ISV models
+ * @param test_stats  list of accumulate statistics for each test trial
+ * @param[out] scores 2D matrix of scores, <tt>scores[m, s]</tt> is the score for model @c m against statistics @c s
+ * @param n_threads   number of threads used to estimate the channel offsets (1 by default; 0 means one per hardware thread)
+ * @warning the output scores matrix should have the correct size (number of models x number of test_stats)
+ */
+void linearScoring(const std::vector<boost::shared_ptr<const bob::learn::em::ISVMachine> >& models,
+                   const std::vector<boost::shared_ptr<const bob::learn::em::GMMStats> >& test_stats,
+                   blitz::Array<double,2>& scores,
+                   const size_t n_threads=1);
+
+/**
+ * Compute a matrix of scores for a set of JFA models, each score being the
+ * one returned by JFAMachine::forward().
+ *
+ * The channel offset Ux of each test trial is estimated only once and shared
+ * by all the models, the test trials being distributed over several threads.
+ *
+ * @warning All the models must share the same JFABase (same UBM and U).
+ *
+ * @param models      list of enrolled JFA models
+ * @param test_stats  list of accumulate statistics for each test trial
+ * @param[out] scores 2D matrix of scores, <tt>scores[m, s]</tt> is the score for model @c m against statistics @c s
+ * @param n_threads   number of threads used to estimate the channel offsets (1 by default; 0 means one per hardware thread)
+ * @warning the output scores matrix should have the correct size (number of models x number of test_stats)
+ */
+void linearScoring(const std::vector<boost::shared_ptr<const bob::learn::em::JFAMachine> >& models,
+                   const std::vector<boost::shared_ptr<const bob::learn::em::GMMStats> >& test_stats,
+                   blitz::Array<double,2>& scores,
+                   const size_t n_threads=1);
+
 } } } // namespaces
 
 #endif // BOB_LEARN_EM_LINEARSCORING_H
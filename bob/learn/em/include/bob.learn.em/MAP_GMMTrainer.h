@@ -79,6 +79,12 @@ class MAP_GMMTrainer
      */
     bool setPriorGMM(boost::shared_ptr<bob::learn::em::GMMMachine> prior_gmm);
 
+    /**
+     * @brief Returns the GMM used as a prior for MAP adaptation
+     */
+    boost::shared_ptr<bob::learn::em::GMMMachine> getPriorGMM() const
+    { return m_prior_gmm; }
+
     /**
      * @brief Calculates and saves statistics across the dataset,
      * and saves these as m_ss. Calculates the average
@@ -102,6 +108,36 @@ class MAP_GMMTrainer
      */
     void mStep(bob::learn::em::GMMMachine& gmm);
 
+    /**
+     * @brief Performs a maximum a posteriori (MAP) update of the GMM
+     * parameters using the given statistics (e.g. the ones accumulated over
+     * all the enrollment sessions of a model) instead of m_ss
+     */
+    void mStep(bob::learn::em::GMMMachine& gmm,
+      const bob::learn::em::GMMStats& stats);
+
+    /**
+     * @brief Incremental MAP adaptation: adds the statistics of the new
+     * data, computed with the prior GMM, to the statistics accumulated so
+     * far for this model, and re-derives the adapted GMM from them.
+     * The cost only depends on the number of new frames, and the result is
+     * the same as a single MAP iteration on all the data.
+     */
+    void adapt(bob::learn::em::GMMMachine& gmm,
+      bob::learn::em::GMMStats& stats, const blitz::Array<double,2>& data);
+
+    /**
+     * @brief One-pass MAP adaptation of the means only: accumulates the
+     * statistics of the data with the prior GMM and writes the adapted mean
+     * supervector (of size n_gaussians*n_inputs, in the layout of
+     * GMMMachine::getMeanSupervector()) into the given array, e.g. a row of
+     * a matrix of models. No GMMMachine is created, and the working
+     * statistics are reused from one call to the next.
+     * The update_* flags are ignored: only the means are adapted.
+     */
+    void adaptMeanSupervector(const blitz::Array<double,2>& data,
+      blitz::Array<double,1>& mean_supervector);
+
     /**
      * @brief Computes the likelihood using current estimates of the latent
      * variables
@@ -110,6 +146,17 @@ class MAP_GMMTrainer
       return m_gmm_base_trainer.computeLikelihood(gmm);
     }
 
+    /**
+     * @brief Saves, loads and sums the statistics of the E-step, to run it
+     * on shards of the data (see GMMBaseTrainer)
+     */
+    void saveStatistics(bob::io::base::HDF5File& config) const
+    { m_gmm_base_trainer.saveStatistics(config); }
+    void loadStatistics(bob::io::base::HDF5File& config)
+    { m_gmm_base_trainer.loadStatistics(config); }
+    void addStatistics(const MAP_GMMTrainer& other)
+    { m_gmm_base_trainer.addStatistics(other.m_gmm_base_trainer); }
+
     bool getReynoldsAdaptation()
     {return m_reynolds_adaptation;}
 
@@ -165,6 +212,7 @@ class MAP_GMMTrainer
     /// cache to avoid re-allocation
     mutable blitz::Array<double,1> m_cache_alpha;
     mutable blitz::Array<double,1> m_cache_ml_weights;
+    bob::learn::em::GMMStats m_cache_stats; ///< used by adaptMeanSupervector()
 };
 
 } } } // namespaces
@@ -76,6 +76,17 @@ class ML_GMMTrainer{
       return m_gmm_base_trainer.computeLikelihood(gmm);
     }
 
+    /**
+     * @brief Saves, loads and sums the statistics of the E-step, to run it
+     * on shards of the data (see GMMBaseTrainer)
+     */
+    void saveStatistics(bob::io::base::HDF5File& config) const
+    { m_gmm_base_trainer.saveStatistics(config); }
+    void loadStatistics(bob::io::base::HDF5File& config)
+    { m_gmm_base_trainer.loadStatistics(config); }
+    void addStatistics(const ML_GMMTrainer& other)
+    { m_gmm_base_trainer.addStatistics(other.m_gmm_base_trainer); }
+
 
     /**
      * @brief Assigns from a different ML_GMMTrainer
@@ -0,0 +1,172 @@
+/**
+ * @date Sun Oct 18 23:10:12 2026 +0200
+ *
+ * @brief A flat binary file of aligned double arrays, which can be mapped
+ * in memory such that the machines use its arrays in place
+ *
+ * Copyright (C) Idiap Research Institute, Martigny, Switzerland
+ */
+
+#ifndef BOB_LEARN_EM_MAPPED_FILE_H
+#define BOB_LEARN_EM_MAPPED_FILE_H
+
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <bob.core/array_copy.h>
+#include <bob.core/check.h>
+#include <blitz/array.h>
+#include <boost/cstdint.hpp>
+#include <boost/noncopyable.hpp>
+
+namespace bob { namespace learn { namespace em {
+
+namespace detail {
+  /* Description of an array, in the table at the end of a mapped file */
+  struct MappedEntry
+  {
+    char name[48];
+    boost::uint64_t ndim;
+    boost::uint64_t shape[4];
+    boost::uint64_t offset;
+  };
+}
+
+/**
+ * @brief Writes named double arrays (of up to 4 dimensions) and scalars to
+ * a flat binary file, readable by MappedFile.
+ *
+ * The file starts with a header holding the type of the machine which
+ * wrote it, followed by the arrays, each of them in C order and aligned on
+ * 64 bytes, and ends with the table of the arrays. Numbers are written in
+ * the byte order of the host: the file is meant to be shared by the
+ * processes of a machine (or of similar machines), not to be exchanged.
+ *
+ * The data is written into <tt>filename.tmp</tt>, which is renamed to
+ * @c filename by close(), such that readers never see a partial file.
+ */
+class MappedFileWriter: private boost::noncopyable
+{
+  public:
+    /**
+     * @brief Starts a new file for a machine of the given type
+     */
+    MappedFileWriter(const std::string& filename, const std::string& type);
+
+    /**
+     * @brief Removes the temporary file if close() was not called
+     */
+    ~MappedFileWriter();
+
+    /**
+     * @brief Appends an array
+     */
+    template <int N>
+    void setArray(const std::string& name, const blitz::Array<double,N>& array)
+    {
+      boost::uint64_t shape[4] = {1, 1, 1, 1};
+      for (int k=0; k<N; ++k) shape[k] = array.extent(k);
+      if (bob::core::array::isCZeroBaseContiguous(array))
+        write(name, array.data(), N, shape);
+      else
+        write(name, bob::core::array::ccopy(array).data(), N, shape);
+    }
+
+    /**
+     * @brief Appends a scalar
+     */
+    void set(const std::string& name, const double value);
+
+    /**
+     * @brief Writes the table of the arrays and publishes the file
+     */
+    void close();
+
+  private:
+    void write(const std::string& name, const double* data,
+      const int ndim, const boost::uint64_t* shape);
+
+    std::string m_filename;
+    std::string m_tmp_filename;
+    std::ofstream m_stream;
+    std::vector<detail::MappedEntry> m_entries;
+    boost::uint64_t m_offset;
+    bool m_closed;
+};
+
+/**
+ * @brief A file written by MappedFileWriter, mapped in memory.
+ *
+ * The arrays returned by readArray() are views into the mapping: the
+ * processes which map the same file share a single copy of it in the page
+ * cache, and the file is only read when its pages are first used. The
+ * mapping is private (copy-on-write): writing into an array, for instance
+ * when a machine is updated, makes a private copy of the pages concerned
+ * and never modifies the file.
+ *
+ * The views do not own their data: the file is unmapped when this object
+ * is destroyed. The machines hence hold the MappedFile they use through a
+ * boost::shared_ptr, and so should any object which keeps a view (e.g. the
+ * numpy arrays returned by the Python bindings).
+ */
+class MappedFile: private boost::noncopyable
+{
+  public:
+    /**
+     * @brief Maps the given file, checking that it was written for a
+     * machine of the given type
+     */
+    MappedFile(const std::string& filename, const std::string& type);
+
+    /**
+     * @brief Unmaps the file
+     */
+    ~MappedFile();
+
+    /**
+     * @brief Tells if the given address lies within the mapping, i.e. if
+     * it is (in) a view of this file
+     */
+    bool holds(const void* data) const
+    { return data >= m_data && data < m_data + m_size; }
+
+    /**
+     * @brief Tells if the file holds an array (or a scalar) with this name
+     */
+    bool contains(const std::string& name) const
+    { return m_entries.find(name) != m_entries.end(); }
+
+    /**
+     * @brief Returns a view of the given array, which should have N
+     * dimensions
+     */
+    template <int N>
+    blitz::Array<double,N> readArray(const std::string& name) const
+    {
+      boost::uint64_t shape[4];
+      double* data = get(name, N, shape);
+      blitz::TinyVector<int,N> extent;
+      for (int k=0; k<N; ++k) extent(k) = static_cast<int>(shape[k]);
+      return blitz::Array<double,N>(data, extent, blitz::neverDeleteData);
+    }
+
+    /**
+     * @brief Returns the given scalar
+     */
+    double read(const std::string& name) const;
+
+  private:
+    double* get(const std::string& name, const int ndim,
+      boost::uint64_t* shape) const;
+
+    std::string m_filename;
+    char* m_data;
+    size_t m_size;
+    std::map<std::string, const detail::MappedEntry*> m_entries;
+};
+
+} } } // namespaces
+
+#endif // BOB_LEARN_EM_MAPPED_FILE_H
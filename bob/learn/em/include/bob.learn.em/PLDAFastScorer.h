@@ -0,0 +1,162 @@
+/**
+ * @date Sun Oct 18 15:08:14 2026 +0200
+ *
+ * @brief Closed-form PLDA scorer for single-sample enrollment
+ *
+ * Copyright (C) Idiap Research Institute, Martigny, Switzerland
+ */
+
+#ifndef BOB_LEARN_EM_PLDAFASTSCORER_H
+#define BOB_LEARN_EM_PLDAFASTSCORER_H
+
+#include <blitz/array.h>
+#include <bob.io.base/HDF5File.h>
+#include <bob.learn.em/PLDAMachine.h>
+
+namespace bob { namespace learn { namespace em {
+
+/**
+ * @brief Scores PLDA trials where the model is enrolled with a single
+ * sample, using the closed form of the log-likelihood ratio
+ * \f$s(x,y) = \tilde{x}^T Q \tilde{x} + \tilde{y}^T Q \tilde{y} + 2 \tilde{x}^T P \tilde{y} + c\f$,
+ * where \f$\tilde{x} = x - \mu\f$,
+ * \f$P = \frac{1}{2} \beta F \gamma_2 F^T \beta\f$,
+ * \f$Q = \frac{1}{2} \beta F (\gamma_2 - \gamma_1) F^T \beta\f$ and
+ * \f$c = l_2 - 2 l_1\f$.\n
+ * The score is the one returned by PLDAMachine::forward() for a model
+ * enrolled with \f$x\f$ and the probe \f$y\f$, and is symmetric.
+ * The scorer only depends on \f$P\f$, \f$Q\f$, \f$\mu\f$ and \f$c\f$, and
+ * can be saved and loaded independently of the PLDABase.
+ */
+class PLDAFastScorer
+{
+  public:
+    /**
+     * @brief Default constructor. Builds an otherwise invalid 0-dimensional
+     * scorer.
+     */
+    PLDAFastScorer();
+
+    /**
+     * @brief Builds the scorer of the given PLDABase
+     */
+    PLDAFastScorer(const bob::learn::em::PLDABase& plda_base);
+
+    /**
+     * @brief Starts a new PLDAFastScorer from an existing configuration
+     * object.
+     * @param config HDF5 configuration file
+     */
+    PLDAFastScorer(bob::io::base::HDF5File& config);
+
+    /**
+     * @brief Copies another PLDAFastScorer
+     */
+    PLDAFastScorer(const PLDAFastScorer& other);
+
+    /**
+     * @brief Just to virtualise the destructor
+     */
+    virtual ~PLDAFastScorer();
+
+    /**
+     * @brief Assigns from a different PLDAFastScorer
+     */
+    PLDAFastScorer& operator=(const PLDAFastScorer& other);
+
+    /**
+     * @brief Equal to
+     */
+    bool operator==(const PLDAFastScorer& b) const;
+
+    /**
+     * @brief Not equal to.\n Defined as the negation of operator==
+     */
+    bool operator!=(const PLDAFastScorer& b) const;
+
+    /**
+     * @brief Similar to
+     */
+    bool is_similar_to(const PLDAFastScorer& b, const double r_epsilon=1e-5,
+      const double a_epsilon=1e-8) const;
+
+    /**
+     * @brief Loads data from an existing configuration object. Resets the
+     * current state.
+     * @param config HDF5 configuration file
+     */
+    void load(bob::io::base::HDF5File& config);
+
+    /**
+     * @brief Saves the scorer to a configuration object.
+     * @param config HDF5 configuration file
+     */
+    void save(bob::io::base::HDF5File& config) const;
+
+    /**
+     * @brief Gets the feature dimensionality
+     */
+    size_t getDimD() const
+    { return m_mu.extent(0); }
+
+    /**
+     * @brief Gets the \f$P\f$ matrix of the cross term
+     */
+    const blitz::Array<double,2>& getP() const
+    { return m_P; }
+
+    /**
+     * @brief Gets the \f$Q\f$ matrix of the quadratic terms
+     */
+    const blitz::Array<double,2>& getQ() const
+    { return m_Q; }
+
+    /**
+     * @brief Gets the \f$\mu\f$ mean vector of the PLDA model
+     */
+    const blitz::Array<double,1>& getMu() const
+    { return m_mu; }
+
+    /**
+     * @brief Gets the constant term \f$c\f$
+     */
+    double getConstant() const
+    { return m_constant; }
+
+    /**
+     * @brief Computes the log-likelihood ratio of a single trial
+     * @param model the enrollment sample of the model
+     * @param probe the probe sample
+     */
+    double score(const blitz::Array<double,1>& model,
+      const blitz::Array<double,1>& probe) const;
+
+    /**
+     * @brief Computes the log-likelihood ratios of all the models against
+     * all the probes, with matrix products
+     * @param models the enrollment samples of the models, one per row
+     * @param probes the probe samples, one per row
+     * @param[out] scores 2D matrix of scores, <tt>scores[m, s]</tt> is the score for model @c m against probe @c s
+     * @warning the output scores matrix should have the correct size (number of models x number of probes)
+     */
+    void score(const blitz::Array<double,2>& models,
+      const blitz::Array<double,2>& probes,
+      blitz::Array<double,2>& scores) const;
+
+  private:
+    /**
+     * @brief Computes \f$\tilde{x}^T Q \tilde{x}\f$ for each row of the
+     * given (centred) samples
+     */
+    void quadraticTerms(const blitz::Array<double,2>& samples,
+      blitz::Array<double,1>& res) const;
+
+    blitz::Array<double,2> m_P; ///< \f$P = \frac{1}{2} \beta F \gamma_2 F^T \beta\f$
+    blitz::Array<double,2> m_Q; ///< \f$Q = \frac{1}{2} \beta F (\gamma_2 - \gamma_1) F^T \beta\f$
+    blitz::Array<double,1> m_mu; ///< \f$\mu\f$ mean vector of the PLDA model
+    double m_constant; ///< \f$c = l_2 - 2 l_1\f$
+};
+
+} } } // namespaces
+
+#endif // BOB_LEARN_EM_PLDAFASTSCORER_H
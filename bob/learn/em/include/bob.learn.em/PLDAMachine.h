@@ -13,12 +13,16 @@
 
 #include <blitz/array.h>
 #include <bob.io.base/HDF5File.h>
+#include <boost/shared_ptr.hpp>
 #include <map>
+#include <vector>
 #include <iostream>
 #include <stdexcept>
 
 namespace bob { namespace learn { namespace em {
 
+class MappedFile;
+
 /**
  * @brief This class is a container for the \f$F\f$, \f$G\f$ and \f$\Sigma\f$
  * matrices and the mean vector \f$\mu\f$ of a PLDA model. This also
@@ -102,6 +106,29 @@ class PLDABase
      */
     void save(bob::io::base::HDF5File& config) const;
 
+    /**
+     * @brief Saves an existing machine to a flat binary file which can be
+     * mapped in memory by loadMapped() (see MappedFile). The
+     * \f$\gamma_a\f$'s are not saved.
+     * @param filename The name of the file to write
+     */
+    void saveMapped(const std::string& filename) const;
+    /**
+     * @brief Loads data from a file written by saveMapped(), which is
+     * mapped in memory: \f$F\f$, \f$G\f$, \f$\Sigma\f$, \f$\mu\f$
+     * and the precomputed matrices are views of the file, shared by all
+     * the processes which map it. The file stays mapped as long as the
+     * machine lives. Resets the current state.
+     * @param filename The name of the file to map
+     */
+    void loadMapped(const std::string& filename);
+    /**
+     * @brief Returns the file mapped by the last call to loadMapped(), if
+     * any
+     */
+    const boost::shared_ptr<const MappedFile>& getMappedFile() const
+    { return m_mapped_file; }
+
     /**
      * @brief Resizes the PLDABase.
      * @warning \f$F\f$, \f$G\f$, \f$\Sigma\f$, \f$\mu\f$ and the variance
@@ -306,7 +333,8 @@ class PLDABase
      * \f$l_{a} = \frac{a}{2} ( -D log(2\pi) -log|\Sigma| +log|\alpha| +log|\gamma_a|)\f$
      */
     bool hasLogLikeConstTerm(const size_t a) const
-    { return (m_cache_loglike_constterm.find(a) != m_cache_loglike_constterm.end()); }
+    { return (a < m_table_loglike_constterm.size() ||
+        m_cache_loglike_constterm.find(a) != m_cache_loglike_constterm.end()); }
     /**
      * @brief Gets the log likelihood constant term for a given \f$a\f$
      * (number of samples)
@@ -334,13 +362,40 @@ class PLDABase
      * \f$\gamma_a = (Id + a F^T \beta F)^{-1}\f$
      */
     bool hasGamma(const size_t a) const
-    { return (m_cache_gamma.find(a) != m_cache_gamma.end()); }
+    { return (a < m_table_gamma.size() ||
+        m_cache_gamma.find(a) != m_cache_gamma.end()); }
 
     /**
      * @brief Clears the maps (\f$\gamma_a\f$ and loglike_constterm_a).
      */
     void clearMaps();
 
+    /**
+     * @brief Precomputes \f$\gamma_a\f$ and the log likelihood constant
+     * term \f$l_a\f$ for all the numbers of samples \f$0 \leq a \leq\f$
+     * max_n_samples, and stores them in flat tables indexed by \f$a\f$.
+     *
+     * Once the tables are filled, getGamma() and getLogLikeConstTerm() (and
+     * the PLDAMachine scoring methods relying on them) are plain lookups,
+     * which neither allocate nor modify this object, and may therefore be
+     * called concurrently from several threads. Values for larger \f$a\f$
+     * are still looked up in (or added to) the maps.
+     *
+     * @warning The tables are cleared whenever the parameters of the model
+     *   change (precompute()), and are neither saved nor compared.
+     */
+    void precomputeTables(const size_t max_n_samples);
+    /**
+     * @brief Returns the number of entries of the precomputed tables, i.e.
+     * \f$\gamma_a\f$ and \f$l_a\f$ are tabulated for \f$a <\f$ this value
+     */
+    size_t getTableSize() const
+    { return m_table_gamma.size(); }
+    /**
+     * @brief Clears the precomputed tables
+     */
+    void clearTables();
+
     /**
      * @brief Gets the log-likelihood of an observation, given the current model
      * and the latent variables (point estimate).\n
@@ -394,12 +449,20 @@ class PLDABase
      * @brief \f$l_{a} = \frac{a}{2} ( -D log(2*\pi) -log|\Sigma| +log|\alpha| +log|\gamma_a|)\f$
      */
     std::map<size_t, double> m_cache_loglike_constterm;
+    /**
+     * @brief \f$\gamma_a\f$ and \f$l_a\f$ for \f$0 \leq a <\f$ size,
+     * filled by precomputeTables()
+     */
+    std::vector<blitz::Array<double,2> > m_table_gamma;
+    std::vector<double> m_table_loglike_constterm;
+    /**
+     * @brief The mapped file the arrays may be views of; only replaced by
+     * loadMapped(), since the other methods may keep using the same arrays
+     */
+    boost::shared_ptr<const MappedFile> m_mapped_file;
 
     // working arrays
-    mutable blitz::Array<double,1> m_tmp_d_1; ///< Cache vector of size dim_d
-    mutable blitz::Array<double,1> m_tmp_d_2; ///< Cache vector of size dim_d
     mutable blitz::Array<double,2> m_tmp_d_ng_1; ///< Cache matrix of size dim_d x dim_g
-    mutable blitz::Array<double,2> m_tmp_nf_nf_1; ///< Cache matrix of size dim_f x dim_f
     mutable blitz::Array<double,2> m_tmp_ng_ng_1; ///< Cache matrix of size dim_g x dim_g
 
     // private methods
@@ -680,21 +743,10 @@ class PLDAMachine
     std::map<size_t, double> m_cache_loglike_constterm;
 
 
-    // working arrays
-    mutable blitz::Array<double,1> m_tmp_d_1; ///< Cache vector of size dim_d
-    mutable blitz::Array<double,1> m_tmp_d_2; ///< Cache vector of size dim_d
-    mutable blitz::Array<double,1> m_tmp_nf_1; ///< Cache vector of size dim_f
-    mutable blitz::Array<double,1> m_tmp_nf_2; ///< Cache vector of size dim_f
-    mutable blitz::Array<double,2> m_tmp_nf_nf_1; ///< Cache vector of size dim_f dim_f
-
     /**
      * @brief Resizes the PLDAMachine
      */
     void resize(const size_t dim_d, const size_t dim_f, const size_t dim_g);
-    /**
-     * @brief Resize working arrays
-     */
-    void resizeTmp();
 };
 
 } } } // namespaces
@@ -0,0 +1,44 @@
+/**
+ * @date Sun Oct 18 14:26:52 2026 +0200
+ *
+ * @brief Batched scoring of PLDA models
+ *
+ * Copyright (C) Idiap Research Institute, Martigny, Switzerland
+ */
+
+#ifndef BOB_LEARN_EM_PLDASCORING_H
+#define BOB_LEARN_EM_PLDASCORING_H
+
+#include <blitz/array.h>
+#include <boost/shared_ptr.hpp>
+#include <vector>
+#include <bob.learn.em/PLDAMachine.h>
+
+namespace bob { namespace learn { namespace em {
+
+/**
+ * Compute a matrix of PLDA log-likelihood ratios, each score being the one
+ * returned by PLDAMachine::forward() for a single probe sample.
+ *
+ * For a model enrolled with \f$n\f$ samples and a probe \f$x\f$, the score
+ * is \f$k_m + W_m^T \gamma_{n+1} f_x + \frac{1}{2} f_x^T (\gamma_{n+1} - \gamma_1) f_x\f$,
+ * where \f$f_x = F^T \beta (x - \mu)\f$, \f$W_m\f$ is the weighted sum of the
+ * model and \f$k_m\f$ only depends on the model. \f$f_x\f$ is hence computed
+ * once per probe and \f$k_m\f$ and \f$\gamma_{n+1} W_m\f$ once per model, the
+ * scores being obtained by matrix products over the models enrolled with
+ * the same number of samples.
+ *
+ * @warning All the models must share the same PLDABase.
+ *
+ * @param models      list of enrolled PLDA models
+ * @param probes      2D array of probe samples, one per row
+ * @param[out] scores 2D matrix of scores, <tt>scores[m, s]</tt> is the score for model @c m against probe @c s
+ * @warning the output scores matrix should have the correct size (number of models x number of probes)
+ */
+void pldaScoring(const std::vector<boost::shared_ptr<const bob::learn::em::PLDAMachine> >& models,
+                 const blitz::Array<double,2>& probes,
+                 blitz::Array<double,2>& scores);
+
+} } } // namespaces
+
+#endif // BOB_LEARN_EM_PLDASCORING_H
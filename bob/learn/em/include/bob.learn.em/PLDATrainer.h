@@ -76,6 +76,8 @@ class PLDATrainer
 
     /**
      * @brief Performs some initialization before the E- and M-steps.
+     * The centred training samples are stored here once for all the
+     * iterations: the E- and M-steps must be given the same training set.
      */
     void initialize(bob::learn::em::PLDABase& machine,
       const std::vector<blitz::Array<double,2> >& v_ar);
@@ -113,6 +115,36 @@ class PLDATrainer
     bool getUseSumSecondOrder() const
     { return m_use_sum_second_order; }
 
+    /**
+     * @brief Sets whether the trainer runs in low-memory mode. In this mode,
+     * neither the centred training samples nor the (first and second order)
+     * statistics of the latent variables of each sample are stored: the
+     * E-step streams the identities, computes the statistics of their
+     * samples on the fly and only keeps the sums required by the M-step.
+     * The memory used no longer depends on the size of the training set,
+     * but getZFirstOrder() and getZSecondOrder() are not available.
+     * This takes effect at the next call to initialize().
+     */
+    void setLowMemory(const bool v) { m_low_memory = v; }
+    /**
+     * @brief Tells whether the trainer runs in low-memory mode
+     */
+    bool getLowMemory() const
+    { return m_low_memory; }
+
+    /**
+     * @brief Sets the number of threads used by the E- and M-steps (0 means
+     * one per hardware thread). The identities are split into as many
+     * chunks, each accumulating its own partial sums, which are then added
+     * in a fixed order: the results only depend on the number of threads.
+     */
+    void setNThreads(const size_t n_threads) { m_n_threads = n_threads; }
+    /**
+     * @brief Gets the number of threads used by the E- and M-steps
+     */
+    size_t getNThreads() const
+    { return m_n_threads; }
+
     /**
      * @brief This enum defines different methods for initializing the \f$F\f$
      * subspace
@@ -197,7 +229,10 @@ class PLDATrainer
      * @brief Gets the z first order statistics (mostly for test purposes)
      */
     const std::vector<blitz::Array<double,2> >& getZFirstOrder() const
-    { return m_cache_z_first_order;}
+    { if(m_low_memory)
+        throw std::runtime_error("You should disable the low_memory flag to use this feature");
+      return m_cache_z_first_order;
+    }
     /**
      * @brief Gets the z second order statistics (mostly for test purposes)
      */
@@ -209,6 +244,8 @@ class PLDATrainer
     const std::vector<blitz::Array<double,3> >& getZSecondOrder() const
     { if(m_use_sum_second_order)
         throw std::runtime_error("You should disable the use_sum_second_order flag to use this feature");
+      if(m_low_memory)
+        throw std::runtime_error("You should disable the low_memory flag to use this feature");
       return m_cache_z_second_order;
     }
 
@@ -218,6 +255,16 @@ class PLDATrainer
     void enroll(bob::learn::em::PLDAMachine& plda_machine,
       const blitz::Array<double,2>& ar) const;
 
+    /**
+     * @brief Adds enrollment samples to a PLDAMachine, keeping the ones it
+     * was already enrolled with. As the statistics of the enrollment samples
+     * are additive, only the new samples are processed: the result is the
+     * same as enrolling with all the samples at once, at a cost that does
+     * not depend on the number of samples previously enrolled.
+     */
+    void enrollAppend(bob::learn::em::PLDAMachine& plda_machine,
+      const blitz::Array<double,2>& ar) const;
+
 
     /**
      * @brief Sets the Random Number Generator
@@ -240,6 +287,8 @@ class PLDATrainer
 	    size_t m_dim_f; ///< Size/rank of the \f$F\f$ subspace
 	    size_t m_dim_g; ///< Size/rank of the \f$G\f$ subspace
 	    bool m_use_sum_second_order; ///< If set, only the sum of the second order statistics is stored/allocated
+	    bool m_low_memory; ///< If set, no per-sample data or statistics are stored (only their sums)
+	    size_t m_n_threads; ///< Number of threads used by the E- and M-steps
 	    InitFMethod m_initF_method; ///< Initialization method for \f$F\f$
 	    double m_initF_ratio; ///< Ratio/factor used for the initialization of \f$F\f$
 	    InitGMethod m_initG_method; ///< Initialization method for \f$G\f$
@@ -249,9 +298,13 @@ class PLDATrainer
 
 	    // Statistics and covariance computed during the training process
 	    blitz::Array<double,2> m_cache_S; ///< Covariance of the training data
+	    blitz::Array<double,2> m_cache_X; ///< Centred training samples \f$x_{ij}-\mu\f$, stacked (nsamples x dim_d)
+	    blitz::Array<double,2> m_cache_Z; ///< First order statistics of all the samples, stacked (nsamples x (dim_f+dim_g)): m_cache_z_first_order holds views on its rows
 	    std::vector<blitz::Array<double,2> > m_cache_z_first_order; ///< Current mean of the z_{n} latent variable (1 for each sample)
 	    blitz::Array<double,2> m_cache_sum_z_second_order; ///< Current sum of the covariance of the z_{n} latent variable
 	    std::vector<blitz::Array<double,3> > m_cache_z_second_order; ///< Current covariance of the z_{n} latent variable
+	    blitz::Array<double,2> m_cache_sum_x_zt; ///< Low-memory mode: \f$\sum_{ij} (x_{ij}-\mu) E\{z_{ij}\}^T\f$, accumulated by the E-step
+	    blitz::Array<double,1> m_cache_sum_x_square; ///< Low-memory mode: \f$\sum_{ij} (x_{ij}-\mu)^2\f$, computed by initialize()
 	    // Precomputed
 	    /**
 	     * @brief Number of training samples for each individual in the training set
@@ -271,18 +324,18 @@ class PLDATrainer
 
     // Working arrays
     mutable blitz::Array<double,1> m_tmp_nf_1; ///< vector of dimension dim_f
-    mutable blitz::Array<double,1> m_tmp_nf_2; ///< vector of dimension dim_f
-    mutable blitz::Array<double,1> m_tmp_ng_1; ///< vector of dimension dim_f
     mutable blitz::Array<double,1> m_tmp_D_1; ///< vector of dimension dim_d
     mutable blitz::Array<double,1> m_tmp_D_2; ///< vector of dimension dim_d
     mutable blitz::Array<double,2> m_tmp_nfng_nfng; ///< matrix of dimension (dim_f+dim_g)x(dim_f+dim_g)
-    mutable blitz::Array<double,2> m_tmp_D_nfng_1; ///< matrix of dimension (dim_d)x(dim_f+dim_g)
     mutable blitz::Array<double,2> m_tmp_D_nfng_2; ///< matrix of dimension (dim_d)x(dim_f+dim_g)
 
     // internal methods
     void computeMeanVariance(bob::learn::em::PLDABase& machine,
       const std::vector<blitz::Array<double,2> >& v_ar);
     void initMembers(const std::vector<blitz::Array<double,2> >& v_ar);
+    void initZFirstOrder();
+    void initCentredData(bob::learn::em::PLDABase& machine,
+      const std::vector<blitz::Array<double,2> >& v_ar);
     void initFGSigma(bob::learn::em::PLDABase& machine,
       const std::vector<blitz::Array<double,2> >& v_ar);
     void initF(bob::learn::em::PLDABase& machine,
@@ -293,6 +346,8 @@ class PLDATrainer
       const std::vector<blitz::Array<double,2> >& v_ar);
 
     void checkTrainingData(const std::vector<blitz::Array<double,2> >& v_ar);
+    void checkLowMemory() const;
+    size_t getNSamples() const;
     void precomputeFromFGSigma(bob::learn::em::PLDABase& machine);
     void precomputeLogLike(bob::learn::em::PLDABase& machine,
       const std::vector<blitz::Array<double,2> >& v_ar);
@@ -0,0 +1,88 @@
+/**
+ * @date Sun Oct 18 10:12:31 2026 +0200
+ *
+ * @brief Helpers to split independent loops across several threads
+ *
+ * Copyright (C) Idiap Research Institute, Martigny, Switzerland
+ */
+
+#ifndef BOB_LEARN_EM_PARALLEL_H
+#define BOB_LEARN_EM_PARALLEL_H
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/ref.hpp>
+#include <boost/thread.hpp>
+
+namespace bob { namespace learn { namespace em {
+
+/**
+ * @brief Returns the number of threads to use: @c n_threads if it is
+ * strictly positive, the number of hardware threads otherwise.
+ */
+inline size_t getNThreads(const size_t n_threads=0)
+{
+  if (n_threads > 0) return n_threads;
+  const size_t n_hw = boost::thread::hardware_concurrency();
+  return n_hw > 0 ? n_hw : 1;
+}
+
+namespace detail {
+
+template <typename F>
+void parallelForChunk(F& f, const size_t begin, const size_t end, std::string& error)
+{
+  try {
+    f(begin, end);
+  }
+  catch (std::exception& e) {
+    error = e.what();
+  }
+  catch (...) {
+    error = "unknown exception";
+  }
+}
+
+} // namespace detail
+
+/**
+ * @brief Splits the range [0, n) into (at most) @c n_threads contiguous
+ * chunks and calls <tt>f(begin, end)</tt> on each of them from a separate
+ * thread. The call returns once all chunks have been processed.
+ *
+ * @c f is shared by all threads: any working array it needs should be
+ * allocated inside its call operator, so that each chunk gets its own.
+ * If a chunk throws, the first error message is rethrown as a
+ * std::runtime_error in the calling thread.
+ *
+ * @param n          number of iterations
+ * @param n_threads  number of threads (0 means one per hardware thread)
+ * @param f          functor with a <tt>void operator()(size_t, size_t)</tt>
+ */
+template <typename F>
+void parallelFor(const size_t n, const size_t n_threads, F& f)
+{
+  const size_t n_chunks = std::min(n, getNThreads(n_threads));
+  if (n_chunks <= 1) {
+    if (n > 0) f(0, n);
+    return;
+  }
+
+  std::vector<std::string> errors(n_chunks);
+  boost::thread_group threads;
+  for (size_t k=0; k<n_chunks; ++k)
+    threads.create_thread(boost::bind(&detail::parallelForChunk<F>, boost::ref(f),
+      n*k/n_chunks, n*(k+1)/n_chunks, boost::ref(errors[k])));
+  threads.join_all();
+
+  for (size_t k=0; k<n_chunks; ++k)
+    if (!errors[k].empty()) throw std::runtime_error(errors[k]);
+}
+
+} } } // namespaces
+
+#endif // BOB_LEARN_EM_PARALLEL_H
@@ -0,0 +1,192 @@
+/**
+ * @date Sun Oct 18 11:02:47 2026 +0200
+ *
+ * @brief A cache of the probe-dependent quantities used when scoring
+ * ISV/JFA models
+ *
+ * Copyright (C) Idiap Research Institute, Martigny, Switzerland
+ */
+
+#ifndef BOB_LEARN_EM_PROBECACHE_H
+#define BOB_LEARN_EM_PROBECACHE_H
+
+#include <list>
+#include <map>
+
+#include <blitz/array.h>
+#include <boost/shared_ptr.hpp>
+
+#include <bob.learn.em/GMMStats.h>
+#include <bob.learn.em/FABase.h>
+#include <bob.learn.em/ISVBase.h>
+#include <bob.learn.em/JFABase.h>
+
+namespace bob { namespace learn { namespace em {
+
+/**
+ * @brief Caches, for each probe (GMMStats), the channel offset Ux and the
+ * centred first order statistics used by linear scoring, so that they are
+ * computed only once when a probe is scored against several models
+ * (enrolled models, Z-/T-norm cohorts, ...).
+ *
+ * A cache is bound to a single ISVBase or JFABase and can be shared by all
+ * the machines using it. Its size is bounded by a memory budget, the least
+ * recently used probes being evicted first.
+ *
+ * @warning Probes are identified by their GMMStats object: the cache must
+ *   be cleared if the statistics of a cached probe or the U matrix / UBM of
+ *   the base are modified.
+ */
+class ProbeCache
+{
+  public:
+    /**
+     * @brief Builds a cache for the machines sharing the given ISVBase
+     *
+     * @param isv_base   The ISVBase of the machines
+     * @param max_bytes  The memory budget of the cached arrays, in bytes
+     */
+    ProbeCache(const boost::shared_ptr<bob::learn::em::ISVBase> isv_base,
+      const size_t max_bytes);
+
+    /**
+     * @brief Builds a cache for the machines sharing the given JFABase
+     *
+     * @param jfa_base   The JFABase of the machines
+     * @param max_bytes  The memory budget of the cached arrays, in bytes
+     */
+    ProbeCache(const boost::shared_ptr<bob::learn::em::JFABase> jfa_base,
+      const size_t max_bytes);
+
+    /**
+     * @brief Just to virtualise the destructor
+     */
+    virtual ~ProbeCache();
+
+    /**
+     * @brief Returns the ISVBase this cache is bound to (empty if it is
+     * bound to a JFABase)
+     */
+    const boost::shared_ptr<bob::learn::em::ISVBase> getISVBase() const
+    { return m_isv_base; }
+
+    /**
+     * @brief Returns the JFABase this cache is bound to (empty if it is
+     * bound to an ISVBase)
+     */
+    const boost::shared_ptr<bob::learn::em::JFABase> getJFABase() const
+    { return m_jfa_base; }
+
+    /**
+     * @brief Returns the memory budget, in bytes
+     */
+    size_t getMaxBytes() const
+    { return m_max_bytes; }
+
+    /**
+     * @brief Sets the memory budget, in bytes, evicting the least recently
+     * used probes if required
+     */
+    void setMaxBytes(const size_t max_bytes);
+
+    /**
+     * @brief Returns the memory currently used by the cached arrays, in bytes
+     */
+    size_t getNBytes() const;
+
+    /**
+     * @brief Returns the number of cached probes
+     */
+    size_t getSize() const
+    { return m_entries.size(); }
+
+    /**
+     * @brief Returns the number of lookups that were served from the cache
+     */
+    size_t getNHits() const
+    { return m_n_hits; }
+
+    /**
+     * @brief Returns the number of lookups that required a computation
+     */
+    size_t getNMisses() const
+    { return m_n_misses; }
+
+    /**
+     * @brief Tells whether the given probe is currently cached
+     */
+    bool contains(const bob::learn::em::GMMStats& gmm_stats) const
+    { return m_entries.find(&gmm_stats) != m_entries.end(); }
+
+    /**
+     * @brief Removes all the cached probes (the hit/miss counters are kept)
+     */
+    void clear();
+
+    /**
+     * @brief Returns the channel offset Ux of the given probe, computing
+     * and caching it if required
+     */
+    blitz::Array<double,1> getUx(const boost::shared_ptr<const bob::learn::em::GMMStats> gmm_stats);
+
+    /**
+     * @brief Returns the centred first order statistics of the given probe
+     * (F - N.(m + Ux)) / T, as used by linear scoring, computing and caching
+     * them if required
+     */
+    blitz::Array<double,1> getCentredStats(const boost::shared_ptr<const bob::learn::em::GMMStats> gmm_stats);
+
+  private:
+    // Not copyable, as entries keep iterators into the LRU list
+    ProbeCache(const ProbeCache& other);
+    ProbeCache& operator=(const ProbeCache& other);
+
+    typedef std::list<const bob::learn::em::GMMStats*> lru_type;
+
+    struct Entry
+    {
+      boost::shared_ptr<const bob::learn::em::GMMStats> stats;
+      blitz::Array<double,1> Ux;
+      blitz::Array<double,1> centred_stats;
+      lru_type::iterator lru;
+    };
+
+    /**
+     * @brief Returns the FABase of the ISVBase/JFABase
+     */
+    const bob::learn::em::FABase& getBase() const;
+
+    /**
+     * @brief Returns the memory used by a single entry, in bytes
+     */
+    size_t getEntryBytes() const;
+
+    /**
+     * @brief Returns the entry of the given probe, computing it if required,
+     * and marks it as the most recently used one
+     */
+    const Entry& lookup(const boost::shared_ptr<const bob::learn::em::GMMStats> gmm_stats);
+
+    /**
+     * @brief Evicts the least recently used probes until n_entries more
+     * entries fit into the memory budget (or the cache is empty)
+     */
+    void evict(const size_t n_entries);
+
+    boost::shared_ptr<bob::learn::em::ISVBase> m_isv_base;
+    boost::shared_ptr<bob::learn::em::JFABase> m_jfa_base;
+    size_t m_max_bytes;
+
+    std::map<const bob::learn::em::GMMStats*, Entry> m_entries;
+    lru_type m_lru;
+
+    size_t m_n_hits;
+    size_t m_n_misses;
+
+    // Working arrays
+    blitz::Array<double,1> m_tmp_x;
+};
+
+} } } // namespaces
+
+#endif // BOB_LEARN_EM_PROBECACHE_H
@@ -0,0 +1,343 @@
+/**
+ * @date Sun Oct 18 21:52:40 2026 +0200
+ *
+ * @brief Runs the E-step of a trainer in several worker processes
+ *
+ * Copyright (C) Idiap Research Institute, Martigny, Switzerland
+ */
+
+#ifndef BOB_LEARN_EM_PROCESS_ESTEP_H
+#define BOB_LEARN_EM_PROCESS_ESTEP_H
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <bob.learn.em/ProcessPool.h>
+#include <bob.learn.em/KMeansTrainer.h>
+#include <bob.learn.em/ML_GMMTrainer.h>
+#include <bob.learn.em/MAP_GMMTrainer.h>
+#include <bob.learn.em/IVectorTrainer.h>
+
+namespace bob { namespace learn { namespace em {
+
+namespace detail {
+
+/**
+ * @brief Wraps a block of doubles of the shared memory into a blitz array
+ */
+template <int N>
+blitz::Array<double,N> wrapBuffer(const double* buffer,
+  const blitz::TinyVector<int,N>& shape)
+{
+  return blitz::Array<double,N>(const_cast<double*>(buffer), shape,
+    blitz::neverDeleteData);
+}
+
+/**
+ * @brief The k-th of n contiguous shards of the rows of the data
+ */
+inline blitz::Array<double,2> shard(const blitz::Array<double,2>& data,
+  const size_t k, const size_t n)
+{
+  const int n_samples = data.extent(0);
+  return data(blitz::Range(n_samples*k/n, n_samples*(k+1)/n - 1),
+    blitz::Range::all());
+}
+
+inline std::vector<GMMStats> shard(const std::vector<GMMStats>& data,
+  const size_t k, const size_t n)
+{
+  const size_t n_samples = data.size();
+  return std::vector<GMMStats>(data.begin() + n_samples*k/n,
+    data.begin() + n_samples*(k+1)/n);
+}
+
+inline size_t nSamples(const blitz::Array<double,2>& data)
+{ return data.extent(0); }
+inline size_t nSamples(const std::vector<GMMStats>& data)
+{ return data.size(); }
+
+} // namespace detail
+
+/**
+ * @brief Describes how the parameters of the machine and the statistics of
+ * the E-step of a trainer are written to (and read from) flat blocks of
+ * doubles, which are exchanged between processes. The statistics should be
+ * additive, such that the ones of several shards of the data are reduced by
+ * an element-wise sum.
+ */
+template <typename T> struct ProcessEStepTraits;
+
+template <> struct ProcessEStepTraits<KMeansTrainer>
+{
+  typedef KMeansMachine machine_type;
+  typedef blitz::Array<double,2> data_type;
+
+  static size_t machineSize(const machine_type& m)
+  { return m.getNMeans() * m.getNInputs(); }
+  static void packMachine(const machine_type& m, double* buffer)
+  { detail::wrapBuffer(buffer, blitz::shape(m.getNMeans(), m.getNInputs())) = m.getMeans(); }
+  static void unpackMachine(machine_type& m, const double* buffer)
+  { m.setMeans(detail::wrapBuffer(buffer, blitz::shape(m.getNMeans(), m.getNInputs()))); }
+  // the E-step resets the accumulators itself
+  static void setUpWorker(KMeansTrainer&, machine_type&) {}
+
+  // zeroeth and first order statistics, and the sum of the min distances
+  static size_t statisticsSize(const KMeansTrainer&, const machine_type& m)
+  { return m.getNMeans() * (m.getNInputs() + 1) + 1; }
+  static void packStatistics(const KMeansTrainer& t, const machine_type& m, double* buffer)
+  {
+    const int C = m.getNMeans(), D = m.getNInputs();
+    detail::wrapBuffer(buffer, blitz::shape(C)) = t.getZeroethOrderStats();
+    detail::wrapBuffer(buffer + C, blitz::shape(C, D)) = t.getFirstOrderStats();
+    buffer[C*(D+1)] = t.getAverageMinDistance() * blitz::sum(t.getZeroethOrderStats());
+  }
+  static void unpackStatistics(KMeansTrainer& t, machine_type& m, const double* buffer)
+  {
+    const int C = m.getNMeans(), D = m.getNInputs();
+    t.resetAccumulators(m);
+    t.setZeroethOrderStats(detail::wrapBuffer(buffer, blitz::shape(C)));
+    t.setFirstOrderStats(detail::wrapBuffer(buffer + C, blitz::shape(C, D)));
+    const double n = blitz::sum(t.getZeroethOrderStats());
+    t.setAverageMinDistance(n > 0. ? buffer[C*(D+1)] / n : 0.);
+  }
+};
+
+/**
+ * @brief Common to the GMM trainers, which both accumulate GMMStats
+ */
+template <typename T> struct GMMProcessEStepTraits
+{
+  typedef GMMMachine machine_type;
+  typedef blitz::Array<double,2> data_type;
+
+  // weights, means and variances
+  static size_t machineSize(const machine_type& m)
+  { return m.getNGaussians() * (2 * m.getNInputs() + 1); }
+  static void packMachine(const machine_type& m, double* buffer)
+  {
+    const int C = m.getNGaussians(), D = m.getNInputs();
+    detail::wrapBuffer(buffer, blitz::shape(C)) = m.getWeights();
+    detail::wrapBuffer(buffer + C, blitz::shape(C, D)) = m.getMeans();
+    detail::wrapBuffer(buffer + C + C*D, blitz::shape(C, D)) = m.getVariances();
+  }
+  static void unpackMachine(machine_type& m, const double* buffer)
+  {
+    const int C = m.getNGaussians(), D = m.getNInputs();
+    m.setWeights(detail::wrapBuffer(buffer, blitz::shape(C)));
+    m.setMeans(detail::wrapBuffer(buffer + C, blitz::shape(C, D)));
+    m.setVariances(detail::wrapBuffer(buffer + C + C*D, blitz::shape(C, D)));
+  }
+  // sizes the statistics, without touching the machine
+  static void setUpWorker(T& t, machine_type& m)
+  { t.base_trainer().initialize(m); }
+
+  // T, log_likelihood, n, sumPx and sumPxx
+  static size_t statisticsSize(const T&, const machine_type& m)
+  { return 2 + m.getNGaussians() * (2 * m.getNInputs() + 1); }
+  static void packStatistics(T& t, const machine_type& m, double* buffer)
+  {
+    const int C = m.getNGaussians(), D = m.getNInputs();
+    const GMMStats& ss = *t.base_trainer().getGMMStats();
+    buffer[0] = static_cast<double>(ss.T);
+    buffer[1] = ss.log_likelihood;
+    detail::wrapBuffer(buffer + 2, blitz::shape(C)) = ss.n;
+    detail::wrapBuffer(buffer + 2 + C, blitz::shape(C, D)) = ss.sumPx;
+    detail::wrapBuffer(buffer + 2 + C + C*D, blitz::shape(C, D)) = ss.sumPxx;
+  }
+  static void unpackStatistics(T& t, machine_type& m, const double* buffer)
+  {
+    const int C = m.getNGaussians(), D = m.getNInputs();
+    GMMStats& ss = *t.base_trainer().getGMMStats();
+    ss.resize(C, D);
+    ss.T = static_cast<size_t>(buffer[0]);
+    ss.log_likelihood = buffer[1];
+    ss.n = detail::wrapBuffer(buffer + 2, blitz::shape(C));
+    ss.sumPx = detail::wrapBuffer(buffer + 2 + C, blitz::shape(C, D));
+    ss.sumPxx = detail::wrapBuffer(buffer + 2 + C + C*D, blitz::shape(C, D));
+  }
+};
+
+template <> struct ProcessEStepTraits<ML_GMMTrainer>:
+  public GMMProcessEStepTraits<ML_GMMTrainer> {};
+
+template <> struct ProcessEStepTraits<MAP_GMMTrainer>:
+  public GMMProcessEStepTraits<MAP_GMMTrainer> {};
+
+template <> struct ProcessEStepTraits<IVectorTrainer>
+{
+  typedef IVectorMachine machine_type;
+  typedef std::vector<GMMStats> data_type;
+
+  // T and sigma
+  static size_t machineSize(const machine_type& m)
+  { return m.getSupervectorLength() * (m.getDimRt() + 1); }
+  static void packMachine(const machine_type& m, double* buffer)
+  {
+    const int CD = m.getSupervectorLength(), Rt = m.getDimRt();
+    detail::wrapBuffer(buffer, blitz::shape(CD, Rt)) = m.getT();
+    detail::wrapBuffer(buffer + CD*Rt, blitz::shape(CD)) = m.getSigma();
+  }
+  static void unpackMachine(machine_type& m, const double* buffer)
+  {
+    const int CD = m.getSupervectorLength(), Rt = m.getDimRt();
+    m.updateT() = detail::wrapBuffer(buffer, blitz::shape(CD, Rt));
+    m.updateSigma() = detail::wrapBuffer(buffer + CD*Rt, blitz::shape(CD));
+    m.precompute();
+  }
+  // the E-step resets the accumulators itself
+  static void setUpWorker(IVectorTrainer&, machine_type&) {}
+
+  // acc_Nij_wij2, acc_Fnormij_wij and, if sigma is updated, acc_Nij and
+  // acc_Snormij
+  static size_t statisticsSize(const IVectorTrainer& t, const machine_type& m)
+  {
+    const size_t C = m.getNGaussians(), D = m.getNInputs(), Rt = m.getDimRt();
+    return C*Rt*Rt + C*D*Rt + (t.getUpdateSigma() ? C + C*D : 0);
+  }
+  static void packStatistics(const IVectorTrainer& t, const machine_type& m, double* buffer)
+  {
+    const int C = m.getNGaussians(), D = m.getNInputs(), Rt = m.getDimRt();
+    detail::wrapBuffer(buffer, blitz::shape(C, Rt, Rt)) = t.getAccNijWij2();
+    buffer += C*Rt*Rt;
+    detail::wrapBuffer(buffer, blitz::shape(C, D, Rt)) = t.getAccFnormijWij();
+    buffer += C*D*Rt;
+    if (t.getUpdateSigma()) {
+      detail::wrapBuffer(buffer, blitz::shape(C)) = t.getAccNij();
+      detail::wrapBuffer(buffer + C, blitz::shape(C, D)) = t.getAccSnormij();
+    }
+  }
+  static void unpackStatistics(IVectorTrainer& t, machine_type& m, const double* buffer)
+  {
+    const int C = m.getNGaussians(), D = m.getNInputs(), Rt = m.getDimRt();
+    t.resetAccumulators(m);
+    t.setAccNijWij2(detail::wrapBuffer(buffer, blitz::shape(C, Rt, Rt)));
+    buffer += C*Rt*Rt;
+    t.setAccFnormijWij(detail::wrapBuffer(buffer, blitz::shape(C, D, Rt)));
+    buffer += C*D*Rt;
+    if (t.getUpdateSigma()) {
+      t.setAccNij(detail::wrapBuffer(buffer, blitz::shape(C)));
+      t.setAccSnormij(detail::wrapBuffer(buffer + C, blitz::shape(C, D)));
+    }
+  }
+};
+
+
+/**
+ * @brief Runs the E-step of a trainer on contiguous shards of the data, in
+ * several worker processes, e.g. to isolate code which is not thread-safe.
+ * It is a drop-in replacement of <tt>trainer.eStep(machine, data)</tt>, to
+ * be given to EMDriver::setEStep().
+ *
+ * The workers are forked by the constructor, and get their shard of the
+ * data from the memory of the process: neither the data nor the trainer is
+ * ever copied. It should hence be created while the process is still
+ * single-threaded, e.g. before releasing the Python GIL, since a forked
+ * child only inherits the calling thread, and not the locks held by the
+ * others. Each worker sets up its copy of the trainer on its first E-step,
+ * such that the trainer may be initialized after the fork. At each call,
+ * the parameters of the machine are published to the workers through POSIX
+ * shared memory; each worker writes the statistics of its shard into its own
+ * block of shared memory, and they are summed into the trainer, ready for
+ * the mStep(). All calls should be made with the trainer, machine and data
+ * given to the constructor, and the shape of the machine should not change.
+ * The workers exit when the last copy of this object is destroyed.
+ */
+template <typename T>
+class ProcessEStep
+{
+  public:
+    typedef ProcessEStepTraits<T> traits_type;
+    typedef typename traits_type::machine_type machine_type;
+    typedef typename traits_type::data_type data_type;
+
+    /**
+     * @brief Constructor, which forks the given number of worker processes
+     * (at most one per sample)
+     */
+    ProcessEStep(const size_t n_processes, T& trainer, machine_type& machine,
+        const data_type& data):
+      m_impl(new Impl(n_processes, trainer, machine, data))
+    {}
+
+    void operator()(T& trainer, machine_type& machine, const data_type& data)
+    { m_impl->eStep(trainer, machine, data); }
+
+    size_t getNProcesses() const { return m_impl->n_processes; }
+
+  private:
+    struct Impl
+    {
+      Impl(const size_t n, T& t, machine_type& m, const data_type& d):
+        n_processes(n), trainer(&t), machine(&m), data(&d),
+        machine_size(0), statistics_size(0)
+      {
+        if (n == 0)
+          throw std::runtime_error("the number of processes should be strictly positive");
+        n_processes = std::max<size_t>(1,
+          std::min(n_processes, detail::nSamples(d)));
+        machine_size = traits_type::machineSize(m);
+        statistics_size = traits_type::statisticsSize(t, m);
+        buffer.reset(new SharedMemory(sizeof(double) *
+          (machine_size + n_processes * statistics_size)));
+        sum.resize(statistics_size);
+        pool.reset(new ProcessPool(n_processes,
+          boost::bind(&Impl::work, this, _1)));
+      }
+
+      void eStep(T& t, machine_type& m, const data_type& d)
+      {
+        if (&t != trainer || &m != machine || &d != data)
+          throw std::runtime_error("the E-step in worker processes should always be called with the same trainer, machine and data");
+
+        double* const shared = static_cast<double*>(buffer->get());
+        traits_type::packMachine(m, shared);
+        pool->run();
+
+        // Reduces the statistics of the workers
+        std::fill(sum.begin(), sum.end(), 0.);
+        for (size_t k=0; k<n_processes; ++k)
+        {
+          const double* slot = shared + machine_size + k * statistics_size;
+          for (size_t i=0; i<statistics_size; ++i) sum[i] += slot[i];
+        }
+        traits_type::unpackStatistics(t, m, &sum[0]);
+      }
+
+      // Runs in the k-th worker, on its own copy of the trainer and machine
+      void work(const size_t k)
+      {
+        if (!shard)
+        {
+          shard.reset(new data_type(detail::shard(*data, k, n_processes)));
+          traits_type::setUpWorker(*trainer, *machine);
+        }
+        double* const shared = static_cast<double*>(buffer->get());
+        traits_type::unpackMachine(*machine, shared);
+        trainer->eStep(*machine, *shard);
+        traits_type::packStatistics(*trainer, *machine,
+          shared + machine_size + k * statistics_size);
+      }
+
+      size_t n_processes;
+      T* trainer;
+      machine_type* machine;
+      const data_type* data;
+      size_t machine_size;
+      size_t statistics_size;
+      boost::shared_ptr<SharedMemory> buffer;
+      std::vector<double> sum;
+      boost::shared_ptr<data_type> shard;
+      boost::shared_ptr<ProcessPool> pool;
+    };
+
+    boost::shared_ptr<Impl> m_impl;
+};
+
+} } } // namespaces
+
+#endif // BOB_LEARN_EM_PROCESS_ESTEP_H
@@ -0,0 +1,106 @@
+/**
+ * @date Sun Oct 18 21:52:40 2026 +0200
+ *
+ * @brief Worker processes exchanging their data through POSIX shared memory
+ *
+ * Copyright (C) Idiap Research Institute, Martigny, Switzerland
+ */
+
+#ifndef BOB_LEARN_EM_PROCESS_POOL_H
+#define BOB_LEARN_EM_PROCESS_POOL_H
+
+#include <vector>
+
+#include <sys/types.h>
+
+#include <boost/function.hpp>
+#include <boost/noncopyable.hpp>
+
+namespace bob { namespace learn { namespace em {
+
+/**
+ * @brief A block of POSIX shared memory, zero-initialized. It should be
+ * created before forking the processes which share it. Its name is unlinked
+ * right away, such that the memory is released when the last process which
+ * maps it exits.
+ */
+class SharedMemory: private boost::noncopyable
+{
+  public:
+    /**
+     * @brief Creates and maps a block of the given size (in bytes)
+     */
+    SharedMemory(const size_t size);
+
+    /**
+     * @brief Unmaps the block
+     */
+    ~SharedMemory();
+
+    void* get() const { return m_data; }
+    size_t size() const { return m_size; }
+
+  private:
+    void* m_data;
+    size_t m_size;
+};
+
+/**
+ * @brief A pool of worker processes, forked by the constructor. Each call
+ * to run() makes every worker call <tt>job(k)</tt>, @c k being the index
+ * of the worker, and returns once all of them are done.
+ *
+ * The workers are copies of the calling process at the time the pool is
+ * created: the job should only read the memory of the process, and send
+ * its results back through a SharedMemory block created beforehand. The
+ * workers never return from the job to the caller: they exit when the
+ * pool is destroyed, or when the calling process dies.
+ *
+ * A forked child only runs the thread which called fork(), while the locks
+ * held by the other threads (e.g. the ones of malloc) stay locked in it for
+ * ever: the pool should hence be created while the calling process is still
+ * single-threaded, e.g. with the Python GIL held, before any thread starts.
+ *
+ * If a job throws, its message is rethrown by run() as a
+ * std::runtime_error in the calling process; if a worker dies, run()
+ * throws as well.
+ */
+class ProcessPool: private boost::noncopyable
+{
+  public:
+    typedef boost::function<void (size_t)> job_type;
+
+    /**
+     * @brief Forks @c n_processes workers running the given job
+     */
+    ProcessPool(const size_t n_processes, const job_type& job);
+
+    /**
+     * @brief Stops the workers, and waits for them to exit
+     */
+    ~ProcessPool();
+
+    /**
+     * @brief Runs the job once in each worker
+     */
+    void run();
+
+    size_t getNProcesses() const { return m_pids.size(); }
+
+  private:
+    struct Control;
+    struct Worker;
+
+    Control& control() const;
+    Worker& worker(const size_t k) const;
+    void work(const size_t k, const pid_t parent);
+    void stop();
+
+    job_type m_job;
+    SharedMemory m_control;
+    std::vector<pid_t> m_pids;
+};
+
+} } } // namespaces
+
+#endif // BOB_LEARN_EM_PROCESS_POOL_H
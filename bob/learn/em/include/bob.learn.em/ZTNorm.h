@@ -84,6 +84,173 @@ void zNorm(const blitz::Array<double,2>& rawscores_probes_vs_models,
            const blitz::Array<double,2>& rawscores_zprobes_vs_models,
            blitz::Array<double,2>& normalizedscores);
 
+/**
+ * Normalise raw scores with adaptive symmetric normalisation (AS-Norm).
+ *
+ * For each model (row of the raw scores), the mean and standard deviation
+ * of its @c top_k highest scores against the Z-Norm cohort are computed, and
+ * likewise for each probe (column of the raw scores) with its @c top_k
+ * highest scores against the T-Norm cohort. The normalised score is then
+ * 0.5 * ((s - mean_model) / std_model + (s - mean_probe) / std_probe).
+ * The statistics are computed once per model and per probe, the top-K
+ * selections being distributed over several threads.
+ *
+ * @exception std::runtime_error matrix sizes are not consistent, or a cohort is empty
+ *
+ * @param rawscores_probes_vs_models
+ * @param rawscores_zprobes_vs_models
+ * @param rawscores_probes_vs_tmodels
+ * @param top_k      number of highest cohort scores to use (0 means the whole cohort, i.e. S-Norm)
+ * @param[out] normalizedscores normalized scores (may be rawscores_probes_vs_models itself)
+ * @param n_threads  number of threads (0 means one per hardware thread)
+ * @warning The destination score array should have the correct size
+ *          (Same size as rawscores_probes_vs_models)
+ */
+void asNorm(const blitz::Array<double,2>& rawscores_probes_vs_models,
+            const blitz::Array<double,2>& rawscores_zprobes_vs_models,
+            const blitz::Array<double,2>& rawscores_probes_vs_tmodels,
+            const size_t top_k,
+            blitz::Array<double,2>& normalizedscores,
+            const size_t n_threads=0);
+
+/**
+ * @brief The cohort statistics used by ZT-Norm, computed once and applied
+ * to tiles of raw scores as they are produced.
+ *
+ * The Z-Norm statistics are the mean and standard deviation of the scores
+ * of each model against the Z-Norm probes. The T-Norm statistics are the
+ * mean and standard deviation, for each probe, of its scores against the
+ * T-Norm models, themselves Z-normalised with the impostor scores of the
+ * T-Norm models against the Z-Norm probes. Normalising a tile only requires
+ * memory for the tile itself, and gives exactly the same scores as ztNorm().
+ */
+class ZTNormStatistics
+{
+  public:
+    /**
+     * @brief Default constructor: no Z-Norm nor T-Norm statistics, so that
+     * scores are left unchanged
+     */
+    ZTNormStatistics();
+
+    /**
+     * @brief Computes the statistics for ZT-Norm
+     *
+     * @param rawscores_zprobes_vs_models
+     * @param rawscores_probes_vs_tmodels
+     * @param rawscores_zprobes_vs_tmodels
+     * @param mask_zprobes_vs_tmodels_istruetrial
+     */
+    ZTNormStatistics(const blitz::Array<double,2>& rawscores_zprobes_vs_models,
+      const blitz::Array<double,2>& rawscores_probes_vs_tmodels,
+      const blitz::Array<double,2>& rawscores_zprobes_vs_tmodels,
+      const blitz::Array<bool,2>& mask_zprobes_vs_tmodels_istruetrial);
+
+    /**
+     * @brief Computes the statistics for ZT-Norm.
+     * Assume that znorm and tnorm have no common subject id.
+     *
+     * @param rawscores_zprobes_vs_models
+     * @param rawscores_probes_vs_tmodels
+     * @param rawscores_zprobes_vs_tmodels
+     */
+    ZTNormStatistics(const blitz::Array<double,2>& rawscores_zprobes_vs_models,
+      const blitz::Array<double,2>& rawscores_probes_vs_tmodels,
+      const blitz::Array<double,2>& rawscores_zprobes_vs_tmodels);
+
+    /**
+     * @brief Just to virtualise the destructor
+     */
+    virtual ~ZTNormStatistics();
+
+    /**
+     * @brief Computes the Z-Norm statistics (no Z-Norm if empty)
+     *
+     * @param rawscores_zprobes_vs_models
+     */
+    void computeZNorm(const blitz::Array<double,2>& rawscores_zprobes_vs_models);
+
+    /**
+     * @brief Computes the T-Norm statistics, without Z-normalising the
+     * T-Norm scores (no T-Norm if empty)
+     *
+     * @param rawscores_probes_vs_tmodels
+     */
+    void computeTNorm(const blitz::Array<double,2>& rawscores_probes_vs_tmodels);
+
+    /**
+     * @brief Computes the T-Norm statistics, the T-Norm scores being
+     * Z-normalised with the scores of the T-Norm models against the Z-Norm
+     * probes, excluding the true trials given by the (optional) mask
+     *
+     * @param rawscores_probes_vs_tmodels
+     * @param rawscores_zprobes_vs_tmodels
+     * @param mask_zprobes_vs_tmodels_istruetrial  NULL if all the trials are impostor trials
+     */
+    void computeTNorm(const blitz::Array<double,2>& rawscores_probes_vs_tmodels,
+      const blitz::Array<double,2>& rawscores_zprobes_vs_tmodels,
+      const blitz::Array<bool,2>* mask_zprobes_vs_tmodels_istruetrial=0);
+
+    /**
+     * @brief Tells whether Z-Norm statistics are available
+     */
+    bool hasZNorm() const
+    { return m_z_mean.extent(0) > 0; }
+
+    /**
+     * @brief Tells whether T-Norm statistics are available
+     */
+    bool hasTNorm() const
+    { return m_t_mean.extent(0) > 0; }
+
+    /**
+     * @brief Returns the mean of the Z-Norm scores, for each model
+     */
+    const blitz::Array<double,1>& getZMean() const
+    { return m_z_mean; }
+
+    /**
+     * @brief Returns the standard deviation of the Z-Norm scores, for each
+     * model (1 if it is null)
+     */
+    const blitz::Array<double,1>& getZStd() const
+    { return m_z_std; }
+
+    /**
+     * @brief Returns the mean of the (Z-normalised) T-Norm scores, for each
+     * probe
+     */
+    const blitz::Array<double,1>& getTMean() const
+    { return m_t_mean; }
+
+    /**
+     * @brief Returns the standard deviation of the (Z-normalised) T-Norm
+     * scores, for each probe (1 if it is null)
+     */
+    const blitz::Array<double,1>& getTStd() const
+    { return m_t_std; }
+
+    /**
+     * @brief Normalises a tile of raw scores
+     *
+     * @param rawscores  raw scores of the tile
+     * @param offset0    index of the first row of the tile in the full score matrix
+     * @param offset1    index of the first column of the tile in the full score matrix
+     * @param[out] normalizedscores normalized scores (may be rawscores itself)
+     * @warning The destination score array should have the correct size
+     *          (Same size as rawscores)
+     */
+    void normalize(const blitz::Array<double,2>& rawscores,
+      const int offset0, const int offset1,
+      blitz::Array<double,2>& normalizedscores) const;
+
+  private:
+    blitz::Array<double,1> m_z_mean;
+    blitz::Array<double,1> m_z_std;
+    blitz::Array<double,1> m_t_mean;
+    blitz::Array<double,1> m_t_std;
+};
+
 } } } // namespaces
 
 #endif /* BOB_LEARN_EM_ZTNORM_H */
@@ -203,7 +203,7 @@ static auto U = bob::extension::VariableDoc(
 );
 PyObject* PyBobLearnEMISVBase_getU(PyBobLearnEMISVBaseObject* self, void*){
   BOB_TRY
-  return PyBlitzArrayCxx_AsConstNumpy(self->cxx->getU());
+  return PyBobLearnEM_AsConstNumpy(self->cxx->getU(), self->cxx->getMappedFile());
   BOB_CATCH_MEMBER("``u`` could not be read", 0)
 }
 int PyBobLearnEMISVBase_setU(PyBobLearnEMISVBaseObject* self, PyObject* value, void*){
@@ -248,7 +248,7 @@ static auto D = bob::extension::VariableDoc(
 );
 PyObject* PyBobLearnEMISVBase_getD(PyBobLearnEMISVBaseObject* self, void*){
   BOB_TRY
-  return PyBlitzArrayCxx_AsConstNumpy(self->cxx->getD());
+  return PyBobLearnEM_AsConstNumpy(self->cxx->getD(), self->cxx->getMappedFile());
   BOB_CATCH_MEMBER("``d`` could not be read", 0)
 }
 int PyBobLearnEMISVBase_setD(PyBobLearnEMISVBaseObject* self, PyObject* value, void*){
@@ -419,6 +419,50 @@ static PyObject* PyBobLearnEMISVBase_Load(PyBobLearnEMISVBaseObject* self, PyObj
 }
 
 
+/*** save_mapped ***/
+static auto save_mapped = bob::extension::FunctionDoc(
+  "save_mapped",
+  "Save the ISVBase to a flat binary file, which can be mapped in memory by :py:meth:`load_mapped`",
+  "The arrays are stored in the byte order of this computer."
+)
+.add_prototype("filename")
+.add_parameter("filename", "str", "The name of the file to write");
+static PyObject* PyBobLearnEMISVBase_SaveMapped(PyBobLearnEMISVBaseObject* self, PyObject* args, PyObject* kwargs) {
+  BOB_TRY
+
+  char** kwlist = save_mapped.kwlist(0);
+  const char* filename;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "s", kwlist, &filename)) return 0;
+
+  self->cxx->saveMapped(filename);
+
+  BOB_CATCH_MEMBER("cannot save the data", 0)
+  Py_RETURN_NONE;
+}
+
+/*** load_mapped ***/
+static auto load_mapped = bob::extension::FunctionDoc(
+  "load_mapped",
+  "Load the ISVBase from a file written by :py:meth:`save_mapped`, mapping it in memory",
+  "Instead of being copies, ``u`` and ``d`` are views of the file: the processes which load the same file share a single copy of it in memory. "
+  "Modifying the machine afterwards does not modify the file."
+)
+.add_prototype("filename")
+.add_parameter("filename", "str", "The name of the file to map");
+static PyObject* PyBobLearnEMISVBase_LoadMapped(PyBobLearnEMISVBaseObject* self, PyObject* args, PyObject* kwargs) {
+  BOB_TRY
+
+  char** kwlist = load_mapped.kwlist(0);
+  const char* filename;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "s", kwlist, &filename)) return 0;
+
+  self->cxx->loadMapped(filename);
+
+  BOB_CATCH_MEMBER("cannot load the data", 0)
+  Py_RETURN_NONE;
+}
+
+
 /*** is_similar_to ***/
 static auto is_similar_to = bob::extension::FunctionDoc(
   "is_similar_to",
@@ -507,6 +551,18 @@ static PyMethodDef PyBobLearnEMISVBase_methods[] = {
     METH_VARARGS|METH_KEYWORDS,
     load.doc()
   },
+  {
+    save_mapped.name(),
+    (PyCFunction)PyBobLearnEMISVBase_SaveMapped,
+    METH_VARARGS|METH_KEYWORDS,
+    save_mapped.doc()
+  },
+  {
+    load_mapped.name(),
+    (PyCFunction)PyBobLearnEMISVBase_LoadMapped,
+    METH_VARARGS|METH_KEYWORDS,
+    load_mapped.doc()
+  },
   {
     is_similar_to.name(),
     (PyCFunction)PyBobLearnEMISVBase_IsSimilarTo,
@@ -522,17 +522,26 @@ static auto forward_ux = bob::extension::FunctionDoc(
 )
 .add_prototype("stats,ux")
 .add_parameter("stats", ":py:class:`bob.learn.em.GMMStats`", "Statistics as input")
-.add_parameter("ux", "array_like <float, 1D>", "Input vector");
+.add_parameter("ux", "array_like <float, 1D> or :py:class:`bob.learn.em.ProbeCache`", "Input vector, or a cache (bound to the same base as this machine) from which Ux is taken or into which it is stored");
 static PyObject* PyBobLearnEMISVMachine_ForwardUx(PyBobLearnEMISVMachineObject* self, PyObject* args, PyObject* kwargs) {
   BOB_TRY
 
   char** kwlist = forward_ux.kwlist(0);
 
   PyBobLearnEMGMMStatsObject* stats = 0;
-  PyBlitzArrayObject* ux_input        = 0;
+  PyObject* ux_o                      = 0;
 
-  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!O&", kwlist, &PyBobLearnEMGMMStats_Type, &stats,
-                                                                 &PyBlitzArray_Converter,&ux_input))
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!O", kwlist, &PyBobLearnEMGMMStats_Type, &stats, &ux_o))
+    return 0;
+
+  // Ux (and the centred statistics) taken from a ProbeCache
+  if (PyBobLearnEMProbeCache_Check(ux_o)){
+    double score = self->cxx->forward(stats->cxx, *reinterpret_cast<PyBobLearnEMProbeCacheObject*>(ux_o)->cxx);
+    return Py_BuildValue("d", score);
+  }
+
+  PyBlitzArrayObject* ux_input = 0;
+  if (!PyBlitzArray_Converter(ux_o, &ux_input))
     return 0;
 
   //protects acquired resources through this scope
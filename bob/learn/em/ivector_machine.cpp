@@ -208,7 +208,7 @@ static auto T = bob::extension::VariableDoc(
 );
 PyObject* PyBobLearnEMIVectorMachine_getT(PyBobLearnEMIVectorMachineObject* self, void*){
   BOB_TRY
-  return PyBlitzArrayCxx_AsConstNumpy(self->cxx->getT());
+  return PyBobLearnEM_AsConstNumpy(self->cxx->getT(), self->cxx->getMappedFile());
   BOB_CATCH_MEMBER("`t` could not be read", 0)
 }
 int PyBobLearnEMIVectorMachine_setT(PyBobLearnEMIVectorMachineObject* self, PyObject* value, void*){
@@ -236,7 +236,7 @@ static auto sigma = bob::extension::VariableDoc(
 );
 PyObject* PyBobLearnEMIVectorMachine_getSigma(PyBobLearnEMIVectorMachineObject* self, void*){
   BOB_TRY
-  return PyBlitzArrayCxx_AsConstNumpy(self->cxx->getSigma());
+  return PyBobLearnEM_AsConstNumpy(self->cxx->getSigma(), self->cxx->getMappedFile());
   BOB_CATCH_MEMBER("`sigma` could not be read", 0)
 }
 int PyBobLearnEMIVectorMachine_setSigma(PyBobLearnEMIVectorMachineObject* self, PyObject* value, void*){
@@ -428,6 +428,50 @@ static PyObject* PyBobLearnEMIVectorMachine_Load(PyBobLearnEMIVectorMachineObjec
 }
 
 
+/*** save_mapped ***/
+static auto save_mapped = bob::extension::FunctionDoc(
+  "save_mapped",
+  "Save the IVectorMachine to a flat binary file, which can be mapped in memory by :py:meth:`load_mapped`",
+  "The arrays are stored in the byte order of this computer."
+)
+.add_prototype("filename")
+.add_parameter("filename", "str", "The name of the file to write");
+static PyObject* PyBobLearnEMIVectorMachine_SaveMapped(PyBobLearnEMIVectorMachineObject* self, PyObject* args, PyObject* kwargs) {
+  BOB_TRY
+
+  char** kwlist = save_mapped.kwlist(0);
+  const char* filename;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "s", kwlist, &filename)) return 0;
+
+  self->cxx->saveMapped(filename);
+
+  BOB_CATCH_MEMBER("cannot save the data", 0)
+  Py_RETURN_NONE;
+}
+
+/*** load_mapped ***/
+static auto load_mapped = bob::extension::FunctionDoc(
+  "load_mapped",
+  "Load the IVectorMachine from a file written by :py:meth:`save_mapped`, mapping it in memory",
+  "Instead of being copies, ``T``, ``sigma`` and the precomputed arrays are views of the file: the processes which load the same file share a single copy of it in memory. "
+  "Modifying the machine afterwards does not modify the file."
+)
+.add_prototype("filename")
+.add_parameter("filename", "str", "The name of the file to map");
+static PyObject* PyBobLearnEMIVectorMachine_LoadMapped(PyBobLearnEMIVectorMachineObject* self, PyObject* args, PyObject* kwargs) {
+  BOB_TRY
+
+  char** kwlist = load_mapped.kwlist(0);
+  const char* filename;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "s", kwlist, &filename)) return 0;
+
+  self->cxx->loadMapped(filename);
+
+  BOB_CATCH_MEMBER("cannot load the data", 0)
+  Py_RETURN_NONE;
+}
+
+
 /*** is_similar_to ***/
 static auto is_similar_to = bob::extension::FunctionDoc(
   "is_similar_to",
@@ -601,6 +645,18 @@ static PyMethodDef PyBobLearnEMIVectorMachine_methods[] = {
     METH_VARARGS|METH_KEYWORDS,
     load.doc()
   },
+  {
+    save_mapped.name(),
+    (PyCFunction)PyBobLearnEMIVectorMachine_SaveMapped,
+    METH_VARARGS|METH_KEYWORDS,
+    save_mapped.doc()
+  },
+  {
+    load_mapped.name(),
+    (PyCFunction)PyBobLearnEMIVectorMachine_LoadMapped,
+    METH_VARARGS|METH_KEYWORDS,
+    load_mapped.doc()
+  },
   {
     is_similar_to.name(),
     (PyCFunction)PyBobLearnEMIVectorMachine_IsSimilarTo,
@@ -430,6 +430,40 @@ static PyObject* PyBobLearnEMIVectorTrainer_reset_accumulators(PyBobLearnEMIVect
 }
 
 
+/*** save_statistics ***/
+static auto save_statistics = bob::extension::FunctionDoc(
+  "save_statistics",
+  "Saves the statistics accumulated by the last E-step (the accumulators) to the given HDF5 file",
+  "The E-step can be run on shards of the data, e.g. in several processes, each of them saving its statistics. "
+  "The statistics are then summed with :py:meth:`load_statistics` and :py:meth:`add_statistics` before the M-step.",
+  true
+)
+.add_prototype("hdf5")
+.add_parameter("hdf5", ":py:class:`bob.io.base.HDF5File`", "An HDF5 file open for writing");
+
+
+/*** load_statistics ***/
+static auto load_statistics = bob::extension::FunctionDoc(
+  "load_statistics",
+  "Loads statistics saved by :py:meth:`save_statistics`, in place of the accumulated ones",
+  "The trainer should have been initialized for the same machine, such that :py:meth:`m_step` can be called afterwards.",
+  true
+)
+.add_prototype("hdf5")
+.add_parameter("hdf5", ":py:class:`bob.io.base.HDF5File`", "An HDF5 file open for reading");
+
+
+/*** add_statistics ***/
+static auto add_statistics = bob::extension::FunctionDoc(
+  "add_statistics",
+  "Adds the statistics accumulated by another trainer to the ones of this trainer",
+  0,
+  true
+)
+.add_prototype("other")
+.add_parameter("other", ":py:class:`bob.learn.em.IVectorTrainer`", "A trainer, e.g. in which :py:meth:`load_statistics` was called");
+
+
 static PyMethodDef PyBobLearnEMIVectorTrainer_methods[] = {
   {
     initialize.name(),
@@ -455,6 +489,24 @@ static PyMethodDef PyBobLearnEMIVectorTrainer_methods[] = {
     METH_VARARGS|METH_KEYWORDS,
     reset_accumulators.doc()
   },
+  {
+    save_statistics.name(),
+    (PyCFunction)PyBobLearnEMTrainer_save_statistics<PyBobLearnEMIVectorTrainerObject>,
+    METH_VARARGS|METH_KEYWORDS,
+    save_statistics.doc()
+  },
+  {
+    load_statistics.name(),
+    (PyCFunction)PyBobLearnEMTrainer_load_statistics<PyBobLearnEMIVectorTrainerObject>,
+    METH_VARARGS|METH_KEYWORDS,
+    load_statistics.doc()
+  },
+  {
+    add_statistics.name(),
+    (PyCFunction)PyBobLearnEMTrainer_add_statistics<PyBobLearnEMIVectorTrainerObject, &PyBobLearnEMIVectorTrainer_Type>,
+    METH_VARARGS|METH_KEYWORDS,
+    add_statistics.doc()
+  },
   {0} /* Sentinel */
 };
 
@@ -211,7 +211,7 @@ static auto U = bob::extension::VariableDoc(
 );
 PyObject* PyBobLearnEMJFABase_getU(PyBobLearnEMJFABaseObject* self, void*){
   BOB_TRY
-  return PyBlitzArrayCxx_AsConstNumpy(self->cxx->getU());
+  return PyBobLearnEM_AsConstNumpy(self->cxx->getU(), self->cxx->getMappedFile());
   BOB_CATCH_MEMBER("``u`` could not be read", 0)
 }
 int PyBobLearnEMJFABase_setU(PyBobLearnEMJFABaseObject* self, PyObject* value, void*){
@@ -256,7 +256,7 @@ static auto V = bob::extension::VariableDoc(
 );
 PyObject* PyBobLearnEMJFABase_getV(PyBobLearnEMJFABaseObject* self, void*){
   BOB_TRY
-  return PyBlitzArrayCxx_AsConstNumpy(self->cxx->getV());
+  return PyBobLearnEM_AsConstNumpy(self->cxx->getV(), self->cxx->getMappedFile());
   BOB_CATCH_MEMBER("``v`` could not be read", 0)
 }
 int PyBobLearnEMJFABase_setV(PyBobLearnEMJFABaseObject* self, PyObject* value, void*){
@@ -301,7 +301,7 @@ static auto D = bob::extension::VariableDoc(
 );
 PyObject* PyBobLearnEMJFABase_getD(PyBobLearnEMJFABaseObject* self, void*){
   BOB_TRY
-  return PyBlitzArrayCxx_AsConstNumpy(self->cxx->getD());
+  return PyBobLearnEM_AsConstNumpy(self->cxx->getD(), self->cxx->getMappedFile());
   BOB_CATCH_MEMBER("``d`` could not be read", 0)
 }
 int PyBobLearnEMJFABase_setD(PyBobLearnEMJFABaseObject* self, PyObject* value, void*){
@@ -481,6 +481,50 @@ static PyObject* PyBobLearnEMJFABase_Load(PyBobLearnEMJFABaseObject* self, PyObj
 }
 
 
+/*** save_mapped ***/
+static auto save_mapped = bob::extension::FunctionDoc(
+  "save_mapped",
+  "Save the JFABase to a flat binary file, which can be mapped in memory by :py:meth:`load_mapped`",
+  "The arrays are stored in the byte order of this computer."
+)
+.add_prototype("filename")
+.add_parameter("filename", "str", "The name of the file to write");
+static PyObject* PyBobLearnEMJFABase_SaveMapped(PyBobLearnEMJFABaseObject* self, PyObject* args, PyObject* kwargs) {
+  BOB_TRY
+
+  char** kwlist = save_mapped.kwlist(0);
+  const char* filename;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "s", kwlist, &filename)) return 0;
+
+  self->cxx->saveMapped(filename);
+
+  BOB_CATCH_MEMBER("cannot save the data", 0)
+  Py_RETURN_NONE;
+}
+
+/*** load_mapped ***/
+static auto load_mapped = bob::extension::FunctionDoc(
+  "load_mapped",
+  "Load the JFABase from a file written by :py:meth:`save_mapped`, mapping it in memory",
+  "Instead of being copies, ``u``, ``v`` and ``d`` are views of the file: the processes which load the same file share a single copy of it in memory. "
+  "Modifying the machine afterwards does not modify the file."
+)
+.add_prototype("filename")
+.add_parameter("filename", "str", "The name of the file to map");
+static PyObject* PyBobLearnEMJFABase_LoadMapped(PyBobLearnEMJFABaseObject* self, PyObject* args, PyObject* kwargs) {
+  BOB_TRY
+
+  char** kwlist = load_mapped.kwlist(0);
+  const char* filename;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "s", kwlist, &filename)) return 0;
+
+  self->cxx->loadMapped(filename);
+
+  BOB_CATCH_MEMBER("cannot load the data", 0)
+  Py_RETURN_NONE;
+}
+
+
 /*** is_similar_to ***/
 static auto is_similar_to = bob::extension::FunctionDoc(
   "is_similar_to",
@@ -575,6 +619,18 @@ static PyMethodDef PyBobLearnEMJFABase_methods[] = {
     METH_VARARGS|METH_KEYWORDS,
     load.doc()
   },
+  {
+    save_mapped.name(),
+    (PyCFunction)PyBobLearnEMJFABase_SaveMapped,
+    METH_VARARGS|METH_KEYWORDS,
+    save_mapped.doc()
+  },
+  {
+    load_mapped.name(),
+    (PyCFunction)PyBobLearnEMJFABase_LoadMapped,
+    METH_VARARGS|METH_KEYWORDS,
+    load_mapped.doc()
+  },
   {
     is_similar_to.name(),
     (PyCFunction)PyBobLearnEMJFABase_IsSimilarTo,
@@ -42,6 +42,35 @@ static int extract_gmmmachine_list(PyObject *list,
 }
 
 
+static int extract_isvmachine_list(PyObject *list,
+                             std::vector<boost::shared_ptr<const bob::learn::em::ISVMachine> >& models)
+{
+  for (int i=0; i<PyList_GET_SIZE(list); i++){
+
+    PyBobLearnEMISVMachineObject* machine;
+    if (!PyArg_Parse(PyList_GetItem(list, i), "O!", &PyBobLearnEMISVMachine_Type, &machine)){
+      PyErr_Format(PyExc_RuntimeError, "Expected ISVMachine objects");
+      return -1;
+    }
+    models.push_back(machine->cxx);
+  }
+  return 0;
+}
+
+static int extract_jfamachine_list(PyObject *list,
+                             std::vector<boost::shared_ptr<const bob::learn::em::JFAMachine> >& models)
+{
+  for (int i=0; i<PyList_GET_SIZE(list); i++){
+
+    PyBobLearnEMJFAMachineObject* machine;
+    if (!PyArg_Parse(PyList_GetItem(list, i), "O!", &PyBobLearnEMJFAMachine_Type, &machine)){
+      PyErr_Format(PyExc_RuntimeError, "Expected JFAMachine objects");
+      return -1;
+    }
+    models.push_back(machine->cxx);
+  }
+  return 0;
+}
 
 /*Convert a PyObject to a list of blitz Array*/
 template <int N>
@@ -117,7 +146,22 @@ bob::extension::FunctionDoc linear_scoring3 = bob::extension::FunctionDoc(
 .add_parameter("frame_length_normalisation", "bool", "")
 .add_return("output","array_like<float,1>","Score");
 
+bob::extension::FunctionDoc linear_scoring4 = bob::extension::FunctionDoc(
+  "linear_scoring",
+  "Scores a list of enrolled ISV or JFA models against a list of test statistics. "
+  "The channel offset of each test trial is estimated only once (in parallel) and shared across all the models; "
+  "``output[m,t]`` is the same as ``models[m](test_stats[t])``.",
+  0,
+  true
+)
+.add_prototype("models, test_stats, [n_threads]", "output")
+.add_parameter("models", "list(:py:class:`bob.learn.em.ISVMachine`) or list(:py:class:`bob.learn.em.JFAMachine`)", "Enrolled models, sharing the same :py:class:`bob.learn.em.ISVBase` or :py:class:`bob.learn.em.JFABase`")
+.add_parameter("test_stats", "list(:py:class:`bob.learn.em.GMMStats`)", "")
+.add_parameter("n_threads", "int", "Number of threads used to estimate the channel offsets (1 by default); 0 uses one thread per core")
+.add_return("output","array_like<float,2>","Scores");
+
 PyObject* PyBobLearnEM_linear_scoring(PyObject*, PyObject* args, PyObject* kwargs) {
+BOB_TRY
 
   //Cheking the number of arguments
   int nargs = (args?PyTuple_Size(args):0) + (kwargs?PyDict_Size(kwargs):0);
@@ -154,15 +198,15 @@ PyObject* PyBobLearnEM_linear_scoring(PyObject*, PyObject* args, PyObject* kwarg
 
     std::vector<boost::shared_ptr<const bob::learn::em::GMMStats> > stats_list;
     if(extract_gmmstats_list(stats_list_o ,stats_list)!=0)
-      Py_RETURN_NONE;
+      return 0;
 
     std::vector<boost::shared_ptr<const bob::learn::em::GMMMachine> > gmm_list;
     if(extract_gmmmachine_list(gmm_list_o ,gmm_list)!=0)
-      Py_RETURN_NONE;
+      return 0;
 
     std::vector<blitz::Array<double,1> > channel_offset_list;
     if(extract_array_list(channel_offset_list_o ,channel_offset_list)!=0)
-      Py_RETURN_NONE;
+      return 0;
 
     blitz::Array<double, 2> scores = blitz::Array<double, 2>(gmm_list.size(), stats_list.size());
     if(channel_offset_list.size()==0)
@@ -173,6 +217,48 @@ PyObject* PyBobLearnEM_linear_scoring(PyObject*, PyObject* args, PyObject* kwarg
     return PyBlitzArrayCxx_AsConstNumpy(scores);
   }
 
+  //Checking the signature of the method (list of ISVMachine or JFAMachine as input)
+  else if ((PyList_Check(arg)) && (PyBobLearnEMISVMachine_Check(PyList_GetItem(arg, 0)) || PyBobLearnEMJFAMachine_Check(PyList_GetItem(arg, 0))) && (nargs >= 2) && (nargs<=3) ){
+
+    char** kwlist = linear_scoring4.kwlist(0);
+
+    PyObject* model_list_o = 0;
+    PyObject* stats_list_o = 0;
+    int n_threads = 1;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!O!|i", kwlist, &PyList_Type, &model_list_o,
+                                                                  &PyList_Type, &stats_list_o,
+                                                                  &n_threads)){
+      linear_scoring4.print_usage();
+      return 0;
+    }
+
+    if (n_threads < 0){
+      PyErr_Format(PyExc_ValueError, "linear_scoring: n_threads must be positive (or 0), but you provided %d", n_threads);
+      return 0;
+    }
+
+    std::vector<boost::shared_ptr<const bob::learn::em::GMMStats> > stats_list;
+    if(extract_gmmstats_list(stats_list_o ,stats_list)!=0)
+      return 0;
+
+    blitz::Array<double, 2> scores = blitz::Array<double, 2>(PyList_GET_SIZE(model_list_o), stats_list.size());
+    if (PyBobLearnEMISVMachine_Check(PyList_GetItem(model_list_o, 0))){
+      std::vector<boost::shared_ptr<const bob::learn::em::ISVMachine> > isv_list;
+      if(extract_isvmachine_list(model_list_o ,isv_list)!=0)
+        return 0;
+      bob::learn::em::linearScoring(isv_list, stats_list, scores, n_threads);
+    }
+    else{
+      std::vector<boost::shared_ptr<const bob::learn::em::JFAMachine> > jfa_list;
+      if(extract_jfamachine_list(model_list_o ,jfa_list)!=0)
+        return 0;
+      bob::learn::em::linearScoring(jfa_list, stats_list, scores, n_threads);
+    }
+
+    return PyBlitzArrayCxx_AsConstNumpy(scores);
+  }
+
   //Checking the signature of the method (list of arrays as input
   else if ((PyList_Check(arg)) && PyArray_Check(PyList_GetItem(arg, 0)) && (nargs >= 4) && (nargs<=6) ){
 
@@ -201,15 +287,15 @@ PyObject* PyBobLearnEM_linear_scoring(PyObject*, PyObject* args, PyObject* kwarg
 
     std::vector<blitz::Array<double,1> > model_supervector_list;
     if(extract_array_list(model_supervector_list_o ,model_supervector_list)!=0)
-      Py_RETURN_NONE;
+      return 0;
 
     std::vector<boost::shared_ptr<const bob::learn::em::GMMStats> > stats_list;
     if(extract_gmmstats_list(stats_list_o ,stats_list)!=0)
-      Py_RETURN_NONE;
+      return 0;
 
     std::vector<blitz::Array<double,1> > channel_offset_list;
     if(extract_array_list(channel_offset_list_o ,channel_offset_list)!=0)
-      Py_RETURN_NONE;
+      return 0;
 
     blitz::Array<double, 2> scores = blitz::Array<double, 2>(model_supervector_list.size(), stats_list.size());
     if(channel_offset_list.size()==0)
@@ -256,11 +342,94 @@ PyObject* PyBobLearnEM_linear_scoring(PyObject*, PyObject* args, PyObject* kwarg
 
 
   else{
-    PyErr_Format(PyExc_RuntimeError, "number of arguments mismatch - linear_scoring requires 5 or 6 arguments, but you provided %d (see help)", nargs);
+    PyErr_Format(PyExc_RuntimeError, "number of arguments mismatch - linear_scoring requires between 2 and 6 arguments, but you provided %d (see help)", nargs);
     linear_scoring1.print_usage();
     linear_scoring2.print_usage();
     linear_scoring3.print_usage();
+    linear_scoring4.print_usage();
     return 0;
   }
 
+BOB_CATCH_FUNCTION("linear_scoring", 0)
+}
+
+
+/*** streaming_linear_scoring ***/
+bob::extension::FunctionDoc streaming_linear_scoring = bob::extension::FunctionDoc(
+  "streaming_linear_scoring",
+  "Computes the same scores as :py:func:`bob.learn.em.linear_scoring`, within a bounded amount of working memory",
+  "The models are processed in blocks and the test statistics in tiles, so that the working arrays never exceed ``max_bytes`` (half of it for a block of models, half of it for the tiles processed in parallel). "
+  "``models`` may hence be a :py:class:`numpy.memmap`, in which case the model supervectors are read block by block.\n\n"
+  "If ``score_file`` is given, the scores are not returned but written to that file, which is memory-mapped and filled tile by tile. "
+  "It contains the raw ``(n_models, n_probes)`` matrix of native ``float64`` in row-major order, and can be read with ``numpy.memmap(score_file, dtype=numpy.float64, shape=(n_models, n_probes))``.",
+  true
+)
+.add_prototype("models, ubm_mean, ubm_variance, test_stats, [test_channelOffset], [frame_length_normalisation], [max_bytes], [score_file], [n_threads]", "output")
+.add_parameter("models", "array_like<float,2>", "The mean supervectors of the client models, one per row")
+.add_parameter("ubm_mean", "array_like<float,1>", "The mean supervector of the world model")
+.add_parameter("ubm_variance", "array_like<float,1>", "The variance supervector of the world model")
+.add_parameter("test_stats", "list(:py:class:`bob.learn.em.GMMStats`)", "The statistics of the test trials")
+.add_parameter("test_channelOffset", "list(array_like<float,1>)", "The channel offsets of the test trials, if any")
+.add_parameter("frame_length_normalisation", "bool", "Normalise the scores by the number of feature vectors? Defaults to ``False``")
+.add_parameter("max_bytes", "int", "The memory budget of the working arrays, in bytes; 0 means unbounded. Defaults to 512 MB")
+.add_parameter("score_file", "str", "If given, the name of the file to write the scores to")
+.add_parameter("n_threads", "int", "Number of threads (1 by default); 0 uses one thread per core")
+.add_return("output","array_like<float,2> or None","The scores, or ``None`` if they were written to ``score_file``");
+PyObject* PyBobLearnEM_streaming_linear_scoring(PyObject*, PyObject* args, PyObject* kwargs) {
+BOB_TRY
+  char** kwlist = streaming_linear_scoring.kwlist(0);
+
+  PyBlitzArrayObject* models                = 0;
+  PyBlitzArrayObject* ubm_means             = 0;
+  PyBlitzArrayObject* ubm_variances         = 0;
+  PyObject* stats_list_o                    = 0;
+  PyObject* channel_offset_list_o           = 0;
+  PyObject* frame_length_normalisation      = Py_False;
+  Py_ssize_t max_bytes                      = 512 << 20;
+  const char* score_file                    = 0;
+  int n_threads                             = 1;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O&O&O&O!|O!O!nzi", kwlist, &PyBlitzArray_Converter, &models,
+                                                                     &PyBlitzArray_Converter, &ubm_means,
+                                                                     &PyBlitzArray_Converter, &ubm_variances,
+                                                                     &PyList_Type, &stats_list_o,
+                                                                     &PyList_Type, &channel_offset_list_o,
+                                                                     &PyBool_Type, &frame_length_normalisation,
+                                                                     &max_bytes, &score_file, &n_threads)){
+    streaming_linear_scoring.print_usage();
+    return 0;
+  }
+
+  //protects acquired resources through this scope
+  auto models_ = make_safe(models);
+  auto ubm_means_ = make_safe(ubm_means);
+  auto ubm_variances_ = make_safe(ubm_variances);
+
+  if (max_bytes < 0 || n_threads < 0){
+    PyErr_Format(PyExc_ValueError, "streaming_linear_scoring: max_bytes and n_threads must be positive (or 0)");
+    return 0;
+  }
+
+  std::vector<boost::shared_ptr<const bob::learn::em::GMMStats> > stats_list;
+  if(extract_gmmstats_list(stats_list_o ,stats_list)!=0)
+    return 0;
+
+  std::vector<blitz::Array<double,1> > channel_offset_list;
+  if(extract_array_list(channel_offset_list_o ,channel_offset_list)!=0)
+    return 0;
+
+  auto models_array_ = PyBlitzArrayCxx_AsBlitz<double,2>(models, "models");
+  if (!models_array_) return 0;
+  const blitz::Array<double,2>& models_array = *models_array_;
+  if (score_file){
+    bob::learn::em::linearScoring(models_array, *PyBlitzArrayCxx_AsBlitz<double,1>(ubm_means), *PyBlitzArrayCxx_AsBlitz<double,1>(ubm_variances),
+      stats_list, channel_offset_list, f(frame_length_normalisation), max_bytes, std::string(score_file), n_threads);
+    Py_RETURN_NONE;
+  }
+
+  blitz::Array<double, 2> scores = blitz::Array<double, 2>(models_array.extent(0), stats_list.size());
+  bob::learn::em::linearScoring(models_array, *PyBlitzArrayCxx_AsBlitz<double,1>(ubm_means), *PyBlitzArrayCxx_AsBlitz<double,1>(ubm_variances),
+    stats_list, channel_offset_list, f(frame_length_normalisation), max_bytes, scores, n_threads);
+  return PyBlitzArrayCxx_AsConstNumpy(scores);
+BOB_CATCH_FUNCTION("streaming_linear_scoring", 0)
 }
@@ -29,12 +29,36 @@ static PyMethodDef module_methods[] = {
     METH_VARARGS|METH_KEYWORDS,
     z_norm.doc()
   },
+  {
+    as_norm.name(),
+    (PyCFunction)PyBobLearnEM_asNorm,
+    METH_VARARGS|METH_KEYWORDS,
+    as_norm.doc()
+  },
   {
     linear_scoring1.name(),
     (PyCFunction)PyBobLearnEM_linear_scoring,
     METH_VARARGS|METH_KEYWORDS,
     linear_scoring1.doc()
   },
+  {
+    streaming_linear_scoring.name(),
+    (PyCFunction)PyBobLearnEM_streaming_linear_scoring,
+    METH_VARARGS|METH_KEYWORDS,
+    streaming_linear_scoring.doc()
+  },
+  {
+    plda_scoring.name(),
+    (PyCFunction)PyBobLearnEM_plda_scoring,
+    METH_VARARGS|METH_KEYWORDS,
+    plda_scoring.doc()
+  },
+  {
+    train_native.name(),
+    (PyCFunction)PyBobLearnEM_train_native,
+    METH_VARARGS|METH_KEYWORDS,
+    train_native.doc()
+  },
 
   {0}//Sentinel
 };
@@ -84,15 +108,22 @@ static PyObject* create_module (void) {
   if (!init_BobLearnEMISVMachine(module)) return 0;
   if (!init_BobLearnEMISVTrainer(module)) return 0;
 
+  if (!init_BobLearnEMProbeCache(module)) return 0;
+
   if (!init_BobLearnEMIVectorMachine(module)) return 0;
   if (!init_BobLearnEMIVectorTrainer(module)) return 0;
 
   if (!init_BobLearnEMPLDABase(module)) return 0;
   if (!init_BobLearnEMPLDAMachine(module)) return 0;
+  if (!init_BobLearnEMPLDAFastScorer(module)) return 0;
   if (!init_BobLearnEMPLDATrainer(module)) return 0;
 
+  if (!init_BobLearnEMZTNormStatistics(module)) return 0;
+
   if (!init_BobLearnEMEMPCATrainer(module)) return 0;
 
+  if (!init_BobLearnEMMappedArray(module)) return 0;
+
 
   static void* PyBobLearnEM_API[PyBobLearnEM_API_pointers];
 
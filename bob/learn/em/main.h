@@ -48,8 +48,13 @@
 
 #include <bob.learn.em/PLDAMachine.h>
 #include <bob.learn.em/PLDATrainer.h>
+#include <bob.learn.em/PLDAScoring.h>
+#include <bob.learn.em/PLDAFastScorer.h>
 
 #include <bob.learn.em/ZTNorm.h>
+#include <bob.learn.em/ProbeCache.h>
+
+#include <bob.learn.em/MappedFile.h>
 
 /// inserts the given key, value pair into the given dictionaries
 static inline int insert_item_string(PyObject* dict, PyObject* entries, const char* key, Py_ssize_t value){
@@ -58,6 +63,27 @@ static inline int insert_item_string(PyObject* dict, PyObject* entries, const ch
   return PyDict_SetItemString(entries, key, v.get());
 }
 
+// Views of the arrays of a mapped file
+bool init_BobLearnEMMappedArray(PyObject* module);
+PyObject* PyBobLearnEMMappedArray_New(const boost::shared_ptr<const bob::learn::em::MappedFile>& file,
+  const double* data, const int ndim, const Py_ssize_t* shape, const Py_ssize_t* strides);
+
+/// Same as PyBlitzArrayCxx_AsConstNumpy, except that if the array is a view
+/// of the given mapped file, the returned numpy array keeps the file mapped
+template <int N>
+PyObject* PyBobLearnEM_AsConstNumpy(const blitz::Array<double,N>& a,
+  const boost::shared_ptr<const bob::learn::em::MappedFile>& file)
+{
+  if (!file || !file->holds(a.data())) return PyBlitzArrayCxx_AsConstNumpy(a);
+  Py_ssize_t shape[N], strides[N];
+  for (int k=0; k<N; ++k){
+    shape[k] = a.extent(k);
+    strides[k] = a.stride(k) * sizeof(double);
+  }
+  return PyBobLearnEMMappedArray_New(file, a.data(), N, shape, strides);
+}
+
+
 // Gaussian
 typedef struct {
   PyObject_HEAD
@@ -198,6 +224,16 @@ extern PyTypeObject PyBobLearnEMISVTrainer_Type;
 bool init_BobLearnEMISVTrainer(PyObject* module);
 int PyBobLearnEMISVTrainer_Check(PyObject* o);
 
+// ProbeCache
+typedef struct {
+  PyObject_HEAD
+  boost::shared_ptr<bob::learn::em::ProbeCache> cxx;
+} PyBobLearnEMProbeCacheObject;
+
+extern PyTypeObject PyBobLearnEMProbeCache_Type;
+bool init_BobLearnEMProbeCache(PyObject* module);
+int PyBobLearnEMProbeCache_Check(PyObject* o);
+
 // IVectorMachine
 typedef struct {
   PyObject_HEAD
@@ -242,6 +278,16 @@ bool init_BobLearnEMPLDAMachine(PyObject* module);
 int PyBobLearnEMPLDAMachine_Check(PyObject* o);
 
 
+// PLDAFastScorer
+typedef struct {
+  PyObject_HEAD
+  boost::shared_ptr<bob::learn::em::PLDAFastScorer> cxx;
+} PyBobLearnEMPLDAFastScorerObject;
+
+extern PyTypeObject PyBobLearnEMPLDAFastScorer_Type;
+bool init_BobLearnEMPLDAFastScorer(PyObject* module);
+int PyBobLearnEMPLDAFastScorer_Check(PyObject* o);
+
 // PLDATrainer
 typedef struct {
   PyObject_HEAD
@@ -266,6 +312,15 @@ int PyBobLearnEMEMPCATrainer_Check(PyObject* o);
 
 
 //ZT Normalization
+typedef struct {
+  PyObject_HEAD
+  boost::shared_ptr<bob::learn::em::ZTNormStatistics> cxx;
+} PyBobLearnEMZTNormStatisticsObject;
+
+extern PyTypeObject PyBobLearnEMZTNormStatistics_Type;
+bool init_BobLearnEMZTNormStatistics(PyObject* module);
+int PyBobLearnEMZTNormStatistics_Check(PyObject* o);
+
 PyObject* PyBobLearnEM_ztNorm(PyObject*, PyObject* args, PyObject* kwargs);
 extern bob::extension::FunctionDoc zt_norm;
 
@@ -275,11 +330,84 @@ extern bob::extension::FunctionDoc t_norm;
 PyObject* PyBobLearnEM_zNorm(PyObject*, PyObject* args, PyObject* kwargs);
 extern bob::extension::FunctionDoc z_norm;
 
+PyObject* PyBobLearnEM_asNorm(PyObject*, PyObject* args, PyObject* kwargs);
+extern bob::extension::FunctionDoc as_norm;
+
 
 //Linear scoring
 PyObject* PyBobLearnEM_linear_scoring(PyObject*, PyObject* args, PyObject* kwargs);
 extern bob::extension::FunctionDoc linear_scoring1;
 extern bob::extension::FunctionDoc linear_scoring2;
 extern bob::extension::FunctionDoc linear_scoring3;
+extern bob::extension::FunctionDoc linear_scoring4;
+
+PyObject* PyBobLearnEM_streaming_linear_scoring(PyObject*, PyObject* args, PyObject* kwargs);
+extern bob::extension::FunctionDoc streaming_linear_scoring;
+
+//PLDA scoring
+PyObject* PyBobLearnEM_plda_scoring(PyObject*, PyObject* args, PyObject* kwargs);
+extern bob::extension::FunctionDoc plda_scoring;
+
+//EM driver
+PyObject* PyBobLearnEM_train_native(PyObject*, PyObject* args, PyObject* kwargs);
+extern bob::extension::FunctionDoc train_native;
+
+
+// Releases the GIL while the object lives
+class GILReleaser {
+  public:
+    GILReleaser(): m_state(PyEval_SaveThread()) {}
+    ~GILReleaser() { PyEval_RestoreThread(m_state); }
+  private:
+    PyThreadState* m_state;
+};
+
+
+// save_statistics, load_statistics and add_statistics methods of the
+// trainers which support sharding the E-step; T is the Python object of the
+// trainer, and type its Python type
+template <typename T>
+PyObject* PyBobLearnEMTrainer_save_statistics(T* self, PyObject* args, PyObject* kwargs) {
+  BOB_TRY
+
+  static char* kwlist[] = {const_cast<char*>("hdf5"), 0};
+  PyBobIoHDF5FileObject* hdf5;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O&", kwlist, PyBobIoHDF5File_Converter, &hdf5)) return 0;
+
+  auto hdf5_ = make_safe(hdf5);
+  self->cxx->saveStatistics(*hdf5->f);
+
+  BOB_CATCH_MEMBER("cannot perform the save_statistics method", 0)
+  Py_RETURN_NONE;
+}
+
+template <typename T>
+PyObject* PyBobLearnEMTrainer_load_statistics(T* self, PyObject* args, PyObject* kwargs) {
+  BOB_TRY
+
+  static char* kwlist[] = {const_cast<char*>("hdf5"), 0};
+  PyBobIoHDF5FileObject* hdf5;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O&", kwlist, PyBobIoHDF5File_Converter, &hdf5)) return 0;
+
+  auto hdf5_ = make_safe(hdf5);
+  self->cxx->loadStatistics(*hdf5->f);
+
+  BOB_CATCH_MEMBER("cannot perform the load_statistics method", 0)
+  Py_RETURN_NONE;
+}
+
+template <typename T, PyTypeObject* type>
+PyObject* PyBobLearnEMTrainer_add_statistics(T* self, PyObject* args, PyObject* kwargs) {
+  BOB_TRY
+
+  static char* kwlist[] = {const_cast<char*>("other"), 0};
+  T* other;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!", kwlist, type, &other)) return 0;
+
+  self->cxx->addStatistics(*other->cxx);
+
+  BOB_CATCH_MEMBER("cannot perform the add_statistics method", 0)
+  Py_RETURN_NONE;
+}
 
 #endif // BOB_LEARN_EM_MAIN_H
@@ -414,6 +414,121 @@ static PyObject* PyBobLearnEMMAPGMMTrainer_m_step(PyBobLearnEMMAPGMMTrainerObjec
 }
 
 
+/*** adapt ***/
+static auto adapt = bob::extension::FunctionDoc(
+  "adapt",
+  "Incremental MAP adaptation: re-derives the adapted GMM from the statistics accumulated for this model",
+  "If ``data`` is given, its statistics are first computed with the prior GMM and added to ``gmm_stats`` (in place). "
+  "Storing the :py:class:`bob.learn.em.GMMStats` of each model along with its adapted :py:class:`bob.learn.em.GMMMachine` "
+  "allows updating the model with new sessions at a cost that only depends on the number of new frames. "
+  "The result is the same as a single MAP iteration (:py:meth:`e_step` with the prior GMM followed by :py:meth:`m_step`) on all the data.",
+  true
+)
+.add_prototype("gmm_machine, gmm_stats, [data]")
+.add_parameter("gmm_machine", ":py:class:`bob.learn.em.GMMMachine`", "The adapted GMM, which is updated")
+.add_parameter("gmm_stats", ":py:class:`bob.learn.em.GMMStats`", "The statistics accumulated so far for this model, computed with the prior GMM")
+.add_parameter("data", "array_like <float, 2D>", "The new data of this model");
+static PyObject* PyBobLearnEMMAPGMMTrainer_adapt(PyBobLearnEMMAPGMMTrainerObject* self, PyObject* args, PyObject* kwargs) {
+  BOB_TRY
+
+  /* Parses input arguments in a single shot */
+  char** kwlist = adapt.kwlist(0);
+
+  PyBobLearnEMGMMMachineObject* gmm_machine;
+  PyBobLearnEMGMMStatsObject* gmm_stats;
+  PyBlitzArrayObject* data = 0;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!O!|O&", kwlist, &PyBobLearnEMGMMMachine_Type, &gmm_machine,
+                                                                    &PyBobLearnEMGMMStats_Type, &gmm_stats,
+                                                                    &PyBlitzArray_Converter, &data)) return 0;
+  auto data_ = make_xsafe(data);
+
+  if (!data) {
+    self->cxx->mStep(*gmm_machine->cxx, *gmm_stats->cxx);
+    Py_RETURN_NONE;
+  }
+
+  // perform check on the input
+  if (data->type_num != NPY_FLOAT64){
+    PyErr_Format(PyExc_TypeError, "`%s' only supports 64-bit float arrays for input array `%s`", Py_TYPE(self)->tp_name, adapt.name());
+    return 0;
+  }
+
+  if (data->ndim != 2){
+    PyErr_Format(PyExc_TypeError, "`%s' only processes 2D arrays of float64 for `%s`", Py_TYPE(self)->tp_name, adapt.name());
+    return 0;
+  }
+
+  if (data->shape[1] != (Py_ssize_t)gmm_machine->cxx->getNInputs() ) {
+    PyErr_Format(PyExc_TypeError, "`%s' 2D `input` array should have the shape [N, %" PY_FORMAT_SIZE_T "d] not [N, %" PY_FORMAT_SIZE_T "d] for `%s`", Py_TYPE(self)->tp_name, gmm_machine->cxx->getNInputs(), data->shape[1], adapt.name());
+    return 0;
+  }
+
+  self->cxx->adapt(*gmm_machine->cxx, *gmm_stats->cxx, *PyBlitzArrayCxx_AsBlitz<double,2>(data));
+
+  BOB_CATCH_MEMBER("cannot perform the adapt method", 0)
+
+  Py_RETURN_NONE;
+}
+
+
+/*** adapt_mean_supervector ***/
+static auto adapt_mean_supervector = bob::extension::FunctionDoc(
+  "adapt_mean_supervector",
+  "One-pass MAP adaptation of the means only, returning the adapted mean supervector",
+  "The statistics of ``data`` are accumulated with the prior GMM, and the adapted means are directly written into the mean supervector "
+  "(in the layout of :py:attr:`bob.learn.em.GMMMachine.mean_supervector`), without creating a :py:class:`bob.learn.em.GMMMachine`. "
+  "Passing a row of a preallocated matrix as ``mean_supervector`` allows enrolling many models without any allocation. "
+  "The ``update_*`` flags of the trainer are ignored: only the means are adapted.",
+  true
+)
+.add_prototype("data, [mean_supervector]", "mean_supervector")
+.add_parameter("data", "array_like <float, 2D>", "The enrollment data")
+.add_parameter("mean_supervector", "array_like <float, 1D>", "If given, the adapted mean supervector is written into this array (of size ``n_gaussians*n_inputs``)")
+.add_return("mean_supervector", "array_like <float, 1D>", "The adapted mean supervector");
+static PyObject* PyBobLearnEMMAPGMMTrainer_adapt_mean_supervector(PyBobLearnEMMAPGMMTrainerObject* self, PyObject* args, PyObject* kwargs) {
+  BOB_TRY
+
+  /* Parses input arguments in a single shot */
+  char** kwlist = adapt_mean_supervector.kwlist(0);
+
+  PyBlitzArrayObject* data = 0;
+  PyObject* output_o = 0;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O&|O!", kwlist, &PyBlitzArray_Converter, &data,
+                                                                  &PyArray_Type, &output_o)) return 0;
+  auto data_ = make_safe(data);
+
+  // perform check on the input
+  if (data->type_num != NPY_FLOAT64 || data->ndim != 2){
+    PyErr_Format(PyExc_TypeError, "`%s' only processes 2D arrays of float64 for `%s`", Py_TYPE(self)->tp_name, adapt_mean_supervector.name());
+    return 0;
+  }
+
+  // writes the means directly into the given array
+  if (output_o){
+    PyBlitzArrayObject* mean_supervector_o = 0;
+    if (!PyBlitzArray_OutputConverter(output_o, &mean_supervector_o)) return 0;
+    auto mean_supervector_ = make_safe(mean_supervector_o);
+    auto mean_supervector = PyBlitzArrayCxx_AsBlitz<double,1>(mean_supervector_o, "mean_supervector");
+    if (!mean_supervector) return 0;
+
+    self->cxx->adaptMeanSupervector(*PyBlitzArrayCxx_AsBlitz<double,2>(data), *mean_supervector);
+    Py_INCREF(output_o);
+    return output_o;
+  }
+
+  const auto prior_gmm = self->cxx->getPriorGMM();
+  if (!prior_gmm){
+    PyErr_Format(PyExc_RuntimeError, "`%s' the prior GMM has not been set", Py_TYPE(self)->tp_name);
+    return 0;
+  }
+  blitz::Array<double,1> mean_supervector(prior_gmm->getNGaussians()*prior_gmm->getNInputs());
+  self->cxx->adaptMeanSupervector(*PyBlitzArrayCxx_AsBlitz<double,2>(data), mean_supervector);
+  return PyBlitzArrayCxx_AsConstNumpy(mean_supervector);
+
+  BOB_CATCH_MEMBER("cannot perform the adapt_mean_supervector method", 0)
+}
+
+
 /*** computeLikelihood ***/
 static auto compute_likelihood = bob::extension::FunctionDoc(
   "compute_likelihood",
@@ -440,6 +555,40 @@ static PyObject* PyBobLearnEMMAPGMMTrainer_compute_likelihood(PyBobLearnEMMAPGMM
 
 
 
+/*** save_statistics ***/
+static auto save_statistics = bob::extension::FunctionDoc(
+  "save_statistics",
+  "Saves the statistics accumulated by the last E-step (the :py:class:`bob.learn.em.GMMStats`) to the given HDF5 file",
+  "The E-step can be run on shards of the data, e.g. in several processes, each of them saving its statistics. "
+  "The statistics are then summed with :py:meth:`load_statistics` and :py:meth:`add_statistics` before the M-step.",
+  true
+)
+.add_prototype("hdf5")
+.add_parameter("hdf5", ":py:class:`bob.io.base.HDF5File`", "An HDF5 file open for writing");
+
+
+/*** load_statistics ***/
+static auto load_statistics = bob::extension::FunctionDoc(
+  "load_statistics",
+  "Loads statistics saved by :py:meth:`save_statistics`, in place of the accumulated ones",
+  "The trainer should have been initialized for the same machine, such that :py:meth:`m_step` can be called afterwards.",
+  true
+)
+.add_prototype("hdf5")
+.add_parameter("hdf5", ":py:class:`bob.io.base.HDF5File`", "An HDF5 file open for reading");
+
+
+/*** add_statistics ***/
+static auto add_statistics = bob::extension::FunctionDoc(
+  "add_statistics",
+  "Adds the statistics accumulated by another trainer to the ones of this trainer",
+  0,
+  true
+)
+.add_prototype("other")
+.add_parameter("other", ":py:class:`bob.learn.em.MAP_GMMTrainer`", "A trainer, e.g. in which :py:meth:`load_statistics` was called");
+
+
 static PyMethodDef PyBobLearnEMMAPGMMTrainer_methods[] = {
   {
     initialize.name(),
@@ -459,6 +608,18 @@ static PyMethodDef PyBobLearnEMMAPGMMTrainer_methods[] = {
     METH_VARARGS|METH_KEYWORDS,
     m_step.doc()
   },
+  {
+    adapt.name(),
+    (PyCFunction)PyBobLearnEMMAPGMMTrainer_adapt,
+    METH_VARARGS|METH_KEYWORDS,
+    adapt.doc()
+  },
+  {
+    adapt_mean_supervector.name(),
+    (PyCFunction)PyBobLearnEMMAPGMMTrainer_adapt_mean_supervector,
+    METH_VARARGS|METH_KEYWORDS,
+    adapt_mean_supervector.doc()
+  },
   {
     compute_likelihood.name(),
     (PyCFunction)PyBobLearnEMMAPGMMTrainer_compute_likelihood,
@@ -466,6 +627,24 @@ static PyMethodDef PyBobLearnEMMAPGMMTrainer_methods[] = {
     compute_likelihood.doc()
   },
 
+  {
+    save_statistics.name(),
+    (PyCFunction)PyBobLearnEMTrainer_save_statistics<PyBobLearnEMMAPGMMTrainerObject>,
+    METH_VARARGS|METH_KEYWORDS,
+    save_statistics.doc()
+  },
+  {
+    load_statistics.name(),
+    (PyCFunction)PyBobLearnEMTrainer_load_statistics<PyBobLearnEMMAPGMMTrainerObject>,
+    METH_VARARGS|METH_KEYWORDS,
+    load_statistics.doc()
+  },
+  {
+    add_statistics.name(),
+    (PyCFunction)PyBobLearnEMTrainer_add_statistics<PyBobLearnEMMAPGMMTrainerObject, &PyBobLearnEMMAPGMMTrainer_Type>,
+    METH_VARARGS|METH_KEYWORDS,
+    add_statistics.doc()
+  },
   {0} /* Sentinel */
 };
 
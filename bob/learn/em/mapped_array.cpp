@@ -0,0 +1,103 @@
+/**
+ * @date Sun Oct 18 23:10:12 2026 +0200
+ *
+ * @brief Numpy arrays which are views of a mapped file
+ *
+ * Copyright (C) Idiap Research Institute, Martigny, Switzerland
+ */
+
+#include "main.h"
+
+/* Exports an array of a mapped file through the buffer protocol, keeping the
+   file mapped as long as it lives; it is the base of the numpy array */
+typedef struct {
+  PyObject_HEAD
+  boost::shared_ptr<const bob::learn::em::MappedFile> file;
+  double* data;
+  int ndim;
+  Py_ssize_t shape[4];
+  Py_ssize_t strides[4];
+} PyBobLearnEMMappedArrayObject;
+
+static PyTypeObject PyBobLearnEMMappedArray_Type = {
+  PyVarObject_HEAD_INIT(0, 0)
+  0
+};
+
+static void PyBobLearnEMMappedArray_delete(PyBobLearnEMMappedArrayObject* self) {
+  self->file.reset();
+  Py_TYPE(self)->tp_free((PyObject*)self);
+}
+
+static int PyBobLearnEMMappedArray_getbuffer(PyBobLearnEMMappedArrayObject* self, Py_buffer* view, int flags) {
+  if (flags & PyBUF_WRITABLE){
+    PyErr_SetString(PyExc_BufferError, "the arrays of a mapped file are read-only");
+    view->obj = 0;
+    return -1;
+  }
+
+  Py_ssize_t size = 1;
+  for (int k=0; k<self->ndim; ++k) size *= self->shape[k];
+
+  view->obj = (PyObject*)self;
+  Py_INCREF(self);
+  view->buf = self->data;
+  view->len = size * sizeof(double);
+  view->readonly = 1;
+  view->itemsize = sizeof(double);
+  view->format = (flags & PyBUF_FORMAT) ? const_cast<char*>("d") : 0;
+  view->ndim = self->ndim;
+  view->shape = (flags & PyBUF_ND) == PyBUF_ND ? self->shape : 0;
+  view->strides = (flags & PyBUF_STRIDES) == PyBUF_STRIDES ? self->strides : 0;
+  view->suboffsets = 0;
+  view->internal = 0;
+  return 0;
+}
+
+static PyBufferProcs PyBobLearnEMMappedArray_buffer = {
+#if PY_VERSION_HEX < 0x03000000
+  0, 0, 0, 0,
+#endif
+  (getbufferproc)PyBobLearnEMMappedArray_getbuffer,
+  0
+};
+
+PyObject* PyBobLearnEMMappedArray_New(const boost::shared_ptr<const bob::learn::em::MappedFile>& file,
+  const double* data, const int ndim, const Py_ssize_t* shape, const Py_ssize_t* strides)
+{
+  PyBobLearnEMMappedArrayObject* self = (PyBobLearnEMMappedArrayObject*)PyBobLearnEMMappedArray_Type.tp_alloc(&PyBobLearnEMMappedArray_Type, 0);
+  if (!self) return 0;
+  auto self_ = make_safe(self);
+  self->file = file;
+  self->data = const_cast<double*>(data);
+  self->ndim = ndim;
+  for (int k=0; k<ndim; ++k){
+    self->shape[k] = shape[k];
+    self->strides[k] = strides[k];
+  }
+
+  PyObject* numpy = PyImport_ImportModule("numpy");
+  if (!numpy) return 0;
+  auto numpy_ = make_safe(numpy);
+  return PyObject_CallMethod(numpy, const_cast<char*>("asarray"), const_cast<char*>("O"), self);
+}
+
+bool init_BobLearnEMMappedArray(PyObject*)
+{
+  // initialize the type struct; it is not added to the module
+  PyBobLearnEMMappedArray_Type.tp_name = "bob.learn.em._MappedArray";
+  PyBobLearnEMMappedArray_Type.tp_basicsize = sizeof(PyBobLearnEMMappedArrayObject);
+  PyBobLearnEMMappedArray_Type.tp_flags = Py_TPFLAGS_DEFAULT
+#if PY_VERSION_HEX < 0x03000000
+    | Py_TPFLAGS_HAVE_NEWBUFFER
+#endif
+    ;
+  PyBobLearnEMMappedArray_Type.tp_doc = "A view of an array of a mapped file, which keeps the file mapped";
+
+  // set the functions
+  PyBobLearnEMMappedArray_Type.tp_dealloc = reinterpret_cast<destructor>(PyBobLearnEMMappedArray_delete);
+  PyBobLearnEMMappedArray_Type.tp_as_buffer = &PyBobLearnEMMappedArray_buffer;
+
+  // check that everything is fine
+  return PyType_Ready(&PyBobLearnEMMappedArray_Type) >= 0;
+}
@@ -209,7 +209,7 @@ static auto F = bob::extension::VariableDoc(
 );
 PyObject* PyBobLearnEMPLDABase_getF(PyBobLearnEMPLDABaseObject* self, void*){
   BOB_TRY
-  return PyBlitzArrayCxx_AsConstNumpy(self->cxx->getF());
+  return PyBobLearnEM_AsConstNumpy(self->cxx->getF(), self->cxx->getMappedFile());
   BOB_CATCH_MEMBER("`f` could not be read", 0)
 }
 int PyBobLearnEMPLDABase_setF(PyBobLearnEMPLDABaseObject* self, PyObject* value, void*){
@@ -236,7 +236,7 @@ static auto G = bob::extension::VariableDoc(
 );
 PyObject* PyBobLearnEMPLDABase_getG(PyBobLearnEMPLDABaseObject* self, void*){
   BOB_TRY
-  return PyBlitzArrayCxx_AsConstNumpy(self->cxx->getG());
+  return PyBobLearnEM_AsConstNumpy(self->cxx->getG(), self->cxx->getMappedFile());
   BOB_CATCH_MEMBER("`g` could not be read", 0)
 }
 int PyBobLearnEMPLDABase_setG(PyBobLearnEMPLDABaseObject* self, PyObject* value, void*){
@@ -264,7 +264,7 @@ static auto mu = bob::extension::VariableDoc(
 );
 PyObject* PyBobLearnEMPLDABase_getMu(PyBobLearnEMPLDABaseObject* self, void*){
   BOB_TRY
-  return PyBlitzArrayCxx_AsConstNumpy(self->cxx->getMu());
+  return PyBobLearnEM_AsConstNumpy(self->cxx->getMu(), self->cxx->getMappedFile());
   BOB_CATCH_MEMBER("`mu` could not be read", 0)
 }
 int PyBobLearnEMPLDABase_setMu(PyBobLearnEMPLDABaseObject* self, PyObject* value, void*){
@@ -292,7 +292,7 @@ static auto __isigma__ = bob::extension::VariableDoc(
 );
 static PyObject* PyBobLearnEMPLDABase_getISigma(PyBobLearnEMPLDABaseObject* self, PyObject* args, PyObject* kwargs) {
   BOB_TRY
-  return PyBlitzArrayCxx_AsConstNumpy(self->cxx->getISigma());
+  return PyBobLearnEM_AsConstNumpy(self->cxx->getISigma(), self->cxx->getMappedFile());
   BOB_CATCH_MEMBER("__isigma__ could not be read", 0)
 }
 
@@ -307,7 +307,7 @@ static auto __alpha__ = bob::extension::VariableDoc(
 );
 static PyObject* PyBobLearnEMPLDABase_getAlpha(PyBobLearnEMPLDABaseObject* self, PyObject* args, PyObject* kwargs) {
   BOB_TRY
-  return PyBlitzArrayCxx_AsConstNumpy(self->cxx->getAlpha());
+  return PyBobLearnEM_AsConstNumpy(self->cxx->getAlpha(), self->cxx->getMappedFile());
   BOB_CATCH_MEMBER("__alpha__ could not be read", 0)
 }
 
@@ -322,7 +322,7 @@ static auto __beta__ = bob::extension::VariableDoc(
 );
 static PyObject* PyBobLearnEMPLDABase_getBeta(PyBobLearnEMPLDABaseObject* self, PyObject* args, PyObject* kwargs) {
   BOB_TRY
-  return PyBlitzArrayCxx_AsConstNumpy(self->cxx->getBeta());
+  return PyBobLearnEM_AsConstNumpy(self->cxx->getBeta(), self->cxx->getMappedFile());
   BOB_CATCH_MEMBER("__beta__ could not be read", 0)
 }
 
@@ -336,7 +336,7 @@ static auto __ft_beta__ = bob::extension::VariableDoc(
 );
 static PyObject* PyBobLearnEMPLDABase_getFtBeta(PyBobLearnEMPLDABaseObject* self, PyObject* args, PyObject* kwargs) {
   BOB_TRY
-  return PyBlitzArrayCxx_AsConstNumpy(self->cxx->getFtBeta());
+  return PyBobLearnEM_AsConstNumpy(self->cxx->getFtBeta(), self->cxx->getMappedFile());
   BOB_CATCH_MEMBER("__ft_beta__ could not be read", 0)
 }
 
@@ -350,11 +350,25 @@ static auto __gt_i_sigma__ = bob::extension::VariableDoc(
 );
 static PyObject* PyBobLearnEMPLDABase_getGtISigma(PyBobLearnEMPLDABaseObject* self, PyObject* args, PyObject* kwargs) {
   BOB_TRY
-  return PyBlitzArrayCxx_AsConstNumpy(self->cxx->getGtISigma());
+  return PyBobLearnEM_AsConstNumpy(self->cxx->getGtISigma(), self->cxx->getMappedFile());
   BOB_CATCH_MEMBER("__gt_i_sigma__ could not be read", 0)
 }
 
 
+/***** table_size *****/
+static auto table_size = bob::extension::VariableDoc(
+  "table_size",
+  "int",
+  "The number of entries of the precomputed tables, see :py:meth:`precompute_tables`",
+  ":math:`\\gamma_a` and the log likelihood constant term are tabulated for all :math:`a` strictly lower than this value."
+);
+static PyObject* PyBobLearnEMPLDABase_getTableSize(PyBobLearnEMPLDABaseObject* self, void*){
+  BOB_TRY
+  return Py_BuildValue("n",self->cxx->getTableSize());
+  BOB_CATCH_MEMBER("table_size could not be read", 0)
+}
+
+
 /***** __logdet_alpha__ *****/
 static auto __logdet_alpha__ = bob::extension::VariableDoc(
   "__logdet_alpha__",
@@ -419,7 +433,7 @@ static auto sigma = bob::extension::VariableDoc(
 );
 static PyObject* PyBobLearnEMPLDABase_getSigma(PyBobLearnEMPLDABaseObject* self, PyObject* args, PyObject* kwargs) {
   BOB_TRY
-  return PyBlitzArrayCxx_AsConstNumpy(self->cxx->getSigma());
+  return PyBobLearnEM_AsConstNumpy(self->cxx->getSigma(), self->cxx->getMappedFile());
   BOB_CATCH_MEMBER("sigma could not be read", 0)
 }
 int PyBobLearnEMPLDABase_setSigma(PyBobLearnEMPLDABaseObject* self, PyObject* value, void*){
@@ -530,6 +544,13 @@ static PyGetSetDef PyBobLearnEMPLDABase_getseters[] = {
    variance_threshold.doc(),
    0
   },
+  {
+   table_size.name(),
+   (getter)PyBobLearnEMPLDABase_getTableSize,
+   0,
+   table_size.doc(),
+   0
+  },
   {0}  // Sentinel
 };
 
@@ -584,6 +605,50 @@ static PyObject* PyBobLearnEMPLDABase_Load(PyBobLearnEMPLDABaseObject* self, PyO
 }
 
 
+/*** save_mapped ***/
+static auto save_mapped = bob::extension::FunctionDoc(
+  "save_mapped",
+  "Save the PLDABase to a flat binary file, which can be mapped in memory by :py:meth:`load_mapped`",
+  "The arrays are stored in the byte order of this computer."
+)
+.add_prototype("filename")
+.add_parameter("filename", "str", "The name of the file to write");
+static PyObject* PyBobLearnEMPLDABase_SaveMapped(PyBobLearnEMPLDABaseObject* self, PyObject* args, PyObject* kwargs) {
+  BOB_TRY
+
+  char** kwlist = save_mapped.kwlist(0);
+  const char* filename;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "s", kwlist, &filename)) return 0;
+
+  self->cxx->saveMapped(filename);
+
+  BOB_CATCH_MEMBER("cannot save the data", 0)
+  Py_RETURN_NONE;
+}
+
+/*** load_mapped ***/
+static auto load_mapped = bob::extension::FunctionDoc(
+  "load_mapped",
+  "Load the PLDABase from a file written by :py:meth:`save_mapped`, mapping it in memory",
+  "Instead of being copies, ``f``, ``g``, ``sigma``, ``mu`` and the precomputed matrices are views of the file: the processes which load the same file share a single copy of it in memory. "
+  "Modifying the machine afterwards does not modify the file."
+)
+.add_prototype("filename")
+.add_parameter("filename", "str", "The name of the file to map");
+static PyObject* PyBobLearnEMPLDABase_LoadMapped(PyBobLearnEMPLDABaseObject* self, PyObject* args, PyObject* kwargs) {
+  BOB_TRY
+
+  char** kwlist = load_mapped.kwlist(0);
+  const char* filename;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "s", kwlist, &filename)) return 0;
+
+  self->cxx->loadMapped(filename);
+
+  BOB_CATCH_MEMBER("cannot load the data", 0)
+  Py_RETURN_NONE;
+}
+
+
 /*** is_similar_to ***/
 static auto is_similar_to = bob::extension::FunctionDoc(
   "is_similar_to",
@@ -888,6 +953,54 @@ static PyObject* PyBobLearnEMPLDABase_clearMaps(PyBobLearnEMPLDABaseObject* self
 }
 
 
+/***** precompute_tables *****/
+static auto precompute_tables = bob::extension::FunctionDoc(
+  "precompute_tables",
+  "Precomputes :math:`\\gamma_a` and the log likelihood constant term for all the numbers of samples :math:`0 \\leq a \\leq` ``max_n_samples``.",
+  "The values are stored in flat tables indexed by :math:`a`, which are then used by the getters and by the scoring methods of the :py:class:`bob.learn.em.PLDAMachine` "
+  "sharing this base: these lookups neither allocate nor modify the base, so that machines can be scored concurrently. "
+  "The tables are cleared whenever the parameters of the model are changed.",
+  true
+)
+.add_prototype("max_n_samples")
+.add_parameter("max_n_samples", "int", "The largest number of samples to tabulate");
+static PyObject* PyBobLearnEMPLDABase_precomputeTables(PyBobLearnEMPLDABaseObject* self, PyObject* args, PyObject* kwargs) {
+  BOB_TRY
+
+  char** kwlist = precompute_tables.kwlist(0);
+  int max_n_samples = 0;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "i", kwlist, &max_n_samples)) return 0;
+
+  if (max_n_samples < 0) {
+    PyErr_Format(PyExc_ValueError, "%s %s expects a positive max_n_samples", Py_TYPE(self)->tp_name, precompute_tables.name());
+    return 0;
+  }
+
+  self->cxx->precomputeTables(max_n_samples);
+  Py_RETURN_NONE;
+
+  BOB_CATCH_MEMBER("cannot precompute the tables", 0)
+}
+
+
+/***** clear_tables *****/
+static auto clear_tables = bob::extension::FunctionDoc(
+  "clear_tables",
+  "Clears the tables filled by :py:meth:`precompute_tables`.",
+  0,
+  true
+)
+.add_prototype("");
+static PyObject* PyBobLearnEMPLDABase_clearTables(PyBobLearnEMPLDABaseObject* self, PyObject* args, PyObject* kwargs) {
+  BOB_TRY
+
+  self->cxx->clearTables();
+  Py_RETURN_NONE;
+
+  BOB_CATCH_MEMBER("cannot clear the tables", 0)
+}
+
+
 /***** compute_log_likelihood_point_estimate *****/
 static auto compute_log_likelihood_point_estimate = bob::extension::FunctionDoc(
   "compute_log_likelihood_point_estimate",
@@ -972,6 +1085,18 @@ static PyMethodDef PyBobLearnEMPLDABase_methods[] = {
     METH_VARARGS|METH_KEYWORDS,
     load.doc()
   },
+  {
+    save_mapped.name(),
+    (PyCFunction)PyBobLearnEMPLDABase_SaveMapped,
+    METH_VARARGS|METH_KEYWORDS,
+    save_mapped.doc()
+  },
+  {
+    load_mapped.name(),
+    (PyCFunction)PyBobLearnEMPLDABase_LoadMapped,
+    METH_VARARGS|METH_KEYWORDS,
+    load_mapped.doc()
+  },
   {
     is_similar_to.name(),
     (PyCFunction)PyBobLearnEMPLDABase_IsSimilarTo,
@@ -1038,6 +1163,18 @@ static PyMethodDef PyBobLearnEMPLDABase_methods[] = {
     METH_NOARGS,
     clear_maps.doc()
   },
+  {
+    precompute_tables.name(),
+    (PyCFunction)PyBobLearnEMPLDABase_precomputeTables,
+    METH_VARARGS|METH_KEYWORDS,
+    precompute_tables.doc()
+  },
+  {
+    clear_tables.name(),
+    (PyCFunction)PyBobLearnEMPLDABase_clearTables,
+    METH_NOARGS,
+    clear_tables.doc()
+  },
   {
     compute_log_likelihood_point_estimate.name(),
     (PyCFunction)PyBobLearnEMPLDABase_computeLogLikelihoodPointEstimate,
@@ -0,0 +1,400 @@
+/**
+ * @date Sun Oct 18 15:08:14 2026 +0200
+ *
+ * @brief Python API for bob::learn::em
+ *
+ * Copyright (C) 2011-2014 Idiap Research Institute, Martigny, Switzerland
+ */
+
+#include "main.h"
+
+/******************************************************************/
+/************ Constructor Section *********************************/
+/******************************************************************/
+
+static auto PLDAFastScorer_doc = bob::extension::ClassDoc(
+  BOB_EXT_MODULE_PREFIX ".PLDAFastScorer",
+
+  "Scores PLDA trials where the model is enrolled with a single sample, using the closed form of the log-likelihood ratio "
+  ":math:`s(x,y) = \\tilde{x}^T Q \\tilde{x} + \\tilde{y}^T Q \\tilde{y} + 2 \\tilde{x}^T P \\tilde{y} + c`, with :math:`\\tilde{x} = x - \\mu`.\n\n"
+  "The score is the one of a :py:class:`bob.learn.em.PLDAMachine` enrolled with :math:`x`, for the probe :math:`y`. "
+  "The scorer only depends on :math:`P`, :math:`Q`, :math:`\\mu` and :math:`c`, and can be saved and loaded independently of the :py:class:`bob.learn.em.PLDABase` it was derived from.",
+  ""
+).add_constructor(
+  bob::extension::FunctionDoc(
+    "__init__",
+    "Creates a PLDAFastScorer",
+    "",
+    true
+  )
+  .add_prototype("plda_base","")
+  .add_prototype("other","")
+  .add_prototype("hdf5","")
+
+  .add_parameter("plda_base", ":py:class:`bob.learn.em.PLDABase`", "The PLDABase to derive the scorer from.")
+  .add_parameter("other", ":py:class:`bob.learn.em.PLDAFastScorer`", "A PLDAFastScorer object to be copied.")
+  .add_parameter("hdf5", ":py:class:`bob.io.base.HDF5File`", "An HDF5 file open for reading")
+);
+
+
+static int PyBobLearnEMPLDAFastScorer_init(PyBobLearnEMPLDAFastScorerObject* self, PyObject* args, PyObject* kwargs) {
+  BOB_TRY
+
+  // get the number of command line arguments
+  int nargs = (args?PyTuple_Size(args):0) + (kwargs?PyDict_Size(kwargs):0);
+
+  if (nargs != 1){
+    PyErr_Format(PyExc_RuntimeError, "number of arguments mismatch - %s requires 1 argument, but you provided %d (see help)", Py_TYPE(self)->tp_name, nargs);
+    PLDAFastScorer_doc.print_usage();
+    return -1;
+  }
+
+  //Reading the input argument
+  PyObject* arg = 0;
+  if (PyTuple_Size(args))
+    arg = PyTuple_GET_ITEM(args, 0);
+  else {
+    PyObject* tmp = PyDict_Values(kwargs);
+    auto tmp_ = make_safe(tmp);
+    arg = PyList_GET_ITEM(tmp, 0);
+  }
+
+  if (PyBobLearnEMPLDABase_Check(arg))
+    self->cxx.reset(new bob::learn::em::PLDAFastScorer(*reinterpret_cast<PyBobLearnEMPLDABaseObject*>(arg)->cxx));
+  else if (PyBobLearnEMPLDAFastScorer_Check(arg))
+    self->cxx.reset(new bob::learn::em::PLDAFastScorer(*reinterpret_cast<PyBobLearnEMPLDAFastScorerObject*>(arg)->cxx));
+  else if (PyBobIoHDF5File_Check(arg))
+    self->cxx.reset(new bob::learn::em::PLDAFastScorer(*reinterpret_cast<PyBobIoHDF5FileObject*>(arg)->f));
+  else {
+    PyErr_Format(PyExc_TypeError, "%s expects a :py:class:`bob.learn.em.PLDABase`, a :py:class:`bob.learn.em.PLDAFastScorer` or a :py:class:`bob.io.base.HDF5File`, not `%s'", Py_TYPE(self)->tp_name, Py_TYPE(arg)->tp_name);
+    PLDAFastScorer_doc.print_usage();
+    return -1;
+  }
+
+  return 0;
+  BOB_CATCH_MEMBER("cannot create PLDAFastScorer", -1)
+}
+
+
+static void PyBobLearnEMPLDAFastScorer_delete(PyBobLearnEMPLDAFastScorerObject* self) {
+  self->cxx.reset();
+  Py_TYPE(self)->tp_free((PyObject*)self);
+}
+
+static PyObject* PyBobLearnEMPLDAFastScorer_RichCompare(PyBobLearnEMPLDAFastScorerObject* self, PyObject* other, int op) {
+  BOB_TRY
+
+  if (!PyBobLearnEMPLDAFastScorer_Check(other)) {
+    PyErr_Format(PyExc_TypeError, "cannot compare `%s' with `%s'", Py_TYPE(self)->tp_name, Py_TYPE(other)->tp_name);
+    return 0;
+  }
+  auto other_ = reinterpret_cast<PyBobLearnEMPLDAFastScorerObject*>(other);
+  switch (op) {
+    case Py_EQ:
+      if (*self->cxx==*other_->cxx) Py_RETURN_TRUE; else Py_RETURN_FALSE;
+    case Py_NE:
+      if (*self->cxx==*other_->cxx) Py_RETURN_FALSE; else Py_RETURN_TRUE;
+    default:
+      Py_INCREF(Py_NotImplemented);
+      return Py_NotImplemented;
+  }
+  BOB_CATCH_MEMBER("cannot compare PLDAFastScorer objects", 0)
+}
+
+int PyBobLearnEMPLDAFastScorer_Check(PyObject* o) {
+  return PyObject_IsInstance(o, reinterpret_cast<PyObject*>(&PyBobLearnEMPLDAFastScorer_Type));
+}
+
+
+/******************************************************************/
+/************ Variables Section ***********************************/
+/******************************************************************/
+
+/***** p *****/
+static auto p = bob::extension::VariableDoc(
+  "p",
+  "array_like <float, 2D>",
+  "The :math:`P` matrix of the cross term",
+  ""
+);
+PyObject* PyBobLearnEMPLDAFastScorer_getP(PyBobLearnEMPLDAFastScorerObject* self, void*) {
+  BOB_TRY
+  return PyBlitzArrayCxx_AsConstNumpy(self->cxx->getP());
+  BOB_CATCH_MEMBER("p could not be read", 0)
+}
+
+
+/***** q *****/
+static auto q = bob::extension::VariableDoc(
+  "q",
+  "array_like <float, 2D>",
+  "The :math:`Q` matrix of the quadratic terms",
+  ""
+);
+PyObject* PyBobLearnEMPLDAFastScorer_getQ(PyBobLearnEMPLDAFastScorerObject* self, void*) {
+  BOB_TRY
+  return PyBlitzArrayCxx_AsConstNumpy(self->cxx->getQ());
+  BOB_CATCH_MEMBER("q could not be read", 0)
+}
+
+
+/***** mu *****/
+static auto mu = bob::extension::VariableDoc(
+  "mu",
+  "array_like <float, 1D>",
+  "The mean vector :math:`\\mu` of the PLDA model",
+  ""
+);
+PyObject* PyBobLearnEMPLDAFastScorer_getMu(PyBobLearnEMPLDAFastScorerObject* self, void*) {
+  BOB_TRY
+  return PyBlitzArrayCxx_AsConstNumpy(self->cxx->getMu());
+  BOB_CATCH_MEMBER("mu could not be read", 0)
+}
+
+
+/***** constant *****/
+static auto constant = bob::extension::VariableDoc(
+  "constant",
+  "float",
+  "The constant term :math:`c`",
+  ""
+);
+PyObject* PyBobLearnEMPLDAFastScorer_getConstant(PyBobLearnEMPLDAFastScorerObject* self, void*) {
+  BOB_TRY
+  return Py_BuildValue("d", self->cxx->getConstant());
+  BOB_CATCH_MEMBER("constant could not be read", 0)
+}
+
+
+static PyGetSetDef PyBobLearnEMPLDAFastScorer_getseters[] = {
+  {
+   p.name(),
+   (getter)PyBobLearnEMPLDAFastScorer_getP,
+   0,
+   p.doc(),
+   0
+  },
+  {
+   q.name(),
+   (getter)PyBobLearnEMPLDAFastScorer_getQ,
+   0,
+   q.doc(),
+   0
+  },
+  {
+   mu.name(),
+   (getter)PyBobLearnEMPLDAFastScorer_getMu,
+   0,
+   mu.doc(),
+   0
+  },
+  {
+   constant.name(),
+   (getter)PyBobLearnEMPLDAFastScorer_getConstant,
+   0,
+   constant.doc(),
+   0
+  },
+
+  {0}  // Sentinel
+};
+
+
+/******************************************************************/
+/************ Functions Section ***********************************/
+/******************************************************************/
+
+/*** score ***/
+static auto score = bob::extension::FunctionDoc(
+  "score",
+  "Computes the log-likelihood ratio of a trial, or of all the models against all the probes",
+  "With 2D arrays, the cross terms of all the trials are obtained with a single matrix product.",
+  true
+)
+.add_prototype("model,probe","output")
+.add_prototype("models,probes","output")
+.add_parameter("model", "array_like <float, 1D>", "The enrollment sample of the model")
+.add_parameter("probe", "array_like <float, 1D>", "The probe sample")
+.add_parameter("models", "array_like <float, 2D>", "The enrollment samples of the models, one per row")
+.add_parameter("probes", "array_like <float, 2D>", "The probe samples, one per row")
+.add_return("output","float or array_like <float, 2D>","The score, or the ``(n_models, n_probes)`` matrix of scores");
+static PyObject* PyBobLearnEMPLDAFastScorer_score(PyBobLearnEMPLDAFastScorerObject* self, PyObject* args, PyObject* kwargs) {
+  BOB_TRY
+
+  char** kwlist = score.kwlist(0);
+
+  PyBlitzArrayObject* models_o = 0;
+  PyBlitzArrayObject* probes_o = 0;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O&O&", kwlist, &PyBlitzArray_Converter, &models_o,
+                                                               &PyBlitzArray_Converter, &probes_o)){
+    score.print_usage();
+    return 0;
+  }
+
+  auto models_ = make_safe(models_o);
+  auto probes_ = make_safe(probes_o);
+
+  if (models_o->type_num != NPY_FLOAT64 || probes_o->type_num != NPY_FLOAT64 || models_o->ndim != probes_o->ndim ||
+      (models_o->ndim != 1 && models_o->ndim != 2)) {
+    PyErr_Format(PyExc_TypeError, "`%s' only processes 1D or 2D arrays of type float64 (of the same dimensionality)", Py_TYPE(self)->tp_name);
+    score.print_usage();
+    return 0;
+  }
+
+  if (models_o->ndim == 1)
+    return Py_BuildValue("d", self->cxx->score(*PyBlitzArrayCxx_AsBlitz<double,1>(models_o), *PyBlitzArrayCxx_AsBlitz<double,1>(probes_o)));
+
+  blitz::Array<double,2> scores(models_o->shape[0], probes_o->shape[0]);
+  self->cxx->score(*PyBlitzArrayCxx_AsBlitz<double,2>(models_o), *PyBlitzArrayCxx_AsBlitz<double,2>(probes_o), scores);
+  return PyBlitzArrayCxx_AsConstNumpy(scores);
+
+  BOB_CATCH_MEMBER("cannot compute the scores", 0)
+}
+
+
+/*** save ***/
+static auto save = bob::extension::FunctionDoc(
+  "save",
+  "Save the configuration of the PLDAFastScorer to a given HDF5 file"
+)
+.add_prototype("hdf5")
+.add_parameter("hdf5", ":py:class:`bob.io.base.HDF5File`", "An HDF5 file open for writing");
+static PyObject* PyBobLearnEMPLDAFastScorer_Save(PyBobLearnEMPLDAFastScorerObject* self,  PyObject* args, PyObject* kwargs) {
+
+  BOB_TRY
+
+  // get list of arguments
+  char** kwlist = save.kwlist(0);
+  PyBobIoHDF5FileObject* hdf5;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O&", kwlist, PyBobIoHDF5File_Converter, &hdf5)) return 0;
+
+  auto hdf5_ = make_safe(hdf5);
+  self->cxx->save(*hdf5->f);
+
+  BOB_CATCH_MEMBER("cannot save the data", 0)
+  Py_RETURN_NONE;
+}
+
+/*** load ***/
+static auto load = bob::extension::FunctionDoc(
+  "load",
+  "Load the configuration of the PLDAFastScorer to a given HDF5 file"
+)
+.add_prototype("hdf5")
+.add_parameter("hdf5", ":py:class:`bob.io.base.HDF5File`", "An HDF5 file open for reading");
+static PyObject* PyBobLearnEMPLDAFastScorer_Load(PyBobLearnEMPLDAFastScorerObject* self, PyObject* args, PyObject* kwargs) {
+  BOB_TRY
+
+  char** kwlist = load.kwlist(0);
+  PyBobIoHDF5FileObject* hdf5;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O&", kwlist, PyBobIoHDF5File_Converter, &hdf5)) return 0;
+
+  auto hdf5_ = make_safe(hdf5);
+  self->cxx->load(*hdf5->f);
+
+  BOB_CATCH_MEMBER("cannot load the data", 0)
+  Py_RETURN_NONE;
+}
+
+
+/*** is_similar_to ***/
+static auto is_similar_to = bob::extension::FunctionDoc(
+  "is_similar_to",
+
+  "Compares this PLDAFastScorer with the ``other`` one to be approximately the same.",
+  "The optional values ``r_epsilon`` and ``a_epsilon`` refer to the "
+  "relative and absolute precision of the matrices and constant."
+)
+.add_prototype("other, [r_epsilon], [a_epsilon]","output")
+.add_parameter("other", ":py:class:`bob.learn.em.PLDAFastScorer`", "A PLDAFastScorer object to be compared.")
+.add_parameter("r_epsilon", "float", "Relative precision.")
+.add_parameter("a_epsilon", "float", "Absolute precision.")
+.add_return("output","bool","True if it is similar, otherwise false.");
+static PyObject* PyBobLearnEMPLDAFastScorer_IsSimilarTo(PyBobLearnEMPLDAFastScorerObject* self, PyObject* args, PyObject* kwds) {
+
+  /* Parses input arguments in a single shot */
+  char** kwlist = is_similar_to.kwlist(0);
+
+  PyBobLearnEMPLDAFastScorerObject* other = 0;
+  double r_epsilon = 1.e-5;
+  double a_epsilon = 1.e-8;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "O!|dd", kwlist,
+        &PyBobLearnEMPLDAFastScorer_Type, &other,
+        &r_epsilon, &a_epsilon)){
+
+        is_similar_to.print_usage();
+        return 0;
+  }
+
+  if (self->cxx->is_similar_to(*other->cxx, r_epsilon, a_epsilon))
+    Py_RETURN_TRUE;
+  else
+    Py_RETURN_FALSE;
+}
+
+
+static PyMethodDef PyBobLearnEMPLDAFastScorer_methods[] = {
+  {
+    score.name(),
+    (PyCFunction)PyBobLearnEMPLDAFastScorer_score,
+    METH_VARARGS|METH_KEYWORDS,
+    score.doc()
+  },
+  {
+    save.name(),
+    (PyCFunction)PyBobLearnEMPLDAFastScorer_Save,
+    METH_VARARGS|METH_KEYWORDS,
+    save.doc()
+  },
+  {
+    load.name(),
+    (PyCFunction)PyBobLearnEMPLDAFastScorer_Load,
+    METH_VARARGS|METH_KEYWORDS,
+    load.doc()
+  },
+  {
+    is_similar_to.name(),
+    (PyCFunction)PyBobLearnEMPLDAFastScorer_IsSimilarTo,
+    METH_VARARGS|METH_KEYWORDS,
+    is_similar_to.doc()
+  },
+
+  {0} /* Sentinel */
+};
+
+
+/******************************************************************/
+/************ Module Section **************************************/
+/******************************************************************/
+
+// Define the PLDAFastScorer type struct; will be initialized later
+PyTypeObject PyBobLearnEMPLDAFastScorer_Type = {
+  PyVarObject_HEAD_INIT(0,0)
+  0
+};
+
+bool init_BobLearnEMPLDAFastScorer(PyObject* module)
+{
+  // initialize the type struct
+  PyBobLearnEMPLDAFastScorer_Type.tp_name      = PLDAFastScorer_doc.name();
+  PyBobLearnEMPLDAFastScorer_Type.tp_basicsize = sizeof(PyBobLearnEMPLDAFastScorerObject);
+  PyBobLearnEMPLDAFastScorer_Type.tp_flags     = Py_TPFLAGS_DEFAULT;
+  PyBobLearnEMPLDAFastScorer_Type.tp_doc       = PLDAFastScorer_doc.doc();
+
+  // set the functions
+  PyBobLearnEMPLDAFastScorer_Type.tp_new         = PyType_GenericNew;
+  PyBobLearnEMPLDAFastScorer_Type.tp_init        = reinterpret_cast<initproc>(PyBobLearnEMPLDAFastScorer_init);
+  PyBobLearnEMPLDAFastScorer_Type.tp_dealloc     = reinterpret_cast<destructor>(PyBobLearnEMPLDAFastScorer_delete);
+  PyBobLearnEMPLDAFastScorer_Type.tp_richcompare = reinterpret_cast<richcmpfunc>(PyBobLearnEMPLDAFastScorer_RichCompare);
+  PyBobLearnEMPLDAFastScorer_Type.tp_methods     = PyBobLearnEMPLDAFastScorer_methods;
+  PyBobLearnEMPLDAFastScorer_Type.tp_getset      = PyBobLearnEMPLDAFastScorer_getseters;
+  PyBobLearnEMPLDAFastScorer_Type.tp_call        = reinterpret_cast<ternaryfunc>(PyBobLearnEMPLDAFastScorer_score);
+
+  // check that everything is fine
+  if (PyType_Ready(&PyBobLearnEMPLDAFastScorer_Type) < 0) return false;
+
+  // add the type to the module
+  Py_INCREF(&PyBobLearnEMPLDAFastScorer_Type);
+  return PyModule_AddObject(module, "PLDAFastScorer", (PyObject*)&PyBobLearnEMPLDAFastScorer_Type) >= 0;
+}
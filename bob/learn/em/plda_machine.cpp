@@ -650,11 +650,21 @@ static PyObject* PyBobLearnEMPLDAMachine_computeLogLikelihood(PyBobLearnEMPLDAMa
                                                                   &PyBool_Type, &with_enrolled_samples)) return 0;
   auto samples_ = make_safe(samples);
 
-  /*Using the proper method according to the dimension*/
-  if (samples->ndim==1)
-    return Py_BuildValue("d",self->cxx->computeLogLikelihood(*PyBlitzArrayCxx_AsBlitz<double,1>(samples), f(with_enrolled_samples)));
-  else
-    return Py_BuildValue("d",self->cxx->computeLogLikelihood(*PyBlitzArrayCxx_AsBlitz<double,2>(samples), f(with_enrolled_samples)));
+  /*Using the proper method according to the dimension; the scoring does not
+    modify the machine, so that several threads can use it*/
+  double log_likelihood;
+  bool enroll = f(with_enrolled_samples);
+  if (samples->ndim==1){
+    auto samples__ = PyBlitzArrayCxx_AsBlitz<double,1>(samples);
+    GILReleaser gil;
+    log_likelihood = self->cxx->computeLogLikelihood(*samples__, enroll);
+  }
+  else{
+    auto samples__ = PyBlitzArrayCxx_AsBlitz<double,2>(samples);
+    GILReleaser gil;
+    log_likelihood = self->cxx->computeLogLikelihood(*samples__, enroll);
+  }
+  return Py_BuildValue("d", log_likelihood);
 
 
   BOB_CATCH_MEMBER("`compute_log_likelihood` could not be read", 0)
@@ -683,10 +693,18 @@ static PyObject* PyBobLearnEMPLDAMachine_log_likelihood_ratio(PyBobLearnEMPLDAMa
   auto samples_ = make_safe(samples);
 
    //There are 2 methods in C++, one <double,1> and the another <double,2>
-  if(samples->ndim==1)
-    return Py_BuildValue("d",self->cxx->forward(*PyBlitzArrayCxx_AsBlitz<double,1>(samples)));
-  else
-    return Py_BuildValue("d",self->cxx->forward(*PyBlitzArrayCxx_AsBlitz<double,2>(samples)));
+  double ratio;
+  if(samples->ndim==1){
+    auto samples__ = PyBlitzArrayCxx_AsBlitz<double,1>(samples);
+    GILReleaser gil;
+    ratio = self->cxx->forward(*samples__);
+  }
+  else{
+    auto samples__ = PyBlitzArrayCxx_AsBlitz<double,2>(samples);
+    GILReleaser gil;
+    ratio = self->cxx->forward(*samples__);
+  }
+  return Py_BuildValue("d", ratio);
 
   BOB_CATCH_MEMBER("log_likelihood_ratio could not be executed", 0)
 }
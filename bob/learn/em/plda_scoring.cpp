@@ -0,0 +1,66 @@
+/**
+ * @date Sun Oct 18 14:26:52 2026 +0200
+ *
+ * @brief Python API for bob::learn::em
+ *
+ * Copyright (C) 2011-2014 Idiap Research Institute, Martigny, Switzerland
+ */
+
+#include "main.h"
+
+/*Convert a PyObject to a list of PLDAMachine*/
+static int extract_pldamachine_list(PyObject *list,
+                             std::vector<boost::shared_ptr<const bob::learn::em::PLDAMachine> >& models)
+{
+  for (int i=0; i<PyList_GET_SIZE(list); i++){
+
+    PyBobLearnEMPLDAMachineObject* machine;
+    if (!PyArg_Parse(PyList_GetItem(list, i), "O!", &PyBobLearnEMPLDAMachine_Type, &machine)){
+      PyErr_Format(PyExc_RuntimeError, "Expected PLDAMachine objects");
+      return -1;
+    }
+    models.push_back(machine->cxx);
+  }
+  return 0;
+}
+
+
+/*** plda_scoring ***/
+bob::extension::FunctionDoc plda_scoring = bob::extension::FunctionDoc(
+  "plda_scoring",
+  "Scores a list of enrolled PLDA models against a list of probe samples",
+  "``output[m,t]`` is the log-likelihood ratio returned by ``models[m](probes[t])``. "
+  "The probe-dependent terms are computed only once per probe and the model-dependent terms once per model, the scores being obtained with matrix products.",
+  true
+)
+.add_prototype("models, probes", "output")
+.add_parameter("models", "list(:py:class:`bob.learn.em.PLDAMachine`)", "Enrolled models, sharing the same :py:class:`bob.learn.em.PLDABase`")
+.add_parameter("probes", "array_like<float,2>", "The probe samples, one per row")
+.add_return("output","array_like<float,2>","The scores");
+PyObject* PyBobLearnEM_plda_scoring(PyObject*, PyObject* args, PyObject* kwargs) {
+BOB_TRY
+  char** kwlist = plda_scoring.kwlist(0);
+
+  PyObject* model_list_o = 0;
+  PyBlitzArrayObject* probes_o = 0;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!O&", kwlist, &PyList_Type, &model_list_o,
+                                                               &PyBlitzArray_Converter, &probes_o)){
+    plda_scoring.print_usage();
+    return 0;
+  }
+
+  //protects acquired resources through this scope
+  auto probes_ = make_safe(probes_o);
+  auto probes = PyBlitzArrayCxx_AsBlitz<double,2>(probes_o, "probes");
+  if (!probes) return 0;
+
+  std::vector<boost::shared_ptr<const bob::learn::em::PLDAMachine> > models;
+  if (extract_pldamachine_list(model_list_o, models) != 0)
+    return 0;
+
+  blitz::Array<double,2> scores(models.size(), probes->extent(0));
+  bob::learn::em::pldaScoring(models, *probes, scores);
+  return PyBlitzArrayCxx_AsConstNumpy(scores);
+BOB_CATCH_FUNCTION("plda_scoring", 0)
+}
@@ -368,6 +368,67 @@ int PyBobLearnEMPLDATrainer_setUseSumSecondOrder(PyBobLearnEMPLDATrainerObject*
 }
 
 
+static auto low_memory = bob::extension::VariableDoc(
+  "low_memory",
+  "bool",
+  "Tells whether the trainer runs in low-memory mode (disabled by default).",
+  "In this mode, neither the centred training samples nor the statistics of the latent variables of each sample are stored: "
+  "the E-step computes them on the fly, identity by identity, and only keeps the sums required by the M-step, "
+  "so that the memory used does not depend on the size of the training set. "
+  ":py:attr:`z_first_order` and :py:attr:`z_second_order` are then not available. "
+  "Changing this flag takes effect at the next call to :py:meth:`initialize`."
+);
+PyObject* PyBobLearnEMPLDATrainer_getLowMemory(PyBobLearnEMPLDATrainerObject* self, void*){
+  BOB_TRY
+  return Py_BuildValue("O",self->cxx->getLowMemory()?Py_True:Py_False);
+  BOB_CATCH_MEMBER("low_memory could not be read", 0)
+}
+int PyBobLearnEMPLDATrainer_setLowMemory(PyBobLearnEMPLDATrainerObject* self, PyObject* value, void*) {
+  BOB_TRY
+
+  if (!PyBool_Check(value)){
+    PyErr_Format(PyExc_RuntimeError, "%s %s expects a bool", Py_TYPE(self)->tp_name, low_memory.name());
+    return -1;
+  }
+  self->cxx->setLowMemory(f(value));
+
+  return 0;
+  BOB_CATCH_MEMBER("low_memory could not be set", -1)
+}
+
+
+static auto n_threads = bob::extension::VariableDoc(
+  "n_threads",
+  "int",
+  "The number of threads used by the E- and M-steps (0 means one per hardware thread)",
+  "The identities are split into as many chunks, each accumulating its own partial sums, which are then added in a fixed order: "
+  "the results only depend on the number of threads, and are the same as the ones of the single-threaded trainer when it is set to 1 (the default)."
+);
+PyObject* PyBobLearnEMPLDATrainer_getNThreads(PyBobLearnEMPLDATrainerObject* self, void*){
+  BOB_TRY
+  return Py_BuildValue("n",self->cxx->getNThreads());
+  BOB_CATCH_MEMBER("n_threads could not be read", 0)
+}
+int PyBobLearnEMPLDATrainer_setNThreads(PyBobLearnEMPLDATrainerObject* self, PyObject* value, void*) {
+  BOB_TRY
+
+  if (!PyInt_Check(value)){
+    PyErr_Format(PyExc_RuntimeError, "%s %s expects an int", Py_TYPE(self)->tp_name, n_threads.name());
+    return -1;
+  }
+
+  if (PyInt_AS_LONG(value) < 0){
+    PyErr_Format(PyExc_TypeError, "n_threads must be greater than or equal to zero");
+    return -1;
+  }
+
+  self->cxx->setNThreads(PyInt_AS_LONG(value));
+
+  return 0;
+  BOB_CATCH_MEMBER("n_threads could not be set", -1)
+}
+
+
 
 static PyGetSetDef PyBobLearnEMPLDATrainer_getseters[] = {
   {
@@ -419,6 +480,20 @@ static PyGetSetDef PyBobLearnEMPLDATrainer_getseters[] = {
    use_sum_second_order.doc(),
    0
   },
+  {
+   low_memory.name(),
+   (getter)PyBobLearnEMPLDATrainer_getLowMemory,
+   (setter)PyBobLearnEMPLDATrainer_setLowMemory,
+   low_memory.doc(),
+   0
+  },
+  {
+   n_threads.name(),
+   (getter)PyBobLearnEMPLDATrainer_getNThreads,
+   (setter)PyBobLearnEMPLDATrainer_setNThreads,
+   n_threads.doc(),
+   0
+  },
   {0}  // Sentinel
 };
 
@@ -603,6 +678,38 @@ static PyObject* PyBobLearnEMPLDATrainer_enroll(PyBobLearnEMPLDATrainerObject* s
 }
 
 
+/*** enroll_append ***/
+static auto enroll_append = bob::extension::FunctionDoc(
+  "enroll_append",
+  "Adds enrollment samples to a PLDAMachine, keeping the ones it was already enrolled with",
+  "Only the new samples are processed, as the statistics of the enrollment samples are additive: "
+  "the result is the same as calling :py:meth:`enroll` with all the samples at once.",
+  true
+)
+.add_prototype("plda_machine,data")
+.add_parameter("plda_machine", ":py:class:`bob.learn.em.PLDAMachine`", "PLDAMachine Object")
+.add_parameter("data", "array_like <float, 2D>", "The new enrollment samples");
+static PyObject* PyBobLearnEMPLDATrainer_enroll_append(PyBobLearnEMPLDATrainerObject* self, PyObject* args, PyObject* kwargs) {
+  BOB_TRY
+
+  /* Parses input arguments in a single shot */
+  char** kwlist = enroll_append.kwlist(0);
+
+  PyBobLearnEMPLDAMachineObject* plda_machine = 0;
+  PyBlitzArrayObject* data = 0;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!O&", kwlist, &PyBobLearnEMPLDAMachine_Type, &plda_machine,
+                                                                 &PyBlitzArray_Converter, &data)) return 0;
+
+  auto data_ = make_safe(data);
+  self->cxx->enrollAppend(*plda_machine->cxx, *PyBlitzArrayCxx_AsBlitz<double,2>(data));
+
+  BOB_CATCH_MEMBER("cannot perform the enroll_append method", 0)
+
+  Py_RETURN_NONE;
+}
+
+
 /*** is_similar_to ***/
 static auto is_similar_to = bob::extension::FunctionDoc(
   "is_similar_to",
@@ -674,6 +781,12 @@ static PyMethodDef PyBobLearnEMPLDATrainer_methods[] = {
     METH_VARARGS|METH_KEYWORDS,
     enroll.doc()
   },
+  {
+    enroll_append.name(),
+    (PyCFunction)PyBobLearnEMPLDATrainer_enroll_append,
+    METH_VARARGS|METH_KEYWORDS,
+    enroll_append.doc()
+  },
   {
     is_similar_to.name(),
     (PyCFunction)PyBobLearnEMPLDATrainer_IsSimilarTo,
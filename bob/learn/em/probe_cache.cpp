@@ -0,0 +1,335 @@
+/**
+ * @date Sun Oct 18 11:02:47 2026 +0200
+ *
+ * @brief Python API for bob::learn::em
+ *
+ * Copyright (C) 2011-2014 Idiap Research Institute, Martigny, Switzerland
+ */
+
+#include "main.h"
+
+/******************************************************************/
+/************ Constructor Section *********************************/
+/******************************************************************/
+
+static auto ProbeCache_doc = bob::extension::ClassDoc(
+  BOB_EXT_MODULE_PREFIX ".ProbeCache",
+
+  "Caches, for each probe, the channel offset Ux and the centred first order statistics used to score ISV/JFA models.\n\n"
+  "When the same probe is scored against several models (enrolled models, Z-/T-norm cohorts), these quantities are computed only once. "
+  "A cache is bound to a single :py:class:`bob.learn.em.ISVBase` or :py:class:`bob.learn.em.JFABase` and can be given to the ``forward_ux`` method of all the machines sharing it. "
+  "Its memory is bounded, the least recently used probes being evicted first.",
+  "Probes are identified by their :py:class:`bob.learn.em.GMMStats` object: call :py:meth:`clear` if the statistics of a cached probe or the base are modified."
+).add_constructor(
+  bob::extension::FunctionDoc(
+    "__init__",
+    "Creates a ProbeCache",
+    "",
+    true
+  )
+  .add_prototype("base,max_bytes","")
+
+  .add_parameter("base", ":py:class:`bob.learn.em.ISVBase` or :py:class:`bob.learn.em.JFABase`", "The base shared by the machines that will use this cache.")
+  .add_parameter("max_bytes", "int", "The memory budget of the cached arrays, in bytes.")
+);
+
+
+static int PyBobLearnEMProbeCache_init(PyBobLearnEMProbeCacheObject* self, PyObject* args, PyObject* kwargs) {
+  BOB_TRY
+
+  char** kwlist = ProbeCache_doc.kwlist(0);
+
+  PyObject* base = 0;
+  Py_ssize_t max_bytes = 0;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "On", kwlist, &base, &max_bytes)){
+    ProbeCache_doc.print_usage();
+    return -1;
+  }
+
+  if (max_bytes < 0){
+    PyErr_Format(PyExc_ValueError, "%s: max_bytes must be positive (or 0), but you provided %" PY_FORMAT_SIZE_T "d", Py_TYPE(self)->tp_name, max_bytes);
+    return -1;
+  }
+
+  if (PyBobLearnEMISVBase_Check(base))
+    self->cxx.reset(new bob::learn::em::ProbeCache(reinterpret_cast<PyBobLearnEMISVBaseObject*>(base)->cxx, max_bytes));
+  else if (PyBobLearnEMJFABase_Check(base))
+    self->cxx.reset(new bob::learn::em::ProbeCache(reinterpret_cast<PyBobLearnEMJFABaseObject*>(base)->cxx, max_bytes));
+  else {
+    PyErr_Format(PyExc_TypeError, "%s expects a :py:class:`bob.learn.em.ISVBase` or a :py:class:`bob.learn.em.JFABase` as base, not `%s'", Py_TYPE(self)->tp_name, Py_TYPE(base)->tp_name);
+    ProbeCache_doc.print_usage();
+    return -1;
+  }
+
+  return 0;
+  BOB_CATCH_MEMBER("cannot create ProbeCache", -1)
+}
+
+
+static void PyBobLearnEMProbeCache_delete(PyBobLearnEMProbeCacheObject* self) {
+  self->cxx.reset();
+  Py_TYPE(self)->tp_free((PyObject*)self);
+}
+
+int PyBobLearnEMProbeCache_Check(PyObject* o) {
+  return PyObject_IsInstance(o, reinterpret_cast<PyObject*>(&PyBobLearnEMProbeCache_Type));
+}
+
+
+/******************************************************************/
+/************ Variables Section ***********************************/
+/******************************************************************/
+
+/***** max_bytes *****/
+static auto max_bytes = bob::extension::VariableDoc(
+  "max_bytes",
+  "int",
+  "The memory budget of the cached arrays, in bytes",
+  "Reducing it evicts the least recently used probes if required."
+);
+PyObject* PyBobLearnEMProbeCache_getMaxBytes(PyBobLearnEMProbeCacheObject* self, void*) {
+  BOB_TRY
+  return Py_BuildValue("n", self->cxx->getMaxBytes());
+  BOB_CATCH_MEMBER("max_bytes could not be read", 0)
+}
+int PyBobLearnEMProbeCache_setMaxBytes(PyBobLearnEMProbeCacheObject* self, PyObject* value, void*) {
+  BOB_TRY
+  Py_ssize_t v = PyNumber_AsSsize_t(value, PyExc_OverflowError);
+  if (v == -1 && PyErr_Occurred()) return -1;
+  if (v < 0){
+    PyErr_Format(PyExc_ValueError, "%s %s must be positive (or 0)", Py_TYPE(self)->tp_name, max_bytes.name());
+    return -1;
+  }
+  self->cxx->setMaxBytes(v);
+  return 0;
+  BOB_CATCH_MEMBER("max_bytes could not be set", -1)
+}
+
+
+/***** n_bytes *****/
+static auto n_bytes = bob::extension::VariableDoc(
+  "n_bytes",
+  "int",
+  "The memory currently used by the cached arrays, in bytes",
+  ""
+);
+PyObject* PyBobLearnEMProbeCache_getNBytes(PyBobLearnEMProbeCacheObject* self, void*) {
+  BOB_TRY
+  return Py_BuildValue("n", self->cxx->getNBytes());
+  BOB_CATCH_MEMBER("n_bytes could not be read", 0)
+}
+
+
+/***** size *****/
+static auto size = bob::extension::VariableDoc(
+  "size",
+  "int",
+  "The number of cached probes",
+  ""
+);
+PyObject* PyBobLearnEMProbeCache_getSize(PyBobLearnEMProbeCacheObject* self, void*) {
+  BOB_TRY
+  return Py_BuildValue("n", self->cxx->getSize());
+  BOB_CATCH_MEMBER("size could not be read", 0)
+}
+
+
+/***** hits *****/
+static auto hits = bob::extension::VariableDoc(
+  "hits",
+  "int",
+  "The number of lookups that were served from the cache",
+  ""
+);
+PyObject* PyBobLearnEMProbeCache_getHits(PyBobLearnEMProbeCacheObject* self, void*) {
+  BOB_TRY
+  return Py_BuildValue("n", self->cxx->getNHits());
+  BOB_CATCH_MEMBER("hits could not be read", 0)
+}
+
+
+/***** misses *****/
+static auto misses = bob::extension::VariableDoc(
+  "misses",
+  "int",
+  "The number of lookups that required a computation",
+  ""
+);
+PyObject* PyBobLearnEMProbeCache_getMisses(PyBobLearnEMProbeCacheObject* self, void*) {
+  BOB_TRY
+  return Py_BuildValue("n", self->cxx->getNMisses());
+  BOB_CATCH_MEMBER("misses could not be read", 0)
+}
+
+
+static PyGetSetDef PyBobLearnEMProbeCache_getseters[] = {
+  {
+   max_bytes.name(),
+   (getter)PyBobLearnEMProbeCache_getMaxBytes,
+   (setter)PyBobLearnEMProbeCache_setMaxBytes,
+   max_bytes.doc(),
+   0
+  },
+  {
+   n_bytes.name(),
+   (getter)PyBobLearnEMProbeCache_getNBytes,
+   0,
+   n_bytes.doc(),
+   0
+  },
+  {
+   size.name(),
+   (getter)PyBobLearnEMProbeCache_getSize,
+   0,
+   size.doc(),
+   0
+  },
+  {
+   hits.name(),
+   (getter)PyBobLearnEMProbeCache_getHits,
+   0,
+   hits.doc(),
+   0
+  },
+  {
+   misses.name(),
+   (getter)PyBobLearnEMProbeCache_getMisses,
+   0,
+   misses.doc(),
+   0
+  },
+
+  {0}  // Sentinel
+};
+
+
+/******************************************************************/
+/************ Functions Section ***********************************/
+/******************************************************************/
+
+/*** ux ***/
+static auto ux = bob::extension::FunctionDoc(
+  "ux",
+  "Returns the channel offset Ux of the given probe",
+  "It is computed and cached if this probe was not cached yet.",
+  true
+)
+.add_prototype("stats","output")
+.add_parameter("stats", ":py:class:`bob.learn.em.GMMStats`", "Statistics of the probe")
+.add_return("output","array_like <float, 1D>","The Ux vector");
+static PyObject* PyBobLearnEMProbeCache_ux(PyBobLearnEMProbeCacheObject* self, PyObject* args, PyObject* kwargs) {
+  BOB_TRY
+
+  char** kwlist = ux.kwlist(0);
+
+  PyBobLearnEMGMMStatsObject* stats = 0;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!", kwlist, &PyBobLearnEMGMMStats_Type, &stats))
+    return 0;
+
+  return PyBlitzArrayCxx_AsConstNumpy(self->cxx->getUx(stats->cxx));
+  BOB_CATCH_MEMBER("cannot compute Ux", 0)
+}
+
+
+/*** centred_stats ***/
+static auto centred_stats = bob::extension::FunctionDoc(
+  "centred_stats",
+  "Returns the centred first order statistics :math:`(F - N(m + Ux)) / T` of the given probe, as used by linear scoring",
+  "They are computed and cached if this probe was not cached yet.",
+  true
+)
+.add_prototype("stats","output")
+.add_parameter("stats", ":py:class:`bob.learn.em.GMMStats`", "Statistics of the probe")
+.add_return("output","array_like <float, 1D>","The centred statistics (as a supervector)");
+static PyObject* PyBobLearnEMProbeCache_centredStats(PyBobLearnEMProbeCacheObject* self, PyObject* args, PyObject* kwargs) {
+  BOB_TRY
+
+  char** kwlist = centred_stats.kwlist(0);
+
+  PyBobLearnEMGMMStatsObject* stats = 0;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!", kwlist, &PyBobLearnEMGMMStats_Type, &stats))
+    return 0;
+
+  return PyBlitzArrayCxx_AsConstNumpy(self->cxx->getCentredStats(stats->cxx));
+  BOB_CATCH_MEMBER("cannot compute the centred statistics", 0)
+}
+
+
+/*** clear ***/
+static auto clear = bob::extension::FunctionDoc(
+  "clear",
+  "Removes all the cached probes",
+  "",
+  true
+)
+.add_prototype("");
+static PyObject* PyBobLearnEMProbeCache_clear(PyBobLearnEMProbeCacheObject* self, PyObject* args, PyObject* kwargs) {
+  BOB_TRY
+
+  char** kwlist = clear.kwlist(0);
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "", kwlist)) return 0;
+
+  self->cxx->clear();
+
+  BOB_CATCH_MEMBER("cannot clear the ProbeCache", 0)
+  Py_RETURN_NONE;
+}
+
+
+static PyMethodDef PyBobLearnEMProbeCache_methods[] = {
+  {
+    ux.name(),
+    (PyCFunction)PyBobLearnEMProbeCache_ux,
+    METH_VARARGS|METH_KEYWORDS,
+    ux.doc()
+  },
+  {
+    centred_stats.name(),
+    (PyCFunction)PyBobLearnEMProbeCache_centredStats,
+    METH_VARARGS|METH_KEYWORDS,
+    centred_stats.doc()
+  },
+  {
+    clear.name(),
+    (PyCFunction)PyBobLearnEMProbeCache_clear,
+    METH_VARARGS|METH_KEYWORDS,
+    clear.doc()
+  },
+
+  {0} /* Sentinel */
+};
+
+
+/******************************************************************/
+/************ Module Section **************************************/
+/******************************************************************/
+
+// Define the ProbeCache type struct; will be initialized later
+PyTypeObject PyBobLearnEMProbeCache_Type = {
+  PyVarObject_HEAD_INIT(0,0)
+  0
+};
+
+bool init_BobLearnEMProbeCache(PyObject* module)
+{
+  // initialize the type struct
+  PyBobLearnEMProbeCache_Type.tp_name      = ProbeCache_doc.name();
+  PyBobLearnEMProbeCache_Type.tp_basicsize = sizeof(PyBobLearnEMProbeCacheObject);
+  PyBobLearnEMProbeCache_Type.tp_flags     = Py_TPFLAGS_DEFAULT;
+  PyBobLearnEMProbeCache_Type.tp_doc       = ProbeCache_doc.doc();
+
+  // set the functions
+  PyBobLearnEMProbeCache_Type.tp_new         = PyType_GenericNew;
+  PyBobLearnEMProbeCache_Type.tp_init        = reinterpret_cast<initproc>(PyBobLearnEMProbeCache_init);
+  PyBobLearnEMProbeCache_Type.tp_dealloc     = reinterpret_cast<destructor>(PyBobLearnEMProbeCache_delete);
+  PyBobLearnEMProbeCache_Type.tp_methods     = PyBobLearnEMProbeCache_methods;
+  PyBobLearnEMProbeCache_Type.tp_getset      = PyBobLearnEMProbeCache_getseters;
+
+  // check that everything is fine
+  if (PyType_Ready(&PyBobLearnEMProbeCache_Type) < 0) return false;
+
+  // add the type to the module
+  Py_INCREF(&PyBobLearnEMProbeCache_Type);
+  return PyModule_AddObject(module, "ProbeCache", (PyObject*)&PyBobLearnEMProbeCache_Type) >= 0;
+}
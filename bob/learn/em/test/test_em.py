@@ -8,7 +8,10 @@
 """Test trainer package
 """
 import unittest
+import os
+import tempfile
 import numpy
+import nose.tools
 
 import bob.io.base
 from bob.io.base.test_utils import datafile
@@ -225,6 +228,66 @@ def test_gmm_MAP_3():
   assert equals(gmm.weights, weightsMAP_ref, 1e-4)
 
 
+def test_gmm_MAP_incremental():
+
+  # Incremental MAP adaptation gives the same model as a single MAP
+  # iteration on all the data
+
+  ar = bob.io.base.load(datafile('faithful.torch3_f64.hdf5', __name__, path="../data/"))
+  gmmprior = GMMMachine(bob.io.base.HDF5File(datafile("gmm_ML.hdf5", __name__, path="../data/")))
+
+  map_gmmtrainer = MAP_GMMTrainer(update_means=True, update_variances=True, update_weights=True, prior_gmm=gmmprior, relevance_factor=4.)
+  gmm_ref = GMMMachine(gmmprior)
+  bob.learn.em.train(map_gmmtrainer, gmm_ref, ar, max_iterations=1)
+
+  map_gmmtrainer = MAP_GMMTrainer(update_means=True, update_variances=True, update_weights=True, prior_gmm=gmmprior, relevance_factor=4.)
+  gmm = GMMMachine(gmmprior)
+  stats = bob.learn.em.GMMStats(*gmmprior.shape)
+  n = ar.shape[0] // 3
+  map_gmmtrainer.adapt(gmm, stats, ar[:n])
+  map_gmmtrainer.adapt(gmm, stats, ar[n:2*n])
+  map_gmmtrainer.adapt(gmm, stats, ar[2*n:])
+  assert stats.t == ar.shape[0]
+  assert equals(gmm.means, gmm_ref.means, 1e-8)
+  assert equals(gmm.variances, gmm_ref.variances, 1e-8)
+  assert equals(gmm.weights, gmm_ref.weights, 1e-8)
+
+  # The statistics can also be merged beforehand
+  stats2 = bob.learn.em.GMMStats(*gmmprior.shape)
+  gmmprior.acc_statistics(ar[:n], stats2)
+  stats3 = bob.learn.em.GMMStats(*gmmprior.shape)
+  gmmprior.acc_statistics(ar[n:], stats3)
+  stats2 += stats3
+  gmm = GMMMachine(gmmprior)
+  map_gmmtrainer.adapt(gmm, stats2)
+  assert equals(gmm.means, gmm_ref.means, 1e-8)
+
+  # The statistics must match the GMM
+  nose.tools.assert_raises(RuntimeError, map_gmmtrainer.adapt, gmm, bob.learn.em.GMMStats(3, 2))
+
+
+def test_gmm_MAP_mean_supervector():
+
+  # Mean-only MAP adaptation without creating a GMMMachine
+
+  ar = bob.io.base.load(datafile('faithful.torch3_f64.hdf5', __name__, path="../data/"))
+  gmmprior = GMMMachine(bob.io.base.HDF5File(datafile("gmm_ML.hdf5", __name__, path="../data/")))
+
+  for kwargs in ({'relevance_factor': 4.}, {'alpha': 0.5}):
+    map_gmmtrainer = MAP_GMMTrainer(update_means=True, update_variances=False, update_weights=False, prior_gmm=gmmprior, **kwargs)
+    segments = (ar[:50], ar[50:150], ar[150:])
+    models = numpy.zeros((len(segments), gmmprior.shape[0]*gmmprior.shape[1]))
+    for i, data in enumerate(segments):
+      gmm = GMMMachine(gmmprior)
+      map_gmmtrainer.adapt(gmm, bob.learn.em.GMMStats(*gmmprior.shape), data)
+      assert equals(map_gmmtrainer.adapt_mean_supervector(data), gmm.mean_supervector, 1e-10)
+      # Written into a row of the matrix of models
+      map_gmmtrainer.adapt_mean_supervector(data, models[i])
+      assert equals(models[i], gmm.mean_supervector, 1e-10)
+
+  nose.tools.assert_raises(RuntimeError, map_gmmtrainer.adapt_mean_supervector, ar, numpy.zeros((3,)))
+
+
 def test_gmm_test():
 
   # Tests a GMMMachine by computing scores against a model and compare to
@@ -309,3 +372,325 @@ def test_EMPCA():
   llh2 = T.compute_likelihood(m)
   assert abs(exp_llh2 - llh2) < 2e-4
 
+
+
+def test_EMPCA_blocks():
+
+  # Tests that the E-step, which processes the samples by blocks, gives the
+  # same result as a direct per-sample implementation of an EM iteration
+  numpy.random.seed(0)
+  ar = numpy.random.randn(600, 5)
+
+  T = bob.learn.em.EMPCATrainer()
+  m = bob.learn.linear.Machine(5,2)
+  T.initialize(m, ar)
+  mu = m.input_subtract.copy()
+  W = m.weights.copy()
+  sigma2 = T.sigma2
+
+  # Reference EM iteration
+  invM = numpy.linalg.inv(numpy.dot(W.T, W) + sigma2 * numpy.eye(2))
+  sum_tz = numpy.zeros((5,2))
+  sum_zz = numpy.zeros((2,2))
+  for t in ar:
+    z = numpy.dot(invM, numpy.dot(W.T, t - mu))
+    sum_tz += numpy.outer(t - mu, z)
+    sum_zz += sigma2 * invM + numpy.outer(z, z)
+  W_ref = numpy.dot(sum_tz, numpy.linalg.inv(sum_zz))
+  sigma2_ref = 0.
+  for t in ar:
+    z = numpy.dot(invM, numpy.dot(W.T, t - mu))
+    zz = sigma2 * invM + numpy.outer(z, z)
+    sigma2_ref += numpy.sum((t - mu)**2) - 2 * numpy.dot(z, numpy.dot(W_ref.T, t - mu)) + \
+      numpy.trace(numpy.dot(zz, numpy.dot(W_ref.T, W_ref)))
+  sigma2_ref /= ar.size
+
+  T.e_step(m, ar)
+  T.m_step(m, ar)
+  assert numpy.allclose(m.weights, W_ref, rtol=1e-8, atol=1e-10)
+  assert abs(T.sigma2 - sigma2_ref) < 1e-8
+
+
+def test_EMPCA_replicated():
+
+  # The EM updates only depend on sums of statistics over the samples:
+  # replicating the training set must give the same estimates of W and sigma2
+  # even when the samples span several blocks of the E-step
+  ar=numpy.array([
+    [1, 2, 3],
+    [2, 4, 19],
+    [3, 6, 5],
+    [4, 8, 13],
+    ], dtype='float64')
+  ar_rep = numpy.tile(ar, (100,1))
+  w_init = numpy.array([1.62945, 0.270954, 1.81158, 1.67002, 0.253974,
+    1.93774], 'float64').reshape(3,2)
+  sigma2_init = 1.82675
+
+  machines = []
+  trainers = []
+  for data in (ar, ar_rep):
+    T = bob.learn.em.EMPCATrainer()
+    m = bob.learn.linear.Machine(3,2)
+    T.initialize(m, data)
+    m.weights = w_init
+    T.sigma2 = sigma2_init
+    for i in range(2):
+      T.e_step(m, data)
+      T.m_step(m, data)
+    machines.append(m)
+    trainers.append(T)
+
+  assert numpy.allclose(machines[0].weights, machines[1].weights, rtol=1e-10, atol=1e-10)
+  assert abs(trainers[0].sigma2 - trainers[1].sigma2) < 1e-10
+  assert abs(-30.8559 - trainers[0].compute_likelihood(machines[0])) < 2e-4
+
+
+def test_EMPCA_streaming():
+
+  # Trains on chunks of the data delivered by a reader, and compares to the
+  # training on the whole array
+  numpy.random.seed(1)
+  ar = numpy.dot(numpy.random.randn(700, 3), numpy.random.randn(3, 6)) + \
+    0.1 * numpy.random.randn(700, 6) + 5.
+
+  def reader():
+    for i in range(0, ar.shape[0], 300):
+      yield ar[i:i+300]
+
+  T = bob.learn.em.EMPCATrainer()
+  m = bob.learn.linear.Machine(6,3)
+  bob.learn.em.train(T, m, ar, max_iterations=5, rng=bob.core.random.mt19937(5))
+
+  T_s = bob.learn.em.EMPCATrainer()
+  m_s = bob.learn.linear.Machine(6,3)
+  bob.learn.em.train_empca_streaming(T_s, m_s, reader, max_iterations=5, rng=bob.core.random.mt19937(5))
+
+  assert numpy.allclose(m.input_subtract, m_s.input_subtract, rtol=1e-10, atol=1e-10)
+  assert numpy.allclose(m.weights, m_s.weights, rtol=1e-6, atol=1e-8)
+  assert abs(T.sigma2 - T_s.sigma2) < 1e-8
+  assert abs(T.compute_likelihood(m) - T_s.compute_likelihood(m_s)) < 1e-6 * abs(T.compute_likelihood(m))
+
+  # The m_step does not require the data anymore
+  T.e_step(m, ar)
+  T.m_step(m)
+  T_s.reset_statistics()
+  for chunk in reader():
+    T_s.acc_statistics(m_s, chunk)
+  T_s.m_step(m_s)
+  assert numpy.allclose(m.weights, m_s.weights, rtol=1e-6, atol=1e-8)
+
+  # The E-step on the whole array is also possible after a streamed
+  # initialization, which keeps no latent mean
+  T.e_step(m, ar)
+  T.m_step(m)
+  T_s.e_step(m_s, ar)
+  T_s.m_step(m_s)
+  assert numpy.allclose(m.weights, m_s.weights, rtol=1e-6, atol=1e-8)
+
+  # Initializing again does not change the scatter of the data
+  llh, sigma2 = T_s.compute_likelihood(m_s), T_s.sigma2
+  T_s.initialize(bob.learn.linear.Machine(6,3), rng=bob.core.random.mt19937(5))
+  T_s.sigma2 = sigma2
+  assert abs(T_s.compute_likelihood(m_s) - llh) < 1e-10 * abs(llh)
+
+
+def test_train_native():
+
+  # The native EM loop gives the same machine as the Python one, calling the
+  # callback after each iteration
+  ar = bob.io.base.load(datafile("faithful.torch3_f64.hdf5", __name__, path="../data/"))
+
+  gmm_ref = loadGMM()
+  trainer = ML_GMMTrainer(True, True, True)
+  trainer.initialize(gmm_ref, ar)
+  trainer.e_step(gmm_ref, ar)
+  for i in range(5):
+    trainer.m_step(gmm_ref, ar)
+    trainer.e_step(gmm_ref, ar)
+  llh_ref = trainer.compute_likelihood(gmm_ref)
+
+  gmm = loadGMM()
+  trainer = ML_GMMTrainer(True, True, True)
+  iterations = []
+  n = bob.learn.em.train_native(trainer, gmm, ar, max_iterations=5,
+    callback=lambda i, llh: iterations.append((i, llh)))
+  assert n == 5
+  assert gmm == gmm_ref
+  assert [i for i, llh in iterations] == [1, 2, 3, 4, 5]
+  assert abs(iterations[-1][1] - llh_ref) < 1e-10
+
+  # Errors raised by the callback stop the training
+  def callback(i, llh):
+    raise StopIteration
+  nose.tools.assert_raises(StopIteration, bob.learn.em.train_native,
+    ML_GMMTrainer(True, True, True), loadGMM(), ar, callback=callback)
+
+  # Mismatching machines are rejected
+  nose.tools.assert_raises(TypeError, bob.learn.em.train_native,
+    ML_GMMTrainer(True, True, True), KMeansMachine(2, 2), ar)
+
+
+def test_EMPCA_e_step_likelihood():
+
+  # The likelihood given by the E-step statistics matches the one computed
+  # from the covariance of the data
+  numpy.random.seed(2)
+  ar = numpy.dot(numpy.random.randn(300, 2), numpy.random.randn(2, 5)) + \
+    0.5 * numpy.random.randn(300, 5)
+
+  T = bob.learn.em.EMPCATrainer()
+  m = bob.learn.linear.Machine(5,2)
+  T.initialize(m, ar, bob.core.random.mt19937(3))
+  for i in range(3):
+    T.e_step(m, ar)
+    llh = T.compute_e_step_likelihood(m)
+    assert abs(llh - T.compute_likelihood(m)) < 1e-8 * abs(llh)
+    T.m_step(m, ar)
+
+
+def test_train_native_checkpoint():
+
+  # A training which is interrupted and resumed from its checkpoint gives
+  # the same machine as an uninterrupted one
+  numpy.random.seed(4)
+  ar = numpy.dot(numpy.random.randn(200, 2), numpy.random.randn(2, 6)) + \
+    0.3 * numpy.random.randn(200, 6)
+
+  m_ref = bob.learn.linear.Machine(6,2)
+  llh_ref = []
+  bob.learn.em.train_native(bob.learn.em.EMPCATrainer(), m_ref, ar, max_iterations=6,
+    rng=bob.core.random.mt19937(5), callback=lambda i, llh: llh_ref.append(llh))
+
+  fd, filename = tempfile.mkstemp(".hdf5")
+  os.close(fd)
+  os.unlink(filename)
+
+  def interrupt(i, llh):
+    if i == 3: raise StopIteration
+  m = bob.learn.linear.Machine(6,2)
+  nose.tools.assert_raises(StopIteration, bob.learn.em.train_native,
+    bob.learn.em.EMPCATrainer(), m, ar, max_iterations=6, rng=bob.core.random.mt19937(5),
+    callback=interrupt, checkpoint=filename, checkpoint_iterations=2)
+  assert os.path.exists(filename)
+
+  m = bob.learn.linear.Machine(6,2)
+  llh = []
+  n = bob.learn.em.train_native(bob.learn.em.EMPCATrainer(), m, ar, max_iterations=6,
+    callback=lambda i, l: llh.append(l), checkpoint=filename, checkpoint_iterations=2)
+  assert n == 6
+  assert numpy.allclose(llh, llh_ref[2:], rtol=0, atol=1e-12)
+  assert numpy.allclose(m.weights, m_ref.weights, rtol=0, atol=1e-12)
+  assert numpy.allclose(m.input_subtract, m_ref.input_subtract, rtol=0, atol=1e-12)
+  assert not os.path.exists(filename)
+
+  # The trainer is initialized when resuming, even if the machine is not
+  m = bob.learn.linear.Machine(6,2)
+  nose.tools.assert_raises(StopIteration, bob.learn.em.train_native,
+    bob.learn.em.EMPCATrainer(), m, ar, max_iterations=6, rng=bob.core.random.mt19937(5),
+    callback=interrupt, checkpoint=filename, checkpoint_iterations=2)
+  m = bob.learn.linear.Machine(6,2)
+  n = bob.learn.em.train_native(bob.learn.em.EMPCATrainer(), m, ar, max_iterations=6,
+    initialize=False, checkpoint=filename, checkpoint_iterations=2)
+  assert n == 6
+  assert numpy.allclose(m.weights, m_ref.weights, rtol=0, atol=1e-12)
+  assert not os.path.exists(filename)
+
+
+def test_sharded_statistics():
+
+  # Running the E-step on shards of the data, and summing the statistics
+  # saved by each shard, gives the same M-step as on the whole data
+  ar = bob.io.base.load(datafile("faithful.torch3_f64.hdf5", __name__, path="../data/"))
+  shards = (ar[:100], ar[100:200], ar[200:])
+
+  def m_step_from_shards(trainer, machine, make_trainer):
+    filenames = []
+    for shard in shards:
+      t = make_trainer()
+      t.e_step(machine, shard)
+      fd, filename = tempfile.mkstemp(".hdf5")
+      os.close(fd)
+      filenames.append(filename)
+      t.save_statistics(bob.io.base.HDF5File(filenames[-1], 'w'))
+    trainer.load_statistics(bob.io.base.HDF5File(filenames[0]))
+    for filename in filenames[1:]:
+      t = make_trainer()
+      t.load_statistics(bob.io.base.HDF5File(filename))
+      trainer.add_statistics(t)
+    for filename in filenames:
+      os.unlink(filename)
+    trainer.m_step(machine, ar)
+
+  # GMM
+  gmm_ref = loadGMM()
+  trainer = ML_GMMTrainer(True, True, True)
+  trainer.initialize(gmm_ref, ar)
+  trainer.e_step(gmm_ref, ar)
+  llh_ref = trainer.compute_likelihood(gmm_ref)
+  trainer.m_step(gmm_ref, ar)
+
+  gmm = loadGMM()
+  def make_gmm_trainer():
+    t = ML_GMMTrainer(True, True, True)
+    t.initialize(gmm)
+    return t
+  trainer = make_gmm_trainer()
+  m_step_from_shards(trainer, gmm, make_gmm_trainer)
+  assert abs(trainer.compute_likelihood(gmm) - llh_ref) < 1e-10 * abs(llh_ref)
+  assert gmm.is_similar_to(gmm_ref, 1e-10, 1e-10)
+
+  # K-means
+  kmeans_ref = KMeansMachine(3, 2)
+  trainer = KMeansTrainer()
+  trainer.initialize(kmeans_ref, ar, bob.core.random.mt19937(1))
+  kmeans = KMeansMachine(kmeans_ref)
+  trainer.e_step(kmeans_ref, ar)
+  distance_ref = trainer.compute_likelihood(kmeans_ref)
+  trainer.m_step(kmeans_ref, ar)
+
+  def make_kmeans_trainer():
+    t = KMeansTrainer()
+    t.reset_accumulators(kmeans)
+    return t
+  trainer = make_kmeans_trainer()
+  m_step_from_shards(trainer, kmeans, make_kmeans_trainer)
+
+  # Statistics of another machine are rejected
+  fd, filename = tempfile.mkstemp(".hdf5")
+  os.close(fd)
+  trainer.save_statistics(bob.io.base.HDF5File(filename, 'w'))
+  t = KMeansTrainer()
+  t.reset_accumulators(KMeansMachine(4, 2))
+  nose.tools.assert_raises(RuntimeError, t.load_statistics, bob.io.base.HDF5File(filename))
+  os.unlink(filename)
+  assert abs(trainer.compute_likelihood(kmeans) - distance_ref) < 1e-10 * distance_ref
+  assert numpy.allclose(kmeans.means, kmeans_ref.means, rtol=0, atol=1e-10)
+
+
+def test_train_native_processes():
+
+  # Running the E-step in several worker processes gives the same training
+  ar = bob.io.base.load(datafile("faithful.torch3_f64.hdf5", __name__, path="../data/"))
+
+  gmm_ref = loadGMM()
+  llh_ref = []
+  bob.learn.em.train_native(ML_GMMTrainer(True, True, True), gmm_ref, ar, max_iterations=5,
+    callback=lambda i, llh: llh_ref.append(llh))
+  gmm = loadGMM()
+  llh = []
+  bob.learn.em.train_native(ML_GMMTrainer(True, True, True), gmm, ar, max_iterations=5,
+    callback=lambda i, l: llh.append(l), n_processes=3)
+  assert numpy.allclose(llh, llh_ref, rtol=1e-10, atol=0)
+  assert gmm.is_similar_to(gmm_ref, 1e-8, 1e-10)
+
+  kmeans_ref = KMeansMachine(3, 2)
+  bob.learn.em.train_native(KMeansTrainer(), kmeans_ref, ar, max_iterations=5, rng=bob.core.random.mt19937(1))
+  kmeans = KMeansMachine(3, 2)
+  bob.learn.em.train_native(KMeansTrainer(), kmeans, ar, max_iterations=5, rng=bob.core.random.mt19937(1),
+    n_processes=2)
+  assert numpy.allclose(kmeans.means, kmeans_ref.means, rtol=1e-10, atol=1e-10)
+
+  # Trainers which do not support it are rejected
+  nose.tools.assert_raises(RuntimeError, bob.learn.em.train_native,
+    bob.learn.em.EMPCATrainer(), bob.learn.linear.Machine(2,1), ar, n_processes=2)
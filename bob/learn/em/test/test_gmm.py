@@ -11,6 +11,7 @@
 import os
 import numpy
 import tempfile
+import nose.tools
 
 import bob.io.base
 from bob.io.base.test_utils import datafile
@@ -261,3 +262,70 @@ def test_GMMMachine_4():
   assert ll==gmm(data)
   
   
+
+
+def test_GMMMachine_hdf5_layout():
+  # The parameters of all the Gaussians are saved in single datasets, and
+  # the former layout, with one group per Gaussian, can still be read
+  gmm_old = GMMMachine(bob.io.base.HDF5File(datafile("gmm_ML.hdf5", __name__, path="../data/")))
+  gmm_old.variance_thresholds = numpy.tile(numpy.linspace(0.01, 0.02, gmm_old.shape[1]), (gmm_old.shape[0], 1))
+
+  filename = str(tempfile.mkstemp(".hdf5")[1])
+  gmm_old.save(bob.io.base.HDF5File(filename, 'w'))
+
+  hdf5 = bob.io.base.HDF5File(filename)
+  assert hdf5.read("version") == 2
+  assert hdf5.read("means").shape == (gmm_old.shape[0], gmm_old.shape[1])
+  assert hdf5.read("variances").shape == (gmm_old.shape[0], gmm_old.shape[1])
+  assert hdf5.read("variance_thresholds").shape == (gmm_old.shape[0], gmm_old.shape[1])
+  assert not hdf5.has_group("m_gaussians0")
+  del hdf5
+
+  gmm = GMMMachine(bob.io.base.HDF5File(filename))
+  assert gmm == gmm_old
+  assert (gmm.variance_thresholds == gmm_old.variance_thresholds).all()
+
+  # The datasets must match the number of Gaussians and inputs
+  for name in ("weights", "means", "variances", "variance_thresholds"):
+    hdf5 = bob.io.base.HDF5File(filename, 'w')
+    hdf5.set("version", 2)
+    hdf5.set("n_gaussians", gmm_old.shape[0])
+    hdf5.set("n_inputs", gmm_old.shape[1])
+    for key, value in (("weights", gmm_old.weights), ("means", gmm_old.means), ("variances", gmm_old.variances), ("variance_thresholds", gmm_old.variance_thresholds)):
+      hdf5.set(key, value[:-1] if key == name else value)
+    del hdf5
+    nose.tools.assert_raises(RuntimeError, GMMMachine, bob.io.base.HDF5File(filename))
+
+  os.unlink(filename)
+
+
+def test_GMMMachine_mapped():
+  # A GMMMachine loaded from a mapped file uses its arrays in place;
+  # modifying the machine does not modify the file
+  gmm_ref = GMMMachine(bob.io.base.HDF5File(datafile("gmm_ML.hdf5", __name__, path="../data/")))
+  filename = str(tempfile.mkstemp(".bin")[1])
+  gmm_ref.save_mapped(filename)
+
+  gmm = GMMMachine()
+  gmm.load_mapped(filename)
+  assert gmm == gmm_ref
+  x = gmm_ref.means[0] + 0.1
+  assert abs(gmm(x) - gmm_ref(x)) < 1e-10
+
+  gmm.means = gmm.means + 1.
+  gmm_reloaded = GMMMachine()
+  gmm_reloaded.load_mapped(filename)
+  assert gmm_reloaded == gmm_ref
+  assert gmm != gmm_ref
+
+  # The arrays of the file stay mapped as long as they are used, and the
+  # mapping is released with the last of them
+  weights = gmm_reloaded.weights
+  gaussian = gmm_reloaded.get_gaussian(0)
+  del gmm_reloaded
+  assert not weights.flags.writeable
+  assert (weights == gmm_ref.weights).all()
+  assert (gaussian.mean == gmm_ref.means[0]).all()
+  del weights, gaussian
+
+  os.unlink(filename)
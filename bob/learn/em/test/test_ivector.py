@@ -9,6 +9,8 @@
 """Tests the I-Vector machine
 """
 
+import os
+import tempfile
 import numpy
 import numpy.linalg
 import numpy.random
@@ -157,3 +159,13 @@ def test_machine():
   wij_ref = numpy.array([-0.04213415, 0.21463343]) # Reference from original Chris implementation
   wij = mc.project(gs)
   assert numpy.allclose(wij_ref, wij, 1e-5)
+
+  # Mapped file: the machine uses T, sigma and the precomputed arrays of the
+  # file in place
+  filename = str(tempfile.mkstemp(".bin")[1])
+  mc.save_mapped(filename)
+  mm = IVectorMachine(ubm, 1)
+  mm.load_mapped(filename)
+  assert mm == mc
+  assert numpy.allclose(wij_ref, mm.project(gs), 1e-5)
+  os.unlink(filename)
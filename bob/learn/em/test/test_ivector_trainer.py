@@ -7,11 +7,15 @@
 """Tests the I-Vector trainer
 """
 
+import os
+import tempfile
 import numpy
 import numpy.linalg
 import numpy.random
 import nose.tools
 
+import bob.io.base
+
 from bob.learn.em import GMMMachine, GMMStats, IVectorMachine, IVectorTrainer
 
 ### Test class inspired by an implementation of Chris McCool
@@ -366,3 +370,16 @@ def test_trainer_update_sigma():
     trainer.m_step(m)
     assert numpy.allclose(t_ref[it], m.t, 1e-5)
     assert numpy.allclose(sigma_ref[it], m.sigma, 1e-5)
+
+  # Saved statistics with inconsistent shapes are rejected
+  fd, filename = tempfile.mkstemp(".hdf5")
+  os.close(fd)
+  try:
+    for name in ("acc_nij_wij2", "acc_nij", "acc_snormij"):
+      hdf5 = bob.io.base.HDF5File(filename, 'w')
+      for key, value in (("acc_nij_wij2", trainer.acc_nij_wij2), ("acc_fnormij_wij", trainer.acc_fnormij_wij), ("acc_nij", trainer.acc_nij), ("acc_snormij", trainer.acc_snormij)):
+        hdf5.set(key, value[:-1] if key == name else value)
+      del hdf5
+      nose.tools.assert_raises(RuntimeError, trainer.load_statistics, bob.io.base.HDF5File(filename))
+  finally:
+    os.unlink(filename)
@@ -15,7 +15,7 @@ import tempfile
 
 import bob.io.base
 
-from bob.learn.em import GMMMachine, GMMStats, JFABase, ISVBase, ISVMachine, JFAMachine
+from bob.learn.em import GMMMachine, GMMStats, JFABase, ISVBase, ISVMachine, JFAMachine, ProbeCache, linear_scoring
 
 def estimate_x(dim_c, dim_d, mean, sigma, U, N, F):
   # Compute helper values
@@ -180,6 +180,41 @@ def test_ISVBase():
   # Clean-up
   os.unlink(filename)
 
+def test_FABase_mapped():
+
+  # Creates a UBM
+  ubm = GMMMachine(2,3)
+  ubm.weights = numpy.array([0.4, 0.6], 'float64')
+  ubm.means = numpy.array([[1, 6, 2], [4, 3, 2]], 'float64')
+  ubm.variances = numpy.array([[1, 2, 1], [2, 1, 2]], 'float64')
+
+  U = numpy.array([[1, 2], [3, 4], [5, 6], [7, 8], [9, 10], [11, 12]], 'float64')
+  V = numpy.array([[6, 5], [4, 3], [2, 1], [1, 2], [3, 4], [5, 6]], 'float64')
+  d = numpy.array([0, 1, 0, 1, 0, 1], 'float64')
+  filename = str(tempfile.mkstemp(".bin")[1])
+
+  # JFABase
+  m = JFABase(ubm, 2, 2)
+  m.u = U
+  m.v = V
+  m.d = d
+  m.save_mapped(filename)
+  m_mapped = JFABase(ubm, 1, 1)
+  m_mapped.load_mapped(filename)
+  assert m_mapped == m
+
+  # ISVBase
+  m = ISVBase(ubm, 2)
+  m.u = U
+  m.d = d
+  m.save_mapped(filename)
+  m_mapped = ISVBase(ubm, 1)
+  m_mapped.load_mapped(filename)
+  assert m_mapped == m
+
+  os.unlink(filename)
+
+
 def test_JFAMachine():
 
   # Creates a UBM
@@ -394,3 +429,142 @@ def test_ISVMachine():
 
   # Clean-up
   os.unlink(filename)
+
+
+def test_FA_linear_scoring():
+
+  # Creates a UBM
+  ubm = GMMMachine(2,3)
+  ubm.weights   = numpy.array([0.4, 0.6], 'float64')
+  ubm.means     = numpy.array([[1, 6, 2], [4, 3, 2]], 'float64')
+  ubm.variances = numpy.array([[1, 2, 1], [2, 1, 2]], 'float64')
+
+  U = numpy.array([[1, 2], [3, 4], [5, 6], [7, 8], [9, 10], [11, 12]], 'float64')
+  V = numpy.array([[6, 5], [4, 3], [2, 1], [1, 2], [3, 4], [5, 6]], 'float64')
+  d = numpy.array([0, 1, 0, 1, 0, 1], 'float64')
+
+  isv_base = ISVBase(ubm,2)
+  isv_base.u = U
+  isv_base.d = d
+  jfa_base = JFABase(ubm,2,2)
+  jfa_base.u = U
+  jfa_base.v = V
+  jfa_base.d = d
+
+  # Enrolled models
+  isv_models = []
+  jfa_models = []
+  for z, y in ((numpy.array([3,4,1,2,0,1], 'float64'), numpy.array([1,2], 'float64')),
+               (numpy.array([1,0,2,1,3,0], 'float64'), numpy.array([-1,0.5], 'float64')),
+               (numpy.array([0,1,0,1,0,1], 'float64'), numpy.array([0.3,-2], 'float64'))):
+    m = ISVMachine(isv_base)
+    m.z = z
+    isv_models.append(m)
+    m = JFAMachine(jfa_base)
+    m.y = y
+    m.z = z
+    jfa_models.append(m)
+
+  # Test statistics
+  stats = []
+  for T, n, sumpx in ((1, [0.4, 0.6], [[1., 2., 3.], [4., 5., 6.]]),
+                      (3, [1.2, 1.8], [[2., 1., 0.], [7., 3., 4.]]),
+                      (0, [0., 0.],   [[0., 0., 0.], [0., 0., 0.]]),
+                      (2, [1.5, 0.5], [[3., 9., 3.], [2., 1., 1.]])):
+    gs = GMMStats(2,3)
+    gs.t = T
+    gs.n = numpy.array(n, 'float64')
+    gs.sum_px = numpy.array(sumpx, 'float64')
+    stats.append(gs)
+
+  eps = 1e-10
+  for models in (isv_models, jfa_models):
+    ref = numpy.array([[m(gs) for gs in stats] for m in models], 'float64')
+    for n_threads in (0, 1, 3):
+      scores = linear_scoring(models, stats, n_threads)
+      assert scores.shape == (len(models), len(stats))
+      assert numpy.allclose(scores, ref, eps)
+
+
+def test_ProbeCache():
+
+  # Creates a UBM
+  ubm = GMMMachine(2,3)
+  ubm.weights   = numpy.array([0.4, 0.6], 'float64')
+  ubm.means     = numpy.array([[1, 6, 2], [4, 3, 2]], 'float64')
+  ubm.variances = numpy.array([[1, 2, 1], [2, 1, 2]], 'float64')
+
+  U = numpy.array([[1, 2], [3, 4], [5, 6], [7, 8], [9, 10], [11, 12]], 'float64')
+  V = numpy.array([[6, 5], [4, 3], [2, 1], [1, 2], [3, 4], [5, 6]], 'float64')
+  d = numpy.array([0, 1, 0, 1, 0, 1], 'float64')
+
+  isv_base = ISVBase(ubm,2)
+  isv_base.u = U
+  isv_base.d = d
+  isv = ISVMachine(isv_base)
+  isv.z = numpy.array([3,4,1,2,0,1], 'float64')
+
+  jfa_base = JFABase(ubm,2,2)
+  jfa_base.u = U
+  jfa_base.v = V
+  jfa_base.d = d
+  jfa = JFAMachine(jfa_base)
+  jfa.y = numpy.array([1,2], 'float64')
+  jfa.z = numpy.array([3,4,1,2,0,1], 'float64')
+
+  stats = []
+  for T, n, sumpx in ((1, [0.4, 0.6], [[1., 2., 3.], [4., 5., 6.]]),
+                      (3, [1.2, 1.8], [[2., 1., 0.], [7., 3., 4.]]),
+                      (2, [1.5, 0.5], [[3., 9., 3.], [2., 1., 1.]])):
+    gs = GMMStats(2,3)
+    gs.t = T
+    gs.n = numpy.array(n, 'float64')
+    gs.sum_px = numpy.array(sumpx, 'float64')
+    stats.append(gs)
+
+  eps = 1e-10
+  entry_bytes = 2 * 6 * 8
+  for machine, base in ((isv, isv_base), (jfa, jfa_base)):
+    cache = ProbeCache(base, 2 * entry_bytes)
+    assert cache.size == 0
+    assert cache.n_bytes == 0
+
+    # Scores (twice) and compares with the reference forward
+    for k in range(2):
+      score = machine.forward_ux(stats[0], cache)
+      assert abs(score - machine(stats[0])) < eps
+    assert cache.misses == 1
+    assert cache.hits == 1
+    assert cache.size == 1
+    assert cache.n_bytes == entry_bytes
+
+    ux = numpy.ndarray((6,), numpy.float64)
+    machine.estimate_ux(stats[0], ux)
+    assert numpy.allclose(cache.ux(stats[0]), ux, eps)
+    assert abs(machine.forward_ux(stats[0], cache.ux(stats[0])) - machine(stats[0])) < eps
+
+    # LRU eviction: stats[1] is the least recently used one when stats[2] comes in
+    machine.forward_ux(stats[1], cache)
+    machine.forward_ux(stats[0], cache)
+    machine.forward_ux(stats[2], cache)
+    assert cache.size == 2
+    assert cache.n_bytes == 2 * entry_bytes
+    misses = cache.misses
+    machine.forward_ux(stats[0], cache)
+    assert cache.misses == misses
+    machine.forward_ux(stats[1], cache)
+    assert cache.misses == misses + 1
+
+    cache.max_bytes = entry_bytes
+    assert cache.size == 1
+    cache.clear()
+    assert cache.size == 0
+
+  # A cache can only be used by the machines of its base
+  cache = ProbeCache(jfa_base, entry_bytes)
+  try:
+    isv.forward_ux(stats[0], cache)
+    raise AssertionError("ISVMachine should not accept a ProbeCache of a JFABase")
+  except RuntimeError:
+    pass
+
@@ -8,9 +8,11 @@
 """Tests on the LinearScoring function
 """
 
+import os
 import numpy
+import tempfile
 
-from bob.learn.em import GMMMachine, GMMStats, linear_scoring
+from bob.learn.em import GMMMachine, GMMStats, linear_scoring, streaming_linear_scoring
 
 def test_LinearScoring():
 
@@ -126,3 +128,76 @@ def test_LinearScoring():
   score = linear_scoring(model2.mean_supervector, ubm.mean_supervector, ubm.variance_supervector, stats3, test_channeloffset[2], True)
   assert abs(score - ref_scores_11[1,2]) < 1e-7
 
+
+
+def test_LinearScoring_many_probes():
+
+  # Enough test trials to be split into several tiles/threads
+  numpy.random.seed(42)
+  C, D, n_models, n_probes = 3, 5, 4, 57
+  ubm_mean = numpy.random.normal(size=(C*D,))
+  ubm_variance = numpy.random.uniform(0.5, 2., size=(C*D,))
+  models = [ubm_mean + numpy.random.normal(size=(C*D,)) for i in range(n_models)]
+
+  stats = []
+  offsets = []
+  for t in range(n_probes):
+    s = GMMStats(C, D)
+    s.n = numpy.random.uniform(0., 10., size=(C,))
+    s.sum_px = numpy.random.normal(size=(C,D)) * s.n.reshape(C,1)
+    s.t = 0 if t == 3 else int(round(sum(s.n)))
+    stats.append(s)
+    offsets.append(numpy.random.normal(size=(C*D,)))
+
+  A = numpy.array([(m - ubm_mean) / ubm_variance for m in models])
+  for channel_offset in ([], offsets):
+    for frame_length_normalisation in (False, True):
+      B = numpy.ndarray((C*D, n_probes), 'float64')
+      for t, s in enumerate(stats):
+        offset = channel_offset[t] if channel_offset else 0.
+        B[:,t] = s.sum_px.flatten() - numpy.repeat(s.n, D) * (ubm_mean + offset)
+        if frame_length_normalisation:
+          B[:,t] = B[:,t] / s.t if s.t else 0.
+      reference = numpy.dot(A, B)
+
+      scores = linear_scoring(models, ubm_mean, ubm_variance, stats, channel_offset, frame_length_normalisation)
+      assert scores.shape == (n_models, n_probes)
+      assert numpy.allclose(scores, reference, 1e-10, 1e-10)
+
+
+def test_LinearScoring_streaming():
+
+  numpy.random.seed(7)
+  C, D, n_models, n_probes = 4, 3, 11, 23
+  ubm_mean = numpy.random.normal(size=(C*D,))
+  ubm_variance = numpy.random.uniform(0.5, 2., size=(C*D,))
+  models = ubm_mean + numpy.random.normal(size=(n_models, C*D))
+
+  stats = []
+  offsets = []
+  for t in range(n_probes):
+    s = GMMStats(C, D)
+    s.n = numpy.random.uniform(0., 10., size=(C,))
+    s.sum_px = numpy.random.normal(size=(C,D)) * s.n.reshape(C,1)
+    s.t = int(round(sum(s.n)))
+    stats.append(s)
+    offsets.append(numpy.random.normal(size=(C*D,)))
+
+  for channel_offset in ([], offsets):
+    reference = linear_scoring(list(models), ubm_mean, ubm_variance, stats, channel_offset, True)
+
+    # budgets forcing several blocks of models and tiles of probes, or none at all
+    for max_bytes in (1, 3*C*D*8, 0):
+      scores = streaming_linear_scoring(models, ubm_mean, ubm_variance, stats, channel_offset, True, max_bytes=max_bytes, n_threads=3)
+      assert scores.shape == (n_models, n_probes)
+      assert numpy.allclose(scores, reference, 1e-10, 1e-10)
+
+    # scores written to a memory-mapped file
+    fd, score_file = tempfile.mkstemp(suffix='.bin')
+    os.close(fd)
+    try:
+      assert streaming_linear_scoring(models, ubm_mean, ubm_variance, stats, channel_offset, True, max_bytes=5*C*D*8, score_file=score_file) is None
+      scores = numpy.fromfile(score_file, numpy.float64).reshape(n_models, n_probes)
+      assert numpy.allclose(scores, reference, 1e-10, 1e-10)
+    finally:
+      os.unlink(score_file)
@@ -13,6 +13,7 @@ import os
 import tempfile
 import nose.tools
 import math
+import threading
 
 import bob.io.base
 
@@ -372,6 +373,88 @@ def test_plda_basemachine_loglikelihood_pointestimate():
   assert equals(log_likelihood_point_estimate, log_likelihood_point_estimate_python, 1e-6)
 
 
+def test_plda_basemachine_mapped():
+
+  sigma = numpy.ndarray(C_dim_d, 'float64')
+  sigma.fill(0.01)
+  mu = numpy.ndarray(C_dim_d, 'float64')
+  mu.fill(0)
+
+  mb = PLDABase(C_dim_d, C_dim_f, C_dim_g)
+  mb.mu = mu
+  mb.f = C_F
+  mb.g = C_G
+  mb.sigma = sigma
+
+  # The precomputed matrices are mapped along with F, G, sigma and mu
+  filename = str(tempfile.mkstemp(".bin")[1])
+  mb.save_mapped(filename)
+  m_mapped = PLDABase(1, 1, 1)
+  m_mapped.load_mapped(filename)
+  assert m_mapped == mb
+  assert equals(m_mapped.__beta__, mb.__beta__, 1e-10)
+  assert equals(m_mapped.get_add_gamma(3), mb.get_add_gamma(3), 1e-10)
+
+  ar = numpy.random.randn(3,C_dim_d)
+  ll_ref = PLDAMachine(mb).compute_log_likelihood(ar, False)
+  assert abs(PLDAMachine(m_mapped).compute_log_likelihood(ar, False) - ll_ref) < 1e-10
+
+  # Loading another type of model fails
+  from bob.learn.em import ISVBase
+  nose.tools.assert_raises(RuntimeError, ISVBase().load_mapped, filename)
+
+  os.unlink(filename)
+
+
+def test_plda_basemachine_tables():
+
+  sigma = numpy.ndarray(C_dim_d, 'float64')
+  sigma.fill(0.01)
+  mu = numpy.ndarray(C_dim_d, 'float64')
+  mu.fill(0)
+
+  mb = PLDABase(C_dim_d, C_dim_f, C_dim_g)
+  mb.mu = mu
+  mb.f = C_F
+  mb.g = C_G
+  mb.sigma = sigma
+
+  # Log-likelihoods computed without any cached value
+  m = PLDAMachine(mb)
+  ar_e = numpy.random.randn(3,C_dim_d)
+  ar_p = numpy.random.randn(C_dim_d)
+  ll_ref = m.compute_log_likelihood(ar_e, False)
+  ll_p_ref = m.compute_log_likelihood(ar_p, False)
+  constterm3_ref = PLDABase(mb).get_add_log_like_const_term(3)
+
+  assert mb.table_size == 0
+  mb.precompute_tables(5)
+  assert mb.table_size == 6
+  for a in range(6):
+    assert mb.has_gamma(a)
+    assert mb.has_log_like_const_term(a)
+    assert equals(mb.get_gamma(a), compute_gamma(C_F,C_G,sigma,a), 1e-10)
+  assert not mb.has_gamma(6)
+  assert abs(mb.get_log_like_const_term(3) - constterm3_ref) < 1e-10
+  # Tabulated values are not added to the maps
+  assert abs(mb.get_add_log_like_const_term(3) - constterm3_ref) < 1e-10
+
+  # Scoring relies on the tables
+  assert abs(m.compute_log_likelihood(ar_e, False) - ll_ref) < 1e-10
+  assert abs(m.compute_log_likelihood(ar_p, False) - ll_p_ref) < 1e-10
+
+  # The tables are copied, and cleared when the model changes
+  mb_copy = PLDABase(mb)
+  assert mb_copy.table_size == 6
+  mb.sigma = sigma
+  assert mb.table_size == 0
+  assert not mb.has_gamma(3)
+  mb_copy.clear_tables()
+  assert mb_copy.table_size == 0
+
+  nose.tools.assert_raises(ValueError, mb.precompute_tables, -1)
+
+
 def test_plda_machine():
 
   # Data used for performing the tests
@@ -497,6 +580,44 @@ def test_plda_machine_log_likelihood_Python():
   llr2d = m.compute_log_likelihood(ar2_s2d, True) - (m.compute_log_likelihood(ar2_s2d, False) + m.log_likelihood)
   assert abs(m(ar2_s2d) - llr2d) < 1e-10
 
+def test_plda_machine_threads():
+
+  sigma = numpy.ndarray(C_dim_d, 'float64')
+  sigma.fill(0.01)
+  mu = numpy.ndarray(C_dim_d, 'float64')
+  mu.fill(0)
+
+  mb = PLDABase(C_dim_d, C_dim_f, C_dim_g)
+  mb.mu = mu
+  mb.f = C_F
+  mb.g = C_G
+  mb.sigma = sigma
+  # tabulates gamma for some of the numbers of samples only; the others are
+  # computed on the fly
+  mb.precompute_tables(4)
+
+  # Defines an enrolled machine
+  m = PLDAMachine(mb)
+  m.n_samples = 2
+  m.weighted_sum = numpy.random.randn(C_dim_f)
+  m.log_likelihood = m.compute_log_likelihood(numpy.random.randn(2,C_dim_d), False)
+
+  # Scores (1D and 2D) probes serially, and then from several threads
+  probes = [numpy.random.randn(C_dim_d) for k in range(5)] + [numpy.random.randn(k,C_dim_d) for k in range(1,6)]
+  def score():
+    return [(m(p), m.compute_log_likelihood(p, True), m.compute_log_likelihood(p, False)) for p in probes]
+  serial = score()
+
+  results = [None] * 8
+  def run(t):
+    results[t] = [score() for k in range(20)]
+  threads = [threading.Thread(target=run, args=(t,)) for t in range(len(results))]
+  for t in threads: t.start()
+  for t in threads: t.join()
+  for r in results:
+    assert all(scores == serial for scores in r)
+
+
 def test_plda_machine_log_likelihood_Prince():
 
   # Data used for performing the tests
@@ -8,12 +8,15 @@
 """Tests PLDA trainer
 """
 
+import os
 import sys
+import tempfile
 import numpy
 import numpy.linalg
 
 from bob.learn.em import PLDATrainer, PLDABase, PLDAMachine
 import bob.learn.em
+import bob.io.base
 import nose.tools
 
 class PythonPLDATrainer():
@@ -711,6 +714,162 @@ def test_plda_enrollment():
     (m.compute_log_likelihood(numpy.array([x1,x2]), False) + m.compute_log_likelihood(numpy.array([x3]), False))
   assert abs(llr - llr_separate) < 1e-10
 
+  # Progressive enrollment gives the same machine
+  m2 = PLDAMachine(mb)
+  t.enroll(m2, a_enroll[:1])
+  t.enroll_append(m2, a_enroll[1:])
+  assert m2.n_samples == 2
+  assert abs(m2.w_sum_xit_beta_xi - m.w_sum_xit_beta_xi) < 1e-10
+  assert numpy.allclose(m2.weighted_sum, m.weighted_sum, atol=1e-10)
+  assert abs(m2.log_likelihood - m.log_likelihood) < 1e-10
+  assert abs(m2(x3) - llr_ref) < 1e-10
+  # Starting from an empty machine
+  m3 = PLDAMachine(mb)
+  t.enroll_append(m3, a_enroll)
+  assert abs(m3(x3) - llr_ref) < 1e-10
+  # enroll() forgets about the previous samples
+  t.enroll(m2, a_enroll)
+  assert m2.n_samples == 2
+  assert abs(m2(x3) - llr_ref) < 1e-10
+
+
+
+def test_plda_scoring():
+  # Random PLDABase
+  numpy.random.seed(11)
+  dim_d, dim_f, dim_g = 7, 2, 3
+  mb = PLDABase(dim_d, dim_f, dim_g)
+  mb.f = numpy.random.normal(size=(dim_d, dim_f))
+  mb.g = numpy.random.normal(size=(dim_d, dim_g))
+  mb.sigma = numpy.random.uniform(0.5, 1.5, size=(dim_d,))
+  mb.mu = numpy.random.normal(size=(dim_d,))
+
+  # Models enrolled with different numbers of samples
+  t = PLDATrainer()
+  models = []
+  for n in (1, 3, 1, 2, 3, 1):
+    m = PLDAMachine(mb)
+    t.enroll(m, numpy.random.normal(size=(n, dim_d)))
+    models.append(m)
+  probes = numpy.random.normal(size=(9, dim_d))
+
+  scores = bob.learn.em.plda_scoring(models, probes)
+  assert scores.shape == (len(models), probes.shape[0])
+  for i, m in enumerate(models):
+    for j, x in enumerate(probes):
+      assert abs(scores[i,j] - m(x)) < 1e-8
+
+  # Models must share the same base
+  other = PLDAMachine(PLDABase(dim_d, dim_f, dim_g))
+  t.enroll(other, probes[:2])
+  nose.tools.assert_raises(RuntimeError, bob.learn.em.plda_scoring, models + [other], probes)
+
+
+def test_plda_fast_scorer():
+  # Random PLDABase
+  numpy.random.seed(12)
+  dim_d, dim_f, dim_g = 7, 2, 3
+  mb = PLDABase(dim_d, dim_f, dim_g)
+  mb.f = numpy.random.normal(size=(dim_d, dim_f))
+  mb.g = numpy.random.normal(size=(dim_d, dim_g))
+  mb.sigma = numpy.random.uniform(0.5, 1.5, size=(dim_d,))
+  mb.mu = numpy.random.normal(size=(dim_d,))
+
+  scorer = bob.learn.em.PLDAFastScorer(mb)
+  assert scorer.p.shape == (dim_d, dim_d)
+  assert scorer.q.shape == (dim_d, dim_d)
+
+  # Same scores as the PLDAMachine enrolled with a single sample
+  t = PLDATrainer()
+  enroll = numpy.random.normal(size=(4, dim_d))
+  probes = numpy.random.normal(size=(5, dim_d))
+  scores = scorer.score(enroll, probes)
+  assert scores.shape == (4, 5)
+  for i, x in enumerate(enroll):
+    m = PLDAMachine(mb)
+    t.enroll(m, x.reshape(1, dim_d))
+    for j, y in enumerate(probes):
+      assert abs(scores[i,j] - m(y)) < 1e-8
+      assert abs(scorer.score(x, y) - m(y)) < 1e-8
+      assert abs(scorer(y, x) - scorer.score(x, y)) < 1e-8
+
+  # Copy and save/load
+  assert bob.learn.em.PLDAFastScorer(scorer) == scorer
+  filename = str(tempfile.mkstemp(".hdf5")[1])
+  scorer.save(bob.io.base.HDF5File(filename, 'w'))
+  scorer2 = bob.learn.em.PLDAFastScorer(bob.io.base.HDF5File(filename))
+  os.unlink(filename)
+  assert scorer2 == scorer
+  assert scorer2.is_similar_to(scorer)
+
+
+def test_plda_trainer_threads():
+  # Identities with different numbers of samples
+  numpy.random.seed(13)
+  dim_d, dim_f, dim_g = 7, 2, 3
+  l = [numpy.random.normal(size=(n, dim_d)) for n in (4, 1, 3, 6, 2, 2, 5, 3, 1, 4)]
+
+  for use_sum_second_order in (True, False):
+    machines = []
+    trainers = []
+    for n_threads in (1, 3, 16):
+      t = PLDATrainer(use_sum_second_order)
+      t.init_f_method = 'BETWEEN_SCATTER'
+      t.init_g_method = 'WITHIN_SCATTER'
+      t.init_sigma_method = 'VARIANCE_DATA'
+      t.n_threads = n_threads
+      assert t.n_threads == n_threads
+      m = PLDABase(dim_d, dim_f, dim_g)
+      bob.learn.em.train(t, m, l, max_iterations=5)
+      machines.append(m)
+      trainers.append(t)
+
+    for m, t in zip(machines[1:], trainers[1:]):
+      assert numpy.allclose(m.f, machines[0].f)
+      assert numpy.allclose(m.g, machines[0].g)
+      assert numpy.allclose(m.sigma, machines[0].sigma)
+      assert numpy.allclose(t.z_second_order_sum, trainers[0].z_second_order_sum)
+      for z, z_ref in zip(t.z_first_order, trainers[0].z_first_order):
+        assert numpy.allclose(z, z_ref)
+
+  # The E- and M-steps rely on the centred data stored by initialize()
+  nose.tools.assert_raises(RuntimeError, trainers[0].e_step, machines[0], l[:-1])
+  # (same total number of samples, but not for each identity)
+  swapped = [l[1], l[0]] + l[2:]
+  nose.tools.assert_raises(RuntimeError, trainers[0].e_step, machines[0], swapped)
+  nose.tools.assert_raises(RuntimeError, trainers[0].m_step, machines[0], swapped)
+
+
+def test_plda_trainer_low_memory():
+  # One of the identities has more samples than a block of the E-step
+  numpy.random.seed(17)
+  dim_d, dim_f, dim_g = 7, 2, 3
+  l = [numpy.random.normal(size=(n, dim_d)) for n in (4, 1, 300, 6, 2, 5)]
+
+  machines = []
+  for low_memory, n_threads in ((False, 1), (True, 1), (True, 3)):
+    t = PLDATrainer()
+    t.init_f_method = 'BETWEEN_SCATTER'
+    t.init_g_method = 'WITHIN_SCATTER'
+    t.init_sigma_method = 'VARIANCE_DATA'
+    t.low_memory = low_memory
+    assert t.low_memory == low_memory
+    t.n_threads = n_threads
+    m = PLDABase(dim_d, dim_f, dim_g)
+    bob.learn.em.train(t, m, l, max_iterations=5)
+    machines.append(m)
+
+  for m in machines[1:]:
+    assert numpy.allclose(m.f, machines[0].f)
+    assert numpy.allclose(m.g, machines[0].g)
+    assert numpy.allclose(m.sigma, machines[0].sigma)
+
+  # The per-sample statistics are not stored
+  nose.tools.assert_raises(RuntimeError, getattr, t, 'z_first_order')
+  nose.tools.assert_raises(RuntimeError, getattr, t, 'z_second_order')
+  # The flag must be set before initialize()
+  t.low_memory = False
+  nose.tools.assert_raises(RuntimeError, t.e_step, m, l)
 
 
 def test_plda_comparisons():
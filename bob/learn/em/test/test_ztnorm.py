@@ -10,6 +10,7 @@
 """
 
 import numpy
+import nose.tools
 
 from bob.io.base.test_utils import datafile
 import bob.io.base
@@ -43,6 +44,16 @@ def znorm(A, B):
 
   return (A - numpy.tile(Bmean.reshape(B.shape[0],1), (1,A.shape[1]))) / numpy.tile(Bstd.reshape(B.shape[0],1), (1,A.shape[1]))
 
+def asnorm(A, B, C, top_k):
+  def statistics(cohort):
+    k = cohort.shape[1] if top_k == 0 else min(top_k, cohort.shape[1])
+    top = -numpy.sort(-cohort, axis=1)[:,:k]
+    std = numpy.std(top, axis=1, ddof=1) if k > 1 else numpy.zeros(top.shape[0])
+    return numpy.mean(top, axis=1), numpy.where(std <= numpy.finfo(numpy.float64).tiny, 1., std)
+  mean_B, std_B = statistics(B)
+  mean_C, std_C = statistics(C.T)
+  return 0.5 * ((A - mean_B.reshape(-1,1)) / std_B.reshape(-1,1) + (A - mean_C.reshape(1,-1)) / std_C.reshape(1,-1))
+
 
 def test_ztnorm_simple():
   # 3x5
@@ -120,3 +131,121 @@ def test_znorm_simple():
   empty = numpy.zeros(shape=(0,0), dtype=numpy.float64)
   zA = bob.learn.em.ztnorm(my_A, my_B, empty, empty)
   assert (abs(zA - zA_py) < 1e-7).all()
+
+def sequential_sum(x, axis):
+  # sums from the first to the last element, as a C loop does (numpy.sum
+  # uses a pairwise summation, which rounds differently)
+  return numpy.cumsum(x, axis=axis).take(-1, axis=axis)
+
+def ztnorm_reference(A, B=None, C=None, D=None, mask=None):
+  # A test-only copy of the original (non-tiled) ZT-Norm implementation,
+  # which follows its order of operations to give exactly the same scores
+  eps = numpy.finfo(numpy.float64).tiny
+
+  # zA = (A - mean(B)) / std(B)
+  zA = A
+  if B is not None and B.shape[1] > 0:
+    mean_B = sequential_sum(B, 1) / B.shape[1]
+    B2n = (B - mean_B.reshape(-1,1)) ** 2
+    if B.shape[1] > 1:
+      std_B = numpy.sqrt(sequential_sum(B2n, 1) / (B.shape[1] - 1))
+    else:
+      std_B = numpy.zeros(B.shape[0])
+    std_B = numpy.where(std_B <= eps, 1., std_B)
+    zA = (A - mean_B.reshape(-1,1)) / std_B.reshape(-1,1)
+
+  if C is None or C.shape[0] == 0:
+    return zA
+
+  # zC = (C - mean(D)) / std(D), with the impostor scores of D only
+  zC = C
+  if D is not None and B is not None and B.shape[1] > 0:
+    keep = numpy.ones(D.shape) if mask is None else numpy.logical_not(mask).astype(numpy.float64)
+    value = keep * D
+    count = sequential_sum(keep, 1)
+    mean_D = sequential_sum(value, 1) / count
+    sumsq = sequential_sum(value * value, 1)
+    std_D = numpy.zeros(D.shape[0])
+    more = count > 1
+    std_D[more] = numpy.sqrt((sumsq[more] - count[more] * mean_D[more] * mean_D[more]) / (count[more] - 1))
+    std_D = numpy.where(std_D <= eps, 1., std_D)
+    zC = (C - mean_D.reshape(-1,1)) / std_D.reshape(-1,1)
+
+  # ztA = (zA - mean(zC)) / std(zC)
+  mean_zC = sequential_sum(zC, 0) / C.shape[0]
+  if C.shape[0] > 1:
+    std_zC = numpy.sqrt(sequential_sum((zC - mean_zC.reshape(1,-1)) ** 2, 0) / (C.shape[0] - 1))
+  else:
+    std_zC = numpy.zeros(C.shape[1])
+  std_zC = numpy.where(std_zC <= eps, 1., std_zC)
+  return (zA - mean_zC.reshape(1,-1)) / std_zC.reshape(1,-1)
+
+def normalize_tiles(statistics, A, tile0, tile1):
+  scores = numpy.ndarray(A.shape, numpy.float64)
+  for i in range(0, A.shape[0], tile0):
+    for j in range(0, A.shape[1], tile1):
+      scores[i:i+tile0, j:j+tile1] = statistics.normalize(A[i:i+tile0, j:j+tile1], i, j)
+  return scores
+
+def test_ztnorm_statistics():
+  my_A = bob.io.base.load(datafile("ztnorm_eval_eval.hdf5", __name__, path="../data/"))
+  my_B = bob.io.base.load(datafile("ztnorm_znorm_eval.hdf5", __name__, path="../data/"))
+  my_C = bob.io.base.load(datafile("ztnorm_eval_tnorm.hdf5", __name__, path="../data/"))
+  my_D = bob.io.base.load(datafile("ztnorm_znorm_tnorm.hdf5", __name__, path="../data/"))
+  empty = numpy.zeros(shape=(0,0), dtype=numpy.float64)
+
+  # The full and the tiled normalisations must give exactly the same scores
+  # as the original implementation
+  reference = ztnorm_reference(my_A, my_B, my_C, my_D)
+  statistics = bob.learn.em.ZTNormStatistics(my_B, my_C, my_D)
+  assert statistics.z_mean.shape == (my_A.shape[0],)
+  assert statistics.t_mean.shape == (my_A.shape[1],)
+  assert (bob.learn.em.ztnorm(my_A, my_B, my_C, my_D) == reference).all()
+  assert (normalize_tiles(statistics, my_A, 7, 11) == reference).all()
+
+  # T-Norm
+  reference = ztnorm_reference(my_A, C=my_C)
+  assert (bob.learn.em.tnorm(my_A, my_C) == reference).all()
+  statistics = bob.learn.em.ZTNormStatistics(rawscores_probes_vs_tmodels=my_C)
+  assert statistics.z_mean.shape == (0,)
+  assert (normalize_tiles(statistics, my_A, 5, 3) == reference).all()
+  statistics = bob.learn.em.ZTNormStatistics(empty, my_C, empty)
+  assert (normalize_tiles(statistics, my_A, 5, 3) == reference).all()
+
+  # Z-Norm
+  reference = ztnorm_reference(my_A, B=my_B)
+  assert (bob.learn.em.znorm(my_A, my_B) == reference).all()
+  statistics = bob.learn.em.ZTNormStatistics(my_B)
+  assert statistics.t_mean.shape == (0,)
+  assert (normalize_tiles(statistics, my_A, 4, 9) == reference).all()
+
+  # With a mask of the true trials
+  my_A = numpy.array([[1, 2, 3, 4, 5], [6, 7, 8, 9, 8], [7, 6, 5, 4, 3]],'float64')
+  my_B = numpy.array([[5, 4, 7, 8],[9, 8, 7, 4],[5, 6, 3, 2]],'float64')
+  my_C = numpy.array([[5, 4, 3, 2, 1],[2, 1, 2, 3, 4]],'float64')
+  my_D = numpy.array([[8, 6, 4, 2],[0, 2, 4, 6]],'float64')
+  mask = sameValue(numpy.array([1, 5],'uint32'), numpy.array([1, 2, 3, 4],'uint32'))
+  reference = ztnorm_reference(my_A, my_B, my_C, my_D, mask)
+  assert (bob.learn.em.ztnorm(my_A, my_B, my_C, my_D, mask) == reference).all()
+  statistics = bob.learn.em.ZTNormStatistics(my_B, my_C, my_D, mask)
+  assert (normalize_tiles(statistics, my_A, 2, 2) == reference).all()
+
+  # Tiles out of range
+  nose.tools.assert_raises(RuntimeError, statistics.normalize, my_A, 1, 0)
+
+def test_asnorm():
+  my_A = bob.io.base.load(datafile("ztnorm_eval_eval.hdf5", __name__, path="../data/"))
+  my_B = bob.io.base.load(datafile("ztnorm_znorm_eval.hdf5", __name__, path="../data/"))
+  my_C = bob.io.base.load(datafile("ztnorm_eval_tnorm.hdf5", __name__, path="../data/"))
+
+  for top_k in (0, 1, 5, my_B.shape[1] + my_C.shape[0]):
+    scores = bob.learn.em.asnorm(my_A, my_B, my_C, top_k, n_threads=3)
+    assert (abs(scores - asnorm(my_A, my_B, my_C, top_k)) < 1e-7).all()
+
+  # in place
+  scores = bob.learn.em.asnorm(my_A, my_B, my_C, 5)
+  output = my_A.copy()
+  assert bob.learn.em.asnorm(output, my_B, my_C, 5, output=output) is output
+  assert (abs(output - scores) < 1e-10).all()
+
+  nose.tools.assert_raises(RuntimeError, bob.learn.em.asnorm, my_A, my_B[:,:0], my_C)
@@ -10,9 +10,18 @@ import logging
 
 logger = logging.getLogger('bob.learn.em')
 
+# Trainers which are run by bob.learn.em.train_native() in bob.learn.em.train()
+_native_trainers = (bob.learn.em.KMeansTrainer, bob.learn.em.ML_GMMTrainer, bob.learn.em.MAP_GMMTrainer,
+                    bob.learn.em.ISVTrainer, bob.learn.em.IVectorTrainer, bob.learn.em.PLDATrainer,
+                    bob.learn.em.EMPCATrainer)
+
+
+def _log_iteration(iteration, likelihood):
+    logger.debug("Iteration = %d, likelihood = %f", iteration, likelihood)
+
 
 def train(trainer, machine, data, max_iterations=50, convergence_threshold=None, initialize=True, rng=None,
-          check_inputs=True):
+          check_inputs=True, checkpoint=None, checkpoint_iterations=0, checkpoint_seconds=0, n_processes=1):
     """
     Trains a machine given a trainer and the proper data
 
@@ -33,16 +42,41 @@ def train(trainer, machine, data, max_iterations=50, convergence_threshold=None,
         The Mersenne Twister mt19937 random generator used for the initialization of subspaces/arrays before the EM loop
       check_inputs:
          Shallow checks in the inputs. Check for inf and NaN
+      checkpoint : str
+        An HDF5 file where the training state is saved every ``checkpoint_iterations`` iterations and/or
+        ``checkpoint_seconds`` seconds. If it exists, the training resumes from it. See :py:func:`train_native`
+      checkpoint_iterations : int
+        The number of iterations between two checkpoints (0 disables this criterion)
+      checkpoint_seconds : float
+        The minimum number of seconds between two checkpoints (0 disables this criterion)
+      n_processes : int
+        If greater than 1, runs the E-step on shards of the data in as many worker processes. Only supported by
+        :py:class:`KMeansTrainer`, :py:class:`ML_GMMTrainer`, :py:class:`MAP_GMMTrainer` and :py:class:`IVectorTrainer`
     """
 
     if check_inputs and type(data) is numpy.ndarray:
 
-        if numpy.isinf(numpy.sum(data)):
+        data_sum = numpy.sum(data)
+        if numpy.isinf(data_sum):
             raise ValueError("Please, check your inputs; numpy.inf detected in `data` ")
 
-        if numpy.isnan(numpy.sum(data)):
+        if numpy.isnan(data_sum):
             raise ValueError("Please, check your inputs; numpy.nan detected in `data` ")
 
+    # The trainers of this package run the whole EM loop in C++
+    if type(trainer) in _native_trainers:
+        callback = _log_iteration if logger.isEnabledFor(logging.DEBUG) else None
+        n_iterations = bob.learn.em.train_native(trainer, machine, data, max_iterations, convergence_threshold,
+                                                 initialize, rng=rng, callback=callback, checkpoint=checkpoint,
+                                                 checkpoint_iterations=checkpoint_iterations,
+                                                 checkpoint_seconds=checkpoint_seconds, n_processes=n_processes)
+        logger.info("EM training stopped after %d iterations", n_iterations)
+        return
+
+    if checkpoint is not None or n_processes > 1:
+        raise ValueError("checkpoints and worker processes are only supported for the trainers of bob.learn.em, "
+                         "not for `%s'" % type(trainer).__name__)
+
     # Initialization
     if initialize:
         if rng is not None:
@@ -82,6 +116,65 @@ def train(trainer, machine, data, max_iterations=50, convergence_threshold=None,
         trainer.finalize(machine, data)
 
 
+def train_empca_streaming(trainer, machine, reader, max_iterations=50, convergence_threshold=None, initialize=True,
+                          rng=None):
+    """
+    Trains a :py:class:`bob.learn.linear.Machine` with a :py:class:`bob.learn.em.EMPCATrainer` on data which is read
+    by chunks, such that the training set does not need to fit in memory
+
+    **Parameters**:
+      trainer : :py:class:`bob.learn.em.EMPCATrainer`
+        An EM-PCA trainer mechanism
+      machine : :py:class:`bob.learn.linear.Machine`
+        A container machine
+      reader : callable
+        Called once per pass over the training set, it returns an iterable of array_like <float, 2D> chunks
+      max_iterations : int
+        The maximum number of iterations to train a machine
+      convergence_threshold : float
+        The convergence threshold to train a machine. If None, the training procedure will stop with the iterations criteria
+      initialize : bool
+        If True, runs the (one-pass) initialization procedure
+      rng :  :py:class:`bob.core.random.mt19937`
+        The Mersenne Twister mt19937 random generator used for the initialization of subspaces/arrays before the EM loop
+    """
+
+    def e_step():
+        trainer.reset_statistics()
+        for chunk in reader():
+            trainer.acc_statistics(machine, chunk)
+
+    # Initialization
+    if initialize:
+        trainer.reset_mean_variance(machine)
+        for chunk in reader():
+            trainer.acc_mean_variance(machine, chunk)
+        if rng is not None:
+            trainer.initialize(machine, rng=rng)
+        else:
+            trainer.initialize(machine)
+
+    e_step()
+    average_output = trainer.compute_e_step_likelihood(machine)
+
+    for i in range(max_iterations):
+        logger.debug("Iteration = %d/%d", i+1, max_iterations)
+        average_output_previous = average_output
+        trainer.m_step(machine)
+        e_step()
+
+        average_output = trainer.compute_e_step_likelihood(machine)
+        logger.debug("log likelihood = %f", average_output)
+
+        convergence_value = abs((average_output_previous - average_output) / average_output_previous)
+        logger.debug("convergence value = %f", convergence_value)
+
+        # Terminates if converged
+        if convergence_threshold != None and convergence_value <= convergence_threshold:
+            logger.info("EM training converged after %d iterations with convergence value %f", i, convergence_value)
+            break
+
+
 def train_jfa(trainer, jfa_base, data, max_iterations=10, initialize=True, rng=None):
     """
     Trains a :py:class:`bob.learn.em.JFABase` given a :py:class:`bob.learn.em.JFATrainer` and the proper data
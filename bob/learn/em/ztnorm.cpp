@@ -142,3 +142,75 @@ PyObject* PyBobLearnEM_zNorm(PyObject*, PyObject* args, PyObject* kwargs) {
   return PyBlitzArrayCxx_AsConstNumpy(normalized_scores);
 }
 
+
+
+/*** as_norm ***/
+bob::extension::FunctionDoc as_norm = bob::extension::FunctionDoc(
+  "asnorm",
+  "Normalise raw scores with adaptive symmetric normalisation (AS-Norm)",
+  "For each model, the mean and standard deviation of its ``top_k`` highest Z-Scores are computed, and likewise for each probe with its ``top_k`` highest T-Scores. "
+  "The normalised scores are ``0.5 * ((s - mean_model) / std_model + (s - mean_probe) / std_probe)``. "
+  "The statistics are computed only once for each model and each probe, in parallel.\n\n"
+  "If ``output`` is given, the normalised scores are written into it and no new array is allocated; it may be ``rawscores_probes_vs_models`` itself to normalise the scores in place.",
+  true
+)
+.add_prototype("rawscores_probes_vs_models,rawscores_zprobes_vs_models,rawscores_probes_vs_tmodels,[top_k],[output],[n_threads]", "output")
+.add_parameter("rawscores_probes_vs_models", "array_like <float, 2D>", "Raw set of scores")
+.add_parameter("rawscores_zprobes_vs_models", "array_like <float, 2D>", "Z-Scores (raw scores of the Z probes against the models)")
+.add_parameter("rawscores_probes_vs_tmodels", "array_like <float, 2D>", "T-Scores (raw scores of the T probes against the models)")
+.add_parameter("top_k", "int", "The number of highest cohort scores to use; 0 (the default) uses the whole cohorts, i.e., S-Norm")
+.add_parameter("output", "array_like <float, 2D>", "If given, the array to write the normalised scores to")
+.add_parameter("n_threads", "int", "Number of threads; 0 (the default) uses one thread per core")
+.add_return("output","array_like <float, 2D>","The scores AS Normalized");
+PyObject* PyBobLearnEM_asNorm(PyObject*, PyObject* args, PyObject* kwargs) {
+BOB_TRY
+  char** kwlist = as_norm.kwlist(0);
+
+  PyBlitzArrayObject *rawscores_probes_vs_models_o, *rawscores_zprobes_vs_models_o, *rawscores_probes_vs_tmodels_o;
+  PyObject* output_o = 0;
+  int top_k = 0, n_threads = 0;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O&O&O&|iO!i", kwlist, &PyBlitzArray_Converter, &rawscores_probes_vs_models_o,
+                                                                       &PyBlitzArray_Converter, &rawscores_zprobes_vs_models_o,
+                                                                       &PyBlitzArray_Converter, &rawscores_probes_vs_tmodels_o,
+                                                                       &top_k, &PyArray_Type, &output_o, &n_threads)){
+    as_norm.print_usage();
+    return 0;
+  }
+
+  auto rawscores_probes_vs_models_          = make_safe(rawscores_probes_vs_models_o);
+  auto rawscores_zprobes_vs_models_         = make_safe(rawscores_zprobes_vs_models_o);
+  auto rawscores_probes_vs_tmodels_         = make_safe(rawscores_probes_vs_tmodels_o);
+
+  if (top_k < 0 || n_threads < 0){
+    PyErr_Format(PyExc_ValueError, "asnorm: top_k and n_threads must be positive (or 0)");
+    return 0;
+  }
+
+  const blitz::Array<double,2>& rawscores_probes_vs_models = *PyBlitzArrayCxx_AsBlitz<double,2>(rawscores_probes_vs_models_o);
+
+  // writes the scores directly into the given array
+  if (output_o){
+    PyBlitzArrayObject* normalized_scores_o = 0;
+    if (!PyBlitzArray_OutputConverter(output_o, &normalized_scores_o)) return 0;
+    auto normalized_scores_ = make_safe(normalized_scores_o);
+    auto normalized_scores = PyBlitzArrayCxx_AsBlitz<double,2>(normalized_scores_o, "output");
+    if (!normalized_scores) return 0;
+
+    bob::learn::em::asNorm(rawscores_probes_vs_models,
+                           *PyBlitzArrayCxx_AsBlitz<double,2>(rawscores_zprobes_vs_models_o),
+                           *PyBlitzArrayCxx_AsBlitz<double,2>(rawscores_probes_vs_tmodels_o),
+                           top_k, *normalized_scores, n_threads);
+    Py_INCREF(output_o);
+    return output_o;
+  }
+
+  blitz::Array<double,2> normalized_scores = blitz::Array<double,2>(rawscores_probes_vs_models.extent(0), rawscores_probes_vs_models.extent(1));
+  bob::learn::em::asNorm(rawscores_probes_vs_models,
+                         *PyBlitzArrayCxx_AsBlitz<double,2>(rawscores_zprobes_vs_models_o),
+                         *PyBlitzArrayCxx_AsBlitz<double,2>(rawscores_probes_vs_tmodels_o),
+                         top_k, normalized_scores, n_threads);
+
+  return PyBlitzArrayCxx_AsConstNumpy(normalized_scores);
+BOB_CATCH_FUNCTION("asnorm", 0)
+}
@@ -0,0 +1,269 @@
+/**
+ * @date Sun Oct 18 13:41:09 2026 +0200
+ *
+ * @brief Python API for bob::learn::em
+ *
+ * Copyright (C) 2011-2014 Idiap Research Institute, Martigny, Switzerland
+ */
+
+#include "main.h"
+
+/******************************************************************/
+/************ Constructor Section *********************************/
+/******************************************************************/
+
+static auto ZTNormStatistics_doc = bob::extension::ClassDoc(
+  BOB_EXT_MODULE_PREFIX ".ZTNormStatistics",
+
+  "The cohort statistics used by :ref:`ZT-Norm <ztnorm>`, computed once and applied to tiles of raw scores as they are produced.\n\n"
+  "The Z-Norm statistics are the mean and standard deviation of the scores of each model against the Z-Norm probes. "
+  "The T-Norm statistics are the mean and standard deviation, for each probe, of its scores against the T-Norm models, themselves Z-normalised with the impostor scores of the T-Norm models against the Z-Norm probes. "
+  "Normalising a tile of scores only requires memory for the tile itself, and gives exactly the same scores as :py:func:`bob.learn.em.ztnorm`, :py:func:`bob.learn.em.tnorm` or :py:func:`bob.learn.em.znorm`.",
+  ""
+).add_constructor(
+  bob::extension::FunctionDoc(
+    "__init__",
+    "Computes the ZT-Norm statistics",
+    "Any of the score matrices may be omitted (or empty): without Z-Norm scores, the T-Norm scores are not Z-normalised and only T-Norm is applied; without T-Norm scores, only Z-Norm is applied.",
+    true
+  )
+  .add_prototype("[rawscores_zprobes_vs_models], [rawscores_probes_vs_tmodels], [rawscores_zprobes_vs_tmodels], [mask_zprobes_vs_tmodels_istruetrial]","")
+
+  .add_parameter("rawscores_zprobes_vs_models", "array_like <float, 2D>", "Z-Scores (raw scores of the Z probes against the models)")
+  .add_parameter("rawscores_probes_vs_tmodels", "array_like <float, 2D>", "T-Scores (raw scores of the T probes against the models)")
+  .add_parameter("rawscores_zprobes_vs_tmodels", "array_like <float, 2D>", "ZT-Scores (raw scores of the Z probes against the T-models)")
+  .add_parameter("mask_zprobes_vs_tmodels_istruetrial", "array_like <bool, 2D>", "The true trials to exclude from the ZT-Scores")
+);
+
+
+static int PyBobLearnEMZTNormStatistics_init(PyBobLearnEMZTNormStatisticsObject* self, PyObject* args, PyObject* kwargs) {
+  BOB_TRY
+
+  char** kwlist = ZTNormStatistics_doc.kwlist(0);
+
+  PyBlitzArrayObject *B_o = 0, *C_o = 0, *D_o = 0, *mask_o = 0;
+
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|O&O&O&O&", kwlist, &PyBlitzArray_Converter, &B_o,
+                                                                     &PyBlitzArray_Converter, &C_o,
+                                                                     &PyBlitzArray_Converter, &D_o,
+                                                                     &PyBlitzArray_Converter, &mask_o)){
+    ZTNormStatistics_doc.print_usage();
+    return -1;
+  }
+
+  auto B_ = make_xsafe(B_o);
+  auto C_ = make_xsafe(C_o);
+  auto D_ = make_xsafe(D_o);
+  auto mask_ = make_xsafe(mask_o);
+
+  self->cxx.reset(new bob::learn::em::ZTNormStatistics());
+
+  bool znorm = false;
+  if (B_o) {
+    blitz::Array<double,2> B = *PyBlitzArrayCxx_AsBlitz<double,2>(B_o);
+    self->cxx->computeZNorm(B);
+    znorm = B.extent(1) > 0;
+  }
+
+  if (C_o) {
+    if (D_o && znorm) {
+      if (mask_o)
+        self->cxx->computeTNorm(*PyBlitzArrayCxx_AsBlitz<double,2>(C_o), *PyBlitzArrayCxx_AsBlitz<double,2>(D_o), PyBlitzArrayCxx_AsBlitz<bool,2>(mask_o));
+      else
+        self->cxx->computeTNorm(*PyBlitzArrayCxx_AsBlitz<double,2>(C_o), *PyBlitzArrayCxx_AsBlitz<double,2>(D_o));
+    }
+    else
+      self->cxx->computeTNorm(*PyBlitzArrayCxx_AsBlitz<double,2>(C_o));
+  }
+
+  return 0;
+  BOB_CATCH_MEMBER("cannot create ZTNormStatistics", -1)
+}
+
+
+static void PyBobLearnEMZTNormStatistics_delete(PyBobLearnEMZTNormStatisticsObject* self) {
+  self->cxx.reset();
+  Py_TYPE(self)->tp_free((PyObject*)self);
+}
+
+int PyBobLearnEMZTNormStatistics_Check(PyObject* o) {
+  return PyObject_IsInstance(o, reinterpret_cast<PyObject*>(&PyBobLearnEMZTNormStatistics_Type));
+}
+
+
+/******************************************************************/
+/************ Variables Section ***********************************/
+/******************************************************************/
+
+/***** z_mean *****/
+static auto z_mean = bob::extension::VariableDoc(
+  "z_mean",
+  "array_like <float, 1D>",
+  "The mean of the Z-Norm scores, for each model (empty without Z-Norm)",
+  ""
+);
+PyObject* PyBobLearnEMZTNormStatistics_getZMean(PyBobLearnEMZTNormStatisticsObject* self, void*) {
+  BOB_TRY
+  return PyBlitzArrayCxx_AsConstNumpy(self->cxx->getZMean());
+  BOB_CATCH_MEMBER("z_mean could not be read", 0)
+}
+
+
+/***** z_std *****/
+static auto z_std = bob::extension::VariableDoc(
+  "z_std",
+  "array_like <float, 1D>",
+  "The standard deviation of the Z-Norm scores, for each model (empty without Z-Norm)",
+  "Null standard deviations are replaced by 1."
+);
+PyObject* PyBobLearnEMZTNormStatistics_getZStd(PyBobLearnEMZTNormStatisticsObject* self, void*) {
+  BOB_TRY
+  return PyBlitzArrayCxx_AsConstNumpy(self->cxx->getZStd());
+  BOB_CATCH_MEMBER("z_std could not be read", 0)
+}
+
+
+/***** t_mean *****/
+static auto t_mean = bob::extension::VariableDoc(
+  "t_mean",
+  "array_like <float, 1D>",
+  "The mean of the (Z-normalised) T-Norm scores, for each probe (empty without T-Norm)",
+  ""
+);
+PyObject* PyBobLearnEMZTNormStatistics_getTMean(PyBobLearnEMZTNormStatisticsObject* self, void*) {
+  BOB_TRY
+  return PyBlitzArrayCxx_AsConstNumpy(self->cxx->getTMean());
+  BOB_CATCH_MEMBER("t_mean could not be read", 0)
+}
+
+
+/***** t_std *****/
+static auto t_std = bob::extension::VariableDoc(
+  "t_std",
+  "array_like <float, 1D>",
+  "The standard deviation of the (Z-normalised) T-Norm scores, for each probe (empty without T-Norm)",
+  "Null standard deviations are replaced by 1."
+);
+PyObject* PyBobLearnEMZTNormStatistics_getTStd(PyBobLearnEMZTNormStatisticsObject* self, void*) {
+  BOB_TRY
+  return PyBlitzArrayCxx_AsConstNumpy(self->cxx->getTStd());
+  BOB_CATCH_MEMBER("t_std could not be read", 0)
+}
+
+
+static PyGetSetDef PyBobLearnEMZTNormStatistics_getseters[] = {
+  {
+   z_mean.name(),
+   (getter)PyBobLearnEMZTNormStatistics_getZMean,
+   0,
+   z_mean.doc(),
+   0
+  },
+  {
+   z_std.name(),
+   (getter)PyBobLearnEMZTNormStatistics_getZStd,
+   0,
+   z_std.doc(),
+   0
+  },
+  {
+   t_mean.name(),
+   (getter)PyBobLearnEMZTNormStatistics_getTMean,
+   0,
+   t_mean.doc(),
+   0
+  },
+  {
+   t_std.name(),
+   (getter)PyBobLearnEMZTNormStatistics_getTStd,
+   0,
+   t_std.doc(),
+   0
+  },
+
+  {0}  // Sentinel
+};
+
+
+/******************************************************************/
+/************ Functions Section ***********************************/
+/******************************************************************/
+
+/*** normalize ***/
+static auto normalize = bob::extension::FunctionDoc(
+  "normalize",
+  "Normalises a tile of raw scores",
+  "The tile starts at row ``offset0`` (model) and column ``offset1`` (probe) of the full score matrix.",
+  true
+)
+.add_prototype("rawscores, [offset0], [offset1]","output")
+.add_parameter("rawscores", "array_like <float, 2D>", "The raw scores of the tile")
+.add_parameter("offset0", "int", "The index of the first row of the tile; defaults to 0")
+.add_parameter("offset1", "int", "The index of the first column of the tile; defaults to 0")
+.add_return("output","array_like <float, 2D>","The normalised scores of the tile");
+static PyObject* PyBobLearnEMZTNormStatistics_normalize(PyBobLearnEMZTNormStatisticsObject* self, PyObject* args, PyObject* kwargs) {
+  BOB_TRY
+
+  char** kwlist = normalize.kwlist(0);
+
+  PyBlitzArrayObject* rawscores_o = 0;
+  int offset0 = 0, offset1 = 0;
+  if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O&|ii", kwlist, &PyBlitzArray_Converter, &rawscores_o,
+                                                                &offset0, &offset1))
+    return 0;
+
+  auto rawscores_ = make_safe(rawscores_o);
+
+  blitz::Array<double,2> rawscores = *PyBlitzArrayCxx_AsBlitz<double,2>(rawscores_o);
+  blitz::Array<double,2> output(rawscores.extent(0), rawscores.extent(1));
+  self->cxx->normalize(rawscores, offset0, offset1, output);
+  return PyBlitzArrayCxx_AsConstNumpy(output);
+
+  BOB_CATCH_MEMBER("cannot normalize the scores", 0)
+}
+
+
+static PyMethodDef PyBobLearnEMZTNormStatistics_methods[] = {
+  {
+    normalize.name(),
+    (PyCFunction)PyBobLearnEMZTNormStatistics_normalize,
+    METH_VARARGS|METH_KEYWORDS,
+    normalize.doc()
+  },
+
+  {0} /* Sentinel */
+};
+
+
+/******************************************************************/
+/************ Module Section **************************************/
+/******************************************************************/
+
+// Define the ZTNormStatistics type struct; will be initialized later
+PyTypeObject PyBobLearnEMZTNormStatistics_Type = {
+  PyVarObject_HEAD_INIT(0,0)
+  0
+};
+
+bool init_BobLearnEMZTNormStatistics(PyObject* module)
+{
+  // initialize the type struct
+  PyBobLearnEMZTNormStatistics_Type.tp_name      = ZTNormStatistics_doc.name();
+  PyBobLearnEMZTNormStatistics_Type.tp_basicsize = sizeof(PyBobLearnEMZTNormStatisticsObject);
+  PyBobLearnEMZTNormStatistics_Type.tp_flags     = Py_TPFLAGS_DEFAULT;
+  PyBobLearnEMZTNormStatistics_Type.tp_doc       = ZTNormStatistics_doc.doc();
+
+  // set the functions
+  PyBobLearnEMZTNormStatistics_Type.tp_new         = PyType_GenericNew;
+  PyBobLearnEMZTNormStatistics_Type.tp_init        = reinterpret_cast<initproc>(PyBobLearnEMZTNormStatistics_init);
+  PyBobLearnEMZTNormStatistics_Type.tp_dealloc     = reinterpret_cast<destructor>(PyBobLearnEMZTNormStatistics_delete);
+  PyBobLearnEMZTNormStatistics_Type.tp_methods     = PyBobLearnEMZTNormStatistics_methods;
+  PyBobLearnEMZTNormStatistics_Type.tp_getset      = PyBobLearnEMZTNormStatistics_getseters;
+
+  // check that everything is fine
+  if (PyType_Ready(&PyBobLearnEMZTNormStatistics_Type) < 0) return false;
+
+  // add the type to the module
+  Py_INCREF(&PyBobLearnEMZTNormStatistics_Type);
+  return PyModule_AddObject(module, "ZTNormStatistics", (PyObject*)&PyBobLearnEMZTNormStatistics_Type) >= 0;
+}
@@ -16,7 +16,12 @@ build_requires = load_requirements()
 version = open("version.txt").read().rstrip()
 
 packages = ['boost']
-boost_modules = ['system']
+boost_modules = ['system', 'thread']
+
+# The worker processes use POSIX shared memory and semaphores, which live in
+# librt and libpthread on Linux
+import sys
+system_libraries = ['rt', 'pthread'] if sys.platform.startswith('linux') else []
 
 setup(
 
@@ -59,6 +64,8 @@ setup(
           "bob/learn/em/cpp/KMeansMachine.cpp",
           "bob/learn/em/cpp/LinearScoring.cpp",
           "bob/learn/em/cpp/PLDAMachine.cpp",
+          "bob/learn/em/cpp/PLDAScoring.cpp",
+          "bob/learn/em/cpp/PLDAFastScorer.cpp",
           "bob/learn/em/cpp/ZTNorm.cpp",
 
           "bob/learn/em/cpp/FABase.cpp",
@@ -66,6 +73,7 @@ setup(
           "bob/learn/em/cpp/ISVBase.cpp",
           "bob/learn/em/cpp/JFAMachine.cpp",
           "bob/learn/em/cpp/ISVMachine.cpp",
+          "bob/learn/em/cpp/ProbeCache.cpp",
 
           "bob/learn/em/cpp/FABaseTrainer.cpp",
           "bob/learn/em/cpp/JFATrainer.cpp",
@@ -78,10 +86,14 @@ setup(
           "bob/learn/em/cpp/MAP_GMMTrainer.cpp",
           "bob/learn/em/cpp/ML_GMMTrainer.cpp",
           "bob/learn/em/cpp/PLDATrainer.cpp",
+
+          "bob/learn/em/cpp/MappedFile.cpp",
+          "bob/learn/em/cpp/ProcessPool.cpp",
         ],
         bob_packages = bob_packages,
         packages = packages,
         boost_modules = boost_modules,
+        libraries = system_libraries,
         version = version,
       ),
 
@@ -104,25 +116,35 @@ setup(
           "bob/learn/em/isv_machine.cpp",
           "bob/learn/em/isv_trainer.cpp",
 
+          "bob/learn/em/probe_cache.cpp",
+
           "bob/learn/em/ivector_machine.cpp",
           "bob/learn/em/ivector_trainer.cpp",
 
           "bob/learn/em/plda_base.cpp",
           "bob/learn/em/plda_machine.cpp",
+          "bob/learn/em/plda_scoring.cpp",
+          "bob/learn/em/plda_fast_scorer.cpp",
 
           "bob/learn/em/empca_trainer.cpp",
 
           "bob/learn/em/plda_trainer.cpp",
 
           "bob/learn/em/ztnorm.cpp",
+          "bob/learn/em/ztnorm_statistics.cpp",
 
           "bob/learn/em/linear_scoring.cpp",
 
+          "bob/learn/em/em_driver.cpp",
+
+          "bob/learn/em/mapped_array.cpp",
+
           "bob/learn/em/main.cpp",
         ],
         bob_packages = bob_packages,
         packages = packages,
         boost_modules = boost_modules,
+        libraries = system_libraries,
         version = version,
       ),
     ],